@@ -0,0 +1,31 @@
+#ifndef _ACCESS_EVENT_H
+#define _ACCESS_EVENT_H
+
+#include <Arduino.h>
+
+#define ACCESS_EVENT_CREDENTIAL_SIZE 12
+
+enum class AccessEventType : uint8_t {
+	FOB_GRANTED = 0,
+	FOB_DENIED = 1,
+	PIN_ACCEPTED = 2,
+	PIN_REJECTED = 3,
+	DOOR_FORCED_OPEN = 4,
+	DOOR_HELD_OPEN = 5
+};
+
+// Audit record for a single access decision or door alarm. Fixed size so
+// it can be written to flash as-is. PINs are never recorded.
+struct AccessEvent {
+	uint32_t sequence;
+	uint32_t timestamp;             // Controller clock (epoch seconds), 0 if not yet set.
+	AccessEventType type;
+	uint8_t doorId;                 // DOOR_NONE if the source is not attached to a door.
+	uint8_t sourceId;               // Reader or keypad ID.
+	uint8_t credentialLen;
+	uint8_t credential[ACCESS_EVENT_CREDENTIAL_SIZE];
+};
+
+static_assert(sizeof(AccessEvent) == 24, "AccessEvent must stay 24 bytes; it is stored in flash");
+
+#endif
\ No newline at end of file
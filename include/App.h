@@ -2,34 +2,51 @@
 #define _APP_H
 
 #include <Arduino.h>
+#include <atomic>
 #include <time.h>
 #include <vector>
 #include <WiFi.h>
 #include <WiFiClient.h>
 #include <WiFiUdp.h>
 
+#include "AccessEvent.h"
 #include "Adafruit_MCP23017.h"
+#include "ArduinoJson.h"
 #include "config.h"
 #include "Doors.h"
+#include "HeapStats.h"
+#include "LatencyStats.h"
 #include "LED.h"
+#include "MqttOutbox.h"
 #include "NTPClient.h"
 #include "PubSubClient.h"
+#include "ReactionManager.h"
 #include "RTClib.h"
+#include "TaskStats.h"
 #include "TelemetryHelper.h"
+#include "TimerWheel.h"
 
 #include "drivers/CoreIO.h"
 #include "drivers/FobReader.h"
+#include "drivers/I2CBus.h"
 #include "drivers/Keypad.h"
 #include "drivers/RelayModule.h"
 
+#include "services/AuthService.h"
+#include "services/ConfigCache.h"
+#include "services/EventSpool.h"
+#include "services/Journal.h"
+
 #include "tasks/TaskApplication.h"
+#include "tasks/TaskAuthWorker.h"
 #include "tasks/TaskCheckKeypads.h"
 #include "tasks/TaskCheckFobReaders.h"
 #include "tasks/TaskSyncClock.h"
 #include "tasks/TaskCheckWiFi.h"
-#include "tasks/TaskCheckMqtt.h"
+#include "tasks/TaskMqtt.h"
 #include "tasks/TaskHeartBeat.h"
 #include "tasks/TaskInput.h"
+#include "tasks/TaskRefreshAuthToken.h"
 
 #ifdef SUPPORT_MDNS
 #include <ESPmDNS.h>
@@ -37,6 +54,46 @@
 
 #define FIRMWARE_VERSION "1.0"
 
+// Status fields changed since the last successful publish.
+#define STATUS_DIRTY_SYSTEM_STATE 0x01
+#define STATUS_DIRTY_ARM_STATE 0x02
+#define STATUS_DIRTY_STATUS_MSG 0x04
+#define STATUS_DIRTY_DOOR(field) (1 << (uint8_t)(field))
+
+// A status message's dirty masks, packed into its outbox context so a
+// failed publish can hand them back: the status fields in the low byte,
+// then STATUS_DOOR_FIELD_BITS per door.
+#define STATUS_DOOR_FIELD_BITS 3
+#define STATUS_CONTEXT_DOOR_SHIFT(id) (8 + ((id) * STATUS_DOOR_FIELD_BITS))
+#define STATUS_CONTEXT_FULL 0x80000000UL
+
+#define STATUS_TOPOLOGY_SIZE 2048               // Serialized door topology.
+#define STATUS_PAYLOAD_SIZE 2560                // Largest status message (full snapshot).
+#define EVENT_PAYLOAD_SIZE 192                  // Largest encoded access event.
+#define JOURNAL_PAYLOAD_SIZE 1536               // Largest journal query reply.
+#define DIAG_PAYLOAD_SIZE 2560                  // Largest diagnostics report. The stage latency report tops out near 2.2 KB.
+#define JOURNAL_DOC_SIZE (JSON_OBJECT_SIZE(3) + JSON_ARRAY_SIZE(JOURNAL_QUERY_LIMIT) + (JOURNAL_QUERY_LIMIT * (JSON_OBJECT_SIZE(7) + (JOURNAL_MAX_DATA * 2) + 1)))
+#define STATUS_DOC_SIZE (JSON_OBJECT_SIZE(8) + JSON_ARRAY_SIZE(DOOR_MAX_DOORS) + (DOOR_MAX_DOORS * JSON_OBJECT_SIZE(4)))
+#define LATENCY_HISTOGRAM_DOC_SIZE (JSON_OBJECT_SIZE(7) + JSON_ARRAY_SIZE(LATENCY_BUCKET_COUNT))
+#define TASK_STATS_DOC_SIZE (JSON_OBJECT_SIZE(5) + JSON_ARRAY_SIZE(TASK_STATS_MAX_TASKS) + (TASK_STATS_MAX_TASKS * JSON_OBJECT_SIZE(4)) + JSON_ARRAY_SIZE(TASK_STATS_MAX_QUEUES) + (TASK_STATS_MAX_QUEUES * JSON_OBJECT_SIZE(6)))
+#define HEAP_STATS_DOC_SIZE (JSON_OBJECT_SIZE(9) + JSON_OBJECT_SIZE(HEAP_SUBSYSTEM_COUNT) + (HEAP_SUBSYSTEM_COUNT * JSON_OBJECT_SIZE(4)))
+#define LATENCY_DOC_SIZE (JSON_OBJECT_SIZE(4) + JSON_ARRAY_SIZE(LATENCY_BOUND_COUNT) + JSON_OBJECT_SIZE(LATENCY_STAGE_COUNT) + (LATENCY_STAGE_COUNT * LATENCY_HISTOGRAM_DOC_SIZE))
+#define DOOR_LATENCY_DOC_SIZE (JSON_OBJECT_SIZE(4) + JSON_ARRAY_SIZE(LATENCY_BOUND_COUNT) + JSON_ARRAY_SIZE(DOOR_MAX_DOORS) + (DOOR_MAX_DOORS * LATENCY_HISTOGRAM_DOC_SIZE))
+
+#define CONTROL_DOC_SIZE JSON_OBJECT_SIZE(12)   // Zero-copy parse; holds no strings.
+
+class Application;
+
+struct ControlHandlerEntry {
+	void (Application::*handler)(const ControlRequest* request);
+	uint8_t requiredFields;         // CONTROL_FIELD_* the command cannot run without.
+};
+
+struct MqttControlMessage {
+	uint16_t length;
+	byte payload[MQTT_CONTROL_MAX_SIZE];
+};
+
 using namespace std;
 
 class Application
@@ -50,15 +107,18 @@ public:
 	TaskHandle_t fobReaderCheckTask;
 	TaskHandle_t clockSyncTask;
 	TaskHandle_t wifiCheckTask;
-	TaskHandle_t mqttCheckTask;
+	TaskHandle_t mqttTask;
 	TaskHandle_t inputTask;
+	TaskHandle_t authTokenTask;
+	TaskHandle_t authWorkerTask;
 	QueueHandle_t keypadQueue;
 	QueueHandle_t fobReaderQueue;
-	QueueHandle_t dryContactQueue;
-	QueueHandle_t optoContactQueue;
+	QueueHandle_t zoneQueue;
+	QueueHandle_t authRequestQueue;
+	QueueHandle_t authResultQueue;
+	QueueHandle_t mqttControlQueue;
 	vector<Keypad> keypads;
 	vector<FobReader> fobReaders;
-	vector<Door> doors;
 	NTPClient *timeClient;
 	RTC_DS1307 rtc;
 	volatile SystemState sysState = SystemState::BOOTING;
@@ -74,7 +134,10 @@ public:
 	void init();
 	void update();
 	void reboot();
-	void onCheckMqtt();
+	void onMqttService();
+	void requestFullStatus();
+	bool publishMqttMessage(MqttTopic topic, const uint8_t* payload, size_t length);
+	void onMqttPublishFailed(MqttTopic topic, uint32_t context);
 	void failSafe();
 	void getAvailableNetworks();
 	void doFactoryRestore();
@@ -83,6 +146,10 @@ public:
 	void handleSwitchToDhcp();
 	void handleSwitchToStatic(IPAddress newIp, IPAddress newSm, IPAddress newGw, IPAddress newDns);
 	void onCheckWiFi();
+	void onRefreshAuthToken();
+	void onFobAuthComplete(const AuthResult* result);
+	void onKeypadAuthComplete(const AuthResult* result);
+	void onDoorStateChange(uint8_t doorId, DoorField field);
 	void handleReconnectFromConsole();
 	void handleWifiConfig(String newSsid, String newPassword);
 	void handleSaveConfig();
@@ -100,13 +167,40 @@ private:
 	bool rtcFound = false;
 	vector<byte> devicesFound;
 	vector<Adafruit_MCP23017> additionalBusses;
+	vector<uint8_t> additionalBusAddresses;     // Bus address of each entry in additionalBusses (for stats).
 	vector<RelayModule> relayModules;
 	String statusMsg;
 	volatile ArmState armState = ArmState::DISARMED;
+	uint16_t zoneState = 0;
+	volatile bool fullStatusRequested = true;
+	uint8_t statusDirty = 0;
+	uint8_t doorDirty[DOOR_MAX_DOORS] = { 0 };
+	std::atomic<uint32_t> statusRetry;          // Dirty masks of failed status publishes (set by the MQTT task).
+	String sentStatusMsg;
+	unsigned long lastStatusPublish = 0;
+	char statusTopology[STATUS_TOPOLOGY_SIZE];
+	size_t statusTopologyLength = 0;
+	char statusPayload[STATUS_PAYLOAD_SIZE];
+	volatile bool mqttConnected = false;
+	volatile bool mqttReconfigureRequested = false;
+	unsigned long lastMqttAttempt = 0;
+	uint32_t mqttControlDropped = 0;
+	uint32_t nextEventSequence = 1;
+	unsigned long lastSpoolDrain = 0;
+	bool spoolDrainFailed = false;
+	char spoolPayload[EVENT_PAYLOAD_SIZE];
+	char journalPayload[JOURNAL_PAYLOAD_SIZE];
+	char diagPayload[DIAG_PAYLOAD_SIZE];
+	unsigned long lastTaskStatsPublish = 0;
+	unsigned long lastHeapStatsPublish = 0;
+	static const ControlHandlerEntry controlHandlers[CONTROL_COMMAND_COUNT];
 
 private:
 	void printNetworkInfo();
 	void publishSystemState();
+	void buildStatusTopology();
+	void setSystemState(SystemState state);
+	void setStatusMessage(const char* message);
 	void saveConfiguration();
 	void printWarningAndContinue(const __FlashStringHelper *message);
 	void setConfigurationDefaults();
@@ -114,8 +208,19 @@ private:
 	void scanBusDevices();
 	void resetCommBus();
 	void connectWifi();
-	void handleControlRequest(ControlCommand command);
+	void handleControlRequest(const ControlRequest* request);
+	bool parseControlRequest(MqttControlMessage* message, ControlRequest* request);
+	void onControlDisable(const ControlRequest* request);
+	void onControlEnable(const ControlRequest* request);
+	void onControlReboot(const ControlRequest* request);
+	void onControlRequestStatus(const ControlRequest* request);
+	void onControlSetArmState(const ControlRequest* request);
+	void onControlLockDoor(const ControlRequest* request);
+	void onControlUnlockDoor(const ControlRequest* request);
+	void onControlQueryJournal(const ControlRequest* request);
+	void onControlQueryLatency(const ControlRequest* request);
 	bool reconnectMqttClient();
+	void handleControlMessage(MqttControlMessage* message);
 	void initSys();
 	void initCommBus();
 	void initCoreIO();
@@ -123,12 +228,34 @@ private:
 	void initRelayModules();
 	void initFilesystem();
 	void loadDoors();
+	void loadRules();
+	void dispatchEvent(ReactionEvent event, uint8_t moduleId, uint8_t sourceId);
+	void executeAction(const ReactionAction* action);
+	void setRelay(uint8_t moduleId, uint8_t relayId, bool energize);
+	void setArmState(ArmState state);
 	void initMDNS();
 	void initOTA();
 	void initConsole();
 	void initApiClient();
+	void initCredentialStore();
 	void onKeypadCommand(KeypadData* cmdData);
 	void onFobRead(Tag* tagData);
+	void onZoneChange(ZoneSnapshot* snapshot);
+	void handleTagDecision(uint8_t readerId, bool valid, const uint8_t* uid, uint8_t uidLen, uint32_t seenAt);
+	void initEventSpool();
+	uint32_t getClockTime();
+	void recordAccessEvent(AccessEventType type, uint8_t doorId, uint8_t sourceId, const uint8_t* credential, uint8_t credentialLen);
+	size_t encodeAccessEvent(const AccessEvent* event, char* buffer, size_t size);
+	void drainEventSpool();
+	void initJournal();
+	void journalEvent(JournalEventType type, uint8_t doorId, uint8_t source, uint8_t target, bool value, const uint8_t* data, uint8_t dataLen);
+	void queryJournal(const ControlRequest* request);
+	void publishLatencyStats();
+	void publishDoorLatencyStats();
+	void publishTaskStats();
+	void publishHeapStats();
+	void addLatencyHistogram(JsonObject item, const LatencyHistogram* histogram);
+	bool submitAuthRequest(AuthRequestType type, uint8_t sourceId, const char* credential, const uint8_t* context, AuthCompletionHandler onComplete, uint32_t seenAt);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef _CHUNKED_STREAM_H
+#define _CHUNKED_STREAM_H
+
+#include <Arduino.h>
+
+#define CHUNKED_STREAM_MAX_SIZE_DIGITS 8        // Longest chunk size line we accept (hex digits).
+
+/**
+ * Read-only view of an HTTP response body sent with "Transfer-Encoding:
+ * chunked". Reads the chunk framing off the source stream as it goes and
+ * hands out only the body bytes, so a parser can consume a chunked body of
+ * any size without it being buffered first. Reading ends (returns -1) at the
+ * terminating zero-length chunk, on a framing error, or when the source
+ * times out.
+ */
+class ChunkedStream : public Stream {
+public:
+	ChunkedStream(Stream& source);
+	int available() override;
+	int read() override;
+	int peek() override;
+	size_t write(uint8_t c) override;
+	void flush() override;
+	void finish();
+	bool failed();
+
+private:
+	int readSource();
+	bool nextChunk();
+
+	Stream* _source;
+	uint32_t _remaining;
+	int _peeked;
+	bool _started;
+	bool _done;
+	bool _failed;
+};
+
+#endif
\ No newline at end of file
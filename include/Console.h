@@ -28,6 +28,9 @@ public:
     void onConsoleInterrupt(void (*interruptHandler)());
     void onFactoryRestore(void (*factoryRestoreHandler)());
     void onBusReset(void (*busResetHandler)());
+    void onLatencyStats(void (*latencyStatsHandler)());
+    void onTaskStats(void (*taskStatsHandler)());
+    void onHeapStats(void (*heapStatsHandler)());
 	void checkInterrupt();
 
 private:
@@ -51,6 +54,9 @@ private:
     void (*interruptHandler)();
     void (*factoryRestoreHandler)();
     void (*busResetHandler)();
+    void (*latencyStatsHandler)();
+    void (*taskStatsHandler)();
+    void (*heapStatsHandler)();
 
 	String _hostname;
     String _mqttBroker;
@@ -2,9 +2,19 @@
 #define _DOORS_H
 
 #include <Arduino.h>
-#include <vector>
+#include "TimerWheel.h"
 
-using namespace std;
+#define DOOR_MAX_DOORS 4
+#define DOOR_MAX_READERS 2
+#define DOOR_MAX_KEYPADS 2
+#define DOOR_MAX_INPUTS 8
+#define DOOR_NAME_SIZE 32
+#define DOOR_INDEX_DEVICES 8    // Reader/keypad IDs covered by the reverse index.
+#define DOOR_INDEX_MODULES 8    // I/O module IDs covered by the reverse index.
+#define DOOR_INDEX_INPUTS 16    // Input IDs per module covered by the reverse index.
+#define DOOR_NONE 0xFF
+#define DOOR_DEFAULT_HELD_OPEN 30000    // Time a door may stay open before it is held open (milliseconds).
+#define DOOR_DEFAULT_UNLOCK_TIME 5000   // Time a granted door stays unlocked or shunted (milliseconds).
 
 enum class LockState : uint8_t {
 	UNLOCKED = 0,
@@ -15,7 +25,9 @@ enum class LockState : uint8_t {
 enum class DoorState : uint8_t {
 	OPEN = 0,
 	CLOSED = 1,
-	UNKNOWN = 2
+	UNKNOWN = 2,
+	HELD_OPEN = 3,
+	FORCED_OPEN = 4
 };
 
 enum class InputType : uint8_t {
@@ -32,6 +44,8 @@ struct DoorInput {
 	InputType type;
 	uint8_t moduleId;
 	uint8_t inputId;
+	uint16_t debounceMs;
+	bool invert;
 };
 
 struct Reader {
@@ -47,35 +61,97 @@ struct LockRelay {
 	uint8_t moduleId;
 };
 
+enum class DoorField : uint8_t {
+	ENABLED = 0,
+	STATE = 1,
+	LOCK_STATE = 2
+};
+
+// Door topology. Fixed after load; runtime state lives in DoorManagerClass.
 struct Door {
-	const char* name;
-	vector<Reader> readers;
-	vector<DoorKeypad> keypads;
-	vector<DoorInput> inputs;
+	char name[DOOR_NAME_SIZE];
+	Reader readers[DOOR_MAX_READERS];
+	uint8_t readerCount;
+	DoorKeypad keypads[DOOR_MAX_KEYPADS];
+	uint8_t keypadCount;
+	DoorInput inputs[DOOR_MAX_INPUTS];
+	uint8_t inputCount;
 	LockRelay lockRelay;
-	bool enabled;
-	DoorState state;
-	LockState lockState;
+	uint32_t heldOpenMs;    // 0 disables held-open detection.
+	uint16_t unlockMs;
+	bool rexUnlock;         // REX also releases the lock, not just shunts the contact.
 };
 
+typedef void (*DoorChangeHandler)(uint8_t doorId, DoorField field);
+
+/**
+ * Fixed-capacity, index-addressed door table. Topology is stored as an
+ * array of Door records and runtime state as parallel arrays, so reads are
+ * plain array accesses and updates never touch the heap. The change handler
+ * only fires when a value actually changes.
+ *
+ * Door state is derived from the door contact, REX inputs and lock state:
+ * a contact that opens while the door is locked and no access was granted
+ * is FORCED_OPEN; one that stays open past heldOpenMs is HELD_OPEN. The
+ * relock and held-open timeouts run on the shared TimerWheel, so every
+ * method here must be called from the main application loop.
+ */
 class DoorManagerClass {
 public:
 	DoorManagerClass();
-	void attachDoor(Door door);
-	void attachReader(uint8_t doorId, Reader reader);
-	void attachKeypad(uint8_t doorId, DoorKeypad keypad);
+	bool attachDoor(const Door& door);
+	bool attachReader(uint8_t doorId, Reader reader);
+	bool attachKeypad(uint8_t doorId, DoorKeypad keypad);
+	bool attachInput(uint8_t doorId, DoorInput input);
 	void attachLockRelay(uint8_t doorId, LockRelay relay);
-	DoorState getDoorState(uint8_t doorId);
-	LockState getLockState(uint8_t doorId);
+	uint8_t getDoorCount() const;
+	const Door* getDoor(uint8_t doorId) const;
+	bool isEnabled(uint8_t doorId) const;
+	DoorState getDoorState(uint8_t doorId) const;
+	LockState getLockState(uint8_t doorId) const;
+	uint8_t getDoorForReader(uint8_t readerId) const;
+	uint8_t getDoorForKeypad(uint8_t keypadId) const;
+	uint8_t getDoorForInput(uint8_t moduleId, uint8_t inputId) const;
+	uint8_t getDoorForRelay(uint8_t moduleId, uint8_t relayId) const;
+	void setDoorState(uint8_t doorId, DoorState state);
 	void enableDoor(uint8_t doorId);
 	void disableDoor(uint8_t doorId);
 	void lockDoor(uint8_t doorId);
 	void unlockDoor(uint8_t doorId);
+	void grantAccess(uint8_t doorId);
+	void onInputChange(uint8_t moduleId, uint8_t inputId, bool active);
+	void syncInput(uint8_t moduleId, uint8_t inputId, bool active);
 	void clearDoors();
-	vector<Door> getDoors();
+	void onStateChange(DoorChangeHandler handler);
 
 private:
-	vector<Door> _doors;
+	void notify(uint8_t doorId, DoorField field);
+	void indexDoor(uint8_t doorId);
+	const DoorInput* findInput(uint8_t doorId, uint8_t moduleId, uint8_t inputId) const;
+	void openAccessWindow(uint8_t doorId, bool unlock);
+	void onContactChange(uint8_t doorId, bool open);
+	void onAccessTimeout(uint8_t doorId);
+	void onHeldOpenTimeout(uint8_t doorId);
+	static void accessTimerExpired(uint32_t arg);
+	static void heldOpenTimerExpired(uint32_t arg);
+	static void indexDevice(uint8_t* index, uint8_t size, uint8_t deviceId, uint8_t doorId);
+
+	Door _doors[DOOR_MAX_DOORS];
+	uint8_t _count;
+	bool _enabled[DOOR_MAX_DOORS];
+	DoorState _state[DOOR_MAX_DOORS];
+	LockState _lockState[DOOR_MAX_DOORS];
+	bool _contactOpen[DOOR_MAX_DOORS];
+	bool _authorized[DOOR_MAX_DOORS];     // An opening is expected (grant, REX or latched unlock).
+	bool _relockPending[DOOR_MAX_DOORS];  // Unlocked by grantAccess(); relock on timeout or close.
+	wheel_timer_t _accessTimer[DOOR_MAX_DOORS];
+	wheel_timer_t _heldTimer[DOOR_MAX_DOORS];
+	DoorChangeHandler _changeHandler;
+
+	// Reverse index: device -> owning door (DOOR_NONE if unassigned).
+	uint8_t _readerDoor[DOOR_INDEX_DEVICES];
+	uint8_t _keypadDoor[DOOR_INDEX_DEVICES];
+	uint8_t _inputDoor[DOOR_INDEX_MODULES * DOOR_INDEX_INPUTS];
 };
 
 extern DoorManagerClass DoorManager;
@@ -0,0 +1,102 @@
+#ifndef _HEAP_STATS_H
+#define _HEAP_STATS_H
+
+#include <Arduino.h>
+#include "ArduinoJson.h"
+
+#define HEAP_STATS_SAMPLE_INTERVAL 1000     // How often the heap-wide figures are sampled (milliseconds).
+
+// Who an allocation is charged to.
+enum class HeapSubsystem : uint8_t {
+	CONFIG = 0,         // config.json parse.
+	DOORS = 1,          // doors.json parse.
+	RULES = 2,          // rules.json parse and the compiled action table.
+	STATUS = 3          // Door topology for status snapshots.
+};
+
+#define HEAP_SUBSYSTEM_COUNT 4
+
+struct HeapUsage {
+	uint32_t current;       // Bytes held right now.
+	uint32_t peak;          // Most bytes ever held at once.
+	uint32_t allocations;
+	uint32_t failures;
+};
+
+// Heap-wide figures. The min* values are lows since boot.
+struct HeapSnapshot {
+	uint32_t size;
+	uint32_t free;
+	uint32_t minFree;
+	uint32_t largest;       // Largest free block: the biggest allocation that can succeed.
+	uint32_t minLargest;
+	uint8_t fragmentation;  // Percent of free heap not in the largest block.
+};
+
+/**
+ * Tracks heap usage per subsystem, along with free heap and the largest
+ * free block over time. Large, short-lived allocations (mostly JSON
+ * documents) go through allocate() and deallocate(), which charge them to
+ * a subsystem. A subsystem whose current usage doesn't return to zero is
+ * leaking. Fragmentation shows up as the largest free block falling while
+ * free heap holds steady.
+ *
+ * Each tracked block carries a small header with its size and owner, so
+ * the matching deallocate() needs nothing but the pointer. Counters are
+ * updated in a critical section; the allocation itself happens outside
+ * of it.
+ */
+class HeapStatsClass {
+public:
+	HeapStatsClass();
+	void begin();
+	void* allocate(HeapSubsystem subsystem, size_t size);
+	void* reallocate(void* ptr, size_t size);
+	void deallocate(void* ptr);
+	void update(unsigned long now);
+	void sample();
+	const HeapUsage* getUsage(HeapSubsystem subsystem);
+	const HeapSnapshot* getSnapshot();
+	uint32_t getOutstanding();
+	void print();
+	static const char* getSubsystemName(HeapSubsystem subsystem);
+
+private:
+	struct Header {
+		uint32_t size;
+		uint8_t subsystem;
+		uint8_t reserved[3];    // Keeps the block pointer-aligned for 64 bit native builds.
+	};
+
+	void charge(uint8_t subsystem, uint32_t size);
+	void release(uint8_t subsystem, uint32_t size);
+
+	HeapUsage _usage[HEAP_SUBSYSTEM_COUNT];
+	HeapSnapshot _snapshot;
+	unsigned long _lastSample;
+	portMUX_TYPE _mux;
+};
+
+extern HeapStatsClass HeapStats;
+
+// ArduinoJson allocator that charges the document's pool to a subsystem.
+template <HeapSubsystem S>
+struct HeapTrackingAllocator {
+	void* allocate(size_t size) {
+		return HeapStats.allocate(S, size);
+	}
+
+	void deallocate(void* ptr) {
+		HeapStats.deallocate(ptr);
+	}
+
+	void* reallocate(void* ptr, size_t size) {
+		return HeapStats.reallocate(ptr, size);
+	}
+};
+
+// Drop-in replacement for DynamicJsonDocument.
+template <HeapSubsystem S>
+using TrackedJsonDocument = BasicJsonDocument<HeapTrackingAllocator<S> >;
+
+#endif
\ No newline at end of file
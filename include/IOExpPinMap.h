@@ -63,6 +63,10 @@
 #define PIN_EXP_DIO_17 17
 #define PIN_EXP_DIO_21 21
 
+// I/O expander interrupt. INTA and INTB are mirrored and routed to DIO 17
+// on the expansion header.
+#define PIN_EXP_INT PIN_EXP_DIO_17
+
 // Relay module relays
 #define PIN_RM_RELAY1 GPB0
 #define PIN_RM_RELAY2 GPB1
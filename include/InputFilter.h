@@ -0,0 +1,39 @@
+#ifndef _INPUT_FILTER_H
+#define _INPUT_FILTER_H
+
+#include <Arduino.h>
+
+#define INPUT_FILTER_ZONES 16
+#define INPUT_FILTER_PLANES 5                                       // Counter bits per zone.
+#define INPUT_FILTER_MAX_SAMPLES ((1 << INPUT_FILTER_PLANES) - 1)   // Longest debounce, in samples.
+#define INPUT_FILTER_SAMPLE_INTERVAL 5                              // Time between samples while settling (milliseconds).
+#define INPUT_FILTER_DEFAULT_DEBOUNCE 20                            // Default debounce time (milliseconds).
+
+/**
+ * Debounces all 16 zone inputs at once using vertical (bit-sliced) counters.
+ * Counter bit N of every zone lives in _counter[N], so advancing, comparing
+ * and resetting all zones costs a handful of word operations per sample
+ * regardless of how many zones are bouncing. A zone only changes state once
+ * it has read the new value for its configured number of consecutive samples.
+ */
+class InputFilterClass {
+public:
+	InputFilterClass();
+	void reset(uint16_t state);
+	void setDebounceTime(uint8_t zone, uint16_t debounceMs);
+	uint16_t getDebounceTime(uint8_t zone);
+	uint16_t update(uint16_t raw);
+	uint16_t getState();
+	bool isSettling();
+
+private:
+	uint16_t _state;
+	uint16_t _settling;
+	uint16_t _counter[INPUT_FILTER_PLANES];
+	uint16_t _threshold[INPUT_FILTER_PLANES];
+	portMUX_TYPE _mux;
+};
+
+extern InputFilterClass InputFilter;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef _LATENCY_STATS_H
+#define _LATENCY_STATS_H
+
+#include <Arduino.h>
+#include "Doors.h"
+
+#define LATENCY_BOUND_COUNT 15                          // Bucket upper bounds. One more bucket catches the rest.
+#define LATENCY_BUCKET_COUNT (LATENCY_BOUND_COUNT + 1)
+
+// Stages a fob read goes through on its way to the lock relay. Tags the
+// local credential database answers skip the three AUTH_* stages.
+enum class LatencyStage : uint8_t {
+	READ_QUEUE = 0,     // Tag read off the reader -> picked up by the main loop.
+	LOOKUP = 1,         // Picked up -> local credential database answered.
+	AUTH_QUEUE = 2,     // Submitted to the auth worker -> worker started on it.
+	AUTH_CHECK = 3,     // Remote credential check.
+	AUTH_RETURN = 4,    // Worker finished -> completion handler run by the main loop.
+	ACTUATE = 5,        // Decision -> lock relay set (journaling included).
+	TOTAL = 6           // Tag read off the reader -> lock relay set.
+};
+
+#define LATENCY_STAGE_COUNT 7
+
+struct LatencyHistogram {
+	uint32_t buckets[LATENCY_BUCKET_COUNT];
+	uint32_t count;
+	uint64_t sum;       // Microseconds.
+	uint32_t max;       // Microseconds.
+};
+
+/**
+ * Fixed-bucket latency histograms for the badge-to-unlock path, one per
+ * stage and one per door (end to end). Samples are micros() deltas, so a
+ * single sample is good for about 71 minutes before it wraps.
+ *
+ * Not thread-safe. Stage timestamps are taken on whatever task hits the
+ * stage and travel with the tag (or auth request) through the queues;
+ * samples are only recorded, read and reset from the main application
+ * loop.
+ */
+class LatencyStatsClass {
+public:
+	LatencyStatsClass();
+	void record(LatencyStage stage, uint32_t start, uint32_t end);
+	void recordDoor(uint8_t doorId, uint32_t start, uint32_t end);
+	const LatencyHistogram* getStage(LatencyStage stage);
+	const LatencyHistogram* getDoor(uint8_t doorId);
+	void reset();
+	void print();
+	static uint32_t getBound(uint8_t bucket);
+	static uint32_t getPercentile(const LatencyHistogram* histogram, uint8_t percent);
+	static const char* getStageName(LatencyStage stage);
+
+private:
+	static void add(LatencyHistogram* histogram, uint32_t elapsed);
+	static void printHistogram(const LatencyHistogram* histogram);
+
+	LatencyHistogram _stages[LATENCY_STAGE_COUNT];
+	LatencyHistogram _doors[DOOR_MAX_DOORS];
+};
+
+extern LatencyStatsClass LatencyStats;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef _MQTT_OUTBOX_H
+#define _MQTT_OUTBOX_H
+
+#include <Arduino.h>
+#include <atomic>
+
+#define MQTT_OUTBOX_DEPTH 4                             // Must be a power of 2.
+#define MQTT_OUTBOX_SLOT_SIZE 2560                      // Largest message payload (a full status snapshot).
+#define MQTT_COALESCE_NONE 0
+#define MQTT_COALESCE_FULL_STATUS 1
+#define MQTT_COALESCE_TASK_STATS 2
+#define MQTT_COALESCE_HEAP_STATS 3
+
+enum class MqttTopic : uint8_t {
+	STATUS = 0,
+	EVENTS = 1,
+	JOURNAL = 2,
+	DIAG = 3
+};
+
+struct MqttOutboxStats {
+	uint32_t queued;
+	uint32_t published;
+	uint32_t dropped;     // Outbox full (or payload too large) when pushed.
+	uint32_t coalesced;   // Superseded by a newer message with the same key before it was sent.
+	uint32_t failed;      // Handed to the client but the publish failed.
+};
+
+// Sends one message. Returns true if the client accepted it.
+typedef bool (*MqttPublishHandler)(MqttTopic topic, const uint8_t* payload, size_t length);
+
+// Called with the context a message was pushed with when its publish failed.
+typedef void (*MqttFailureHandler)(MqttTopic topic, uint32_t context);
+
+/**
+ * Bounded multi-producer/multi-consumer ring of outbound MQTT messages
+ * (Vyukov's sequence-per-slot queue). Producers on any task claim a slot
+ * with one CAS and never block; when the ring is full the new message is
+ * dropped and counted, and the producer decides whether to retry later.
+ * The network task drains the ring and owns the socket, so a slow broker
+ * never stalls the task that produced the message.
+ *
+ * Messages pushed with the same non-zero coalesce key replace each other:
+ * if a newer one is queued anywhere behind it when it reaches the head,
+ * the older one is skipped.
+ *
+ * A producer can attach a context word to a message. It is handed back
+ * through the failure handler if the publish fails, so the producer can
+ * send the same content again.
+ */
+class MqttOutboxClass {
+public:
+	MqttOutboxClass();
+	bool push(MqttTopic topic, const uint8_t* payload, size_t length, uint8_t coalesceKey = MQTT_COALESCE_NONE, uint32_t context = 0);
+	uint8_t drain(MqttPublishHandler handler, uint8_t maxMessages, MqttFailureHandler onFailure = nullptr);
+	void getStats(MqttOutboxStats* stats);
+
+private:
+	struct Slot {
+		std::atomic<uint32_t> sequence;
+		uint32_t position;
+		MqttTopic topic;
+		uint8_t coalesceKey;
+		uint16_t length;
+		uint32_t context;
+		uint8_t payload[MQTT_OUTBOX_SLOT_SIZE];
+	};
+
+	Slot* acquire();
+	void release(Slot* slot);
+	bool isSuperseded(const Slot* slot);
+
+	Slot _slots[MQTT_OUTBOX_DEPTH];
+	std::atomic<uint32_t> _enqueuePos;
+	std::atomic<uint32_t> _dequeuePos;
+	std::atomic<uint32_t> _queued;
+	std::atomic<uint32_t> _dropped;
+	uint32_t _published;
+	uint32_t _coalesced;
+	uint32_t _failed;
+};
+
+extern MqttOutboxClass MqttOutbox;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef _REACTION_MANAGER_H
+#define _REACTION_MANAGER_H
+
+#include <Arduino.h>
+#include <vector>
+
+using namespace std;
+
+#define REACTION_EVENT_TYPES 5
+#define REACTION_MAX_MODULES 8
+#define REACTION_MAX_SOURCES 16
+#define REACTION_TABLE_SIZE (REACTION_EVENT_TYPES * REACTION_MAX_MODULES * REACTION_MAX_SOURCES)
+#define REACTION_MAX_ACTIONS 0xFFFF
+
+enum class ReactionEvent : uint8_t {
+	KEYPAD_COMMAND = 0,     // module = keypad ID, source = KeypadCommands value
+	FOB_GRANTED = 1,        // module = reader ID, source = 0
+	FOB_DENIED = 2,         // module = reader ID, source = 0
+	ZONE_ACTIVE = 3,        // module = I/O module ID, source = input ID
+	ZONE_INACTIVE = 4       // module = I/O module ID, source = input ID
+};
+
+enum class ReactionActionType : uint8_t {
+	RELAY_ON = 0,           // module = relay module ID, target = relay ID
+	RELAY_OFF = 1,          // module = relay module ID, target = relay ID
+	LOCK_DOOR = 2,          // target = door ID
+	UNLOCK_DOOR = 3,        // target = door ID
+	ARM_STAY = 4,
+	ARM_AWAY = 5,
+	DISARM = 6
+};
+
+struct ReactionAction {
+	ReactionActionType type;
+	uint8_t moduleId;
+	uint8_t targetId;
+};
+
+/**
+ * Maps events (keypad commands, fob decisions, zone changes) to actions.
+ * Rules are staged while loading the rules file and then compiled into a
+ * flat table indexed by (event, module, source): an offset array into one
+ * contiguous action array. Dispatch is a bounds check and two array reads.
+ */
+class ReactionManagerClass {
+public:
+	ReactionManagerClass();
+	void clear();
+	bool addRule(ReactionEvent event, uint8_t moduleId, uint8_t sourceId, ReactionAction action);
+	bool compile();
+	uint16_t getActions(ReactionEvent event, uint8_t moduleId, uint8_t sourceId, const ReactionAction** actions);
+	uint16_t getActionCount();
+
+private:
+	struct StagedRule {
+		uint16_t key;
+		ReactionAction action;
+	};
+
+	static int getKey(ReactionEvent event, uint8_t moduleId, uint8_t sourceId);
+
+	vector<StagedRule> _staged;
+	uint16_t _offsets[REACTION_TABLE_SIZE + 1];
+	ReactionAction* _actions;
+	uint16_t _actionCount;
+};
+
+extern ReactionManagerClass ReactionManager;
+
+#endif
\ No newline at end of file
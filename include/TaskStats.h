@@ -0,0 +1,81 @@
+#ifndef _TASK_STATS_H
+#define _TASK_STATS_H
+
+#include <Arduino.h>
+
+#define TASK_STATS_MAX_TASKS 12
+#define TASK_STATS_MAX_QUEUES 8
+#define TASK_STATS_SYSTEM_TASKS 24                  // Room for every task in the system, ours or not (run time stats only).
+#define TASK_STATS_CPU_UNKNOWN 0xFFFF
+
+#if (configUSE_TRACE_FACILITY == 1) && (configGENERATE_RUN_TIME_STATS == 1)
+	#define TASK_STATS_RUN_TIME
+#endif
+
+struct TaskStatsTask {
+	TaskHandle_t handle;
+	uint32_t stackSize;         // As passed to xTaskCreate().
+	uint32_t stackFree;         // Least free stack the task has ever had.
+	uint16_t cpu;               // Share of one core since the last collection (per mille).
+	uint32_t lastRunTime;
+};
+
+struct TaskStatsQueue {
+	QueueHandle_t queue;
+	const char* name;
+	uint16_t capacity;
+	uint16_t depth;
+	uint16_t peak;              // Deepest the queue has been.
+	uint32_t sent;
+	uint32_t overflows;         // Sends refused because the queue was full.
+};
+
+/**
+ * Runtime statistics for our FreeRTOS tasks and queues: stack headroom,
+ * CPU share, queue depth (now and peak), sends and overflows, plus the
+ * main loop iteration rate.
+ *
+ * CPU share needs the FreeRTOS run time stats (configUSE_TRACE_FACILITY
+ * and configGENERATE_RUN_TIME_STATS). Without them it is reported as
+ * TASK_STATS_CPU_UNKNOWN. On a dual core part the shares of all tasks can
+ * add up to 2000.
+ *
+ * Tasks and queues are registered, collected and read from the main
+ * application loop. send() is called by producers on any task; each queue
+ * has one producer, so its counters are only ever written by that task.
+ */
+class TaskStatsClass {
+public:
+	TaskStatsClass();
+	void watchTask(TaskHandle_t task, uint32_t stackSize);
+	void watchQueue(QueueHandle_t queue, const char* name);
+	bool send(QueueHandle_t queue, const void* item, TickType_t ticks = 0);
+	void countLoop();
+	void collect(unsigned long now);
+	uint8_t getTaskCount();
+	const TaskStatsTask* getTask(uint8_t index);
+	uint8_t getQueueCount();
+	const TaskStatsQueue* getQueue(uint8_t index);
+	uint32_t getLoopRate();
+	void print();
+
+private:
+	TaskStatsQueue* findQueue(QueueHandle_t queue);
+	void collectRunTime();
+
+	TaskStatsTask _tasks[TASK_STATS_MAX_TASKS];
+	TaskStatsQueue _queues[TASK_STATS_MAX_QUEUES];
+	uint8_t _taskCount;
+	uint8_t _queueCount;
+	uint32_t _loops;
+	uint32_t _loopRate;         // Main loop iterations per second since the last collection.
+	unsigned long _lastCollect;
+	#ifdef TASK_STATS_RUN_TIME
+	TaskStatus_t _system[TASK_STATS_SYSTEM_TASKS];
+	uint32_t _lastTotalRunTime;
+	#endif
+};
+
+extern TaskStatsClass TaskStats;
+
+#endif
\ No newline at end of file
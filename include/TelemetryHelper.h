@@ -2,6 +2,7 @@
 #define TelemetryHelper_h
 
 #include <Arduino.h>
+#include "ArduinoJson.h"
 
 enum class SystemState : uint8_t {
 	BOOTING = 0,
@@ -16,6 +17,13 @@ enum class ArmState : uint8_t {
 	ARMED_AWAY = 2
 };
 
+// Wire encoding of status and control messages. Both formats carry the
+// same document schema; only the encoding differs.
+enum class PayloadFormat : uint8_t {
+	JSON = 0,
+	MSGPACK = 1
+};
+
 enum class ControlCommand : uint8_t {
 	DISABLE = 0,
 	ENABLE = 1,
@@ -23,7 +31,31 @@ enum class ControlCommand : uint8_t {
 	REQUEST_STATUS = 3,
 	SET_ARM_STATE = 4,
 	LOCK_DOOR = 5,
-	UNLOCK_DOOR = 6
+	UNLOCK_DOOR = 6,
+	QUERY_JOURNAL = 7,
+	QUERY_LATENCY = 8
+};
+
+#define CONTROL_COMMAND_COUNT 9
+
+// Optional control message fields (ControlRequest::fields).
+#define CONTROL_FIELD_DOOR 0x01
+#define CONTROL_FIELD_ARM_STATE 0x02
+#define CONTROL_FIELD_FROM 0x04
+#define CONTROL_FIELD_TO 0x08
+#define CONTROL_FIELD_CURSOR 0x10
+#define CONTROL_FIELD_RESET 0x20
+
+// A control message, decoded. Plain data so it can be handed around (or
+// queued) without touching the parse buffer again.
+struct ControlRequest {
+	ControlCommand command;
+	uint8_t fields;                 // CONTROL_FIELD_* present in the message.
+	uint8_t doorId;
+	ArmState armState;
+	uint32_t from;
+	uint32_t to;
+	uint32_t cursor;
 };
 
 // TODO relay mapping
@@ -41,6 +73,8 @@ class TelemetryHelper
 {
 public:
     static String getMqttStateDesc(int state);
+    static size_t serializePayload(const JsonDocument& doc, char* buffer, size_t size, PayloadFormat format);
+    static DeserializationError deserializePayload(JsonDocument& doc, byte* payload, size_t length, PayloadFormat format);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+#ifndef _TIMER_WHEEL_H
+#define _TIMER_WHEEL_H
+
+#include <Arduino.h>
+
+#define TIMER_WHEEL_TICK 10                                     // Resolution (milliseconds).
+#define TIMER_WHEEL_LEVELS 3
+#define TIMER_WHEEL_SLOT_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS)          // Slots per level.
+#define TIMER_WHEEL_MAX_TIMERS 64                               // Node pool size.
+#define TIMER_WHEEL_MAX_TICKS ((1UL << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) - 1)
+#define TIMER_WHEEL_INVALID 0
+#define TIMER_WHEEL_NIL 0xFF
+
+// Handle to a scheduled timer. Encodes the pool index and a generation
+// count so a stale handle can never cancel a reused node.
+typedef uint16_t wheel_timer_t;
+
+typedef void (*TimerWheelCallback)(uint32_t arg);
+
+/**
+ * Hierarchical timing wheel (Varghese & Lauck). Timers live in a fixed
+ * node pool and are kept on intrusive doubly-linked slot lists, so
+ * schedule, cancel and expire are all O(1) and nothing is allocated at
+ * runtime. Level 0 holds timers due within 64 ticks; timers further out
+ * sit on coarser levels and cascade down as the wheel turns. The longest
+ * delay is TIMER_WHEEL_MAX_TICKS ticks (about 43 minutes at 10 ms).
+ *
+ * Not thread-safe. Timers are scheduled, cancelled and fired from the
+ * main application loop only; callbacks run from advance().
+ */
+class TimerWheelClass {
+public:
+	TimerWheelClass();
+	void begin(unsigned long now);
+	wheel_timer_t schedule(unsigned long delayMs, TimerWheelCallback callback, uint32_t arg);
+	bool cancel(wheel_timer_t timer);
+	bool isPending(wheel_timer_t timer);
+	void advance(unsigned long now);
+	uint8_t getActiveCount();
+
+private:
+	struct Node {
+		uint32_t expires;
+		TimerWheelCallback callback;
+		uint32_t arg;
+		uint8_t next;
+		uint8_t prev;
+		uint8_t level;
+		uint8_t slot;
+		uint8_t generation;
+		bool active;
+	};
+
+	void link(uint8_t index);
+	void unlink(uint8_t index);
+	void release(uint8_t index);
+	void cascade(uint8_t level);
+	uint8_t nodeFor(wheel_timer_t timer);
+
+	Node _nodes[TIMER_WHEEL_MAX_TIMERS];
+	uint8_t _slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+	uint8_t _freeList;
+	uint8_t _activeCount;
+	uint32_t _tick;
+	unsigned long _lastAdvance;
+};
+
+extern TimerWheelClass TimerWheel;
+
+#endif
\ No newline at end of file
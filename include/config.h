@@ -2,6 +2,7 @@
 #define _CONFIG_H
 
 #include <IPAddress.h>
+#include "TelemetryHelper.h"
 
 #define DEBUG
 #define SUPPORT_OTA
@@ -12,13 +13,31 @@
 #define SERIAL_BAUD 115200
 #define CONFIG_FILE_PATH "/config.json"
 #define DOOR_FILE_PATH "/doors.json"
+#define RULES_FILE_PATH "/rules.json"
+#define CONFIG_CACHE_FILE_PATH "/config.bin"
 #define CHECK_WIFI_INTERVAL 30000               // How often to check WiFi status (milliseconds).
-#define CHECK_MQTT_INTERVAL 35000               // How often to check connectivity to the MQTT broker.
+#define CHECK_MQTT_INTERVAL 35000               // Time between MQTT reconnect attempts (milliseconds).
+#define MQTT_SERVICE_INTERVAL 10                // MQTT network task loop period (milliseconds).
+#define MQTT_PUBLISH_BURST 4                    // Max queued messages sent per network task pass.
+#define MQTT_CONTROL_QUEUE_DEPTH 4              // Inbound control messages waiting for the main loop.
+#define MQTT_CONTROL_MAX_SIZE 256               // Largest accepted control message.
+#define SPOOL_DRAIN_INTERVAL 250                // Min time between batches while a backlog of spooled events drains (milliseconds).
+#define SPOOL_DRAIN_BATCH 5                     // Max spooled events sent per batch.
+#define JOURNAL_QUERY_LIMIT 10                  // Max journal records per query reply.
 #define CLOCK_SYNC_INTERVAL 3600000             // How often to sync the local clock with NTP (milliseconds).
+#define ZONE_RESCAN_INTERVAL 1000               // Max time between zone input reads when no interrupt fires (milliseconds).
+#define STATUS_PUBLISH_INTERVAL 250             // Min time between status publishes; changes in between are coalesced (milliseconds).
+#define TASK_STATS_INTERVAL 60000               // How often task, stack and queue stats are published (milliseconds).
+#define HEAP_STATS_INTERVAL 60000               // How often heap stats are published (milliseconds).
+#define MQTT_BUFFER_SIZE 3072                   // MQTT packet buffer. Must hold a full status snapshot plus topic.
 #define MQTT_TOPIC_STATUS "cygate4/status"
 #define MQTT_TOPIC_CONTROL "cygate4/control"
+#define MQTT_TOPIC_EVENTS "cygate4/events"
+#define MQTT_TOPIC_JOURNAL "cygate4/journal"
+#define MQTT_TOPIC_DIAG "cygate4/diag"
 #define MQTT_BROKER "your_mqtt_host_here"
 #define MQTT_PORT 1883
+#define MQTT_PAYLOAD_FORMAT PayloadFormat::JSON
 #define DEFAULT_HOST_NAME "CYGATE4"
 #define NTP_POOL "pool.ntp.org"
 
@@ -45,10 +64,14 @@ typedef struct {
     // MQTT stuff
     String mqttTopicStatus;
     String mqttTopicControl;
+    String mqttTopicEvents;
+    String mqttTopicJournal;
+    String mqttTopicDiag;
     String mqttBroker;
     String mqttUsername;
     String mqttPassword;
     uint16_t mqttPort;
+    PayloadFormat mqttPayloadFormat;
 
     // OTA stuff
 	bool otaEnable;
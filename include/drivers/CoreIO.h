@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include "Adafruit_MCP23017.h"
+#include "drivers/I2CBus.h"
 #include "IOExpPinMap.h"
 #include "LED.h"
 #include "Relay.h"
@@ -11,10 +12,19 @@
 #define I2C_ADDRESS_OFFSET 32
 #define RTC_ADDRESS 0x68
 #define PRIMARY_EXP_ADDRESS 0
+#define PRIMARY_EXP_BUS_ADDRESS (I2C_ADDRESS_OFFSET + PRIMARY_EXP_ADDRESS)
 
 // Peripheral I/O processing core ID
 #define PIO_CORE_ID 1
 
+// Zone snapshot bit layout. Bits 0 - 7 are the dry-contact inputs in port
+// order (GPA0 - GPA7), bits 8 - 15 are opto zones 1 - 8.
+#define ZONE_DRY_CONTACT_SHIFT 0
+#define ZONE_OPTO_SHIFT 8
+#define ZONE_COUNT 16
+#define ZONE_QUEUE_DEPTH 8
+#define ZONE_POLL_INTERVAL 20           // Zone read interval when the expander interrupt line isn't connected (milliseconds).
+
 enum class OnboardRelaySelect : uint8_t {
 	RELAY_1 = 0,
 	RELAY_2 = 1,
@@ -44,6 +54,13 @@ enum class OnboardDryContactInput : uint8_t {
 	REX_4 = 7
 };
 
+struct ZoneSnapshot {
+	unsigned long timestamp;
+	uint16_t state;
+	uint16_t rising;
+	uint16_t falling;
+};
+
 class CoreIOClass {
 public:
 	CoreIOClass();
@@ -55,12 +72,17 @@ public:
 	void heartbeatLedFlash(unsigned long delayMs);
 	uint8_t readOptoZoneInput(OnboardOptoZoneInput input);
 	uint8_t readDryContactZoneInput(OnboardDryContactInput input);
+	uint16_t readZoneInputs();
+	void enableInputInterrupts(TaskHandle_t notifyTask);
+	bool hasExpanderInterrupt();
 	void relayOn(OnboardRelaySelect relay);
 	void relayOff(OnboardRelaySelect relay);
 
 private:
 	Adafruit_MCP23017* _controller;
 	LED* _heartbeatLED;
+	uint16_t _lastZones;
+	bool _expanderInterrupt;
 	const uint8_t _localOptoInputs[6] = {
 		PIN_OPTO_ZONE_1,
 		PIN_OPTO_ZONE_2,
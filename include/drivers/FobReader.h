@@ -1,9 +1,11 @@
 #ifndef _FOB_READER_H
 #define _FOB_READER_H
 
-#include <Wire.h>
+#include <Arduino.h>
+#include "drivers/I2CBus.h"
 
 // Commands
+#define FOBREADER_POLL 0xF9
 #define FOBREADER_DETECT 0xFA
 #define FOBREADER_INIT 0xFB
 #define FOBREADER_GET_FIRMWARE 0xFC
@@ -21,6 +23,13 @@
 #define FOBREADER_TAG_DATA_SIZE 14
 #define FOBREADER_MIFARE_VER_SIZE 2
 #define FOBREADER_SELF_TEST_SIZE 2
+#define FOBREADER_MAX_FW_SIZE 24
+#define FOBREADER_POLL_SIZE 15
+
+// Adaptive polling (milliseconds)
+#define FOBREADER_POLL_FAST 10          // Interval right after a tag is seen.
+#define FOBREADER_POLL_IDLE 80          // Interval once the reader has been quiet for a while.
+#define FOBREADER_ACTIVE_WINDOW 5000    // How long the fast interval is kept after a read.
 
 // TODO Init status codes
 // TODO Self-test status codes
@@ -30,12 +39,13 @@ typedef struct {
 	uint8_t tagBytes[FOBREADER_MAX_TAG_SIZE];
 	uint8_t size;
 	uint8_t id;
+	uint32_t seenAt;    // When the read came off the reader (micros()).
 } Tag;
 
 class FobReader
 {
 public:
-	void begin(uint8_t addr, TwoWire *theWire = &Wire);
+	void begin(uint8_t addr);
 	uint8_t getAddress();
 	bool detect();
 	uint8_t init();
@@ -43,6 +53,9 @@ public:
 	String getFirmwareVersion();
 	bool isNewTagPresent();
 	bool getTagData();
+	bool poll();
+	uint32_t getPollDelay();
+	bool hasCombinedPoll();
 	uint8_t getMiFareVersion();
 	void setId(uint8_t id);
 	uint8_t getId();
@@ -51,12 +64,21 @@ public:
 	Tag tag;
 
 private:
-	void writeByte(uint8_t byte);
-	uint8_t readByte();
-	uint8_t *readBytes(size_t len);
+	bool command(uint8_t cmd, uint8_t* response, size_t len);
+	void readTag(const uint8_t* response);
+	void schedule(unsigned long now, bool activity);
+	bool pollCombined();
+	bool pollLegacy();
+
 	uint8_t _i2cAddr;
 	uint8_t _id;
-	TwoWire *_wire;
+	I2CExchange _exchange;
+	uint8_t _pollCommand;           // FOBREADER_GET_AVAILABLE or FOBREADER_GET_TAGS (legacy firmware only).
+	uint8_t _response[FOBREADER_POLL_SIZE];
+	bool _combinedPoll;
+	unsigned long _nextPoll;
+	unsigned long _lastActivity;
+	uint32_t _pollInterval;
 };
 
 #endif
\ No newline at end of file
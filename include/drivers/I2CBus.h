@@ -0,0 +1,147 @@
+#ifndef _I2C_BUS_H
+#define _I2C_BUS_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <atomic>
+
+#define I2C_BUS_MAX_DEVICES 16          // Device addresses tracked in the stats table.
+#define I2C_BUS_LOCK_TIMEOUT 100        // Max wait for the bus (milliseconds).
+#define I2C_BUS_BOOST_PRIORITY 3        // Task priority held by ELEVATED transactions. Above every peripheral task.
+#define I2C_BUS_MAX_TRANSFER 32         // Wire buffer size; longest single read or write.
+#define I2C_BUS_WIRE_TIMEOUT 10         // Longest a single Wire operation may stretch (milliseconds).
+
+#define I2C_EXCHANGE_RESPONSE_DELAY 2   // Time a device gets to prepare a response (milliseconds).
+#define I2C_EXCHANGE_DEADLINE 50        // Time a device gets to answer a command at all (milliseconds).
+#define I2C_EXCHANGE_BACKOFF_MIN 100    // Wait before retrying a device that missed a deadline (milliseconds).
+#define I2C_EXCHANGE_BACKOFF_MAX 5000   // Upper bound of the doubling backoff (milliseconds).
+#define I2C_EXCHANGE_OFFLINE_AFTER 3    // Consecutive misses before a device is reported offline.
+
+enum class I2CPriority : uint8_t {
+	NORMAL = 0,     // Polling (keypads, fob readers, status LEDs).
+	ELEVATED = 1    // Relay outputs and zone inputs.
+};
+
+enum class I2CExchangeResult : uint8_t {
+	PENDING = 0,    // Waiting on the device (or backing off). Call step() again later.
+	COMPLETE = 1,   // Response is in the buffer.
+	FAILED = 2      // Missed the deadline. The exchange is backing off.
+};
+
+struct I2CDeviceStats {
+	uint8_t address;
+	uint32_t transactions;
+	uint32_t errors;
+	uint32_t lastLatencyUs;         // Time the bus was held, not counting the wait for it.
+	uint32_t maxLatencyUs;
+	uint32_t maxWaitUs;
+	uint64_t totalLatencyUs;
+};
+
+/**
+ * Serializes access to the shared I2C bus. Every driver goes through a
+ * transaction (see I2CTransaction), which holds a recursive mutex so a
+ * driver can group several operations (ie. read-modify-write of an
+ * expander port) into one without other tasks interleaving.
+ *
+ * FreeRTOS hands a contended mutex to the highest priority waiter and
+ * lends the holder that priority. An ELEVATED transaction raises the calling
+ * task to I2C_BUS_BOOST_PRIORITY before it waits, so relay and zone
+ * traffic goes ahead of any number of pending polls.
+ *
+ * All buffers are supplied by the caller. Latency and error counters are
+ * kept per device address.
+ */
+class I2CBusClass {
+public:
+	I2CBusClass();
+	void begin(TwoWire* wire = &Wire);
+	bool probe(uint8_t address);
+	bool write(uint8_t address, const uint8_t* data, size_t len, I2CPriority priority = I2CPriority::NORMAL);
+	bool read(uint8_t address, uint8_t* buffer, size_t len, I2CPriority priority = I2CPriority::NORMAL);
+	bool transfer(uint8_t address, const uint8_t* tx, size_t txLen, uint8_t* rx, size_t rxLen, I2CPriority priority = I2CPriority::NORMAL);
+	uint8_t getDeviceCount();
+	bool getDeviceStats(uint8_t index, I2CDeviceStats* stats);
+	uint32_t getLockTimeouts();
+
+private:
+	friend class I2CTransaction;
+
+	bool lock(uint32_t timeoutMs);
+	void unlock();
+	bool writeLocked(uint8_t address, const uint8_t* data, size_t len);
+	bool readLocked(uint8_t address, uint8_t* buffer, size_t len);
+	void record(uint8_t address, uint32_t latencyUs, uint32_t waitUs, bool ok);
+
+	TwoWire* _wire;
+	SemaphoreHandle_t _lock;
+	I2CDeviceStats _stats[I2C_BUS_MAX_DEVICES];
+	uint8_t _deviceCount;
+	std::atomic<uint32_t> _lockTimeouts;
+};
+
+/**
+ * Scoped hold on the bus. Locks (and boosts the calling task for ELEVATED)
+ * on construction, records stats and unlocks on destruction. Check
+ * isLocked() before touching the bus; the lock can time out.
+ */
+class I2CTransaction {
+public:
+	I2CTransaction(uint8_t address, I2CPriority priority = I2CPriority::NORMAL, uint32_t timeoutMs = I2C_BUS_LOCK_TIMEOUT);
+	~I2CTransaction();
+	bool isLocked();
+	void fail();
+
+private:
+	I2CTransaction(const I2CTransaction&);
+	I2CTransaction& operator=(const I2CTransaction&);
+
+	uint8_t _address;
+	bool _locked;
+	bool _failed;
+	bool _boosted;
+	UBaseType_t _savedPriority;
+	unsigned long _started;
+	uint32_t _waitUs;
+};
+
+/**
+ * Resumable command/response exchange with a polled device. Each call to
+ * step() does at most one short bus operation: send the command, or read
+ * the response once the device has had time to prepare it. The bus is
+ * released in between, so a slow device doesn't hold up the others.
+ *
+ * A response counts once its first byte echoes the command. A device that
+ * doesn't manage that before the deadline is backed off (doubling, capped)
+ * and retried later with a fresh command.
+ */
+class I2CExchange {
+public:
+	I2CExchange();
+	void begin(uint8_t address);
+	I2CExchangeResult step(uint8_t command, uint8_t* response, size_t len);
+	bool isAwaitingResponse();
+	bool isOnline();
+	uint32_t getMissedDeadlines();
+
+private:
+	enum class State : uint8_t {
+		IDLE,
+		AWAITING_RESPONSE,
+		BACKOFF
+	};
+
+	I2CExchangeResult fail(unsigned long now);
+
+	uint8_t _address;
+	uint8_t _command;
+	State _state;
+	unsigned long _deadline;
+	unsigned long _nextStep;
+	uint8_t _failures;              // Consecutive. Reset by any completed exchange.
+	uint32_t _missedDeadlines;
+};
+
+extern I2CBusClass I2CBus;
+
+#endif
\ No newline at end of file
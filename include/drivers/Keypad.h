@@ -1,8 +1,8 @@
 #ifndef _KEYPAD_H
 #define _KEYPAD_H
 
-#include <functional>
-#include <Wire.h>
+#include <Arduino.h>
+#include "drivers/I2CBus.h"
 
 // Commands
 #define KEYPAD_INIT 0xDA
@@ -12,6 +12,7 @@
 
 // Sizes
 #define KEYPAD_DATA_BUFFER_SIZE 4
+#define KEYPAD_CMD_PREAMBLE_SIZE 3
 
 // TODO Init status codes
 
@@ -33,24 +34,23 @@ enum class KeypadCommands : uint8_t {
 class Keypad
 {
 public:
-	void begin(uint8_t address, TwoWire *theWire = &Wire);
+	void begin(uint8_t address);
 	uint8_t getAddress();
 	bool detect();
 	uint8_t init();
-	KeypadData* readEntries();
+	KeypadData* poll();
+	bool isAwaitingResponse();
 	void setId(uint8_t id);
 	uint8_t getId();
 
 private:
-	void writeByte(uint8_t byte);
-	void writeBytes(uint8_t *bytes, size_t len);
-	uint8_t readByte();
-	uint8_t* readBytes(size_t len);
+	bool command(uint8_t cmd, uint8_t* response, size_t len);
 
 	uint8_t _i2cAddress;
 	uint8_t _id;
-	TwoWire *_wire;
-	KeypadData *_commandData;
+	I2CExchange _exchange;
+	uint8_t _payload[KEYPAD_DATA_BUFFER_SIZE + KEYPAD_CMD_PREAMBLE_SIZE];
+	KeypadData _commandData;
 };
 
 #endif
\ No newline at end of file
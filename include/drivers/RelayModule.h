@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include "Adafruit_MCP23017.h"
 #include "IOExpPinMap.h"
+#include "drivers/I2CBus.h"
 
 enum class RelaySelect : uint8_t {
 	RELAY1 = 1,
@@ -21,7 +22,7 @@ enum class ModuleRelayState : uint8_t {
 class RelayModule
 {
 public:
-	RelayModule(Adafruit_MCP23017 *busController);
+	RelayModule(Adafruit_MCP23017 *busController, uint8_t busAddress);
 	bool detect();
 	void init();
 	ModuleRelayState getState(RelaySelect relay);
@@ -36,6 +37,7 @@ private:
 	uint8_t getRelayAddress(RelaySelect relay);
 	uint8_t getLedAddressForRelay(RelaySelect relay);
 	Adafruit_MCP23017 *_busController;
+	uint8_t _busAddress;
 };
 
 #endif
\ No newline at end of file
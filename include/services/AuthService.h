@@ -2,27 +2,90 @@
 #define _AUTH_SERVICE_H
 
 #include <Arduino.h>
+#include <HTTPClient.h>
+#include <WiFiClient.h>
+#include "ArduinoJson.h"
+
+#define AUTH_TOKEN_DEFAULT_TTL 3600             // Token lifetime (seconds) when the API does not supply "expiresIn".
+#define AUTH_TOKEN_REFRESH_MARGIN 60000         // Refresh the token this long before it expires (milliseconds).
+#define AUTH_TOKEN_CHECK_INTERVAL 15000         // How often the background task checks the token (milliseconds).
+#define AUTH_HTTP_TIMEOUT 3000                  // Per-request HTTP timeout (milliseconds).
+#define AUTH_QUEUE_DEPTH 4                      // Max pending requests for the auth worker.
+#define AUTH_REQUEST_DEADLINE 4000              // Max time from submit to decision (milliseconds).
+#define AUTH_RESULT_TIMEOUT 4000                // Max wait for room in the result queue (milliseconds).
+#define AUTH_CREDENTIAL_MAX_LEN 24
+#define AUTH_CONTEXT_SIZE 4
+#define AUTH_LOGIN_BODY_SIZE 256                // Max serialized login request size.
+#define AUTH_LOGIN_DOC_SIZE 1024                // Parse arena for login responses (holds the token).
+#define AUTH_VALIDATE_DOC_SIZE 64               // Parse arena for validation responses.
+
+enum class AuthRequestType : uint8_t {
+	CARD = 0,
+	PIN = 1
+};
+
+enum class AuthResultCode : uint8_t {
+	ACCEPTED = 0,
+	REJECTED = 1,
+	EXPIRED = 2
+};
+
+struct AuthResult;
+
+// Completion handlers are invoked from the main application loop, never
+// from the auth worker task.
+typedef void (*AuthCompletionHandler)(const AuthResult* result);
+
+struct AuthRequest {
+	AuthRequestType type;
+	uint8_t sourceId;
+	char credential[AUTH_CREDENTIAL_MAX_LEN];
+	uint8_t context[AUTH_CONTEXT_SIZE];
+	unsigned long deadline;
+	AuthCompletionHandler onComplete;
+	uint32_t seenAt;                // When the credential was read (micros()). See LatencyStats.
+	uint32_t submittedAt;
+};
+
+struct AuthResult {
+	AuthRequest request;
+	AuthResultCode code;
+	uint32_t startedAt;             // Auth worker timestamps (micros()).
+	uint32_t finishedAt;
+};
 
 class AuthServiceClass {
 public:
 	AuthServiceClass();
+	void begin();
 	void setLoginEndpoint(const char* endpoint);
 	void setCardAuthEndpoint(const char* endpoint);
 	void setPinAuthEndpoint(const char* endpoint);
 	void setApiCredentials(String username, String password);
+	bool refreshToken(bool force = false, unsigned long margin = AUTH_TOKEN_REFRESH_MARGIN);
+	void invalidateToken();
 	bool checkCardValid(const char* serial);
 	bool checkPinValid(const char* pin);
 
 private:
-	String login();
+	bool login();
+	bool tokenNeedsRefresh(unsigned long margin);
+	bool checkCredential(const char* endpoint, const char* param, const char* value);
+	DeserializationError parseResponse(JsonDocument& doc, JsonDocument& filter);
 
 	const char* _loginEndpoint;
 	const char* _cardAuthEndpoint;
 	const char* _pinAuthEndpoint;
 	String _username;
 	String _password;
+	String _token;
+	unsigned long _tokenIssuedAt;
+	unsigned long _tokenLifetime;
+	WiFiClient _client;
+	HTTPClient _http;
+	SemaphoreHandle_t _lock;
 };
 
 extern AuthServiceClass AuthService;
 
-#endif
\ No newline at end of file
+#endif
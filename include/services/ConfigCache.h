@@ -0,0 +1,76 @@
+#ifndef _CONFIG_CACHE_H
+#define _CONFIG_CACHE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Snapshot format. Bump the version whenever config_t, the field order
+// below or the defaults loadConfiguration() fills in for missing keys
+// change, so old snapshots are rebuilt from the JSON.
+#define CONFIG_CACHE_MAGIC 0x46435943  // "CYCF"
+#define CONFIG_CACHE_VERSION 1
+#define CONFIG_CACHE_MAX_SIZE 1536      // Header plus body. Read and written through one stack buffer.
+#define CONFIG_CACHE_HASH_CHUNK 128
+
+typedef struct {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t bodySize;
+	uint32_t sourceCrc;             // crc32 of the config.json the snapshot was built from.
+	uint32_t sourceSize;
+	uint32_t crc;                   // crc32 of the body.
+} configcache_header_t;
+
+// Fixed part of the body. The strings follow, each as a uint16_t length,
+// the characters and a terminating NUL.
+typedef struct {
+	uint32_t ip;
+	uint32_t gw;
+	uint32_t sm;
+	uint32_t dns;
+	uint16_t mqttPort;
+	uint16_t otaPort;
+	uint8_t clockTimezone;
+	uint8_t mqttPayloadFormat;
+	uint8_t flags;
+	uint8_t reserved;
+} configcache_fixed_t;
+
+// Fixed part flags
+#define CONFIG_CACHE_FLAG_DHCP 0x01
+#define CONFIG_CACHE_FLAG_MDNS 0x02
+#define CONFIG_CACHE_FLAG_OTA 0x04
+
+enum class ConfigCacheStatus : uint8_t {
+	LOADED = 0,
+	MISSING = 1,
+	STALE = 2,          // Built from a different config.json or by an older firmware.
+	INVALID = 3         // Truncated, damaged or not a snapshot at all.
+};
+
+/**
+ * Binary snapshot of the parsed configuration, kept next to config.json.
+ * Boot loads it with a single read, checks the magic, version and CRC, and
+ * only falls back to parsing the JSON when the snapshot is missing, damaged
+ * or was built from a different config.json. That skips the parse and its
+ * large JSON document on every ordinary boot.
+ *
+ * Staleness is detected by hashing config.json, which is streamed through
+ * a small buffer and never held in memory. Edits made to the file outside
+ * the firmware are picked up on the next boot.
+ */
+class ConfigCacheClass {
+public:
+	ConfigCacheStatus load(config_t* config, uint32_t sourceCrc, uint32_t sourceSize);
+	bool save(const config_t* config, uint32_t sourceCrc, uint32_t sourceSize);
+	void clear();
+	static bool hashFile(const char* path, uint32_t* crc, uint32_t* size);
+
+private:
+	static bool decode(const uint8_t* body, size_t size, config_t* config);
+	static size_t encode(const config_t* config, uint8_t* body, size_t capacity);
+};
+
+extern ConfigCacheClass ConfigCache;
+
+#endif
\ No newline at end of file
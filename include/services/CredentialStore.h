@@ -0,0 +1,74 @@
+#ifndef _CREDENTIAL_STORE_H
+#define _CREDENTIAL_STORE_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+
+// Flash partition holding the credential image (see partitions.csv).
+#define CREDDB_PARTITION_LABEL "creddb"
+#define CREDDB_PARTITION_SUBTYPE (esp_partition_subtype_t)0x40
+
+// Image format. Must match tools/build_credential_db.py.
+#define CREDDB_MAGIC 0x42445943  // "CYDB"
+#define CREDDB_VERSION 1
+#define CREDDB_HEADER_SIZE 32
+#define CREDDB_MAX_UID_SIZE 10
+#define CREDDB_ENTRY_SIZE 12
+
+// Entry flags
+#define CREDDB_FLAG_GRANTED 0x01
+
+enum class CredentialStatus : uint8_t {
+	UNKNOWN = 0,
+	GRANTED = 1,
+	DENIED = 2
+};
+
+typedef struct {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t entrySize;
+	uint32_t entryCount;
+	uint32_t bucketCount;
+	uint32_t slotCount;
+	uint32_t seed;
+	uint32_t generation;
+	uint32_t crc;
+} creddb_header_t;
+
+typedef struct {
+	uint8_t uidLen;
+	uint8_t flags;
+	uint8_t uid[CREDDB_MAX_UID_SIZE];
+} creddb_entry_t;
+
+/**
+ * Read-only tag credential database kept in a dedicated flash partition.
+ * The image is memory-mapped and laid out for a minimal perfect hash
+ * (hash-and-displace) so a lookup touches exactly one bucket displacement
+ * and one slot, with no heap allocation and no network access.
+ */
+class CredentialStoreClass {
+public:
+	CredentialStoreClass();
+	bool begin();
+	void end();
+	bool isLoaded();
+	uint32_t getEntryCount();
+	uint32_t getGeneration();
+	CredentialStatus lookup(const uint8_t* uid, uint8_t len);
+
+private:
+	static uint32_t hash(const uint8_t* key, uint8_t len, uint32_t seed);
+
+	spi_flash_mmap_handle_t _mapHandle;
+	const uint8_t* _image;
+	const creddb_header_t* _header;
+	const uint32_t* _displacements;
+	const creddb_entry_t* _entries;
+	bool _loaded;
+};
+
+extern CredentialStoreClass CredentialStore;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,86 @@
+#ifndef _EVENT_SPOOL_H
+#define _EVENT_SPOOL_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "AccessEvent.h"
+
+// Flash partition holding the spool (see partitions.csv).
+#define SPOOL_PARTITION_LABEL "spool"
+#define SPOOL_PARTITION_SUBTYPE (esp_partition_subtype_t)0x41
+
+#define SPOOL_SECTOR_SIZE 4096
+#define SPOOL_SECTOR_MAGIC 0x314C5053   // "SPL1"
+#define SPOOL_HEADER_SIZE 32
+#define SPOOL_RECORD_SIZE 32
+#define SPOOL_RECORDS_PER_SECTOR ((SPOOL_SECTOR_SIZE - SPOOL_HEADER_SIZE) / SPOOL_RECORD_SIZE)
+#define SPOOL_ERASED 0xFFFFFFFF
+
+typedef struct {
+	uint32_t magic;
+	uint32_t sequence;              // Incremented each time a sector is (re)opened.
+	uint8_t reserved[SPOOL_HEADER_SIZE - 8];
+} spool_sector_header_t;
+
+typedef struct {
+	AccessEvent event;
+	uint32_t crc;                   // crc32 of the event. Catches torn writes.
+	uint32_t consumed;              // SPOOL_ERASED until delivered, then programmed to 0.
+} spool_record_t;
+
+/**
+ * Store-and-forward queue for access events in a dedicated flash partition.
+ * Records are appended to a ring of sectors and never rewritten. Delivery
+ * only clears bits (the consumed word goes from all ones to zero), so no
+ * erase is needed until the writer laps around. Sectors are reused in
+ * strict rotation, which spreads erases evenly across the partition. On
+ * boot the partition is scanned to recover the read and write positions.
+ *
+ * When the ring is full the oldest sector is erased to make room and its
+ * undelivered records are counted as lost. So is an event that is
+ * discarded because it can't be delivered at all.
+ *
+ * Only uses the esp_partition_* API, so it can run against a file-backed
+ * flash emulation.
+ */
+class EventSpoolClass {
+public:
+	EventSpoolClass();
+	bool begin();
+	bool isReady();
+	bool append(const AccessEvent* event);
+	bool peek(AccessEvent* event);
+	void consume(uint32_t sequence);
+	void discard(uint32_t sequence);
+	uint32_t getPendingCount();
+	uint32_t getLostCount();
+	uint32_t getLastSequence();
+
+private:
+	size_t recordOffset(uint16_t sector, uint16_t slot);
+	bool readRecord(uint16_t sector, uint16_t slot, spool_record_t* record);
+	bool isErased(const spool_record_t* record);
+	bool isPending(const spool_record_t* record);
+	uint32_t readSectorSequence(uint16_t sector);
+	bool openSector(uint16_t sector, uint32_t sequence);
+	bool markConsumed(uint32_t sequence);
+	void recover();
+	void advance(uint16_t* sector, uint16_t* slot);
+
+	const esp_partition_t* _partition;
+	SemaphoreHandle_t _lock;
+	uint16_t _sectorCount;
+	uint16_t _headSector;
+	uint16_t _headSlot;
+	uint32_t _headSequence;         // Sector sequence of the head, 0 if nothing written yet.
+	uint16_t _tailSector;
+	uint16_t _tailSlot;
+	uint32_t _pending;
+	uint32_t _lost;
+	uint32_t _lastEventSequence;
+	bool _ready;
+};
+
+extern EventSpoolClass EventSpool;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,120 @@
+#ifndef _JOURNAL_H
+#define _JOURNAL_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+
+// Flash partition holding the journal (see partitions.csv).
+#define JOURNAL_PARTITION_LABEL "journal"
+#define JOURNAL_PARTITION_SUBTYPE (esp_partition_subtype_t)0x42
+
+#define JOURNAL_BLOCK_SIZE 4096         // One flash sector. Cursors assume 12 bits of offset.
+#define JOURNAL_MAX_BLOCKS 32           // Blocks covered by the in-memory index.
+#define JOURNAL_BLOCK_MAGIC 0x314E524A  // "JRN1"
+#define JOURNAL_HEADER_SIZE 32
+#define JOURNAL_MAX_DATA 10             // Largest record payload (a tag UID).
+#define JOURNAL_MAX_BODY 20             // Largest encoded record body.
+#define JOURNAL_SEALED 0
+#define JOURNAL_ERASED 0xFFFFFFFF
+#define JOURNAL_DOOR_NONE_BIT 0x80000000    // Door mask bit for records not tied to a door.
+#define JOURNAL_ANY_DOOR 0xFF
+
+enum class JournalEventType : uint8_t {
+	FOB = 0,
+	KEYPAD = 1,
+	RELAY = 2,
+	ZONE = 3
+};
+
+// Decoded journal entry. What source, target and value mean depends on the
+// type:
+//   FOB:    reader ID, -, 1 if granted. data holds the tag UID.
+//   KEYPAD: keypad ID, keypad command, 1 if the pin was accepted.
+//   RELAY:  module ID, relay ID, 1 if energized.
+//   ZONE:   module ID, input ID, 1 if active.
+struct JournalRecord {
+	uint32_t timestamp;             // Controller clock (epoch seconds).
+	JournalEventType type;
+	uint8_t doorId;                 // DOOR_NONE if not tied to a door.
+	uint8_t source;
+	uint8_t target;
+	uint8_t value;
+	uint8_t dataLen;
+	uint8_t data[JOURNAL_MAX_DATA];
+};
+
+struct JournalQuery {
+	uint8_t doorId;                 // JOURNAL_ANY_DOOR to match all records.
+	uint32_t from;                  // Inclusive.
+	uint32_t to;                    // Inclusive. 0 for no upper bound.
+	uint32_t cursor;                // 0 to start at the oldest record. 0 again once exhausted.
+};
+
+typedef struct {
+	uint32_t magic;
+	uint32_t sequence;              // Incremented each time a block is (re)opened.
+	uint32_t baseTime;              // Time of the first record; deltas chain from here.
+	uint32_t reserved;
+	uint32_t minTime;               // Block summary, written once when the block fills.
+	uint32_t maxTime;
+	uint32_t doorMask;
+	uint32_t sealed;                // JOURNAL_SEALED once the summary is valid.
+} journal_block_header_t;
+
+typedef struct {
+	uint32_t sequence;              // 0 if the block holds no records.
+	uint32_t minTime;
+	uint32_t maxTime;
+	uint32_t doorMask;
+} journal_index_t;
+
+/**
+ * Append-only log of fob reads, keypad commands, relay actuations and zone
+ * changes in a dedicated flash partition. The partition is a ring of
+ * blocks (one per sector). Records are variable length: a length byte, the
+ * type, a zigzag varint time delta from the previous record in the block,
+ * the door, the fields above and a CRC-8 that lets a torn write be skipped.
+ * A typical record takes 8 bytes.
+ *
+ * Each block's time range and door set are summarized in its header when
+ * it fills and kept in a small in-memory index, so a query only decodes
+ * the blocks that can contain a match. Reads go through a memory mapping
+ * of the partition, which the flash driver keeps coherent with writes.
+ *
+ * Not thread-safe. Only call from the main application loop.
+ */
+class JournalClass {
+public:
+	JournalClass();
+	bool begin();
+	bool isReady();
+	bool append(const JournalRecord* record);
+	uint8_t query(JournalQuery* query, JournalRecord* results, uint8_t maxResults);
+
+private:
+	static uint32_t doorBit(uint8_t doorId);
+	static size_t encode(const JournalRecord* record, int32_t delta, uint8_t* buffer);
+	static bool decode(const uint8_t* body, uint8_t len, uint32_t prevTime, JournalRecord* record);
+	size_t next(uint16_t block, size_t offset, uint32_t* prevTime, JournalRecord* record, bool* valid);
+	const journal_block_header_t* header(uint16_t block);
+	void scanBlock(uint16_t block, size_t* end, uint32_t* lastTime);
+	bool blockMayMatch(const JournalQuery* query, const journal_index_t* index);
+	bool sealBlock(uint16_t block);
+	bool openBlock(uint16_t block, uint32_t sequence, uint32_t baseTime);
+	void recover();
+
+	const esp_partition_t* _partition;
+	spi_flash_mmap_handle_t _mapHandle;
+	const uint8_t* _image;
+	journal_index_t _index[JOURNAL_MAX_BLOCKS];
+	uint16_t _blockCount;
+	uint16_t _headBlock;
+	size_t _headOffset;
+	uint32_t _headSequence;         // 0 if nothing written yet.
+	uint32_t _lastTime;             // Time of the last valid record in the head block.
+	bool _ready;
+};
+
+extern JournalClass Journal;
+
+#endif
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <Arduino.h>
 #include "App.h"
 
+#define APPLICATION_TASK_STACK_SIZE 8192    // Stack size (bytes).
+
 void initApplication();
 void ApplicationTask(void *pvParameter);
 
@@ -0,0 +1,12 @@
+#ifndef TASK_AUTH_WORKER_H
+#define TASK_AUTH_WORKER_H
+
+#include <Arduino.h>
+#include "App.h"
+
+#define AUTH_WORKER_TASK_STACK_SIZE 6144    // Stack size (bytes).
+
+TaskHandle_t initAuthWorker();
+void authWorkerTask(void *pvParameter);
+
+#endif
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <Arduino.h>
 #include "App.h"
 
+#define FOB_READER_TASK_STACK_SIZE 2048    // Stack size (bytes).
+
 TaskHandle_t initFobReaderDevices();
 void fobReaderTask(void *pvParameter);
 
@@ -4,6 +4,9 @@
 #include <Arduino.h>
 #include "App.h"
 
+#define KEYPAD_TASK_STACK_SIZE 2048      // Stack size (bytes).
+#define KEYPAD_POLL_INTERVAL 20          // Time between polls while no reply is outstanding (milliseconds).
+
 TaskHandle_t initKeypadDevices();
 void keypadTask(void *pvParameter);
 
@@ -4,6 +4,9 @@
 #include <Arduino.h>
 #include "App.h"
 
+#define HEARTBEAT_TASK_STACK_SIZE 1024    // Stack size (bytes).
+#define HEARTBEAT_BOOT_POLL 100           // How often to check for the end of boot (milliseconds).
+
 TaskHandle_t initHeartbeat();
 void heartBeatTask(void *pvParameter);
 
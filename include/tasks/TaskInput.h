@@ -4,6 +4,8 @@
 #include <Arduino.h>
 #include "App.h"
 
+#define INPUT_TASK_STACK_SIZE 1024    // Stack size (bytes).
+
 TaskHandle_t initInputTask();
 void inputTask(void *pvParameter);
 
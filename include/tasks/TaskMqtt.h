@@ -0,0 +1,12 @@
+#ifndef TASK_MQTT_H
+#define TASK_MQTT_H
+
+#include <Arduino.h>
+#include "App.h"
+
+#define MQTT_TASK_STACK_SIZE 4096    // Stack size (bytes).
+
+TaskHandle_t initMqttTask();
+void mqttNetworkTask(void *pvParameter);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,12 @@
+#ifndef TASK_REFRESH_AUTH_TOKEN_H
+#define TASK_REFRESH_AUTH_TOKEN_H
+
+#include <Arduino.h>
+#include "App.h"
+
+#define AUTH_TOKEN_TASK_STACK_SIZE 4096    // Stack size (bytes).
+
+TaskHandle_t initAuthTokenRefresh();
+void authTokenRefreshTask(void *pvParameter);
+
+#endif
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <Arduino.h>
 #include "App.h"
 
+#define CLOCK_SYNC_TASK_STACK_SIZE 2048    // Stack size (bytes).
+
 TaskHandle_t initClockSync();
 void clockSyncTask(void *pvParameter);
 
@@ -0,0 +1,132 @@
+#include "Adafruit_MCP23017.h"
+
+static uint8_t bitForPin(uint8_t pin) {
+	return pin % 8;
+}
+
+static uint8_t regForPin(uint8_t pin, uint8_t portAaddr, uint8_t portBaddr) {
+	return pin < 8 ? portAaddr : portBaddr;
+}
+
+void Adafruit_MCP23017::begin(uint8_t addr, TwoWire* theWire) {
+	if (addr > 7) {
+		addr = 7;
+	}
+
+	this->_i2caddr = MCP23017_ADDRESS | addr;
+	this->_wire = theWire;
+	this->_wire->begin();
+
+	// All inputs on both ports, as after power-on.
+	this->writeRegister(MCP23017_IODIRA, 0xff);
+	this->writeRegister(MCP23017_IODIRA + 1, 0xff);
+}
+
+void Adafruit_MCP23017::begin(TwoWire* theWire) {
+	this->begin(0, theWire);
+}
+
+uint8_t Adafruit_MCP23017::readRegister(uint8_t addr) {
+	this->_wire->beginTransmission(this->_i2caddr);
+	this->_wire->write(addr);
+	this->_wire->endTransmission();
+	this->_wire->requestFrom(this->_i2caddr, (uint8_t)1);
+	return this->_wire->read();
+}
+
+void Adafruit_MCP23017::writeRegister(uint8_t addr, uint8_t value) {
+	this->_wire->beginTransmission(this->_i2caddr);
+	this->_wire->write(addr);
+	this->_wire->write(value);
+	this->_wire->endTransmission();
+}
+
+void Adafruit_MCP23017::updateRegisterBit(uint8_t p, uint8_t pValue, uint8_t portAaddr, uint8_t portBaddr) {
+	uint8_t regAddr = regForPin(p, portAaddr, portBaddr);
+	uint8_t regValue = this->readRegister(regAddr);
+	bitWrite(regValue, bitForPin(p), pValue);
+	this->writeRegister(regAddr, regValue);
+}
+
+void Adafruit_MCP23017::pinMode(uint8_t p, uint8_t d) {
+	this->updateRegisterBit(p, (d == INPUT), MCP23017_IODIRA, MCP23017_IODIRA + 1);
+}
+
+void Adafruit_MCP23017::digitalWrite(uint8_t pin, uint8_t d) {
+	uint8_t bit = bitForPin(pin);
+	uint8_t gpio = this->readRegister(regForPin(pin, MCP23017_OLATA, MCP23017_OLATA + 1));
+	bitWrite(gpio, bit, d);
+	this->writeRegister(regForPin(pin, MCP23017_GPIOA, MCP23017_GPIOA + 1), gpio);
+}
+
+void Adafruit_MCP23017::pullUp(uint8_t p, uint8_t d) {
+	this->updateRegisterBit(p, d, MCP23017_GPPUA, MCP23017_GPPUA + 1);
+}
+
+uint8_t Adafruit_MCP23017::digitalRead(uint8_t pin) {
+	uint8_t bit = bitForPin(pin);
+	return (this->readRegister(regForPin(pin, MCP23017_GPIOA, MCP23017_GPIOA + 1)) >> bit) & 0x1;
+}
+
+void Adafruit_MCP23017::writeGPIOAB(uint16_t ba) {
+	this->_wire->beginTransmission(this->_i2caddr);
+	this->_wire->write(MCP23017_GPIOA);
+	this->_wire->write(ba & 0xFF);
+	this->_wire->write(ba >> 8);
+	this->_wire->endTransmission();
+}
+
+uint16_t Adafruit_MCP23017::readGPIOAB() {
+	this->_wire->beginTransmission(this->_i2caddr);
+	this->_wire->write(MCP23017_GPIOA);
+	this->_wire->endTransmission();
+	this->_wire->requestFrom(this->_i2caddr, (uint8_t)2);
+	uint16_t a = this->_wire->read();
+	uint16_t ba = this->_wire->read();
+	return (ba << 8) | a;
+}
+
+uint8_t Adafruit_MCP23017::readGPIO(uint8_t b) {
+	return this->readRegister(b == 0 ? MCP23017_GPIOA : MCP23017_GPIOA + 1);
+}
+
+void Adafruit_MCP23017::setupInterrupts(uint8_t mirroring, uint8_t openDrain, uint8_t polarity) {
+	for (uint8_t port = 0; port < 2; port++) {
+		uint8_t ioconf = this->readRegister(MCP23017_IOCONA + port);
+		bitWrite(ioconf, 6, mirroring);
+		bitWrite(ioconf, 2, openDrain);
+		bitWrite(ioconf, 1, polarity);
+		this->writeRegister(MCP23017_IOCONA + port, ioconf);
+	}
+}
+
+void Adafruit_MCP23017::setupInterruptPin(uint8_t pin, uint8_t mode) {
+	// CHANGE compares against the previous value; RISING/FALLING compare
+	// against DEFVAL, which is the opposite of the level being waited for.
+	this->updateRegisterBit(pin, (mode != CHANGE), MCP23017_INTCONA, MCP23017_INTCONA + 1);
+	this->updateRegisterBit(pin, (mode == FALLING), MCP23017_DEFVALA, MCP23017_DEFVALA + 1);
+	this->updateRegisterBit(pin, HIGH, MCP23017_GPINTENA, MCP23017_GPINTENA + 1);
+}
+
+uint8_t Adafruit_MCP23017::getLastInterruptPin() {
+	for (uint8_t port = 0; port < 2; port++) {
+		uint8_t intf = this->readRegister(MCP23017_INTFA + port);
+		for (uint8_t i = 0; i < 8; i++) {
+			if (bitRead(intf, i)) {
+				return (port * 8) + i;
+			}
+		}
+	}
+
+	return MCP23017_INT_ERR;
+}
+
+uint8_t Adafruit_MCP23017::getLastInterruptPinValue() {
+	uint8_t pin = this->getLastInterruptPin();
+	if (pin == MCP23017_INT_ERR) {
+		return MCP23017_INT_ERR;
+	}
+
+	uint8_t val = this->readRegister(regForPin(pin, MCP23017_INTCAPA, MCP23017_INTCAPA + 1));
+	return (val >> bitForPin(pin)) & 0x01;
+}
\ No newline at end of file
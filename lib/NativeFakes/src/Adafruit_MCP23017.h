@@ -0,0 +1,56 @@
+#ifndef _NATIVE_ADAFRUIT_MCP23017_H
+#define _NATIVE_ADAFRUIT_MCP23017_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define MCP23017_ADDRESS 0x20
+
+// Registers (IOCON.BANK = 0). Port B registers follow each port A one.
+#define MCP23017_IODIRA 0x00
+#define MCP23017_IPOLA 0x02
+#define MCP23017_GPINTENA 0x04
+#define MCP23017_DEFVALA 0x06
+#define MCP23017_INTCONA 0x08
+#define MCP23017_IOCONA 0x0A
+#define MCP23017_GPPUA 0x0C
+#define MCP23017_INTFA 0x0E
+#define MCP23017_INTCAPA 0x10
+#define MCP23017_GPIOA 0x12
+#define MCP23017_OLATA 0x14
+#define MCP23017_REGISTERS 0x16
+
+#define MCP23017_INT_ERR 255
+
+// Same API as the Adafruit 1.x driver, talking the real register protocol
+// over Wire so a simulated expander (MCP23017Device) sees the same
+// traffic the hardware would.
+class Adafruit_MCP23017 {
+public:
+	void begin(uint8_t addr, TwoWire* theWire = &Wire);
+	void begin(TwoWire* theWire = &Wire);
+
+	void pinMode(uint8_t p, uint8_t d);
+	void digitalWrite(uint8_t p, uint8_t d);
+	void pullUp(uint8_t p, uint8_t d);
+	uint8_t digitalRead(uint8_t p);
+
+	void writeGPIOAB(uint16_t ba);
+	uint16_t readGPIOAB();
+	uint8_t readGPIO(uint8_t b);
+
+	void setupInterrupts(uint8_t mirroring, uint8_t open, uint8_t polarity);
+	void setupInterruptPin(uint8_t p, uint8_t mode);
+	uint8_t getLastInterruptPin();
+	uint8_t getLastInterruptPinValue();
+
+private:
+	uint8_t readRegister(uint8_t addr);
+	void writeRegister(uint8_t addr, uint8_t value);
+	void updateRegisterBit(uint8_t p, uint8_t pValue, uint8_t portAaddr, uint8_t portBaddr);
+
+	uint8_t _i2caddr;
+	TwoWire* _wire;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include "Arduino.h"
+#include "NativeHarness.h"
+#include "VirtualClock.h"
+#include <stdio.h>
+#include <strings.h>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+
+struct NativePin {
+	uint8_t mode;
+	uint8_t level;
+	bool driven;                        // Set by nativeSetPin(). Pulls no longer apply.
+	int interruptMode;
+	void (*handler)(void);
+};
+
+static NativePin pins[NATIVE_GPIO_PINS];
+static std::mutex pinLock;
+
+unsigned long millis() {
+	return (unsigned long)(VirtualClock.micros() / 1000);
+}
+
+unsigned long micros() {
+	return (unsigned long)VirtualClock.micros();
+}
+
+void delay(uint32_t ms) {
+	vTaskDelay(ms / portTICK_PERIOD_MS);
+}
+
+void delayMicroseconds(uint32_t us) {
+	// Shorter than a tick. Only the ACCELERATED and MANUAL clocks can be
+	// moved this finely, and only while nothing else is running, so just
+	// yield.
+	(void)us;
+	yield();
+}
+
+void yield() {
+	vTaskDelay(0);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+	if (pin >= NATIVE_GPIO_PINS) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(pinLock);
+	pins[pin].mode = mode;
+	if (!pins[pin].driven && (mode & PULLUP) != 0) {
+		pins[pin].level = HIGH;
+	}
+	else if (!pins[pin].driven && (mode & PULLDOWN) != 0) {
+		pins[pin].level = LOW;
+	}
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+	if (pin >= NATIVE_GPIO_PINS) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(pinLock);
+	pins[pin].level = value ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+	return nativeGetPin(pin);
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {
+	if (pin >= NATIVE_GPIO_PINS) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(pinLock);
+	pins[pin].handler = handler;
+	pins[pin].interruptMode = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+	attachInterrupt(pin, NULL, 0);
+}
+
+void nativeSetPin(uint8_t pin, uint8_t level) {
+	if (pin >= NATIVE_GPIO_PINS) {
+		return;
+	}
+
+	void (*handler)(void) = NULL;
+	{
+		std::lock_guard<std::mutex> guard(pinLock);
+		NativePin* p = &pins[pin];
+		level = level ? HIGH : LOW;
+		bool rising = p->level == LOW && level == HIGH;
+		bool falling = p->level == HIGH && level == LOW;
+		p->level = level;
+		p->driven = true;
+		switch (p->interruptMode) {
+			case RISING: handler = rising ? p->handler : NULL; break;
+			case FALLING: handler = falling ? p->handler : NULL; break;
+			case CHANGE: handler = (rising || falling) ? p->handler : NULL; break;
+			case ONLOW: handler = level == LOW ? p->handler : NULL; break;
+			case ONHIGH: handler = level == HIGH ? p->handler : NULL; break;
+			default: break;
+		}
+	}
+
+	// ISRs run on the calling thread.
+	if (handler != NULL) {
+		handler();
+	}
+}
+
+uint8_t nativeGetPin(uint8_t pin) {
+	if (pin >= NATIVE_GPIO_PINS) {
+		return LOW;
+	}
+
+	std::lock_guard<std::mutex> guard(pinLock);
+	return pins[pin].level;
+}
+
+#if defined(__GLIBC__) && !(__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 38))
+size_t strlcpy(char* dst, const char* src, size_t size) {
+	size_t len = strlen(src);
+	if (size > 0) {
+		size_t count = len < size - 1 ? len : size - 1;
+		memcpy(dst, src, count);
+		dst[count] = '\0';
+	}
+
+	return len;
+}
+
+size_t strlcat(char* dst, const char* src, size_t size) {
+	size_t used = strnlen(dst, size);
+	if (used == size) {
+		return size + strlen(src);
+	}
+
+	return used + strlcpy(dst + used, src, size - used);
+}
+#endif
+
+long random(long max) {
+	return max > 0 ? ::random() % max : 0;
+}
+
+long random(long min, long max) {
+	return min >= max ? min : min + random(max - min);
+}
+
+void randomSeed(unsigned long seed) {
+	srandom(seed);
+}
+
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh) {
+	return (value - fromLow) * (toHigh - toLow) / (fromHigh - fromLow) + toLow;
+}
+
+void EspClass::restart() {
+	Serial.println(F("NATIVE: Restart requested. Exiting."));
+	fflush(NULL);
+	std::quick_exit(0);
+}
+
+// Roughly what the firmware sees on a WROOM-32 after boot.
+uint32_t EspClass::getHeapSize() { return 327680; }
+uint32_t EspClass::getFreeHeap() { return 180000; }
+uint32_t EspClass::getMinFreeHeap() { return 160000; }
+uint32_t EspClass::getMaxAllocHeap() { return 110000; }
+uint8_t EspClass::getChipRevision() { return 1; }
+uint32_t EspClass::getCpuFreqMHz() { return 240; }
+uint32_t EspClass::getFlashChipSize() { return 4 * 1024 * 1024; }
+const char* EspClass::getSdkVersion() { return "native"; }
+uint64_t EspClass::getEfuseMac() { return 0x0000A4CF12C0FFEEULL; }
+
+EspClass ESP;
+
+uint64_t nativeHostNanos() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void nativeExit(int status) {
+	fflush(NULL);
+	std::quick_exit(status);
+}
+
+static uint64_t parseDuration(const char* value) {
+	// Seconds of virtual time.
+	return (uint64_t)(atof(value) * 1000000.0);
+}
+
+int main(int argc, char** argv) {
+	(void)argc;
+	(void)argv;
+
+	// CYGATE_CLOCK: accelerated (default), realtime or manual.
+	// CYGATE_RUN_FOR: stop after this many seconds of virtual time.
+	// CYGATE_QUIET: discard serial output.
+	const char* mode = getenv("CYGATE_CLOCK");
+	if (mode != NULL && strcasecmp(mode, "realtime") == 0) {
+		VirtualClock.setMode(ClockMode::REALTIME);
+	}
+	else if (mode != NULL && strcasecmp(mode, "manual") == 0) {
+		VirtualClock.setMode(ClockMode::MANUAL);
+	}
+
+	const char* runFor = getenv("CYGATE_RUN_FOR");
+	if (runFor != NULL) {
+		VirtualClock.setStopTime(parseDuration(runFor));
+	}
+
+	Serial.setMuted(getenv("CYGATE_QUIET") != NULL);
+
+	// This thread plays the ESP32's loop task.
+	VirtualClock.enterTask();
+	xTaskGetCurrentTaskHandle();
+	nativeSetup();
+	setup();
+	for (;;) {
+		loop();
+		vTaskDelay(1);
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#ifndef _NATIVE_ARDUINO_H
+#define _NATIVE_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_system.h"
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "HardwareSerial.h"
+#include "IPAddress.h"
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x02
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define ONLOW 0x04
+#define ONHIGH 0x05
+
+#define IRAM_ATTR
+
+#define bit(b) (1UL << (b))
+#define bitRead(value, b) (((value) >> (b)) & 0x01)
+#define bitSet(value, b) ((value) |= (1UL << (b)))
+#define bitClear(value, b) ((value) &= ~(1UL << (b)))
+#define bitWrite(value, b, bitValue) ((bitValue) ? bitSet(value, b) : bitClear(value, b))
+#define lowByte(w) ((uint8_t)((w) & 0xFF))
+#define highByte(w) ((uint8_t)((w) >> 8))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define digitalPinToInterrupt(p) (p)
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef uint16_t word;
+
+// As on the ESP32 core, min() and max() need both arguments to have the
+// same type.
+using std::min;
+using std::max;
+
+// newlib has these; glibc only from 2.38.
+#if defined(__GLIBC__) && !(__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 38))
+size_t strlcpy(char* dst, const char* src, size_t size);
+size_t strlcat(char* dst, const char* src, size_t size);
+#endif
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void detachInterrupt(uint8_t pin);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh);
+
+// WCharacter.h
+inline bool isDigit(int c) { return isdigit(c) != 0; }
+inline bool isHexadecimalDigit(int c) { return isxdigit(c) != 0; }
+
+class EspClass {
+public:
+	void restart();
+	uint32_t getHeapSize();
+	uint32_t getFreeHeap();
+	uint32_t getMinFreeHeap();
+	uint32_t getMaxAllocHeap();
+	uint8_t getChipRevision();
+	uint32_t getCpuFreqMHz();
+	uint32_t getFlashChipSize();
+	const char* getSdkVersion();
+	uint64_t getEfuseMac();
+};
+
+extern EspClass ESP;
+
+void setup();
+void loop();
+
+#endif
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef _NATIVE_ARDUINO_OTA_H
+#define _NATIVE_ARDUINO_OTA_H
+
+#include <Arduino.h>
+#include <functional>
+
+#define U_FLASH 0
+#define U_SPIFFS 100
+
+typedef enum {
+	OTA_AUTH_ERROR,
+	OTA_BEGIN_ERROR,
+	OTA_CONNECT_ERROR,
+	OTA_RECEIVE_ERROR,
+	OTA_END_ERROR
+} ota_error_t;
+
+// Configured but never offered an update.
+class ArduinoOTAClass {
+public:
+	typedef std::function<void(void)> THandlerFunction;
+	typedef std::function<void(ota_error_t)> THandlerFunction_Error;
+	typedef std::function<void(unsigned int, unsigned int)> THandlerFunction_Progress;
+
+	ArduinoOTAClass& setPort(uint16_t port) { (void)port; return *this; }
+	ArduinoOTAClass& setHostname(const char* hostname) { (void)hostname; return *this; }
+	ArduinoOTAClass& setPassword(const char* password) { (void)password; return *this; }
+	ArduinoOTAClass& setMdnsEnabled(bool enabled) { (void)enabled; return *this; }
+	ArduinoOTAClass& onStart(THandlerFunction fn) { this->_start = fn; return *this; }
+	ArduinoOTAClass& onEnd(THandlerFunction fn) { this->_end = fn; return *this; }
+	ArduinoOTAClass& onError(THandlerFunction_Error fn) { this->_error = fn; return *this; }
+	ArduinoOTAClass& onProgress(THandlerFunction_Progress fn) { this->_progress = fn; return *this; }
+	int getCommand() { return U_FLASH; }
+	void begin() {}
+	void end() {}
+	void handle() {}
+
+private:
+	THandlerFunction _start;
+	THandlerFunction _end;
+	THandlerFunction_Error _error;
+	THandlerFunction_Progress _progress;
+};
+
+static ArduinoOTAClass ArduinoOTA;
+
+#endif
\ No newline at end of file
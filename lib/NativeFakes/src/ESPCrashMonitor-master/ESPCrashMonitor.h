@@ -0,0 +1,31 @@
+#ifndef _NATIVE_ESP_CRASH_MONITOR_H
+#define _NATIVE_ESP_CRASH_MONITOR_H
+
+#include <Arduino.h>
+
+// No watchdog on the host: a wedged task shows up as the virtual clock
+// stopping (or not stopping) instead.
+class ESPCrashMonitorClass {
+public:
+	enum class ETimeout : uint8_t {
+		Timeout_15ms,
+		Timeout_30ms,
+		Timeout_60ms,
+		Timeout_120ms,
+		Timeout_250ms,
+		Timeout_500ms,
+		Timeout_1s,
+		Timeout_2s,
+		Timeout_4s,
+		Timeout_8s
+	};
+
+	void enableWatchdog(ETimeout timeout) { (void)timeout; }
+	void disableWatchdog() {}
+	void defer() {}
+	void iAmAlive() {}
+};
+
+static ESPCrashMonitorClass ESPCrashMonitor;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,16 @@
+#ifndef _NATIVE_ESPMDNS_H
+#define _NATIVE_ESPMDNS_H
+
+#include <Arduino.h>
+
+class MDNSResponder {
+public:
+	bool begin(const char* hostName) { (void)hostName; return true; }
+	void end() {}
+	bool addService(const char* service, const char* proto, uint16_t port) { (void)service; (void)proto; (void)port; return true; }
+	bool addService(const String& service, const String& proto, uint16_t port) { return this->addService(service.c_str(), proto.c_str(), port); }
+};
+
+static MDNSResponder MDNS;
+
+#endif
\ No newline at end of file
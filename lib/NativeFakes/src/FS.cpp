@@ -0,0 +1,131 @@
+#include "FS.h"
+#include "SPIFFS.h"
+#include <dirent.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+using namespace fs;
+
+File::File(FILE* file, const char* name) : _file(file, fclose), _name(name) {}
+
+size_t File::write(uint8_t c) {
+	return this->write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+	return this->_file ? fwrite(buffer, 1, size, this->_file.get()) : 0;
+}
+
+int File::available() {
+	return this->_file ? (int)(this->size() - this->position()) : 0;
+}
+
+int File::read() {
+	return this->_file ? fgetc(this->_file.get()) : -1;
+}
+
+int File::peek() {
+	if (!this->_file) {
+		return -1;
+	}
+
+	int c = fgetc(this->_file.get());
+	if (c != EOF) {
+		ungetc(c, this->_file.get());
+	}
+
+	return c;
+}
+
+size_t File::readBytes(char* buffer, size_t length) {
+	return this->_file ? fread(buffer, 1, length, this->_file.get()) : 0;
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+	return this->readBytes((char*)buffer, size);
+}
+
+void File::flush() {
+	if (this->_file) {
+		fflush(this->_file.get());
+	}
+}
+
+bool File::seek(uint32_t pos) {
+	return this->_file && fseek(this->_file.get(), pos, SEEK_SET) == 0;
+}
+
+size_t File::position() const {
+	return this->_file ? ftell(this->_file.get()) : 0;
+}
+
+size_t File::size() const {
+	if (!this->_file) {
+		return 0;
+	}
+
+	struct stat info;
+	fflush(this->_file.get());
+	return fstat(fileno(this->_file.get()), &info) == 0 ? info.st_size : 0;
+}
+
+void File::close() {
+	this->_file.reset();
+}
+
+bool FS::begin(bool formatOnFail) {
+	(void)formatOnFail;
+	const char* root = getenv("CYGATE_FS_ROOT");
+	this->_root = root != NULL ? root : "data";
+	struct stat info;
+	return stat(this->_root.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+String FS::hostPath(const char* path) {
+	String result = this->_root;
+	if (path[0] != '/') {
+		result += "/";
+	}
+
+	result += path;
+	return result;
+}
+
+File FS::open(const char* path, const char* mode) {
+	// Binary mode so sizes and offsets match the device.
+	String hostMode(mode);
+	hostMode += "b";
+	FILE* file = fopen(this->hostPath(path).c_str(), hostMode.c_str());
+	return file != NULL ? File(file, path) : File();
+}
+
+bool FS::exists(const char* path) {
+	struct stat info;
+	return stat(this->hostPath(path).c_str(), &info) == 0;
+}
+
+bool FS::remove(const char* path) {
+	return ::remove(this->hostPath(path).c_str()) == 0;
+}
+
+size_t FS::usedBytes() {
+	size_t used = 0;
+	DIR* dir = opendir(this->_root.c_str());
+	if (dir == NULL) {
+		return 0;
+	}
+
+	struct dirent* entry;
+	while ((entry = readdir(dir)) != NULL) {
+		struct stat info;
+		String path = this->hostPath(entry->d_name);
+		if (stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode)) {
+			used += info.st_size;
+		}
+	}
+
+	closedir(dir);
+	return used;
+}
+
+SPIFFSFS SPIFFS;
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef _NATIVE_FS_H
+#define _NATIVE_FS_H
+
+#include <stdio.h>
+#include <memory>
+#include "Stream.h"
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+// Handle to a host file. Copies share the underlying FILE, like the
+// ref-counted handles on the device.
+class File : public Stream {
+public:
+	File() {}
+	File(FILE* file, const char* name);
+	operator bool() const { return this->_file != nullptr; }
+
+	size_t write(uint8_t c) override;
+	size_t write(const uint8_t* buffer, size_t size) override;
+	using Print::write;
+	int available() override;
+	int read() override;
+	size_t read(uint8_t* buffer, size_t size);
+	int peek() override;
+	size_t readBytes(char* buffer, size_t length) override;
+	void flush() override;
+	bool seek(uint32_t pos);
+	size_t position() const;
+	size_t size() const;
+	void close();
+	const char* name() const { return this->_name.c_str(); }
+
+private:
+	std::shared_ptr<FILE> _file;
+	String _name;
+};
+
+// Flat filesystem under a host directory: $CYGATE_FS_ROOT, or "data"
+// (the SPIFFS image source) when unset.
+class FS {
+public:
+	bool begin(bool formatOnFail = false);
+	void end() {}
+	File open(const char* path, const char* mode = FILE_READ);
+	File open(const String& path, const char* mode = FILE_READ) { return this->open(path.c_str(), mode); }
+	bool exists(const char* path);
+	bool exists(const String& path) { return this->exists(path.c_str()); }
+	bool remove(const char* path);
+	bool remove(const String& path) { return this->remove(path.c_str()); }
+	size_t totalBytes() { return 1441792; }
+	size_t usedBytes();
+
+private:
+	String hostPath(const char* path);
+
+	String _root;
+};
+
+}
+
+using fs::File;
+using fs::FS;
+
+#endif
\ No newline at end of file
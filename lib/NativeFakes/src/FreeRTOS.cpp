@@ -0,0 +1,425 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "VirtualClock.h"
+
+#include <pthread.h>
+#include <string.h>
+#include <atomic>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class NativeQueueKind : uint8_t {
+	QUEUE,
+	MUTEX,
+	RECURSIVE_MUTEX,
+	COUNTING
+};
+
+struct NativeTask {
+	std::string name;
+	TaskFunction_t code;
+	void* params;
+	uint32_t stackDepth;
+	UBaseType_t priority;
+	uint32_t notifications;
+	pthread_t thread;
+};
+
+struct NativeQueue {
+	NativeQueueKind kind;
+	UBaseType_t length;
+	UBaseType_t itemSize;
+	std::deque<std::vector<uint8_t> > items;
+	UBaseType_t count;                  // Semaphores only.
+	TaskHandle_t owner;                 // Mutexes only.
+	UBaseType_t recursion;
+};
+
+static std::vector<NativeTask*> tasks;
+static thread_local NativeTask* currentTask = NULL;
+static std::atomic<uint32_t> nextCriticalOwnerId(1);
+static thread_local uint32_t criticalOwnerId = nextCriticalOwnerId++;
+
+static uint64_t deadlineFor(TickType_t ticks) {
+	if (ticks == portMAX_DELAY) {
+		return VIRTUAL_CLOCK_FOREVER;
+	}
+
+	return VirtualClock.micros() + (uint64_t)ticks * portTICK_PERIOD_MS * 1000;
+}
+
+static void* taskEntry(void* arg) {
+	NativeTask* task = (NativeTask*)arg;
+	currentTask = task;
+	task->code(task->params);
+
+	// Returning from a task function is a bug on the ESP32 as well.
+	VirtualClock.exitTask();
+	return NULL;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+	if (currentTask == NULL) {
+		// A thread not started by xTaskCreate(), ie. the loop thread.
+		currentTask = new NativeTask();
+		currentTask->name = "loopTask";
+		currentTask->code = NULL;
+		currentTask->params = NULL;
+		currentTask->stackDepth = 8192;
+		currentTask->priority = 1;
+		currentTask->notifications = 0;
+		currentTask->thread = pthread_self();
+		std::lock_guard<std::mutex> guard(VirtualClock.kernelLock());
+		tasks.push_back(currentTask);
+	}
+
+	return currentTask;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char* name, uint32_t stackDepth, void* params, UBaseType_t priority, TaskHandle_t* handle) {
+	NativeTask* task = new NativeTask();
+	task->name = name;
+	task->code = code;
+	task->params = params;
+	task->stackDepth = stackDepth;
+	task->priority = priority;
+	task->notifications = 0;
+	{
+		std::lock_guard<std::mutex> guard(VirtualClock.kernelLock());
+		tasks.push_back(task);
+	}
+
+	// Count the task as running before it exists, so the clock can't skip
+	// ahead while the thread is still starting up.
+	VirtualClock.enterTask();
+	if (pthread_create(&task->thread, NULL, taskEntry, task) != 0) {
+		VirtualClock.exitTask();
+		return pdFAIL;
+	}
+
+	pthread_setname_np(task->thread, task->name.substr(0, 15).c_str());
+	if (handle != NULL) {
+		*handle = task;
+	}
+
+	return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stackDepth, void* params, UBaseType_t priority, TaskHandle_t* handle, BaseType_t coreId) {
+	(void)coreId;
+	return xTaskCreate(code, name, stackDepth, params, priority, handle);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+	// Only self-deletion is supported.
+	if (task == NULL || task == currentTask) {
+		VirtualClock.exitTask();
+		pthread_exit(NULL);
+	}
+}
+
+void vTaskDelay(TickType_t ticks) {
+	if (ticks == 0) {
+		std::this_thread::yield();
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(VirtualClock.kernelLock());
+	VirtualClock.wait(lock, deadlineFor(ticks), []() { return false; });
+}
+
+TickType_t xTaskGetTickCount() {
+	return (TickType_t)(VirtualClock.micros() / 1000 / portTICK_PERIOD_MS);
+}
+
+const char* pcTaskGetTaskName(TaskHandle_t task) {
+	if (task == NULL) {
+		task = xTaskGetCurrentTaskHandle();
+	}
+
+	return task->name.c_str();
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task) {
+	if (task == NULL) {
+		task = xTaskGetCurrentTaskHandle();
+	}
+
+	return task->priority;
+}
+
+void vTaskPrioritySet(TaskHandle_t task, UBaseType_t priority) {
+	if (task == NULL) {
+		task = xTaskGetCurrentTaskHandle();
+	}
+
+	task->priority = priority;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+	// Host stacks aren't comparable to the ESP32's. Report the full
+	// allocation as unused.
+	if (task == NULL) {
+		task = xTaskGetCurrentTaskHandle();
+	}
+
+	return task->stackDepth;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks() {
+	std::lock_guard<std::mutex> guard(VirtualClock.kernelLock());
+	return tasks.size();
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+	std::lock_guard<std::mutex> guard(VirtualClock.kernelLock());
+	task->notifications++;
+	VirtualClock.notify();
+	return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken) {
+	xTaskNotifyGive(task);
+	if (higherPriorityTaskWoken != NULL) {
+		*higherPriorityTaskWoken = pdFALSE;
+	}
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+	NativeTask* task = xTaskGetCurrentTaskHandle();
+	std::unique_lock<std::mutex> lock(VirtualClock.kernelLock());
+	VirtualClock.wait(lock, deadlineFor(ticks), [task]() { return task->notifications > 0; });
+
+	uint32_t value = task->notifications;
+	if (value > 0) {
+		task->notifications = clearOnExit ? 0 : value - 1;
+	}
+
+	return value;
+}
+
+void vPortEnterCritical(portMUX_TYPE* mux) {
+	uint32_t self = criticalOwnerId;
+	if (__atomic_load_n(&mux->owner, __ATOMIC_ACQUIRE) == self) {
+		mux->count++;
+		return;
+	}
+
+	uint32_t expected = 0;
+	while (!__atomic_compare_exchange_n(&mux->owner, &expected, self, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+		expected = 0;
+		std::this_thread::yield();
+	}
+
+	mux->count = 1;
+}
+
+void vPortExitCritical(portMUX_TYPE* mux) {
+	if (--mux->count == 0) {
+		__atomic_store_n(&mux->owner, 0, __ATOMIC_RELEASE);
+	}
+}
+
+static NativeQueue* createQueue(NativeQueueKind kind, UBaseType_t length, UBaseType_t itemSize, UBaseType_t count) {
+	NativeQueue* queue = new NativeQueue();
+	queue->kind = kind;
+	queue->length = length;
+	queue->itemSize = itemSize;
+	queue->count = count;
+	queue->owner = NULL;
+	queue->recursion = 0;
+	return queue;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+	return createQueue(NativeQueueKind::QUEUE, length, itemSize, 0);
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+	delete queue;
+}
+
+static BaseType_t queueSend(QueueHandle_t queue, const void* item, TickType_t ticks, bool front) {
+	std::unique_lock<std::mutex> lock(VirtualClock.kernelLock());
+	bool ready = VirtualClock.wait(lock, deadlineFor(ticks), [queue]() { return queue->items.size() < queue->length; });
+	if (!ready) {
+		return errQUEUE_FULL;
+	}
+
+	const uint8_t* bytes = (const uint8_t*)item;
+	std::vector<uint8_t> copy(bytes, bytes + queue->itemSize);
+	if (front) {
+		queue->items.push_front(copy);
+	}
+	else {
+		queue->items.push_back(copy);
+	}
+
+	VirtualClock.notify();
+	return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks) {
+	return queueSend(queue, item, ticks, false);
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks) {
+	return queueSend(queue, item, ticks, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticks) {
+	return queueSend(queue, item, ticks, true);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higherPriorityTaskWoken) {
+	if (higherPriorityTaskWoken != NULL) {
+		*higherPriorityTaskWoken = pdFALSE;
+	}
+
+	return queueSend(queue, item, 0, false);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item) {
+	std::lock_guard<std::mutex> guard(VirtualClock.kernelLock());
+	const uint8_t* bytes = (const uint8_t*)item;
+	queue->items.clear();
+	queue->items.push_back(std::vector<uint8_t>(bytes, bytes + queue->itemSize));
+	VirtualClock.notify();
+	return pdPASS;
+}
+
+static BaseType_t queueReceive(QueueHandle_t queue, void* buffer, TickType_t ticks, bool remove) {
+	std::unique_lock<std::mutex> lock(VirtualClock.kernelLock());
+	bool ready = VirtualClock.wait(lock, deadlineFor(ticks), [queue]() { return !queue->items.empty(); });
+	if (!ready) {
+		return pdFALSE;
+	}
+
+	memcpy(buffer, queue->items.front().data(), queue->itemSize);
+	if (remove) {
+		queue->items.pop_front();
+		VirtualClock.notify();
+	}
+
+	return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* buffer, TickType_t ticks) {
+	return queueReceive(queue, buffer, ticks, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* buffer, TickType_t ticks) {
+	return queueReceive(queue, buffer, ticks, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+	std::lock_guard<std::mutex> guard(VirtualClock.kernelLock());
+	return queue->kind == NativeQueueKind::QUEUE ? queue->items.size() : queue->count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+	std::lock_guard<std::mutex> guard(VirtualClock.kernelLock());
+	return queue->length - (queue->kind == NativeQueueKind::QUEUE ? queue->items.size() : queue->count);
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+	std::lock_guard<std::mutex> guard(VirtualClock.kernelLock());
+	queue->items.clear();
+	VirtualClock.notify();
+	return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+	return createQueue(NativeQueueKind::MUTEX, 1, 0, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() {
+	return createQueue(NativeQueueKind::RECURSIVE_MUTEX, 1, 0, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+	return createQueue(NativeQueueKind::COUNTING, 1, 0, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount) {
+	return createQueue(NativeQueueKind::COUNTING, maxCount, 0, initialCount);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+	delete semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+	TaskHandle_t self = xTaskGetCurrentTaskHandle();
+	std::unique_lock<std::mutex> lock(VirtualClock.kernelLock());
+	if (!VirtualClock.wait(lock, deadlineFor(ticks), [semaphore]() { return semaphore->count > 0; })) {
+		return pdFALSE;
+	}
+
+	semaphore->count--;
+	semaphore->owner = self;
+	return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+	std::lock_guard<std::mutex> guard(VirtualClock.kernelLock());
+	if (semaphore->count >= semaphore->length) {
+		return pdFALSE;
+	}
+
+	semaphore->count++;
+	semaphore->owner = NULL;
+	VirtualClock.notify();
+	return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* higherPriorityTaskWoken) {
+	if (higherPriorityTaskWoken != NULL) {
+		*higherPriorityTaskWoken = pdFALSE;
+	}
+
+	return xSemaphoreGive(semaphore);
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t ticks) {
+	TaskHandle_t self = xTaskGetCurrentTaskHandle();
+	std::unique_lock<std::mutex> lock(VirtualClock.kernelLock());
+	if (semaphore->owner == self) {
+		semaphore->recursion++;
+		return pdTRUE;
+	}
+
+	if (!VirtualClock.wait(lock, deadlineFor(ticks), [semaphore]() { return semaphore->owner == NULL; })) {
+		return pdFALSE;
+	}
+
+	semaphore->owner = self;
+	semaphore->recursion = 1;
+	semaphore->count = 0;
+	return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore) {
+	TaskHandle_t self = xTaskGetCurrentTaskHandle();
+	std::lock_guard<std::mutex> guard(VirtualClock.kernelLock());
+	if (semaphore->owner != self) {
+		return pdFALSE;
+	}
+
+	if (--semaphore->recursion == 0) {
+		semaphore->owner = NULL;
+		semaphore->count = 1;
+		VirtualClock.notify();
+	}
+
+	return pdTRUE;
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t semaphore) {
+	std::lock_guard<std::mutex> guard(VirtualClock.kernelLock());
+	return semaphore->count;
+}
\ No newline at end of file
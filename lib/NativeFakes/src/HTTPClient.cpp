@@ -0,0 +1,163 @@
+#include "HTTPClient.h"
+#include <atomic>
+#include <mutex>
+
+#define HTTP_FAKE_CHUNK_SIZE 64                 // Body bytes per chunk in chunked responses.
+
+static std::mutex responderLock;
+static HTTPResponder responder;
+static std::atomic<uint32_t> connections(0);
+
+HTTPClient::HTTPClient() {
+	this->_client = NULL;
+	this->_timeout = 5000;
+	this->_reuse = true;
+	this->_exchange.chunked = false;
+	this->_exchange.keepAlive = true;
+}
+
+void HTTPClient::setResponder(HTTPResponder newResponder) {
+	std::lock_guard<std::mutex> guard(responderLock);
+	responder = newResponder;
+}
+
+uint32_t HTTPClient::getConnectionCount() {
+	return connections;
+}
+
+bool HTTPClient::begin(WiFiClient& client, const String& url) {
+	this->_client = &client;
+	this->_exchange = HTTPExchange();
+	this->_exchange.url = url;
+	this->_exchange.chunked = false;
+	this->_exchange.keepAlive = true;
+	return true;
+}
+
+void HTTPClient::end() {
+	if (this->_client != NULL && !(this->_reuse && this->_exchange.keepAlive)) {
+		this->_client->stop();
+	}
+}
+
+void HTTPClient::addHeader(const String& name, const String& value) {
+	if (name.equalsIgnoreCase("Authorization")) {
+		this->_exchange.authorization = value;
+	}
+}
+
+void HTTPClient::setAuthorization(const char* auth) {
+	this->_exchange.authorization = auth;
+}
+
+void HTTPClient::collectHeaders(const char* headerKeys[], const size_t headerKeysCount) {
+	this->_collectedHeaders.clear();
+	for (size_t i = 0; i < headerKeysCount; i++) {
+		this->_collectedHeaders.push_back(headerKeys[i]);
+	}
+}
+
+String HTTPClient::header(const char* name) {
+	for (size_t i = 0; i < this->_collectedHeaders.size(); i++) {
+		if (this->_collectedHeaders[i].equalsIgnoreCase(name)) {
+			if (this->_exchange.chunked && this->_collectedHeaders[i].equalsIgnoreCase("Transfer-Encoding")) {
+				return "chunked";
+			}
+
+			break;
+		}
+	}
+
+	return String();
+}
+
+// The body as it goes over the wire: as is, or split into chunks.
+static String encodeBody(const HTTPExchange& exchange) {
+	if (!exchange.chunked) {
+		return exchange.body;
+	}
+
+	String wire;
+	char sizeLine[16];
+	for (unsigned int pos = 0; pos < exchange.body.length(); pos += HTTP_FAKE_CHUNK_SIZE) {
+		String chunk = exchange.body.substring(pos, pos + HTTP_FAKE_CHUNK_SIZE);
+		snprintf(sizeLine, sizeof(sizeLine), "%x\r\n", chunk.length());
+		wire += sizeLine;
+		wire += chunk;
+		wire += "\r\n";
+	}
+
+	wire += "0\r\n\r\n";
+	return wire;
+}
+
+int HTTPClient::sendRequest(const char* method, const uint8_t* payload, size_t size) {
+	if (this->_client == NULL) {
+		return HTTPC_ERROR_NOT_CONNECTED;
+	}
+
+	HTTPResponder current;
+	{
+		std::lock_guard<std::mutex> guard(responderLock);
+		current = responder;
+	}
+
+	if (!current) {
+		return HTTPC_ERROR_CONNECTION_REFUSED;
+	}
+
+	this->_exchange.method = method;
+	this->_exchange.requestBody = String();
+	if (payload != NULL) {
+		this->_exchange.requestBody.concat((const char*)payload, size);
+	}
+
+	if (!this->_client->connected()) {
+		this->_client->connect(this->_exchange.url.c_str(), 80);
+		connections++;
+	}
+
+	int code = current(this->_exchange);
+	this->_client->loadResponse(encodeBody(this->_exchange));
+	return code;
+}
+
+int HTTPClient::GET() {
+	return this->sendRequest("GET", NULL, 0);
+}
+
+int HTTPClient::POST(uint8_t* payload, size_t size) {
+	return this->sendRequest("POST", payload, size);
+}
+
+int HTTPClient::POST(const String& payload) {
+	return this->sendRequest("POST", (const uint8_t*)payload.c_str(), payload.length());
+}
+
+int HTTPClient::getSize() {
+	return this->_exchange.chunked ? -1 : (int)this->_exchange.body.length();
+}
+
+WiFiClient& HTTPClient::getStream() {
+	return *this->_client;
+}
+
+int HTTPClient::writeToStream(Stream* stream) {
+	if (this->_client == NULL || stream == NULL) {
+		return HTTPC_ERROR_NOT_CONNECTED;
+	}
+
+	// The client already holds the whole response, so the body is decoded
+	// from the exchange rather than from the framing.
+	int written = 0;
+	for (unsigned int i = 0; i < this->_exchange.body.length(); i++) {
+		written += stream->write((uint8_t)this->_exchange.body[i]);
+	}
+
+	this->_client->loadResponse(String());
+	return written;
+}
+
+String HTTPClient::getString() {
+	return this->_exchange.body;
+}
\ No newline at end of file
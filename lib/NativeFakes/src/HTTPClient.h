@@ -0,0 +1,76 @@
+#ifndef _NATIVE_HTTP_CLIENT_H
+#define _NATIVE_HTTP_CLIENT_H
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+#include "WiFiClient.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+
+typedef enum {
+	HTTP_CODE_OK = 200,
+	HTTP_CODE_BAD_REQUEST = 400,
+	HTTP_CODE_UNAUTHORIZED = 401,
+	HTTP_CODE_FORBIDDEN = 403,
+	HTTP_CODE_NOT_FOUND = 404,
+	HTTP_CODE_INTERNAL_SERVER_ERROR = 500
+} t_http_codes;
+
+// A request as the server sees it. The responder fills in body (and
+// chunked, to have it sent with "Transfer-Encoding: chunked" instead of a
+// Content-Length) and returns the status code. Clearing keepAlive answers with
+// "Connection: close".
+struct HTTPExchange {
+	String method;
+	String url;
+	String authorization;               // Value of the Authorization header, if any.
+	String requestBody;
+	String body;
+	bool chunked;
+	bool keepAlive;
+};
+
+typedef std::function<int(HTTPExchange& exchange)> HTTPResponder;
+
+// Requests are answered in-process by the responder installed with
+// setResponder(); with none installed the server refuses connections.
+// A chunked body reaches the stream (getStream()) with its chunk framing,
+// as on the device; writeToStream() and getString() decode it.
+// As on the device, end() leaves the connection open for the next request
+// if reuse is on (the default) and the server kept it alive. Every new
+// connection is counted (getConnectionCount()).
+class HTTPClient {
+public:
+	HTTPClient();
+	void setReuse(bool reuse) { this->_reuse = reuse; }
+	void setTimeout(uint16_t timeout) { this->_timeout = timeout; }
+	bool begin(WiFiClient& client, const String& url);
+	void end();
+	void addHeader(const String& name, const String& value);
+	void setAuthorization(const char* auth);
+	void collectHeaders(const char* headerKeys[], const size_t headerKeysCount);
+	String header(const char* name);
+	int GET();
+	int POST(uint8_t* payload, size_t size);
+	int POST(const String& payload);
+	int getSize();
+	WiFiClient& getStream();
+	int writeToStream(Stream* stream);
+	String getString();
+
+	static void setResponder(HTTPResponder responder);
+	static uint32_t getConnectionCount();
+
+private:
+	int sendRequest(const char* method, const uint8_t* payload, size_t size);
+
+	WiFiClient* _client;
+	HTTPExchange _exchange;
+	std::vector<String> _collectedHeaders;
+	uint16_t _timeout;
+	bool _reuse;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "HardwareSerial.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <unistd.h>
+
+HardwareSerial::HardwareSerial() {
+	this->_started = false;
+	this->_muted = false;
+}
+
+void HardwareSerial::begin(unsigned long baud, uint32_t config) {
+	(void)baud;
+	(void)config;
+	std::lock_guard<std::mutex> guard(this->_lock);
+	if (this->_started) {
+		return;
+	}
+
+	// Line buffered, so a harness piping the console sees each line as it
+	// is printed.
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	// Not a task, so it doesn't hold the virtual clock back.
+	pthread_t thread;
+	if (pthread_create(&thread, NULL, HardwareSerial::inputThread, this) == 0) {
+		pthread_detach(thread);
+		this->_started = true;
+	}
+}
+
+void HardwareSerial::end() {}
+
+void HardwareSerial::setDebugOutput(bool enabled) {
+	(void)enabled;
+}
+
+void HardwareSerial::setMuted(bool muted) {
+	this->_muted = muted;
+}
+
+void* HardwareSerial::inputThread(void* arg) {
+	HardwareSerial* serial = (HardwareSerial*)arg;
+	uint8_t buffer[64];
+	ssize_t count;
+	while ((count = ::read(STDIN_FILENO, buffer, sizeof(buffer))) > 0) {
+		std::lock_guard<std::mutex> guard(serial->_lock);
+		serial->_input.insert(serial->_input.end(), buffer, buffer + count);
+	}
+
+	return NULL;
+}
+
+int HardwareSerial::available() {
+	std::lock_guard<std::mutex> guard(this->_lock);
+	return this->_input.size();
+}
+
+int HardwareSerial::read() {
+	std::lock_guard<std::mutex> guard(this->_lock);
+	if (this->_input.empty()) {
+		return -1;
+	}
+
+	uint8_t c = this->_input.front();
+	this->_input.pop_front();
+	return c;
+}
+
+int HardwareSerial::peek() {
+	std::lock_guard<std::mutex> guard(this->_lock);
+	return this->_input.empty() ? -1 : this->_input.front();
+}
+
+void HardwareSerial::flush() {
+	fflush(stdout);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+	return this->write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+	if (!this->_muted) {
+		fwrite(buffer, 1, size, stdout);
+	}
+
+	return size;
+}
+
+HardwareSerial Serial;
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef _NATIVE_HARDWARE_SERIAL_H
+#define _NATIVE_HARDWARE_SERIAL_H
+
+#include <deque>
+#include <mutex>
+#include "Stream.h"
+
+#define SERIAL_8N1 0x800001c
+
+// Console on the host's stdin/stdout. Input is read by a helper thread so
+// available() never blocks.
+class HardwareSerial : public Stream {
+public:
+	HardwareSerial();
+	void begin(unsigned long baud, uint32_t config = SERIAL_8N1);
+	void end();
+	void setDebugOutput(bool enabled);
+	void setMuted(bool muted);
+	int available() override;
+	int read() override;
+	int peek() override;
+	void flush() override;
+	size_t write(uint8_t c) override;
+	size_t write(const uint8_t* buffer, size_t size) override;
+	using Print::write;
+	operator bool() const { return true; }
+
+private:
+	static void* inputThread(void* arg);
+
+	std::mutex _lock;
+	std::deque<uint8_t> _input;
+	bool _started;
+	bool _muted;
+};
+
+extern HardwareSerial Serial;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "IPAddress.h"
+#include "Print.h"
+#include <stdio.h>
+
+IPAddress::IPAddress() {
+	this->_address.dword = 0;
+}
+
+IPAddress::IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth) {
+	this->_address.bytes[0] = first;
+	this->_address.bytes[1] = second;
+	this->_address.bytes[2] = third;
+	this->_address.bytes[3] = fourth;
+}
+
+IPAddress::IPAddress(uint32_t address) {
+	this->_address.dword = address;
+}
+
+bool IPAddress::fromString(const char* address) {
+	unsigned int parts[4];
+	char trailing;
+	if (address == NULL || sscanf(address, "%u.%u.%u.%u%c", &parts[0], &parts[1], &parts[2], &parts[3], &trailing) != 4) {
+		return false;
+	}
+
+	for (int i = 0; i < 4; i++) {
+		if (parts[i] > 255) {
+			return false;
+		}
+
+		this->_address.bytes[i] = parts[i];
+	}
+
+	return true;
+}
+
+String IPAddress::toString() const {
+	char buffer[16];
+	snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", this->_address.bytes[0], this->_address.bytes[1], this->_address.bytes[2], this->_address.bytes[3]);
+	return String(buffer);
+}
+
+size_t IPAddress::printTo(Print& p) const {
+	return p.print(this->toString());
+}
+
+const IPAddress INADDR_NONE(0, 0, 0, 0);
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef _NATIVE_IP_ADDRESS_H
+#define _NATIVE_IP_ADDRESS_H
+
+#include <stdint.h>
+#include "Printable.h"
+#include "WString.h"
+
+class IPAddress : public Printable {
+public:
+	IPAddress();
+	IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth);
+	IPAddress(uint32_t address);
+	bool fromString(const char* address);
+	bool fromString(const String& address) { return this->fromString(address.c_str()); }
+	String toString() const;
+	operator uint32_t() const { return this->_address.dword; }
+	bool operator==(const IPAddress& rhs) const { return this->_address.dword == rhs._address.dword; }
+	bool operator==(uint32_t rhs) const { return this->_address.dword == rhs; }
+	bool operator!=(const IPAddress& rhs) const { return !(*this == rhs); }
+	uint8_t operator[](int index) const { return this->_address.bytes[index]; }
+	uint8_t& operator[](int index) { return this->_address.bytes[index]; }
+	size_t printTo(Print& p) const override;
+
+private:
+	union {
+		uint8_t bytes[4];
+		uint32_t dword;
+	} _address;
+};
+
+extern const IPAddress INADDR_NONE;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,20 @@
+#ifndef _NATIVE_LED_H
+#define _NATIVE_LED_H
+
+#include <Arduino.h>
+
+// Drives a host GPIO; the harness can watch it with nativeGetPin().
+class LED {
+public:
+	LED(uint8_t pin, void* name) : _pin(pin) { (void)name; }
+	void init() { pinMode(this->_pin, OUTPUT); this->off(); }
+	void on() { digitalWrite(this->_pin, HIGH); }
+	void off() { digitalWrite(this->_pin, LOW); }
+	bool isOn() { return digitalRead(this->_pin) == HIGH; }
+	void blink(unsigned long delayMs) { this->on(); delay(delayMs); this->off(); }
+
+private:
+	uint8_t _pin;
+};
+
+#endif
\ No newline at end of file
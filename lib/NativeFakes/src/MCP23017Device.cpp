@@ -0,0 +1,147 @@
+#include "MCP23017Device.h"
+#include "NativeHarness.h"
+#include <string.h>
+
+MCP23017Device::MCP23017Device() {
+	memset(this->_registers, 0, sizeof(this->_registers));
+	this->_registers[MCP23017_IODIRA] = 0xFF;
+	this->_registers[MCP23017_IODIRA + 1] = 0xFF;
+	this->_inputs[0] = 0xFF;
+	this->_inputs[1] = 0xFF;
+	this->_pointer = 0;
+	this->_intPin = MCP23017_NO_INT_PIN;
+}
+
+void MCP23017Device::setInterruptPin(uint8_t hostPin) {
+	std::lock_guard<std::recursive_mutex> guard(this->_lock);
+	this->_intPin = hostPin;
+	this->driveInterruptPin();
+}
+
+void MCP23017Device::setInput(uint8_t pin, uint8_t level) {
+	if (pin > 15) {
+		return;
+	}
+
+	std::lock_guard<std::recursive_mutex> guard(this->_lock);
+	uint8_t previous[2] = { this->readPort(0), this->readPort(1) };
+	uint8_t port = pin / 8;
+	uint8_t mask = 1 << (pin % 8);
+	this->_inputs[port] = level ? (this->_inputs[port] | mask) : (this->_inputs[port] & ~mask);
+	this->evaluateInterrupts(previous);
+}
+
+uint8_t MCP23017Device::getOutput(uint8_t pin) {
+	if (pin > 15) {
+		return 0;
+	}
+
+	std::lock_guard<std::recursive_mutex> guard(this->_lock);
+	return (this->_registers[MCP23017_OLATA + (pin / 8)] >> (pin % 8)) & 0x01;
+}
+
+uint8_t MCP23017Device::getRegister(uint8_t reg) {
+	std::lock_guard<std::recursive_mutex> guard(this->_lock);
+	return reg < MCP23017_REGISTERS ? this->_registers[reg] : 0;
+}
+
+uint8_t MCP23017Device::readPort(uint8_t port) {
+	// Inputs (IODIR = 1) read the pin, inverted by IPOL. Outputs read back
+	// the latch.
+	uint8_t dir = this->_registers[MCP23017_IODIRA + port];
+	uint8_t in = this->_inputs[port] ^ this->_registers[MCP23017_IPOLA + port];
+	return (in & dir) | (this->_registers[MCP23017_OLATA + port] & ~dir);
+}
+
+uint8_t MCP23017Device::readRegister(uint8_t reg) {
+	uint8_t port = reg & 0x01;
+	switch (reg & ~0x01) {
+		case MCP23017_GPIOA:
+		case MCP23017_INTCAPA: {
+			// Reading GPIO or INTCAP clears the port's interrupt.
+			uint8_t value = (reg & ~0x01) == MCP23017_GPIOA
+				? this->readPort(port)
+				: this->_registers[reg];
+			this->_registers[MCP23017_INTFA + port] = 0;
+			uint8_t current[2] = { this->readPort(0), this->readPort(1) };
+			this->evaluateInterrupts(current);
+			return value;
+		}
+		default:
+			return this->_registers[reg];
+	}
+}
+
+void MCP23017Device::writeRegister(uint8_t reg, uint8_t value) {
+	uint8_t port = reg & 0x01;
+	uint8_t previous[2] = { this->readPort(0), this->readPort(1) };
+	switch (reg & ~0x01) {
+		case MCP23017_INTFA:
+		case MCP23017_INTCAPA:
+			return;             // Read-only.
+		case MCP23017_GPIOA:
+			this->_registers[MCP23017_OLATA + port] = value;
+			break;
+		case MCP23017_IOCONA:
+			// Both addresses map to the same register.
+			this->_registers[MCP23017_IOCONA] = value;
+			this->_registers[MCP23017_IOCONA + 1] = value;
+			break;
+		default:
+			this->_registers[reg] = value;
+			break;
+	}
+
+	this->evaluateInterrupts(previous);
+}
+
+void MCP23017Device::evaluateInterrupts(const uint8_t* previous) {
+	for (uint8_t port = 0; port < 2; port++) {
+		uint8_t current = this->readPort(port);
+		uint8_t intcon = this->_registers[MCP23017_INTCONA + port];
+		uint8_t compare = (intcon & (current ^ this->_registers[MCP23017_DEFVALA + port]))
+			| (~intcon & (current ^ previous[port]));
+		uint8_t pending = compare & this->_registers[MCP23017_GPINTENA + port];
+
+		// Once latched, the port holds INTF/INTCAP until it is read.
+		if (pending != 0 && this->_registers[MCP23017_INTFA + port] == 0) {
+			this->_registers[MCP23017_INTFA + port] = pending;
+			this->_registers[MCP23017_INTCAPA + port] = current;
+		}
+	}
+
+	this->driveInterruptPin();
+}
+
+void MCP23017Device::driveInterruptPin() {
+	bool mirror = (this->_registers[MCP23017_IOCONA] & 0x40) != 0;
+	bool activeHigh = (this->_registers[MCP23017_IOCONA] & 0x02) != 0;
+	bool asserted = this->_registers[MCP23017_INTFA] != 0
+		|| (mirror && this->_registers[MCP23017_INTFA + 1] != 0);
+	if (this->_intPin != MCP23017_NO_INT_PIN) {
+		nativeSetPin(this->_intPin, asserted == activeHigh ? HIGH : LOW);
+	}
+}
+
+void MCP23017Device::onReceive(const uint8_t* data, size_t len) {
+	if (len == 0) {
+		return;
+	}
+
+	std::lock_guard<std::recursive_mutex> guard(this->_lock);
+	this->_pointer = data[0] % MCP23017_REGISTERS;
+	for (size_t i = 1; i < len; i++) {
+		this->writeRegister(this->_pointer, data[i]);
+		this->_pointer = (this->_pointer + 1) % MCP23017_REGISTERS;
+	}
+}
+
+size_t MCP23017Device::onRequest(uint8_t* buffer, size_t len) {
+	std::lock_guard<std::recursive_mutex> guard(this->_lock);
+	for (size_t i = 0; i < len; i++) {
+		buffer[i] = this->readRegister(this->_pointer);
+		this->_pointer = (this->_pointer + 1) % MCP23017_REGISTERS;
+	}
+
+	return len;
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef _MCP23017_DEVICE_H
+#define _MCP23017_DEVICE_H
+
+#include <stdint.h>
+#include <mutex>
+#include "Adafruit_MCP23017.h"
+#include "Wire.h"
+
+#define MCP23017_NO_INT_PIN 0xFF
+
+/**
+ * Register-level model of an MCP23017 for the native bench (BANK = 0,
+ * sequential addressing). Inputs are driven with setInput() as the field
+ * wiring would. Interrupt-on-change, DEFVAL compare, INTF/INTCAP latching
+ * and clear-on-read follow the datasheet. INTA is wired to a host GPIO
+ * (setInterruptPin()); with IOCON.MIRROR set it reports both ports.
+ */
+class MCP23017Device : public I2CDevice {
+public:
+	MCP23017Device();
+	void setInterruptPin(uint8_t hostPin);
+	void setInput(uint8_t pin, uint8_t level);
+	uint8_t getOutput(uint8_t pin);
+	uint8_t getRegister(uint8_t reg);
+
+	void onReceive(const uint8_t* data, size_t len) override;
+	size_t onRequest(uint8_t* buffer, size_t len) override;
+
+private:
+	uint8_t readPort(uint8_t port);
+	uint8_t readRegister(uint8_t reg);
+	void writeRegister(uint8_t reg, uint8_t value);
+	void evaluateInterrupts(const uint8_t* previous);
+	void driveInterruptPin();
+
+	std::recursive_mutex _lock;
+	uint8_t _registers[MCP23017_REGISTERS];
+	uint8_t _inputs[2];                 // Levels on the pins when not driven as outputs.
+	uint8_t _pointer;
+	uint8_t _intPin;
+};
+
+#endif
\ No newline at end of file
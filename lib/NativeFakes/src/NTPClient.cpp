@@ -0,0 +1,61 @@
+#include "NTPClient.h"
+#include <stdio.h>
+#include <time.h>
+#include "WiFi.h"
+
+static const unsigned long hostEpochAtStart = (unsigned long)time(NULL);
+
+NTPClient::NTPClient(WiFiUDP& udp, const char* poolServerName, long timeOffset, unsigned long updateInterval) {
+	(void)poolServerName;
+	this->_udp = &udp;
+	this->_timeOffset = timeOffset;
+	this->_updateInterval = updateInterval;
+	this->_lastUpdate = 0;
+	this->_timeSet = false;
+}
+
+void NTPClient::begin() {
+	this->_udp->begin(123);
+}
+
+void NTPClient::end() {
+	this->_udp->stop();
+}
+
+bool NTPClient::update() {
+	if (!this->_timeSet || millis() - this->_lastUpdate >= this->_updateInterval) {
+		return this->forceUpdate();
+	}
+
+	return false;
+}
+
+bool NTPClient::forceUpdate() {
+	if (WiFi.status() != WL_CONNECTED) {
+		delay(NTP_RESPONSE_TIMEOUT);
+		return false;
+	}
+
+	this->_lastUpdate = millis();
+	this->_timeSet = true;
+	return true;
+}
+
+bool NTPClient::isTimeSet() const {
+	return this->_timeSet;
+}
+
+void NTPClient::setTimeOffset(int timeOffset) {
+	this->_timeOffset = timeOffset;
+}
+
+unsigned long NTPClient::getEpochTime() const {
+	return hostEpochAtStart + this->_timeOffset + (millis() / 1000);
+}
+
+String NTPClient::getFormattedTime() const {
+	unsigned long rawTime = this->getEpochTime();
+	char buffer[9];
+	snprintf(buffer, sizeof(buffer), "%02lu:%02lu:%02lu", (rawTime % 86400L) / 3600, (rawTime % 3600) / 60, rawTime % 60);
+	return String(buffer);
+}
\ No newline at end of file
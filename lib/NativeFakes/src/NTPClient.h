@@ -0,0 +1,33 @@
+#ifndef _NATIVE_NTPCLIENT_H
+#define _NATIVE_NTPCLIENT_H
+
+#include <Arduino.h>
+#include "WiFiUdp.h"
+
+#define NTP_DEFAULT_UPDATE_INTERVAL 60000
+#define NTP_RESPONSE_TIMEOUT 1000
+
+// Answers from the host's wall clock at start-up plus virtual time, so
+// timestamps stay consistent with millis() in every clock mode. Fails
+// (after the usual timeout) while WiFi is down.
+class NTPClient {
+public:
+	NTPClient(WiFiUDP& udp, const char* poolServerName, long timeOffset = 0, unsigned long updateInterval = NTP_DEFAULT_UPDATE_INTERVAL);
+	void begin();
+	void end();
+	bool update();
+	bool forceUpdate();
+	bool isTimeSet() const;
+	void setTimeOffset(int timeOffset);
+	unsigned long getEpochTime() const;
+	String getFormattedTime() const;
+
+private:
+	WiFiUDP* _udp;
+	long _timeOffset;
+	unsigned long _updateInterval;
+	unsigned long _lastUpdate;
+	bool _timeSet;
+};
+
+#endif
\ No newline at end of file
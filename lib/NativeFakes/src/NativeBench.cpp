@@ -0,0 +1,20 @@
+#include "NativeHarness.h"
+#include "MCP23017Device.h"
+#include "Wire.h"
+
+#define BENCH_PRIMARY_EXPANDER 0x20
+#define BENCH_EXPANDER_INT_PIN 17       // PIN_EXP_INT
+#define BENCH_RTC_ADDRESS 0x68
+
+// The default bench: a bare controller board. The primary expander (with
+// its interrupt line on GPIO 17) and the RTC are on the bus; no keypads,
+// fob readers or relay modules are attached. Harnesses that need more
+// define their own nativeSetup() and attach devices to Wire.
+static MCP23017Device primaryExpander;
+static NullI2CDevice rtc;
+
+void __attribute__((weak)) nativeSetup() {
+	primaryExpander.setInterruptPin(BENCH_EXPANDER_INT_PIN);
+	Wire.attach(BENCH_PRIMARY_EXPANDER, &primaryExpander);
+	Wire.attach(BENCH_RTC_ADDRESS, &rtc);
+}
\ No newline at end of file
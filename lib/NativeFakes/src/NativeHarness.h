@@ -0,0 +1,32 @@
+#ifndef _NATIVE_HARNESS_H
+#define _NATIVE_HARNESS_H
+
+#include <stdint.h>
+
+// Controls for driving the firmware in the native build. Everything else
+// (time, I2C devices, the MQTT broker) is reached through VirtualClock,
+// Wire and PubSubClient.
+
+#define NATIVE_GPIO_PINS 40
+
+// Drives a GPIO as an external signal would, firing any interrupt
+// attached to it. Once driven, the pin's pull-up or pull-down no longer
+// sets its level; an undriven pin reads as its pull.
+void nativeSetPin(uint8_t pin, uint8_t level);
+uint8_t nativeGetPin(uint8_t pin);
+
+// Called before setup() to attach the simulated hardware. The default
+// (weak) implementation builds the bench described in NativeBench.cpp;
+// a harness can provide its own.
+void nativeSetup();
+
+// Host CPU time (nanoseconds), for benchmarks. millis() and micros() are
+// virtual and don't move while a test is computing.
+uint64_t nativeHostNanos();
+
+// Ends the run with the given exit status. Firmware tasks are still
+// running, so this skips static destructors like the stop time does.
+// Test suites finish with nativeExit(UNITY_END()).
+void nativeExit(int status);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "Print.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+	size_t written = 0;
+	while (written < size && this->write(buffer[written])) {
+		written++;
+	}
+
+	return written;
+}
+
+size_t Print::write(const char* str) {
+	return str != NULL ? this->write((const uint8_t*)str, strlen(str)) : 0;
+}
+
+size_t Print::write(const char* buffer, size_t size) {
+	return this->write((const uint8_t*)buffer, size);
+}
+
+size_t Print::printf(const char* format, ...) {
+	va_list args;
+	va_start(args, format);
+	va_list copy;
+	va_copy(copy, args);
+	int len = vsnprintf(NULL, 0, format, copy);
+	va_end(copy);
+	if (len < 0) {
+		va_end(args);
+		return 0;
+	}
+
+	std::vector<char> buffer(len + 1);
+	vsnprintf(buffer.data(), buffer.size(), format, args);
+	va_end(args);
+	return this->write((const uint8_t*)buffer.data(), len);
+}
+
+size_t Print::print(const __FlashStringHelper* str) {
+	return this->write((const char*)str);
+}
+
+size_t Print::print(const String& str) {
+	return this->write((const uint8_t*)str.c_str(), str.length());
+}
+
+size_t Print::print(const char* str) {
+	return this->write(str);
+}
+
+size_t Print::print(char c) {
+	return this->write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char value, int base) {
+	return this->print((unsigned long)value, base);
+}
+
+size_t Print::print(int value, int base) {
+	return this->print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base) {
+	return this->print((unsigned long)value, base);
+}
+
+size_t Print::print(long value, int base) {
+	if (base == 0) {
+		return this->write((uint8_t)value);
+	}
+
+	return this->print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(unsigned long value, int base) {
+	if (base == 0) {
+		return this->write((uint8_t)value);
+	}
+
+	return this->print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(long long value, int base) {
+	return this->print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(unsigned long long value, int base) {
+	return this->print(String(value, (unsigned char)base));
+}
+
+size_t Print::print(double value, int decimals) {
+	return this->print(String(value, (unsigned char)decimals));
+}
+
+size_t Print::print(const Printable& printable) {
+	return printable.printTo(*this);
+}
+
+size_t Print::println() {
+	return this->write("\r\n");
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef _NATIVE_PRINT_H
+#define _NATIVE_PRINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "WString.h"
+#include "Printable.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print {
+public:
+	virtual ~Print() {}
+	virtual size_t write(uint8_t c) = 0;
+	virtual size_t write(const uint8_t* buffer, size_t size);
+	size_t write(const char* str);
+	size_t write(const char* buffer, size_t size);
+	virtual void flush() {}
+
+	size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+	size_t print(const __FlashStringHelper* str);
+	size_t print(const String& str);
+	size_t print(const char* str);
+	size_t print(char c);
+	size_t print(unsigned char value, int base = DEC);
+	size_t print(int value, int base = DEC);
+	size_t print(unsigned int value, int base = DEC);
+	size_t print(long value, int base = DEC);
+	size_t print(unsigned long value, int base = DEC);
+	size_t print(long long value, int base = DEC);
+	size_t print(unsigned long long value, int base = DEC);
+	size_t print(double value, int decimals = 2);
+	size_t print(const Printable& printable);
+
+	template<typename T> size_t println(const T& value) { size_t n = this->print(value); return n + this->println(); }
+	template<typename T> size_t println(const T& value, int format) { size_t n = this->print(value, format); return n + this->println(); }
+	size_t println();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,261 @@
+#include "PubSubClient.h"
+#include <string.h>
+
+MqttBrokerClass::MqttBrokerClass() {
+	this->_available = true;
+	this->_publishCount = 0;
+}
+
+void MqttBrokerClass::setAvailable(bool available) {
+	// Going away drops every connection.
+	std::lock_guard<std::recursive_mutex> guard(this->_lock);
+	this->_available = available;
+	if (!available) {
+		for (size_t i = 0; i < this->_clients.size(); i++) {
+			this->_clients[i]->_state = MQTT_CONNECTION_LOST;
+			this->_clients[i]->_inbox.clear();
+		}
+
+		this->_clients.clear();
+	}
+}
+
+bool MqttBrokerClass::isAvailable() {
+	std::lock_guard<std::recursive_mutex> guard(this->_lock);
+	return this->_available;
+}
+
+void MqttBrokerClass::onPublish(MqttPublishHook hook) {
+	std::lock_guard<std::recursive_mutex> guard(this->_lock);
+	this->_hook = hook;
+}
+
+void MqttBrokerClass::inject(const char* topic, const uint8_t* payload, unsigned int length) {
+	std::lock_guard<std::recursive_mutex> guard(this->_lock);
+	for (size_t i = 0; i < this->_clients.size(); i++) {
+		PubSubClient* client = this->_clients[i];
+		std::set<std::string>::iterator it;
+		for (it = client->_subscriptions.begin(); it != client->_subscriptions.end(); ++it) {
+			if (matches(*it, topic)) {
+				PubSubClient::Message message = { topic, std::string((const char*)payload, length) };
+				client->_inbox.push_back(message);
+				break;
+			}
+		}
+	}
+}
+
+void MqttBrokerClass::inject(const char* topic, const char* payload) {
+	this->inject(topic, (const uint8_t*)payload, strlen(payload));
+}
+
+uint32_t MqttBrokerClass::getPublishCount() {
+	std::lock_guard<std::recursive_mutex> guard(this->_lock);
+	return this->_publishCount;
+}
+
+bool MqttBrokerClass::attach(PubSubClient* client) {
+	std::lock_guard<std::recursive_mutex> guard(this->_lock);
+	if (!this->_available) {
+		return false;
+	}
+
+	this->detach(client);
+	this->_clients.push_back(client);
+	return true;
+}
+
+void MqttBrokerClass::detach(PubSubClient* client) {
+	std::lock_guard<std::recursive_mutex> guard(this->_lock);
+	for (size_t i = 0; i < this->_clients.size(); i++) {
+		if (this->_clients[i] == client) {
+			this->_clients.erase(this->_clients.begin() + i);
+			break;
+		}
+	}
+
+	client->_inbox.clear();
+}
+
+void MqttBrokerClass::publish(const char* topic, const uint8_t* payload, unsigned int length) {
+	MqttPublishHook hook;
+	{
+		std::lock_guard<std::recursive_mutex> guard(this->_lock);
+		this->_publishCount++;
+		hook = this->_hook;
+	}
+
+	if (hook) {
+		hook(topic, payload, length);
+	}
+}
+
+bool MqttBrokerClass::matches(const std::string& filter, const char* topic) {
+	size_t len = filter.length();
+	if (len > 0 && filter[len - 1] == '#') {
+		return strncmp(filter.c_str(), topic, len - 1) == 0;
+	}
+
+	return filter == topic;
+}
+
+MqttBrokerClass MqttBroker;
+
+PubSubClient::PubSubClient() {
+	this->_state = MQTT_DISCONNECTED;
+	this->_buffer.resize(MQTT_MAX_PACKET_SIZE);
+}
+
+PubSubClient::~PubSubClient() {
+	MqttBroker.detach(this);
+}
+
+PubSubClient& PubSubClient::setServer(IPAddress ip, uint16_t port) {
+	(void)ip;
+	(void)port;
+	return *this;
+}
+
+PubSubClient& PubSubClient::setServer(const char* domain, uint16_t port) {
+	(void)domain;
+	(void)port;
+	return *this;
+}
+
+PubSubClient& PubSubClient::setCallback(MQTT_CALLBACK_SIGNATURE) {
+	this->_callback = callback;
+	return *this;
+}
+
+PubSubClient& PubSubClient::setClient(Client& client) {
+	(void)client;
+	return *this;
+}
+
+PubSubClient& PubSubClient::setKeepAlive(uint16_t keepAlive) {
+	(void)keepAlive;
+	return *this;
+}
+
+bool PubSubClient::setBufferSize(uint16_t size) {
+	if (size == 0) {
+		return false;
+	}
+
+	this->_buffer.resize(size);
+	return true;
+}
+
+uint16_t PubSubClient::getBufferSize() {
+	return this->_buffer.size();
+}
+
+bool PubSubClient::connect(const char* id) {
+	(void)id;
+	if (!MqttBroker.attach(this)) {
+		this->_state = MQTT_CONNECTION_TIMEOUT;
+		return false;
+	}
+
+	this->_subscriptions.clear();
+	this->_state = MQTT_CONNECTED;
+	return true;
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass) {
+	(void)user;
+	(void)pass;
+	return this->connect(id);
+}
+
+void PubSubClient::disconnect() {
+	MqttBroker.detach(this);
+	this->_subscriptions.clear();
+	this->_state = MQTT_DISCONNECTED;
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload) {
+	return this->publish(topic, (const uint8_t*)payload, payload != NULL ? strlen(payload) : 0, false);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int plength) {
+	return this->publish(topic, payload, plength, false);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int plength, bool retained) {
+	(void)retained;
+	if (!this->connected()) {
+		return false;
+	}
+
+	// Same limit as the library: the whole packet has to fit the buffer.
+	if (MQTT_MAX_HEADER_SIZE + 2 + strlen(topic) + plength > this->_buffer.size()) {
+		return false;
+	}
+
+	MqttBroker.publish(topic, payload, plength);
+	return true;
+}
+
+bool PubSubClient::subscribe(const char* topic) {
+	if (!this->connected()) {
+		return false;
+	}
+
+	std::lock_guard<std::recursive_mutex> guard(MqttBroker._lock);
+	this->_subscriptions.insert(topic);
+	return true;
+}
+
+bool PubSubClient::unsubscribe(const char* topic) {
+	if (!this->connected()) {
+		return false;
+	}
+
+	std::lock_guard<std::recursive_mutex> guard(MqttBroker._lock);
+	this->_subscriptions.erase(topic);
+	return true;
+}
+
+bool PubSubClient::loop() {
+	if (!this->connected()) {
+		return false;
+	}
+
+	// One message per call, like the library's one packet per read.
+	Message message;
+	{
+		std::lock_guard<std::recursive_mutex> guard(MqttBroker._lock);
+		if (this->_inbox.empty()) {
+			return true;
+		}
+
+		message = this->_inbox.front();
+		this->_inbox.pop_front();
+	}
+
+	// Topic and payload share the packet buffer; oversized ones are dropped.
+	size_t topicLen = message.topic.length();
+	if (MQTT_MAX_HEADER_SIZE + 2 + topicLen + message.payload.length() > this->_buffer.size()) {
+		return true;
+	}
+
+	if (this->_callback) {
+		char* topic = (char*)&this->_buffer[0];
+		uint8_t* payload = &this->_buffer[topicLen + 1];
+		memcpy(topic, message.topic.c_str(), topicLen + 1);
+		memcpy(payload, message.payload.data(), message.payload.length());
+		this->_callback(topic, payload, message.payload.length());
+	}
+
+	return true;
+}
+
+bool PubSubClient::connected() {
+	std::lock_guard<std::recursive_mutex> guard(MqttBroker._lock);
+	return this->_state == MQTT_CONNECTED;
+}
+
+int PubSubClient::state() {
+	return this->_state;
+}
\ No newline at end of file
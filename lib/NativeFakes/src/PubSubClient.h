@@ -0,0 +1,104 @@
+#ifndef _NATIVE_PUBSUBCLIENT_H
+#define _NATIVE_PUBSUBCLIENT_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "WiFiClient.h"
+
+#define MQTT_MAX_PACKET_SIZE 256
+#define MQTT_KEEPALIVE 15
+#define MQTT_MAX_HEADER_SIZE 5
+
+#define MQTT_CONNECTION_TIMEOUT     -4
+#define MQTT_CONNECTION_LOST        -3
+#define MQTT_CONNECT_FAILED         -2
+#define MQTT_DISCONNECTED           -1
+#define MQTT_CONNECTED               0
+#define MQTT_CONNECT_BAD_PROTOCOL    1
+#define MQTT_CONNECT_BAD_CLIENT_ID   2
+#define MQTT_CONNECT_UNAVAILABLE     3
+#define MQTT_CONNECT_BAD_CREDENTIALS 4
+#define MQTT_CONNECT_UNAUTHORIZED    5
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+
+class PubSubClient;
+
+typedef std::function<void(const char* topic, const uint8_t* payload, unsigned int length)> MqttPublishHook;
+
+// In-process broker. Topics match exactly or through a trailing "#".
+// Injected messages are delivered from the subscriber's own loop() call,
+// on its task, as with a real connection.
+class MqttBrokerClass {
+public:
+	MqttBrokerClass();
+	void setAvailable(bool available);
+	bool isAvailable();
+	void onPublish(MqttPublishHook hook);
+	void inject(const char* topic, const uint8_t* payload, unsigned int length);
+	void inject(const char* topic, const char* payload);
+	uint32_t getPublishCount();
+
+private:
+	friend class PubSubClient;
+
+	bool attach(PubSubClient* client);
+	void detach(PubSubClient* client);
+	void publish(const char* topic, const uint8_t* payload, unsigned int length);
+	static bool matches(const std::string& filter, const char* topic);
+
+	std::recursive_mutex _lock;
+	std::vector<PubSubClient*> _clients;
+	MqttPublishHook _hook;
+	bool _available;
+	uint32_t _publishCount;
+};
+
+extern MqttBrokerClass MqttBroker;
+
+class PubSubClient {
+public:
+	PubSubClient();
+	~PubSubClient();
+	PubSubClient& setServer(IPAddress ip, uint16_t port);
+	PubSubClient& setServer(const char* domain, uint16_t port);
+	PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE);
+	PubSubClient& setClient(Client& client);
+	PubSubClient& setKeepAlive(uint16_t keepAlive);
+	bool setBufferSize(uint16_t size);
+	uint16_t getBufferSize();
+
+	bool connect(const char* id);
+	bool connect(const char* id, const char* user, const char* pass);
+	void disconnect();
+	bool publish(const char* topic, const char* payload);
+	bool publish(const char* topic, const uint8_t* payload, unsigned int plength);
+	bool publish(const char* topic, const uint8_t* payload, unsigned int plength, bool retained);
+	bool subscribe(const char* topic);
+	bool unsubscribe(const char* topic);
+	bool loop();
+	bool connected();
+	int state();
+
+private:
+	friend class MqttBrokerClass;
+
+	struct Message {
+		std::string topic;
+		std::string payload;
+	};
+
+	std::function<void(char*, uint8_t*, unsigned int)> _callback;
+	std::set<std::string> _subscriptions;
+	std::deque<Message> _inbox;         // Guarded by the broker lock.
+	std::vector<uint8_t> _buffer;
+	int _state;
+};
+
+#endif
\ No newline at end of file
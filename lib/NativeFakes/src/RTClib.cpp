@@ -0,0 +1,117 @@
+#include "RTClib.h"
+#include <stdio.h>
+#include <string.h>
+
+// Days since 1970-01-01 for a civil date (proleptic Gregorian).
+static int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+	y -= m <= 2;
+	int64_t era = (y >= 0 ? y : y - 399) / 400;
+	unsigned yoe = (unsigned)(y - era * 400);
+	unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+	unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	return era * 146097 + (int64_t)doe - 719468;
+}
+
+DateTime::DateTime(uint32_t t) {
+	int64_t z = t / 86400 + 719468;
+	uint32_t secs = t % 86400;
+	int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+	unsigned doe = (unsigned)(z - era * 146097);
+	unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	unsigned mp = (5 * doy + 2) / 153;
+	unsigned m = mp < 10 ? mp + 3 : mp - 9;
+	this->_year = (uint16_t)(yoe + era * 400 + (m <= 2));
+	this->_month = m;
+	this->_day = doy - (153 * mp + 2) / 5 + 1;
+	this->_hour = secs / 3600;
+	this->_minute = (secs / 60) % 60;
+	this->_second = secs % 60;
+}
+
+DateTime::DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t min, uint8_t sec) {
+	if (year < 100) {
+		year += 2000;
+	}
+
+	this->_year = year;
+	this->_month = month;
+	this->_day = day;
+	this->_hour = hour;
+	this->_minute = min;
+	this->_second = sec;
+}
+
+DateTime::DateTime(const char* date, const char* time) {
+	// "Mmm dd yyyy" and "hh:mm:ss", as produced by __DATE__ and __TIME__.
+	static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+	char month[4] = { 0 };
+	int day = 1;
+	int year = 2000;
+	int hour = 0;
+	int minute = 0;
+	int second = 0;
+	sscanf(date, "%3s %d %d", month, &day, &year);
+	sscanf(time, "%d:%d:%d", &hour, &minute, &second);
+	const char* found = strstr(months, month);
+	this->_year = year;
+	this->_month = found != NULL ? ((found - months) / 3) + 1 : 1;
+	this->_day = day;
+	this->_hour = hour;
+	this->_minute = minute;
+	this->_second = second;
+}
+
+DateTime::DateTime(const __FlashStringHelper* date, const __FlashStringHelper* time)
+	: DateTime((const char*)date, (const char*)time) {}
+
+uint32_t DateTime::unixtime() const {
+	return (uint32_t)(daysFromCivil(this->_year, this->_month, this->_day) * 86400
+		+ this->_hour * 3600 + this->_minute * 60 + this->_second);
+}
+
+String DateTime::timestamp(timestampOpt opt) const {
+	char buffer[32];
+	switch (opt) {
+		case TIMESTAMP_TIME:
+			snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d", this->_hour, this->_minute, this->_second);
+			break;
+		case TIMESTAMP_DATE:
+			snprintf(buffer, sizeof(buffer), "%u-%02d-%02d", this->_year, this->_month, this->_day);
+			break;
+		default:
+			snprintf(buffer, sizeof(buffer), "%u-%02d-%02dT%02d:%02d:%02d", this->_year, this->_month,
+				this->_day, this->_hour, this->_minute, this->_second);
+			break;
+	}
+
+	return String(buffer);
+}
+
+RTC_DS1307::RTC_DS1307() {
+	this->_wire = &Wire;
+	this->_running = false;
+	this->_offset = 0;
+}
+
+bool RTC_DS1307::begin(TwoWire* wireInstance) {
+	this->_wire = wireInstance;
+	return this->_wire->getDevice(DS1307_ADDRESS) != NULL;
+}
+
+uint8_t RTC_DS1307::isrunning() {
+	return this->_running ? 1 : 0;
+}
+
+void RTC_DS1307::adjust(const DateTime& dt) {
+	this->_offset = (int64_t)dt.unixtime() - (int64_t)(millis() / 1000);
+	this->_running = true;
+}
+
+DateTime RTC_DS1307::now() {
+	if (!this->_running) {
+		return DateTime((uint32_t)946684800);
+	}
+
+	return DateTime((uint32_t)(this->_offset + (int64_t)(millis() / 1000)));
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef _NATIVE_RTCLIB_H
+#define _NATIVE_RTCLIB_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define DS1307_ADDRESS 0x68
+
+// The parts of RTClib's DateTime the firmware uses.
+class DateTime {
+public:
+	enum timestampOpt {
+		TIMESTAMP_FULL,
+		TIMESTAMP_TIME,
+		TIMESTAMP_DATE
+	};
+
+	DateTime(uint32_t t = 946684800);
+	DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour = 0, uint8_t min = 0, uint8_t sec = 0);
+	DateTime(const char* date, const char* time);
+	DateTime(const __FlashStringHelper* date, const __FlashStringHelper* time);
+
+	uint16_t year() const { return this->_year; }
+	uint8_t month() const { return this->_month; }
+	uint8_t day() const { return this->_day; }
+	uint8_t hour() const { return this->_hour; }
+	uint8_t minute() const { return this->_minute; }
+	uint8_t second() const { return this->_second; }
+	uint32_t unixtime() const;
+	String timestamp(timestampOpt opt = TIMESTAMP_FULL) const;
+
+private:
+	uint16_t _year;
+	uint8_t _month;
+	uint8_t _day;
+	uint8_t _hour;
+	uint8_t _minute;
+	uint8_t _second;
+};
+
+// DS1307 backed by the virtual clock. begin() succeeds only when a device
+// is attached to Wire at DS1307_ADDRESS; a fresh RTC isn't running until
+// it is first adjusted, like a chip with a dead backup cell.
+class RTC_DS1307 {
+public:
+	RTC_DS1307();
+	bool begin(TwoWire* wireInstance = &Wire);
+	uint8_t isrunning();
+	void adjust(const DateTime& dt);
+	DateTime now();
+
+private:
+	TwoWire* _wire;
+	bool _running;
+	int64_t _offset;                    // Seconds from virtual time zero to RTC time.
+};
+
+#endif
\ No newline at end of file
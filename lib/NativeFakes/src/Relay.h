@@ -0,0 +1,25 @@
+#ifndef _NATIVE_RELAY_H
+#define _NATIVE_RELAY_H
+
+#include <Arduino.h>
+
+enum class RelayState : uint8_t {
+	Open = LOW,
+	Closed = HIGH
+};
+
+class Relay {
+public:
+	Relay(uint8_t pin, void* name) : _pin(pin) { (void)name; }
+	void init() { pinMode(this->_pin, OUTPUT); this->open(); }
+	void open() { digitalWrite(this->_pin, LOW); }
+	void close() { digitalWrite(this->_pin, HIGH); }
+	RelayState getState() { return digitalRead(this->_pin) == HIGH ? RelayState::Closed : RelayState::Open; }
+	bool isOpen() { return this->getState() == RelayState::Open; }
+	bool isClosed() { return this->getState() == RelayState::Closed; }
+
+private:
+	uint8_t _pin;
+};
+
+#endif
\ No newline at end of file
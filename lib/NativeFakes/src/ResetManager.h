@@ -0,0 +1,14 @@
+#ifndef _NATIVE_RESET_MANAGER_H
+#define _NATIVE_RESET_MANAGER_H
+
+#include <Arduino.h>
+
+class ResetManagerClass {
+public:
+	void softReset() { ESP.restart(); }
+	void hardReset() { ESP.restart(); }
+};
+
+static ResetManagerClass ResetManager;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,14 @@
+#ifndef _NATIVE_SPIFFS_H
+#define _NATIVE_SPIFFS_H
+
+#include "FS.h"
+
+namespace fs {
+
+class SPIFFSFS : public FS {};
+
+}
+
+extern fs::SPIFFSFS SPIFFS;
+
+#endif
\ No newline at end of file
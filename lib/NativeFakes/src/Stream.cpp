@@ -0,0 +1,50 @@
+#include "Stream.h"
+#include "Arduino.h"
+
+int Stream::timedRead() {
+	unsigned long start = millis();
+	do {
+		int c = this->read();
+		if (c >= 0) {
+			return c;
+		}
+
+		delay(1);
+	} while (millis() - start < this->_timeout);
+
+	return -1;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+	size_t count = 0;
+	while (count < length) {
+		int c = this->timedRead();
+		if (c < 0) {
+			break;
+		}
+
+		buffer[count++] = (char)c;
+	}
+
+	return count;
+}
+
+String Stream::readString() {
+	String result;
+	int c;
+	while ((c = this->timedRead()) >= 0) {
+		result += (char)c;
+	}
+
+	return result;
+}
+
+String Stream::readStringUntil(char terminator) {
+	String result;
+	int c;
+	while ((c = this->timedRead()) >= 0 && c != terminator) {
+		result += (char)c;
+	}
+
+	return result;
+}
\ No newline at end of file
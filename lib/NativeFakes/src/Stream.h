@@ -0,0 +1,26 @@
+#ifndef _NATIVE_STREAM_H
+#define _NATIVE_STREAM_H
+
+#include "Print.h"
+
+class Stream : public Print {
+public:
+	Stream() : _timeout(1000) {}
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+
+	void setTimeout(unsigned long timeout) { this->_timeout = timeout; }
+	unsigned long getTimeout() { return this->_timeout; }
+	virtual size_t readBytes(char* buffer, size_t length);
+	size_t readBytes(uint8_t* buffer, size_t length) { return this->readBytes((char*)buffer, length); }
+	String readString();
+	String readStringUntil(char terminator);
+
+protected:
+	int timedRead();
+
+	unsigned long _timeout;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include "VirtualClock.h"
+#include <stdio.h>
+#include <cstdlib>
+
+VirtualClockClass::VirtualClockClass() {
+	this->_now = 0;
+	this->_mode = (uint8_t)ClockMode::ACCELERATED;
+	this->_realStart = std::chrono::steady_clock::now();
+	this->_realOffset = 0;
+	this->_stopTime = VIRTUAL_CLOCK_FOREVER;
+	this->_running = 0;
+}
+
+uint64_t VirtualClockClass::micros() {
+	if ((ClockMode)this->_mode.load() == ClockMode::REALTIME) {
+		auto elapsed = std::chrono::steady_clock::now() - this->_realStart;
+		return this->_realOffset + std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+	}
+
+	return this->_now;
+}
+
+void VirtualClockClass::setMode(ClockMode mode) {
+	std::lock_guard<std::mutex> guard(this->_lock);
+	this->_now = this->micros();
+	this->_realOffset = this->_now;
+	this->_realStart = std::chrono::steady_clock::now();
+	this->_mode = (uint8_t)mode;
+	this->notifyAll();
+}
+
+ClockMode VirtualClockClass::getMode() {
+	return (ClockMode)this->_mode.load();
+}
+
+void VirtualClockClass::advance(uint64_t us) {
+	std::lock_guard<std::mutex> guard(this->_lock);
+	this->_now += us;
+	this->checkStop();
+	this->notifyAll();
+}
+
+void VirtualClockClass::setStopTime(uint64_t us) {
+	std::lock_guard<std::mutex> guard(this->_lock);
+	this->_stopTime = us;
+}
+
+std::mutex& VirtualClockClass::kernelLock() {
+	return this->_lock;
+}
+
+void VirtualClockClass::checkStop() {
+	// Lock held. Other threads are still running, so skip the static
+	// destructors. Harnesses can print results from an at_quick_exit()
+	// handler.
+	if (this->micros() >= this->_stopTime) {
+		fflush(NULL);
+		std::quick_exit(0);
+	}
+}
+
+bool VirtualClockClass::skipAhead() {
+	// Lock held, every task blocked. Don't move time while any waiter can
+	// already run (or has timed out); it just hasn't been scheduled yet.
+	uint64_t next = VIRTUAL_CLOCK_FOREVER;
+	for (size_t i = 0; i < this->_waiters.size(); i++) {
+		Waiter* waiter = this->_waiters[i];
+		if (waiter->deadline <= this->_now || (*waiter->ready)()) {
+			waiter->cond.notify_one();
+			return false;
+		}
+
+		if (waiter->deadline < next) {
+			next = waiter->deadline;
+		}
+	}
+
+	if (next == VIRTUAL_CLOCK_FOREVER) {
+		return false;
+	}
+
+	this->_now = next;
+	this->checkStop();
+	for (size_t i = 0; i < this->_waiters.size(); i++) {
+		if (this->_waiters[i]->deadline <= next) {
+			this->_waiters[i]->cond.notify_one();
+		}
+	}
+
+	return true;
+}
+
+bool VirtualClockClass::wait(std::unique_lock<std::mutex>& lock, uint64_t deadline, const std::function<bool()>& ready) {
+	static thread_local uint32_t failedPolls = 0;
+	if (ready()) {
+		failedPolls = 0;
+		return true;
+	}
+
+	if (deadline <= this->micros()) {
+		if (++failedPolls < VIRTUAL_CLOCK_IDLE_POLLS) {
+			return false;
+		}
+
+		deadline = this->micros() + VIRTUAL_CLOCK_IDLE_SLEEP;
+	}
+
+	failedPolls = 0;
+	Waiter waiter;
+	waiter.deadline = deadline;
+	waiter.ready = &ready;
+	this->_waiters.push_back(&waiter);
+	this->_running--;
+
+	while (!ready() && this->micros() < deadline) {
+		ClockMode mode = (ClockMode)this->_mode.load();
+		if (mode == ClockMode::ACCELERATED && this->_running <= 0 && this->skipAhead()) {
+			continue;
+		}
+
+		if (mode == ClockMode::REALTIME && deadline != VIRTUAL_CLOCK_FOREVER) {
+			waiter.cond.wait_until(lock, this->_realStart + std::chrono::microseconds(deadline - this->_realOffset));
+		}
+		else {
+			waiter.cond.wait(lock);
+		}
+
+		this->checkStop();
+	}
+
+	this->_running++;
+	for (size_t i = 0; i < this->_waiters.size(); i++) {
+		if (this->_waiters[i] == &waiter) {
+			this->_waiters.erase(this->_waiters.begin() + i);
+			break;
+		}
+	}
+
+	return ready();
+}
+
+void VirtualClockClass::notify() {
+	// Lock held. Something a waiter may be blocked on has changed.
+	this->notifyAll();
+}
+
+void VirtualClockClass::notifyAll() {
+	for (size_t i = 0; i < this->_waiters.size(); i++) {
+		this->_waiters[i]->cond.notify_one();
+	}
+}
+
+void VirtualClockClass::enterTask() {
+	std::lock_guard<std::mutex> guard(this->_lock);
+	this->_running++;
+}
+
+void VirtualClockClass::exitTask() {
+	std::lock_guard<std::mutex> guard(this->_lock);
+	this->_running--;
+	this->notifyAll();
+}
+
+VirtualClockClass VirtualClock;
\ No newline at end of file
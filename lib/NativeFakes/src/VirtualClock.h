@@ -0,0 +1,78 @@
+#ifndef _VIRTUAL_CLOCK_H
+#define _VIRTUAL_CLOCK_H
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#define VIRTUAL_CLOCK_FOREVER UINT64_MAX
+#define VIRTUAL_CLOCK_IDLE_POLLS 64     // Failed non-blocking polls in a row before a task counts as idle.
+#define VIRTUAL_CLOCK_IDLE_SLEEP 1000   // How long an idle poller is put to sleep (microseconds).
+
+enum class ClockMode : uint8_t {
+	ACCELERATED = 0,    // Jump straight to the next wakeup whenever every task is blocked.
+	REALTIME = 1,       // Follow the host's monotonic clock.
+	MANUAL = 2          // Only move when advance() is called.
+};
+
+/**
+ * Time source for the native build. millis(), micros(), vTaskDelay() and
+ * every blocking FreeRTOS call go through here.
+ *
+ * Threads started by xTaskCreate() (and the loop thread) are counted as
+ * tasks. In ACCELERATED mode, once every task is blocked and none of them
+ * can proceed, the clock skips ahead to the earliest pending timeout. The
+ * control logic therefore runs at full host speed, and time only passes
+ * where the firmware would be waiting anyway. Code that spins on millis()
+ * without blocking will never see the clock move in this mode. A task that
+ * keeps polling empty queues with a zero timeout (the main loop does) is
+ * treated as idle: after VIRTUAL_CLOCK_IDLE_POLLS misses in a row its next
+ * poll sleeps for VIRTUAL_CLOCK_IDLE_SLEEP, as if the spin had taken that
+ * long on the device.
+ *
+ * All blocking goes through one kernel lock, which the FreeRTOS fakes take
+ * before touching queues, semaphores or notifications.
+ */
+class VirtualClockClass {
+public:
+	VirtualClockClass();
+	uint64_t micros();
+	void setMode(ClockMode mode);
+	ClockMode getMode();
+	void advance(uint64_t us);
+	void setStopTime(uint64_t us);
+
+	std::mutex& kernelLock();
+	bool wait(std::unique_lock<std::mutex>& lock, uint64_t deadline, const std::function<bool()>& ready);
+	void notify();
+	void enterTask();
+	void exitTask();
+
+private:
+	struct Waiter {
+		uint64_t deadline;
+		const std::function<bool()>* ready;
+		std::condition_variable cond;   // Per waiter, so a time skip only wakes the tasks that are due.
+	};
+
+	bool skipAhead();
+	void checkStop();
+	void notifyAll();
+
+	std::mutex _lock;
+	std::vector<Waiter*> _waiters;
+	std::atomic<uint64_t> _now;
+	std::atomic<uint8_t> _mode;
+	std::chrono::steady_clock::time_point _realStart;
+	uint64_t _realOffset;               // Virtual time when REALTIME mode was entered.
+	uint64_t _stopTime;
+	int _running;                       // Tasks not blocked in wait().
+};
+
+extern VirtualClockClass VirtualClock;
+
+#endif
\ No newline at end of file
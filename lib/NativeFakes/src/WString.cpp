@@ -0,0 +1,306 @@
+#include "WString.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+static std::string formatUnsigned(unsigned long long value, unsigned char base) {
+	if (base < 2 || base > 36) {
+		base = 10;
+	}
+
+	char buffer[65];
+	int pos = sizeof(buffer) - 1;
+	buffer[pos] = '\0';
+	do {
+		int digit = value % base;
+		buffer[--pos] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+		value /= base;
+	} while (value > 0);
+
+	return std::string(&buffer[pos]);
+}
+
+static std::string formatSigned(long long value, unsigned char base) {
+	// Like Arduino, only base 10 gets a sign. Other bases show the bits.
+	if (base == 10 && value < 0) {
+		return "-" + formatUnsigned(0ULL - (unsigned long long)value, base);
+	}
+
+	return formatUnsigned((unsigned long long)value, base);
+}
+
+static std::string formatFloat(double value, unsigned char decimals) {
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+	return std::string(buffer);
+}
+
+String::String(const char* str) : _buffer(str != NULL ? str : "") {}
+String::String(const String& str) : _buffer(str._buffer) {}
+String::String(const __FlashStringHelper* str) : _buffer(str != NULL ? (const char*)str : "") {}
+String::String(const std::string& str) : _buffer(str) {}
+String::String(char c) : _buffer(1, c) {}
+String::String(unsigned char value, unsigned char base) : _buffer(formatUnsigned(value, base)) {}
+String::String(int value, unsigned char base) : _buffer(formatSigned(base == 10 ? value : (unsigned int)value, base)) {}
+String::String(unsigned int value, unsigned char base) : _buffer(formatUnsigned(value, base)) {}
+String::String(long value, unsigned char base) : _buffer(formatSigned(base == 10 ? value : (unsigned long)value, base)) {}
+String::String(unsigned long value, unsigned char base) : _buffer(formatUnsigned(value, base)) {}
+String::String(long long value, unsigned char base) : _buffer(formatSigned(value, base)) {}
+String::String(unsigned long long value, unsigned char base) : _buffer(formatUnsigned(value, base)) {}
+String::String(float value, unsigned char decimals) : _buffer(formatFloat(value, decimals)) {}
+String::String(double value, unsigned char decimals) : _buffer(formatFloat(value, decimals)) {}
+
+String& String::operator=(const String& rhs) {
+	this->_buffer = rhs._buffer;
+	return *this;
+}
+
+String& String::operator=(const char* rhs) {
+	this->_buffer = rhs != NULL ? rhs : "";
+	return *this;
+}
+
+String& String::operator=(const __FlashStringHelper* rhs) {
+	return *this = (const char*)rhs;
+}
+
+bool String::reserve(unsigned int size) {
+	this->_buffer.reserve(size);
+	return true;
+}
+
+unsigned int String::length() const {
+	return this->_buffer.length();
+}
+
+const char* String::c_str() const {
+	return this->_buffer.c_str();
+}
+
+bool String::isEmpty() const {
+	return this->_buffer.empty();
+}
+
+bool String::concat(const String& str) {
+	this->_buffer += str._buffer;
+	return true;
+}
+
+bool String::concat(const char* str) {
+	if (str == NULL) {
+		return false;
+	}
+
+	this->_buffer += str;
+	return true;
+}
+
+bool String::concat(const char* str, unsigned int length) {
+	if (str == NULL) {
+		return false;
+	}
+
+	this->_buffer.append(str, length);
+	return true;
+}
+
+bool String::concat(char c) {
+	this->_buffer += c;
+	return true;
+}
+
+bool String::concat(unsigned char value) { return this->concat(String(value)); }
+bool String::concat(int value) { return this->concat(String(value)); }
+bool String::concat(unsigned int value) { return this->concat(String(value)); }
+bool String::concat(long value) { return this->concat(String(value)); }
+bool String::concat(unsigned long value) { return this->concat(String(value)); }
+bool String::concat(float value) { return this->concat(String(value)); }
+bool String::concat(double value) { return this->concat(String(value)); }
+bool String::concat(const __FlashStringHelper* str) { return this->concat((const char*)str); }
+
+int String::compareTo(const String& str) const {
+	return this->_buffer.compare(str._buffer);
+}
+
+bool String::equals(const String& str) const {
+	return this->_buffer == str._buffer;
+}
+
+bool String::equals(const char* str) const {
+	return this->_buffer == (str != NULL ? str : "");
+}
+
+bool String::equalsIgnoreCase(const String& str) const {
+	return this->length() == str.length() && strcasecmp(this->c_str(), str.c_str()) == 0;
+}
+
+bool String::startsWith(const String& prefix) const {
+	return this->_buffer.compare(0, prefix.length(), prefix._buffer) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+	return this->length() >= suffix.length()
+		&& this->_buffer.compare(this->length() - suffix.length(), suffix.length(), suffix._buffer) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+	return index < this->length() ? this->_buffer[index] : 0;
+}
+
+void String::setCharAt(unsigned int index, char c) {
+	if (index < this->length()) {
+		this->_buffer[index] = c;
+	}
+}
+
+char String::operator[](unsigned int index) const {
+	return this->charAt(index);
+}
+
+char& String::operator[](unsigned int index) {
+	return this->_buffer[index];
+}
+
+void String::getBytes(unsigned char* buffer, unsigned int size, unsigned int index) const {
+	if (size == 0) {
+		return;
+	}
+
+	unsigned int count = 0;
+	if (index < this->length()) {
+		count = this->length() - index;
+		if (count > size - 1) {
+			count = size - 1;
+		}
+
+		memcpy(buffer, this->c_str() + index, count);
+	}
+
+	buffer[count] = '\0';
+}
+
+void String::toCharArray(char* buffer, unsigned int size, unsigned int index) const {
+	this->getBytes((unsigned char*)buffer, size, index);
+}
+
+int String::indexOf(char c, unsigned int from) const {
+	size_t pos = this->_buffer.find(c, from);
+	return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String& str, unsigned int from) const {
+	size_t pos = this->_buffer.find(str._buffer, from);
+	return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char c) const {
+	size_t pos = this->_buffer.rfind(c);
+	return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int from) const {
+	return this->substring(from, this->length());
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+	if (from > to) {
+		unsigned int temp = from;
+		from = to;
+		to = temp;
+	}
+
+	if (from >= this->length()) {
+		return String();
+	}
+
+	if (to > this->length()) {
+		to = this->length();
+	}
+
+	return String(this->_buffer.substr(from, to - from));
+}
+
+void String::replace(const String& find, const String& replace) {
+	if (find.length() == 0) {
+		return;
+	}
+
+	size_t pos = 0;
+	while ((pos = this->_buffer.find(find._buffer, pos)) != std::string::npos) {
+		this->_buffer.replace(pos, find.length(), replace._buffer);
+		pos += replace.length();
+	}
+}
+
+void String::remove(unsigned int index) {
+	if (index < this->length()) {
+		this->_buffer.erase(index);
+	}
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+	if (index < this->length()) {
+		this->_buffer.erase(index, count);
+	}
+}
+
+void String::toLowerCase() {
+	for (size_t i = 0; i < this->_buffer.length(); i++) {
+		this->_buffer[i] = tolower(this->_buffer[i]);
+	}
+}
+
+void String::toUpperCase() {
+	for (size_t i = 0; i < this->_buffer.length(); i++) {
+		this->_buffer[i] = toupper(this->_buffer[i]);
+	}
+}
+
+void String::trim() {
+	size_t start = this->_buffer.find_first_not_of(" \t\r\n");
+	if (start == std::string::npos) {
+		this->_buffer.clear();
+		return;
+	}
+
+	size_t end = this->_buffer.find_last_not_of(" \t\r\n");
+	this->_buffer = this->_buffer.substr(start, end - start + 1);
+}
+
+long String::toInt() const {
+	return atol(this->c_str());
+}
+
+float String::toFloat() const {
+	return (float)atof(this->c_str());
+}
+
+double String::toDouble() const {
+	return atof(this->c_str());
+}
+
+String operator+(const String& lhs, const String& rhs) {
+	String result(lhs);
+	result.concat(rhs);
+	return result;
+}
+
+String operator+(const String& lhs, const char* rhs) {
+	String result(lhs);
+	result.concat(rhs);
+	return result;
+}
+
+String operator+(const char* lhs, const String& rhs) {
+	String result(lhs);
+	result.concat(rhs);
+	return result;
+}
+
+String operator+(const String& lhs, char rhs) {
+	String result(lhs);
+	result.concat(rhs);
+	return result;
+}
\ No newline at end of file
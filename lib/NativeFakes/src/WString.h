@@ -0,0 +1,102 @@
+#ifndef _NATIVE_WSTRING_H
+#define _NATIVE_WSTRING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+class __FlashStringHelper;
+#define FPSTR(str) (reinterpret_cast<const __FlashStringHelper*>(str))
+#define F(str) FPSTR(str)
+
+// Arduino String on top of std::string. Flash strings are ordinary
+// strings on the host.
+class String {
+public:
+	String(const char* str = "");
+	String(const String& str);
+	String(const __FlashStringHelper* str);
+	String(const std::string& str);
+	explicit String(char c);
+	explicit String(unsigned char value, unsigned char base = 10);
+	explicit String(int value, unsigned char base = 10);
+	explicit String(unsigned int value, unsigned char base = 10);
+	explicit String(long value, unsigned char base = 10);
+	explicit String(unsigned long value, unsigned char base = 10);
+	explicit String(long long value, unsigned char base = 10);
+	explicit String(unsigned long long value, unsigned char base = 10);
+	explicit String(float value, unsigned char decimals = 2);
+	explicit String(double value, unsigned char decimals = 2);
+
+	String& operator=(const String& rhs);
+	String& operator=(const char* rhs);
+	String& operator=(const __FlashStringHelper* rhs);
+
+	bool reserve(unsigned int size);
+	unsigned int length() const;
+	const char* c_str() const;
+	bool isEmpty() const;
+	explicit operator bool() const { return true; }
+
+	bool concat(const String& str);
+	bool concat(const char* str);
+	bool concat(const char* str, unsigned int length);
+	bool concat(char c);
+	bool concat(unsigned char value);
+	bool concat(int value);
+	bool concat(unsigned int value);
+	bool concat(long value);
+	bool concat(unsigned long value);
+	bool concat(float value);
+	bool concat(double value);
+	bool concat(const __FlashStringHelper* str);
+
+	template<typename T> String& operator+=(const T& rhs) { this->concat(rhs); return *this; }
+	String& operator+=(const char* rhs) { this->concat(rhs); return *this; }
+
+	int compareTo(const String& str) const;
+	bool equals(const String& str) const;
+	bool equals(const char* str) const;
+	bool equalsIgnoreCase(const String& str) const;
+	bool startsWith(const String& prefix) const;
+	bool endsWith(const String& suffix) const;
+	bool operator==(const String& rhs) const { return this->equals(rhs); }
+	bool operator==(const char* rhs) const { return this->equals(rhs); }
+	bool operator!=(const String& rhs) const { return !this->equals(rhs); }
+	bool operator!=(const char* rhs) const { return !this->equals(rhs); }
+	bool operator<(const String& rhs) const { return this->compareTo(rhs) < 0; }
+
+	char charAt(unsigned int index) const;
+	void setCharAt(unsigned int index, char c);
+	char operator[](unsigned int index) const;
+	char& operator[](unsigned int index);
+	void getBytes(unsigned char* buffer, unsigned int size, unsigned int index = 0) const;
+	void toCharArray(char* buffer, unsigned int size, unsigned int index = 0) const;
+
+	int indexOf(char c, unsigned int from = 0) const;
+	int indexOf(const String& str, unsigned int from = 0) const;
+	int lastIndexOf(char c) const;
+	String substring(unsigned int from) const;
+	String substring(unsigned int from, unsigned int to) const;
+
+	void replace(const String& find, const String& replace);
+	void remove(unsigned int index);
+	void remove(unsigned int index, unsigned int count);
+	void toLowerCase();
+	void toUpperCase();
+	void trim();
+
+	long toInt() const;
+	float toFloat() const;
+	double toDouble() const;
+
+private:
+	std::string _buffer;
+};
+
+String operator+(const String& lhs, const String& rhs);
+String operator+(const String& lhs, const char* rhs);
+String operator+(const char* lhs, const String& rhs);
+String operator+(const String& lhs, char rhs);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "WiFi.h"
+
+WiFiClass::WiFiClass() {
+	this->_available = true;
+	this->_status = WL_DISCONNECTED;
+	this->_localIP = (uint32_t)0;
+	this->_gateway = (uint32_t)0;
+	this->_subnet = (uint32_t)0;
+	this->_dns = (uint32_t)0;
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+	(void)mode;
+	return true;
+}
+
+bool WiFiClass::config(IPAddress localIP, IPAddress gateway, IPAddress subnet, IPAddress dns1) {
+	// All zeros selects DHCP.
+	this->_localIP = localIP;
+	this->_gateway = gateway;
+	this->_subnet = subnet;
+	this->_dns = dns1;
+	return true;
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase) {
+	(void)passphrase;
+	this->_ssid = ssid;
+	this->_status = this->_available ? WL_CONNECTED : WL_NO_SSID_AVAIL;
+	return this->_status;
+}
+
+wl_status_t WiFiClass::status() {
+	return this->_status;
+}
+
+bool WiFiClass::disconnect(bool wifiOff) {
+	(void)wifiOff;
+	this->_status = WL_DISCONNECTED;
+	return true;
+}
+
+bool WiFiClass::setHostname(const char* hostname) {
+	this->_hostname = hostname;
+	return true;
+}
+
+String WiFiClass::SSID() {
+	return this->_status == WL_CONNECTED ? this->_ssid : String();
+}
+
+String WiFiClass::SSID(uint8_t networkItem) {
+	return networkItem == 0 ? String("native-bench") : String();
+}
+
+int32_t WiFiClass::RSSI() {
+	return this->_status == WL_CONNECTED ? -50 : 0;
+}
+
+int32_t WiFiClass::RSSI(uint8_t networkItem) {
+	return networkItem == 0 ? -50 : 0;
+}
+
+int16_t WiFiClass::scanNetworks() {
+	return this->_available ? 1 : 0;
+}
+
+void WiFiClass::printDiag(Print& dest) {
+	dest.print(F("Mode: STA\nSSID: "));
+	dest.println(this->_ssid);
+}
+
+String WiFiClass::macAddress() {
+	return String("24:0A:C4:00:00:01");
+}
+
+IPAddress WiFiClass::localIP() {
+	if (this->_status != WL_CONNECTED) {
+		return IPAddress((uint32_t)0);
+	}
+
+	return (uint32_t)this->_localIP != 0 ? this->_localIP : IPAddress((uint32_t)WIFI_NATIVE_IP);
+}
+
+IPAddress WiFiClass::subnetMask() {
+	return (uint32_t)this->_subnet != 0 ? this->_subnet : IPAddress((uint32_t)WIFI_NATIVE_SUBNET);
+}
+
+IPAddress WiFiClass::gatewayIP() {
+	return (uint32_t)this->_gateway != 0 ? this->_gateway : IPAddress((uint32_t)WIFI_NATIVE_GATEWAY);
+}
+
+IPAddress WiFiClass::dnsIP(uint8_t dnsNo) {
+	(void)dnsNo;
+	return (uint32_t)this->_dns != 0 ? this->_dns : this->gatewayIP();
+}
+
+void WiFiClass::setAccessPointAvailable(bool available) {
+	this->_available = available;
+	if (!available && this->_status == WL_CONNECTED) {
+		this->_status = WL_CONNECTION_LOST;
+	}
+}
+
+WiFiClass WiFi;
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef _NATIVE_WIFI_H
+#define _NATIVE_WIFI_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include "WiFiClient.h"
+
+typedef enum {
+	WL_NO_SHIELD = 255,
+	WL_IDLE_STATUS = 0,
+	WL_NO_SSID_AVAIL = 1,
+	WL_SCAN_COMPLETED = 2,
+	WL_CONNECTED = 3,
+	WL_CONNECT_FAILED = 4,
+	WL_CONNECTION_LOST = 5,
+	WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+	WIFI_OFF = 0,
+	WIFI_STA = 1,
+	WIFI_AP = 2,
+	WIFI_AP_STA = 3
+} wifi_mode_t;
+
+#define WIFI_NATIVE_IP 0x0201A8C0       // 192.168.1.2
+#define WIFI_NATIVE_GATEWAY 0x0101A8C0  // 192.168.1.1
+#define WIFI_NATIVE_SUBNET 0x00FFFFFF   // 255.255.255.0
+
+// Station interface. begin() associates at once unless the harness has
+// taken the access point away with setAccessPointAvailable(false), which
+// also drops an existing association.
+class WiFiClass {
+public:
+	WiFiClass();
+	bool mode(wifi_mode_t mode);
+	bool config(IPAddress localIP, IPAddress gateway, IPAddress subnet, IPAddress dns1 = (uint32_t)0);
+	wl_status_t begin(const char* ssid, const char* passphrase = NULL);
+	wl_status_t status();
+	bool disconnect(bool wifiOff = false);
+	void persistent(bool persistent) { (void)persistent; }
+	bool setHostname(const char* hostname);
+	String SSID();
+	String SSID(uint8_t networkItem);
+	int32_t RSSI();
+	int32_t RSSI(uint8_t networkItem);
+	int16_t scanNetworks();
+	void printDiag(Print& dest);
+	String macAddress();
+	IPAddress localIP();
+	IPAddress subnetMask();
+	IPAddress gatewayIP();
+	IPAddress dnsIP(uint8_t dnsNo = 0);
+
+	void setAccessPointAvailable(bool available);
+
+private:
+	volatile bool _available;
+	volatile wl_status_t _status;
+	String _ssid;
+	String _hostname;
+	IPAddress _localIP;
+	IPAddress _gateway;
+	IPAddress _subnet;
+	IPAddress _dns;
+};
+
+extern WiFiClass WiFi;
+
+#endif
\ No newline at end of file
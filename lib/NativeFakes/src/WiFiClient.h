@@ -0,0 +1,44 @@
+#ifndef _NATIVE_WIFI_CLIENT_H
+#define _NATIVE_WIFI_CLIENT_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <string>
+
+class Client : public Stream {
+public:
+	virtual int connect(IPAddress ip, uint16_t port) = 0;
+	virtual int connect(const char* host, uint16_t port) = 0;
+	virtual void stop() = 0;
+	virtual uint8_t connected() = 0;
+	virtual operator bool() = 0;
+};
+
+// No sockets on the host. The client just holds whatever the fake on top
+// of it (HTTPClient, PubSubClient) loads as the peer's response.
+class WiFiClient : public Client {
+public:
+	WiFiClient() : _connected(false), _readIndex(0) {}
+	int connect(IPAddress ip, uint16_t port) override { (void)ip; (void)port; this->_connected = true; return 1; }
+	int connect(const char* host, uint16_t port) override { (void)host; (void)port; this->_connected = true; return 1; }
+	void stop() override { this->_connected = false; this->_response.clear(); this->_readIndex = 0; }
+	uint8_t connected() override { return this->_connected ? 1 : 0; }
+	operator bool() override { return this->_connected; }
+
+	size_t write(uint8_t c) override { (void)c; return 1; }
+	size_t write(const uint8_t* buffer, size_t size) override { (void)buffer; return size; }
+	using Print::write;
+	int available() override { return this->_response.size() - this->_readIndex; }
+	int read() override { return this->available() > 0 ? (uint8_t)this->_response[this->_readIndex++] : -1; }
+	int peek() override { return this->available() > 0 ? (uint8_t)this->_response[this->_readIndex] : -1; }
+	void flush() override {}
+
+	void loadResponse(const String& body) { this->_response.assign(body.c_str(), body.length()); this->_readIndex = 0; }
+
+private:
+	bool _connected;
+	std::string _response;
+	size_t _readIndex;
+};
+
+#endif
\ No newline at end of file
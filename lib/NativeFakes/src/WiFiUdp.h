@@ -0,0 +1,14 @@
+#ifndef _NATIVE_WIFI_UDP_H
+#define _NATIVE_WIFI_UDP_H
+
+#include <Arduino.h>
+
+// Placeholder for NTPClient's transport; NTP is answered from the host
+// clock without any packets.
+class WiFiUDP {
+public:
+	uint8_t begin(uint16_t port) { (void)port; return 1; }
+	void stop() {}
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "Wire.h"
+#include <string.h>
+
+size_t NullI2CDevice::onRequest(uint8_t* buffer, size_t len) {
+	memset(buffer, 0, len);
+	return len;
+}
+
+TwoWire::TwoWire(uint8_t busNum) {
+	(void)busNum;
+	this->_txAddress = 0;
+	this->_txLength = 0;
+	this->_rxLength = 0;
+	this->_rxIndex = 0;
+	this->_timeout = 50;
+}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+	(void)sda;
+	(void)scl;
+	(void)frequency;
+	return true;
+}
+
+void TwoWire::setClock(uint32_t frequency) {
+	(void)frequency;
+}
+
+void TwoWire::setTimeOut(uint16_t timeOutMillis) {
+	this->_timeout = timeOutMillis;
+}
+
+uint16_t TwoWire::getTimeOut() {
+	return this->_timeout;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+	this->_txAddress = address;
+	this->_txLength = 0;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+	// 0: success, 2: address NACK (same codes as the Arduino core).
+	(void)sendStop;
+	std::lock_guard<std::recursive_mutex> guard(this->_lock);
+	I2CDevice* device = this->getDevice(this->_txAddress);
+	if (device == NULL) {
+		return 2;
+	}
+
+	device->onReceive(this->_txBuffer, this->_txLength);
+	this->_txLength = 0;
+	return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, bool sendStop) {
+	(void)sendStop;
+	std::lock_guard<std::recursive_mutex> guard(this->_lock);
+	this->_rxIndex = 0;
+	this->_rxLength = 0;
+	I2CDevice* device = this->getDevice(address);
+	if (device == NULL) {
+		return 0;
+	}
+
+	size_t len = quantity < I2C_BUFFER_LENGTH ? quantity : I2C_BUFFER_LENGTH;
+	this->_rxLength = device->onRequest(this->_rxBuffer, len);
+	return this->_rxLength;
+}
+
+size_t TwoWire::write(uint8_t data) {
+	if (this->_txLength >= I2C_BUFFER_LENGTH) {
+		return 0;
+	}
+
+	this->_txBuffer[this->_txLength++] = data;
+	return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t quantity) {
+	size_t written = 0;
+	while (written < quantity && this->write(data[written])) {
+		written++;
+	}
+
+	return written;
+}
+
+int TwoWire::available() {
+	return this->_rxLength - this->_rxIndex;
+}
+
+int TwoWire::read() {
+	return this->_rxIndex < this->_rxLength ? this->_rxBuffer[this->_rxIndex++] : -1;
+}
+
+int TwoWire::peek() {
+	return this->_rxIndex < this->_rxLength ? this->_rxBuffer[this->_rxIndex] : -1;
+}
+
+void TwoWire::flush() {
+	this->_rxIndex = 0;
+	this->_rxLength = 0;
+	this->_txLength = 0;
+}
+
+void TwoWire::attach(uint8_t address, I2CDevice* device) {
+	std::lock_guard<std::recursive_mutex> guard(this->_lock);
+	this->_devices[address] = device;
+}
+
+void TwoWire::detach(uint8_t address) {
+	std::lock_guard<std::recursive_mutex> guard(this->_lock);
+	this->_devices.erase(address);
+}
+
+I2CDevice* TwoWire::getDevice(uint8_t address) {
+	std::lock_guard<std::recursive_mutex> guard(this->_lock);
+	std::map<uint8_t, I2CDevice*>::iterator it = this->_devices.find(address);
+	return it != this->_devices.end() ? it->second : NULL;
+}
+
+TwoWire Wire(0);
\ No newline at end of file
@@ -0,0 +1,71 @@
+#ifndef _NATIVE_WIRE_H
+#define _NATIVE_WIRE_H
+
+#include <stdint.h>
+#include <map>
+#include <mutex>
+#include "Stream.h"
+
+#define I2C_BUFFER_LENGTH 128
+
+// A simulated device on the bus. Each transmission from the master is
+// delivered whole to onReceive(); each read asks onRequest() for up to
+// len bytes.
+class I2CDevice {
+public:
+	virtual ~I2CDevice() {}
+	virtual void onReceive(const uint8_t* data, size_t len) = 0;
+	virtual size_t onRequest(uint8_t* buffer, size_t len) = 0;
+};
+
+// Acknowledges its address and nothing else. Reads return zeros.
+class NullI2CDevice : public I2CDevice {
+public:
+	void onReceive(const uint8_t* data, size_t len) override { (void)data; (void)len; }
+	size_t onRequest(uint8_t* buffer, size_t len) override;
+};
+
+// Bus master. Addresses with no attached device NACK, as on real hardware.
+// Bus timing isn't modelled; transfers take no virtual time.
+class TwoWire : public Stream {
+public:
+	TwoWire(uint8_t busNum);
+	bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+	void setClock(uint32_t frequency);
+	void setTimeOut(uint16_t timeOutMillis);
+	uint16_t getTimeOut();
+
+	void beginTransmission(uint8_t address);
+	void beginTransmission(int address) { this->beginTransmission((uint8_t)address); }
+	uint8_t endTransmission(bool sendStop = true);
+	uint8_t requestFrom(uint8_t address, uint8_t quantity, bool sendStop = true);
+	uint8_t requestFrom(int address, int quantity) { return this->requestFrom((uint8_t)address, (uint8_t)quantity); }
+	uint8_t requestFrom(int address, int quantity, int sendStop) { return this->requestFrom((uint8_t)address, (uint8_t)quantity, sendStop != 0); }
+
+	size_t write(uint8_t data) override;
+	size_t write(const uint8_t* data, size_t quantity) override;
+	using Print::write;
+	int available() override;
+	int read() override;
+	int peek() override;
+	void flush() override;
+
+	void attach(uint8_t address, I2CDevice* device);
+	void detach(uint8_t address);
+	I2CDevice* getDevice(uint8_t address);
+
+private:
+	std::recursive_mutex _lock;
+	std::map<uint8_t, I2CDevice*> _devices;
+	uint8_t _txAddress;
+	uint8_t _txBuffer[I2C_BUFFER_LENGTH];
+	size_t _txLength;
+	uint8_t _rxBuffer[I2C_BUFFER_LENGTH];
+	size_t _rxLength;
+	size_t _rxIndex;
+	uint16_t _timeout;
+};
+
+extern TwoWire Wire;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,25 @@
+#include "rom/crc.h"
+
+uint32_t crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len) {
+	crc = ~crc;
+	for (uint32_t i = 0; i < len; i++) {
+		crc ^= buf[i];
+		for (int bit = 0; bit < 8; bit++) {
+			crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+		}
+	}
+
+	return ~crc;
+}
+
+uint8_t crc8_le(uint8_t crc, const uint8_t* buf, uint32_t len) {
+	crc = ~crc;
+	for (uint32_t i = 0; i < len; i++) {
+		crc ^= buf[i];
+		for (int bit = 0; bit < 8; bit++) {
+			crc = (crc >> 1) ^ (0xE0 & (0 - (crc & 1)));
+		}
+	}
+
+	return ~crc;
+}
\ No newline at end of file
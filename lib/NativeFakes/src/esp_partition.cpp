@@ -0,0 +1,133 @@
+#include "esp_partition.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct NativePartition {
+	esp_partition_t info;
+	std::vector<uint8_t> image;
+};
+
+// Keep in step with partitions.csv.
+static NativePartition partitions[] = {
+	{ { ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_NVS, 0x9000, 0x5000, "nvs", false }, {} },
+	{ { ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_OTA, 0xE000, 0x2000, "otadata", false }, {} },
+	{ { ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, 0x290000, 0x100000, "spiffs", false }, {} },
+	{ { ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)0x40, 0x390000, 0x40000, "creddb", false }, {} },
+	{ { ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)0x41, 0x3D0000, 0x10000, "spool", false }, {} },
+	{ { ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)0x42, 0x3E0000, 0x20000, "journal", false }, {} }
+};
+
+static std::mutex flashLock;
+
+static NativePartition* lookup(const esp_partition_t* partition) {
+	for (size_t i = 0; i < sizeof(partitions) / sizeof(partitions[0]); i++) {
+		if (&partitions[i].info == partition) {
+			return &partitions[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void load(NativePartition* partition) {
+	// Lock held.
+	if (!partition->image.empty()) {
+		return;
+	}
+
+	partition->image.assign(partition->info.size, 0xFF);
+	const char* dir = getenv("CYGATE_FLASH_DIR");
+	if (dir == NULL) {
+		return;
+	}
+
+	std::string path = std::string(dir) + "/" + partition->info.label + ".bin";
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file != NULL) {
+		size_t count = fread(partition->image.data(), 1, partition->image.size(), file);
+		fclose(file);
+		printf("NATIVE: Loaded %u bytes into partition '%s' from %s\n", (unsigned)count, partition->info.label, path.c_str());
+	}
+}
+
+static NativePartition* checkRange(const esp_partition_t* partition, size_t offset, size_t size) {
+	NativePartition* native = lookup(partition);
+	if (native == NULL || offset > native->info.size || size > native->info.size - offset) {
+		return NULL;
+	}
+
+	load(native);
+	return native;
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char* label) {
+	for (size_t i = 0; i < sizeof(partitions) / sizeof(partitions[0]); i++) {
+		const esp_partition_t* info = &partitions[i].info;
+		if (info->type == type && (subtype == ESP_PARTITION_SUBTYPE_ANY || info->subtype == subtype)
+			&& (label == NULL || strcmp(info->label, label) == 0)) {
+			return info;
+		}
+	}
+
+	return NULL;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t offset, void* dst, size_t size) {
+	std::lock_guard<std::mutex> guard(flashLock);
+	NativePartition* native = checkRange(partition, offset, size);
+	if (native == NULL) {
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+	memcpy(dst, &native->image[offset], size);
+	return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t offset, const void* src, size_t size) {
+	// NOR flash: programming can only clear bits.
+	std::lock_guard<std::mutex> guard(flashLock);
+	NativePartition* native = checkRange(partition, offset, size);
+	if (native == NULL) {
+		return ESP_ERR_INVALID_SIZE;
+	}
+
+	const uint8_t* bytes = (const uint8_t*)src;
+	for (size_t i = 0; i < size; i++) {
+		native->image[offset + i] &= bytes[i];
+	}
+
+	return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size) {
+	std::lock_guard<std::mutex> guard(flashLock);
+	NativePartition* native = checkRange(partition, offset, size);
+	if (native == NULL || offset % SPI_FLASH_SEC_SIZE != 0 || size % SPI_FLASH_SEC_SIZE != 0) {
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	memset(&native->image[offset], 0xFF, size);
+	return ESP_OK;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t* partition, size_t offset, size_t size, spi_flash_mmap_memory_t memory, const void** outPtr, spi_flash_mmap_handle_t* outHandle) {
+	// The "mapping" is the image itself, so it always sees later writes.
+	(void)memory;
+	std::lock_guard<std::mutex> guard(flashLock);
+	NativePartition* native = checkRange(partition, offset, size);
+	if (native == NULL) {
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	*outPtr = &native->image[offset];
+	*outHandle = 0;
+	return ESP_OK;
+}
+
+void spi_flash_munmap(spi_flash_mmap_handle_t handle) {
+	(void)handle;
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#ifndef _NATIVE_ESP_PARTITION_H
+#define _NATIVE_ESP_PARTITION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_system.h"
+
+// Data partitions from partitions.csv, held in memory. A partition starts
+// out erased unless $CYGATE_FLASH_DIR/<label>.bin exists (ie. a creddb
+// image from tools/build_credential_db.py). Nothing is written back.
+
+#define SPI_FLASH_SEC_SIZE 4096
+
+typedef enum {
+	ESP_PARTITION_TYPE_APP = 0x00,
+	ESP_PARTITION_TYPE_DATA = 0x01
+} esp_partition_type_t;
+
+typedef enum {
+	ESP_PARTITION_SUBTYPE_DATA_OTA = 0x00,
+	ESP_PARTITION_SUBTYPE_DATA_NVS = 0x02,
+	ESP_PARTITION_SUBTYPE_DATA_SPIFFS = 0x82,
+	ESP_PARTITION_SUBTYPE_ANY = 0xff
+} esp_partition_subtype_t;
+
+typedef enum {
+	SPI_FLASH_MMAP_DATA,
+	SPI_FLASH_MMAP_INST
+} spi_flash_mmap_memory_t;
+
+typedef uint32_t spi_flash_mmap_handle_t;
+
+typedef struct {
+	esp_partition_type_t type;
+	esp_partition_subtype_t subtype;
+	uint32_t address;
+	uint32_t size;
+	char label[17];
+	bool encrypted;
+} esp_partition_t;
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char* label);
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t offset, void* dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t offset, const void* src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size);
+esp_err_t esp_partition_mmap(const esp_partition_t* partition, size_t offset, size_t size, spi_flash_mmap_memory_t memory, const void** outPtr, spi_flash_mmap_handle_t* outHandle);
+void spi_flash_munmap(spi_flash_mmap_handle_t handle);
+
+#endif
\ No newline at end of file
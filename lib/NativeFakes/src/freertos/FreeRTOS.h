@@ -0,0 +1,51 @@
+#ifndef _NATIVE_FREERTOS_H
+#define _NATIVE_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Just enough of the FreeRTOS API for the firmware, on top of pthreads and
+// the virtual clock (see VirtualClock.h). Priorities are recorded but not
+// enforced; the host schedules the threads.
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+
+struct NativeTask;
+struct NativeQueue;
+typedef NativeTask* TaskHandle_t;
+typedef NativeQueue* QueueHandle_t;
+typedef NativeQueue* SemaphoreHandle_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define errQUEUE_FULL 0
+
+#define configTICK_RATE_HZ 1000
+#define configMAX_PRIORITIES 25
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY (TickType_t)0xFFFFFFFF
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms) / portTICK_PERIOD_MS)
+
+// Critical sections are a recursive spinlock, as on the ESP32.
+typedef struct {
+	uint32_t owner;
+	uint32_t count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED { 0, 0 }
+
+void vPortEnterCritical(portMUX_TYPE* mux);
+void vPortExitCritical(portMUX_TYPE* mux);
+
+#define portENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux) vPortExitCritical(mux)
+#define portYIELD_FROM_ISR() do {} while (0)
+
+#endif
\ No newline at end of file
@@ -0,0 +1,11 @@
+#ifndef _NATIVE_ROM_CRC_H
+#define _NATIVE_ROM_CRC_H
+
+#include <stdint.h>
+
+// Same conventions as the ESP32 ROM (reflected polynomials 0x04C11DB7 and
+// 0x07): the running value is passed in and returned uninverted.
+uint32_t crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len);
+uint8_t crc8_le(uint8_t crc, const uint8_t* buf, uint32_t len);
+
+#endif
\ No newline at end of file
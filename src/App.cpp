@@ -1,17 +1,20 @@
 #include "App.h"
 
-#include <FS.H>
+#include <FS.h>
 #include <SPIFFS.h>
-#include <Wire.h>
 
 #include "ArduinoJson.h"
 #include "services/AuthService.h"
+#include "services/CredentialStore.h"
 #include "Console.h"
+#include "InputFilter.h"
 #include "ESPCrashMonitor-master/ESPCrashMonitor.h"
 #include "ResetManager.h"
 
 #define PIN_BUS_RESET 16
 
+static_assert(STATUS_CONTEXT_DOOR_SHIFT(DOOR_MAX_DOORS) <= 31, "Door dirty masks must fit below STATUS_CONTEXT_FULL");
+
 IPAddress defaultIp(192, 168, 0, 235);
 IPAddress defaultGw(192, 168, 0, 1);
 IPAddress defaultSm(255, 255, 255, 0);
@@ -38,6 +41,14 @@ void appOnMqttMessage(char* topic, byte* payload, unsigned int length) {
     Application::singleton->onMqttMessage(topic, payload, length);
 }
 
+bool appPublishMqttMessage(MqttTopic topic, const uint8_t* payload, size_t length) {
+    return Application::singleton->publishMqttMessage(topic, payload, length);
+}
+
+void appOnMqttPublishFailed(MqttTopic topic, uint32_t context) {
+    Application::singleton->onMqttPublishFailed(topic, context);
+}
+
 void appHandleSwitchToDhcp() {
     Application::singleton->handleSwitchToDhcp();
 }
@@ -66,6 +77,32 @@ void appHandleBusResetCommand() {
     Application::singleton->handleBusResetCommand();
 }
 
+void appHandleLatencyStatsCommand() {
+    LatencyStats.print();
+}
+
+void appHandleTaskStatsCommand() {
+    TaskStats.collect(millis());
+    TaskStats.print();
+}
+
+void appHandleHeapStatsCommand() {
+    HeapStats.sample();
+    HeapStats.print();
+}
+
+void appOnFobAuthComplete(const AuthResult* result) {
+    Application::singleton->onFobAuthComplete(result);
+}
+
+void appOnKeypadAuthComplete(const AuthResult* result) {
+    Application::singleton->onKeypadAuthComplete(result);
+}
+
+void appOnDoorStateChange(uint8_t doorId, DoorField field) {
+    Application::singleton->onDoorStateChange(doorId, field);
+}
+
 Application* Application::singleton = nullptr;
 
 Application::Application() {
@@ -73,6 +110,7 @@ Application::Application() {
 	    Application::singleton = this;
     }
     this->mqttClient.setClient(this->wifiClient);
+    this->statusRetry.store(0);
 }
 
 void Application::printNetworkInfo() {
@@ -113,86 +151,197 @@ void Application::reboot() {
     ResetManager.softReset();
 }
 
+void Application::buildStatusTopology() {
+    // Door topology only changes when doors.json is loaded, so it is
+    // serialized once here and spliced into each full snapshot as-is.
+    TrackedJsonDocument<HeapSubsystem::STATUS> doc(STATUS_TOPOLOGY_SIZE * 2);
+    JsonArray theDoors = doc.to<JsonArray>();
+    for (uint8_t id = 0; id < DoorManager.getDoorCount(); id++) {
+        const Door* d = DoorManager.getDoor(id);
+        JsonObject obj = theDoors.createNestedObject();
+        obj["id"] = id;
+        obj["name"] = (const char*)d->name;
+
+        JsonObject rel = obj.createNestedObject("lockRelay");
+        rel["moduleId"] = d->lockRelay.moduleId;
+        rel["relayId"] = d->lockRelay.relayId;
+
+        JsonArray readers = obj.createNestedArray("readers");
+        for (uint8_t r = 0; r < d->readerCount; r++) {
+            JsonObject rdr = readers.createNestedObject();
+            rdr["id"] = d->readers[r].id;
+            // TODO add result of self-test?
+            // TODO add firmware version?
+            // TODO add MiFare version?
+            // TODO The above things probably need to be retrieved during device enumeration?
+        }
+
+        JsonArray keypads = obj.createNestedArray("keypads");
+        for (uint8_t k = 0; k < d->keypadCount; k++) {
+            JsonObject kpd = keypads.createNestedObject();
+            kpd["id"] = d->keypads[k].id;
+            // TODO add keypad firmware version?
+        }
+
+        JsonArray inputs = obj.createNestedArray("inputs");
+        for (uint8_t i = 0; i < d->inputCount; i++) {
+            JsonObject inp = inputs.createNestedObject();
+            inp["type"] = (uint8_t)d->inputs[i].type;
+            inp["moduleId"] = d->inputs[i].moduleId;
+            inp["inputId"] = d->inputs[i].inputId;
+        }
+    }
+
+    // Stored pre-encoded in the wire format, since it is copied into the
+    // status message verbatim.
+    size_t len = TelemetryHelper::serializePayload(doc, statusTopology, sizeof(statusTopology), config.mqttPayloadFormat);
+    if (doc.overflowed() || len == 0 || len >= sizeof(statusTopology) - 1) {
+        Serial.println(F("ERROR: Door topology too large for status messages."));
+        doc.clear();
+        doc.to<JsonArray>();
+        len = TelemetryHelper::serializePayload(doc, statusTopology, sizeof(statusTopology), config.mqttPayloadFormat);
+    }
+
+    statusTopologyLength = len;
+
+    requestFullStatus();
+}
+
+void Application::requestFullStatus() {
+    fullStatusRequested = true;
+}
+
+void Application::setSystemState(SystemState state) {
+    if (sysState != state) {
+        sysState = state;
+        statusDirty |= STATUS_DIRTY_SYSTEM_STATE;
+    }
+}
+
+void Application::setStatusMessage(const char* message) {
+    statusMsg = message;
+    statusDirty |= STATUS_DIRTY_STATUS_MSG;
+}
+
 void Application::publishSystemState() {
-    if (mqttClient.connected()) {
-        CoreIO.heartbeatLedOn();
-        uint16_t freeMem = ESP.getFreeHeap() - 512;
+    // Sends only the fields that changed since the last successful publish,
+    // or a full snapshot (including topology) when one was requested.
+    // Changes carried by a publish that failed are marked dirty again.
+    uint32_t retry = statusRetry.exchange(0);
+    if (retry != 0) {
+        if (retry & STATUS_CONTEXT_FULL) {
+            fullStatusRequested = true;
+        }
 
-        DynamicJsonDocument doc(freeMem);
-        doc["clientId"] = config.hostname;
-        doc["systemState"] = (uint8_t)sysState;
+        if ((retry & STATUS_DIRTY_STATUS_MSG) && statusMsg.length() == 0) {
+            statusMsg = sentStatusMsg;
+        }
+
+        statusDirty |= (uint8_t)(retry & 0xFF);
+        for (uint8_t id = 0; id < DOOR_MAX_DOORS; id++) {
+            doorDirty[id] |= (uint8_t)((retry >> STATUS_CONTEXT_DOOR_SHIFT(id)) & ((1 << STATUS_DOOR_FIELD_BITS) - 1));
+        }
+    }
+
+    bool full = fullStatusRequested;
+    uint8_t doorMask = 0;
+    for (uint8_t id = 0; id < DoorManager.getDoorCount(); id++) {
+        if (doorDirty[id] != 0) {
+            doorMask |= (1 << id);
+        }
+    }
+
+    if (!full && statusDirty == 0 && doorMask == 0) {
+        return;
+    }
+
+    if (!mqttConnected) {
+        return;
+    }
+
+    CoreIO.heartbeatLedOn();
+    StaticJsonDocument<STATUS_DOC_SIZE> doc;
+    doc["clientId"] = config.hostname.c_str();
+    doc["full"] = full;
+    if (full) {
         doc["firmwareVersion"] = FIRMWARE_VERSION;
+        if (statusTopologyLength > 0) {
+            doc["topology"] = serialized((const char*)statusTopology, statusTopologyLength);
+        }
+    }
+
+    if (full || (statusDirty & STATUS_DIRTY_SYSTEM_STATE)) {
+        doc["systemState"] = (uint8_t)sysState;
+    }
+
+    if (full || (statusDirty & STATUS_DIRTY_ARM_STATE)) {
         doc["armState"] = (uint8_t)armState;
-        doc["statusMsg"] = statusMsg;
+    }
 
+    if (full || (statusDirty & STATUS_DIRTY_STATUS_MSG)) {
+        doc["statusMsg"] = statusMsg.c_str();
+    }
+
+    if (full || doorMask != 0) {
         JsonArray theDoors = doc.createNestedArray("doors");
-        auto doors = DoorManager.getDoors();
-        for (auto d = doors.begin(); d != doors.end(); d++) {
-            // TODO We are going to need logic for updating state data based on the states of the
-            // devices associated with the door.
-            JsonObject obj;
-            obj["name"] = d->name;
-            obj["state"] = (uint8_t)d->state;
-            obj["enabled"] = d->enabled ? 1 : 0;
-            obj["lockState"] = (uint8_t)d->lockState;
-
-            if (&d->lockRelay != nullptr) {
-                JsonObject rel = obj.createNestedObject("lockRelay");
-                rel["moduleId"] = d->lockRelay.moduleId;
-                rel["relayId"] = d->lockRelay.relayId;
+        for (uint8_t id = 0; id < DoorManager.getDoorCount(); id++) {
+            uint8_t dirty = full ? 0xFF : doorDirty[id];
+            if (dirty == 0) {
+                continue;
             }
 
-            JsonArray readers = obj.createNestedArray("readers");
-            if (d->readers.size() > 0) {
-                for (auto r = d->readers.begin(); r != d->readers.end(); r++) {
-                    JsonObject rdr;
-                    rdr["id"] = r->id;
-                    // TODO add result of self-test?
-                    // TODO add firmware version?
-                    // TODO add MiFare version?
-                    // TODO The above things probably need to be retrieved during device enumeration?
-                    readers.add(rdr);
-                }
+            JsonObject obj = theDoors.createNestedObject();
+            obj["id"] = id;
+            if (dirty & STATUS_DIRTY_DOOR(DoorField::STATE)) {
+                obj["state"] = (uint8_t)DoorManager.getDoorState(id);
             }
 
-            JsonArray keypads = obj.createNestedArray("keypads");
-            if (d->keypads.size() > 0) {
-                for (auto k = d->keypads.begin(); k != d->keypads.end(); k++) {
-                    JsonObject kpd;
-                    kpd["id"] = k->id;
-                    // TODO add keypad firmware version?
-                    keypads.add(kpd);
-                }
+            if (dirty & STATUS_DIRTY_DOOR(DoorField::ENABLED)) {
+                obj["enabled"] = DoorManager.isEnabled(id) ? 1 : 0;
             }
 
-            JsonArray inputs = obj.createNestedArray("inputs");
-            if (d->inputs.size() > 0) {
-                for (auto i = d->inputs.begin(); i != d->inputs.end(); i++) {
-                    JsonObject inp;
-                    inp["type"] = (uint8_t)i->type;
-                    inp["moduleId"] = i->moduleId;
-                    inp["inputId"] = i->inputId;
-                    inputs.add(inp);
-                }
+            if (dirty & STATUS_DIRTY_DOOR(DoorField::LOCK_STATE)) {
+                obj["lockState"] = (uint8_t)DoorManager.getLockState(id);
             }
-
-            theDoors.add(obj);
-        }
-        
-        doc.shrinkToFit();
-
-        String jsonStr;
-        size_t len = serializeJson(doc, jsonStr);
-        Serial.print(F("INFO: Publishing system state: "));
-        Serial.println(jsonStr);
-        if (!mqttClient.publish(config.mqttTopicStatus.c_str(), jsonStr.c_str(), len)) {
-            Serial.println(F("ERROR: Failed to publish message."));
         }
+    }
 
-        statusMsg = "";
-        doc.clear();
+    size_t len = TelemetryHelper::serializePayload(doc, statusPayload, sizeof(statusPayload), config.mqttPayloadFormat);
+    if (doc.overflowed() || len == 0 || len >= sizeof(statusPayload) - 1) {
+        Serial.println(F("ERROR: Status message too large. Dropped."));
         CoreIO.heartbeatLedOff();
+        return;
+    }
+
+    // A full snapshot supersedes any older one still waiting in the outbox.
+    lastStatusPublish = millis();
+    uint8_t coalesceKey = full ? MQTT_COALESCE_FULL_STATUS : MQTT_COALESCE_NONE;
+    uint32_t context = full ? STATUS_CONTEXT_FULL : statusDirty;
+    for (uint8_t id = 0; !full && id < DoorManager.getDoorCount(); id++) {
+        context |= (uint32_t)doorDirty[id] << STATUS_CONTEXT_DOOR_SHIFT(id);
     }
+
+    if (!MqttOutbox.push(MqttTopic::STATUS, (const uint8_t*)statusPayload, len, coalesceKey, context)) {
+        // Dirty bits are kept, so the same changes go out on the next attempt.
+        Serial.println(F("WARN: MQTT outbox full. Status publish deferred."));
+        CoreIO.heartbeatLedOff();
+        return;
+    }
+
+    if (full) {
+        fullStatusRequested = false;
+    }
+
+    statusDirty = 0;
+    memset(doorDirty, 0, sizeof(doorDirty));
+    if (statusMsg.length() > 0) {
+        // The status message is a one-shot notice. Kept aside until the
+        // publish is through, in case it has to be sent again.
+        sentStatusMsg = statusMsg;
+        statusMsg = "";
+    }
+
+    CoreIO.heartbeatLedOff();
 }
 
 void Application::saveConfiguration() {
@@ -205,21 +354,25 @@ void Application::saveConfiguration() {
         return;
     }
 
-	StaticJsonDocument<750> doc;
+	StaticJsonDocument<1024> doc;
     doc["hostname"] = config.hostname;
-    doc["useDhcp"] = config.useDhcp;
+    doc["isDhcp"] = config.useDhcp;
     doc["ip"] = config.ip.toString();
     doc["gateway"] = config.gw.toString();
     doc["subnetmask"] = config.sm.toString();
-    doc["dnsServer"] = config.dns.toString();
+    doc["dns"] = config.dns.toString();
     doc["wifiSSID"] = config.ssid;
     doc["wifiPassword"] = config.password;
     doc["mqttBroker"] = config.mqttBroker;
     doc["mqttPort"] = config.mqttPort;
     doc["mqttControlChannel"] = config.mqttTopicControl;
     doc["mqttStatusChannel"] = config.mqttTopicStatus;
+    doc["mqttEventChannel"] = config.mqttTopicEvents;
+    doc["mqttJournalChannel"] = config.mqttTopicJournal;
+    doc["mqttDiagChannel"] = config.mqttTopicDiag;
     doc["mqttUsername"] = config.mqttUsername;
     doc["mqttPassword"] = config.mqttPassword;
+    doc["mqttPayloadFormat"] = (uint8_t)config.mqttPayloadFormat;
 	doc["clockTimezone"] = config.clockTimezone;
     doc["loginEndpoint"] = config.loginEndpoint;
     doc["cardValidateEndpoint"] = config.cardValidateEndpoint;
@@ -248,6 +401,13 @@ void Application::saveConfiguration() {
     configFile.flush();
     configFile.close();
     Serial.println(F("DONE"));
+
+    // Snapshot what was just written so the next boot doesn't parse it.
+    uint32_t sourceCrc = 0;
+    uint32_t sourceSize = 0;
+    if (ConfigCache.hashFile(CONFIG_FILE_PATH, &sourceCrc, &sourceSize)) {
+        ConfigCache.save(&config, sourceCrc, sourceSize);
+    }
 }
 
 void Application::printWarningAndContinue(const __FlashStringHelper *message) {
@@ -267,7 +427,11 @@ void Application::setConfigurationDefaults() {
     config.mqttPort = MQTT_PORT;
     config.mqttTopicControl = MQTT_TOPIC_CONTROL;
     config.mqttTopicStatus = MQTT_TOPIC_STATUS;
+    config.mqttTopicEvents = MQTT_TOPIC_EVENTS;
+    config.mqttTopicJournal = MQTT_TOPIC_JOURNAL;
+    config.mqttTopicDiag = MQTT_TOPIC_DIAG;
     config.mqttUsername = "";
+    config.mqttPayloadFormat = MQTT_PAYLOAD_FORMAT;
     config.password = DEFAULT_PASSWORD;
     config.sm = defaultSm;
     config.ssid = DEFAULT_SSID;
@@ -288,7 +452,7 @@ void Application::setConfigurationDefaults() {
 }
 
 void Application::loadConfiguration() {
-	memset(&config, 0, sizeof(config));
+	config = config_t();
 
     Serial.print(F("INFO: Loading config file "));
     Serial.print(CONFIG_FILE_PATH);
@@ -306,6 +470,18 @@ void Application::loadConfiguration() {
         return;
     }
 
+    uint32_t sourceCrc = 0;
+    uint32_t sourceSize = 0;
+    ConfigCacheStatus cached = ConfigCacheStatus::MISSING;
+    bool hashed = ConfigCache.hashFile(CONFIG_FILE_PATH, &sourceCrc, &sourceSize);
+    if (hashed) {
+        cached = ConfigCache.load(&config, sourceCrc, sourceSize);
+        if (cached == ConfigCacheStatus::LOADED) {
+            Serial.println(F("DONE (snapshot)"));
+            return;
+        }
+    }
+
     File configFile = SPIFFS.open(CONFIG_FILE_PATH, "r");
     if (!configFile) {
         Serial.println(F("FAIL"));
@@ -314,7 +490,7 @@ void Application::loadConfiguration() {
     }
 
     size_t size = configFile.size();
-    uint16_t freeMem = ESP.getMaxAllocHeap() - 512;
+    size_t freeMem = ESP.getMaxAllocHeap() - 512;
     if (size > freeMem) {
         Serial.println(F("FAIL"));
         Serial.print(F("ERROR: Not enough free memory to load document. Size = "));
@@ -325,7 +501,7 @@ void Application::loadConfiguration() {
         return;
     }
 
-    DynamicJsonDocument doc(freeMem);
+    TrackedJsonDocument<HeapSubsystem::CONFIG> doc(freeMem);
     DeserializationError error = deserializeJson(doc, configFile);
     if (error) {
         Serial.println(F("FAIL"));
@@ -385,8 +561,16 @@ void Application::loadConfiguration() {
     config.mqttPort = doc.containsKey("mqttPort") ? doc["mqttPort"].as<int>() : MQTT_PORT;
     config.mqttTopicControl = doc.containsKey("mqttControlChannel") ? doc["mqttControlChannel"].as<String>() : MQTT_TOPIC_CONTROL;
     config.mqttTopicStatus = doc.containsKey("mqttStatusChannel") ? doc["mqttStatusChannel"].as<String>() : MQTT_TOPIC_STATUS;
+    config.mqttTopicEvents = doc.containsKey("mqttEventChannel") ? doc["mqttEventChannel"].as<String>() : MQTT_TOPIC_EVENTS;
+    config.mqttTopicJournal = doc.containsKey("mqttJournalChannel") ? doc["mqttJournalChannel"].as<String>() : MQTT_TOPIC_JOURNAL;
+    config.mqttTopicDiag = doc.containsKey("mqttDiagChannel") ? doc["mqttDiagChannel"].as<String>() : MQTT_TOPIC_DIAG;
     config.mqttUsername = doc.containsKey("mqttUsername") ? doc["mqttUsername"].as<String>() : "";
     config.mqttPassword = doc.containsKey("mqttPassword") ? doc["mqttPassword"].as<String>() : "";
+    config.mqttPayloadFormat = doc.containsKey("mqttPayloadFormat") ? (PayloadFormat)doc["mqttPayloadFormat"].as<uint8_t>() : MQTT_PAYLOAD_FORMAT;
+    if (config.mqttPayloadFormat > PayloadFormat::MSGPACK) {
+        printWarningAndContinue(F("WARN: Invalid MQTT payload format in configuration. Falling back to factory default."));
+        config.mqttPayloadFormat = MQTT_PAYLOAD_FORMAT;
+    }
 	config.clockTimezone = doc.containsKey("clockTimezone") ? doc["clockTimezone"].as<int>() : DEFAULT_TIMEZONE;
     config.loginEndpoint = doc.containsKey("loginEndpoint") ? doc["loginEndpoint"].as<String>() : "";
     config.cardValidateEndpoint = doc.containsKey("cardValidateEndpoint") ? doc["cardValidateEndpoint"].as<String>() : "";
@@ -406,6 +590,17 @@ void Application::loadConfiguration() {
 
     doc.clear();
     Serial.println(F("DONE"));
+
+    if (hashed) {
+        if (cached == ConfigCacheStatus::INVALID) {
+            Serial.println(F("WARN: Config snapshot is damaged. Rebuilding ..."));
+        }
+        else if (cached == ConfigCacheStatus::STALE) {
+            Serial.println(F("INFO: Config file changed. Rebuilding snapshot ..."));
+        }
+
+        ConfigCache.save(&config, sourceCrc, sourceSize);
+    }
 }
 
 void Application::loadDoors() {
@@ -432,7 +627,7 @@ void Application::loadDoors() {
     }
 
     size_t size = doorFile.size();
-    uint16_t freeMem = ESP.getMaxAllocHeap() - 512;
+    size_t freeMem = ESP.getMaxAllocHeap() - 512;
     if (size > freeMem) {
         Serial.println(F("FAIL"));
         Serial.print(F("ERROR: Not enough free memory to load door file. Size = "));
@@ -443,7 +638,7 @@ void Application::loadDoors() {
         return;
     }
 
-    DynamicJsonDocument doc(freeMem);
+    TrackedJsonDocument<HeapSubsystem::DOORS> doc(freeMem);
     DeserializationError error = deserializeJson(doc, doorFile);
     if (error) {
         Serial.println(F("FAIL"));
@@ -457,48 +652,159 @@ void Application::loadDoors() {
 
     if (doc.containsKey("doors")) {
         DoorManager.clearDoors();
+        DoorManager.onStateChange(appOnDoorStateChange);
         JsonArray doors = doc["doors"];
         for (auto d : doors) {
+            if (DoorManager.getDoorCount() >= DOOR_MAX_DOORS) {
+                Serial.println(F("WARN: Door limit reached. Ignoring remaining doors."));
+                break;
+            }
+
             Door theDoor;
-            theDoor.name = d["name"].as<const char*>();
+            memset(&theDoor, 0, sizeof(Door));
+            strlcpy(theDoor.name, d["name"] | "", sizeof(theDoor.name));
 
             JsonArray rdrs = d["readers"];
             for (auto r : rdrs) {
-                Reader reader;
-                reader.id = r["id"].as<uint8_t>(); 
-                theDoor.readers.push_back(reader);
+                if (theDoor.readerCount >= DOOR_MAX_READERS) {
+                    break;
+                }
+
+                theDoor.readers[theDoor.readerCount++].id = r["id"].as<uint8_t>();
             }
 
             JsonArray keypds = d["keypads"];
             for (auto k : keypds) {
-                DoorKeypad kpd;
-                kpd.id = k["id"].as<uint8_t>();
-                theDoor.keypads.push_back(kpd);
+                if (theDoor.keypadCount >= DOOR_MAX_KEYPADS) {
+                    break;
+                }
+
+                theDoor.keypads[theDoor.keypadCount++].id = k["id"].as<uint8_t>();
             }
 
             JsonArray inps = d["inputs"];
             for (auto in : inps) {
-                DoorInput di;
-                di.inputId = in["inputId"].as<uint8_t>();
-                di.moduleId = in["moduleId"].as<uint8_t>();
-                di.type = (InputType)in["type"].as<uint8_t>();
-                theDoor.inputs.push_back(di);
+                if (theDoor.inputCount >= DOOR_MAX_INPUTS) {
+                    break;
+                }
+
+                DoorInput* di = &theDoor.inputs[theDoor.inputCount++];
+                di->inputId = in["inputId"].as<uint8_t>();
+                di->moduleId = in["moduleId"].as<uint8_t>();
+                di->type = (InputType)in["type"].as<uint8_t>();
+                di->debounceMs = in["debounceMs"] | INPUT_FILTER_DEFAULT_DEBOUNCE;
+                di->invert = in["invert"] | false;
+
+                // Module 0 is the onboard I/O. Its input IDs are zone
+                // snapshot bit positions.
+                if (di->moduleId == 0 && di->inputId < ZONE_COUNT) {
+                    InputFilter.setDebounceTime(di->inputId, di->debounceMs);
+                }
             }
 
+            theDoor.heldOpenMs = d["heldOpenMs"] | (uint32_t)DOOR_DEFAULT_HELD_OPEN;
+            theDoor.unlockMs = d["unlockMs"] | DOOR_DEFAULT_UNLOCK_TIME;
+            theDoor.rexUnlock = d["rexUnlock"] | false;
+
             JsonObject rel = d["lockRelay"];
+            theDoor.lockRelay.moduleId = rel["moduleId"].as<uint8_t>();
+            theDoor.lockRelay.relayId = rel["relayId"].as<uint8_t>();
 
-            LockRelay lockRelay;
-            lockRelay.moduleId = rel["moduleId"].as<uint8_t>();
-            lockRelay.relayId = rel["relayId"].as<uint8_t>();
+            DoorManager.attachDoor(theDoor);
+            if (!(d["enabled"] | true)) {
+                DoorManager.disableDoor(DoorManager.getDoorCount() - 1);
+            }
+        }
+    }
 
-            theDoor.lockRelay = lockRelay;
-            
-            this->doors.push_back(theDoor);
+    doc.clear();
+    Serial.println(F("DONE"));
+}
+
+void Application::loadRules() {
+    Serial.print(F("INFO: Loading rules file "));
+    Serial.print(RULES_FILE_PATH);
+    Serial.print(F(" ... "));
+    if (!filesystemMounted) {
+        Serial.println(F("FAIL"));
+        Serial.println(F("ERROR: Filesystem not mounted."));
+        return;
+    }
+
+    if (!SPIFFS.exists(RULES_FILE_PATH)) {
+        Serial.println(F("FAIL"));
+        Serial.println(F("WARN: No rules file found. Skipping..."));
+        return;
+    }
+
+    File rulesFile = SPIFFS.open(RULES_FILE_PATH, "r");
+    if (!rulesFile) {
+        Serial.println(F("FAIL"));
+        Serial.println(F("ERROR: Unable to open rules file."));
+        return;
+    }
+
+    size_t size = rulesFile.size();
+    size_t freeMem = ESP.getMaxAllocHeap() - 512;
+    if (size > freeMem) {
+        Serial.println(F("FAIL"));
+        Serial.print(F("ERROR: Not enough free memory to load rules file. Size = "));
+        Serial.print(size);
+        Serial.print(F(", Free = "));
+        Serial.println(freeMem);
+        rulesFile.close();
+        return;
+    }
+
+    TrackedJsonDocument<HeapSubsystem::RULES> doc(freeMem);
+    DeserializationError error = deserializeJson(doc, rulesFile);
+    if (error) {
+        Serial.println(F("FAIL"));
+        Serial.println(F("ERROR: Fail to parse rules file to JSON."));
+        rulesFile.close();
+        return;
+    }
+
+    rulesFile.close();
+
+    // Rules are only staged here. The JSON is gone once compile() has
+    // built the dispatch table, so nothing on the event path touches it.
+    ReactionManager.clear();
+    uint16_t skipped = 0;
+    JsonArray rules = doc["rules"];
+    for (auto r : rules) {
+        ReactionEvent event = (ReactionEvent)r["event"].as<uint8_t>();
+        uint8_t moduleId = r["module"].as<uint8_t>();
+        uint8_t sourceId = r["source"].as<uint8_t>();
+
+        JsonArray actions = r["actions"];
+        for (auto a : actions) {
+            ReactionAction action;
+            action.type = (ReactionActionType)a["type"].as<uint8_t>();
+            action.moduleId = a["module"].as<uint8_t>();
+            action.targetId = a["target"].as<uint8_t>();
+            if (!ReactionManager.addRule(event, moduleId, sourceId, action)) {
+                skipped++;
+            }
         }
     }
 
     doc.clear();
+    if (!ReactionManager.compile()) {
+        Serial.println(F("FAIL"));
+        Serial.println(F("ERROR: Not enough memory to build rules table."));
+        return;
+    }
+
     Serial.println(F("DONE"));
+    Serial.print(F("INFO: Loaded "));
+    Serial.print(ReactionManager.getActionCount());
+    Serial.println(F(" rule actions."));
+    if (skipped > 0) {
+        Serial.print(F("WARN: Skipped "));
+        Serial.print(skipped);
+        Serial.println(F(" rule actions with out-of-range event, module or source IDs."));
+    }
 }
 
 void Application::doFactoryRestore() {
@@ -511,6 +817,7 @@ void Application::doFactoryRestore() {
         Serial.print(F("INFO: Clearing current config... "));
         if (filesystemMounted) {
             if (SPIFFS.remove(CONFIG_FILE_PATH)) {
+                ConfigCache.clear();
                 Serial.println(F("DONE"));
                 Serial.print(F("INFO: Removed file: "));
                 Serial.println(CONFIG_FILE_PATH);
@@ -543,7 +850,8 @@ void Application::failSafe() {
     Serial.println();
     Serial.println(F("ERROR: Entering failsafe (config) mode..."));
     CoreIO.heartbeatLedOn();
-    sysState = SystemState::SYS_DISABLED;
+    setSystemState(SystemState::SYS_DISABLED);
+    requestFullStatus();
     publishSystemState();
     Console.enterCommandInterpreter();
 }
@@ -603,15 +911,12 @@ void Application::connectWifi() {
 }
 
 void Application::scanBusDevices() {
-    byte error;
     byte address;
     int devices = 0;
 
     Serial.println(F("INFO: Beginning I2C bus scan ..."));
     for (address = 0; address < 127; address++) {
-        Wire.beginTransmission(address);
-        error = Wire.endTransmission();
-        if (error == 0) {
+        if (I2CBus.probe(address)) {
             devices++;
             Serial.print(F("INFO: I2C device found at address 0x"));
             if (address < 16) {
@@ -631,14 +936,6 @@ void Application::scanBusDevices() {
                 devicesFound.push_back(realAddress);
             }
         }
-        else if (error == 4) {
-            Serial.print(F("ERROR: Unknown error at address 0x"));
-            if (address < 16) {
-                Serial.print(F("0"));
-            }
-
-            Serial.println(address, HEX);
-        }
     }
 
     if (devices == 0) {
@@ -657,6 +954,28 @@ void Application::resetCommBus() {
     Serial.println(F("DONE"));
 }
 
+bool Application::submitAuthRequest(AuthRequestType type, uint8_t sourceId, const char* credential, const uint8_t* context, AuthCompletionHandler onComplete, uint32_t seenAt) {
+    AuthRequest request;
+    memset(&request, 0, sizeof(AuthRequest));
+    request.type = type;
+    request.sourceId = sourceId;
+    strncpy(request.credential, credential, AUTH_CREDENTIAL_MAX_LEN - 1);
+    if (context != nullptr) {
+        memcpy(request.context, context, AUTH_CONTEXT_SIZE);
+    }
+
+    request.deadline = millis() + AUTH_REQUEST_DEADLINE;
+    request.onComplete = onComplete;
+    request.seenAt = seenAt;
+    request.submittedAt = micros();
+    if (!TaskStats.send(authRequestQueue, &request)) {
+        Serial.println(F("ERROR: [AUTH] Auth worker busy. Request rejected."));
+        return false;
+    }
+
+    return true;
+}
+
 void Application::onKeypadCommand(KeypadData* cmdData) {
     String key = "";
     for (uint8_t i = 0; i < cmdData->size; i++) {
@@ -666,124 +985,789 @@ void Application::onKeypadCommand(KeypadData* cmdData) {
     Serial.print(F("INFO: [KEY] Got keypad code: "));
     Serial.println(key);
 
-    if (AuthService.checkPinValid(key.c_str())) {
+    if (sysState == SystemState::SYS_DISABLED) {
+        Serial.println(F("WARN: [KEY] System disabled. Ignoring keypad input."));
+        return;
+    }
+
+    uint8_t doorId = DoorManager.getDoorForKeypad(cmdData->id);
+    if (doorId != DOOR_NONE && !DoorManager.isEnabled(doorId)) {
+        Serial.print(F("WARN: [KEY] Ignoring keypad input for disabled door: "));
+        Serial.println(DoorManager.getDoor(doorId)->name);
+        return;
+    }
+
+    // The command is only carried out once the pin has been validated.
+    uint8_t context[AUTH_CONTEXT_SIZE] = { cmdData->command };
+    if (!submitAuthRequest(AuthRequestType::PIN, cmdData->id, key.c_str(), context, appOnKeypadAuthComplete, micros())) {
         // TODO if invalid key, need a way to signal back to the user
         // of bad input. Need support for this in keypad firmware first.
     }
+}
 
-    switch ((KeypadCommands)cmdData->command) {
+void Application::onKeypadAuthComplete(const AuthResult* result) {
+    uint8_t doorId = DoorManager.getDoorForKeypad(result->request.sourceId);
+    bool accepted = result->code == AuthResultCode::ACCEPTED;
+    uint8_t command = result->request.context[0];
+    recordAccessEvent(accepted ? AccessEventType::PIN_ACCEPTED : AccessEventType::PIN_REJECTED, doorId, result->request.sourceId, nullptr, 0);
+    journalEvent(JournalEventType::KEYPAD, doorId, result->request.sourceId, command, accepted, nullptr, 0);
+    if (!accepted) {
+        Serial.print(F("WARN: [KEY] Pin rejected for keypad "));
+        Serial.print(result->request.sourceId);
+        Serial.println(result->code == AuthResultCode::EXPIRED ? F(" (timed out).") : F("."));
+        // TODO if invalid key, need a way to signal back to the user
+        // of bad input. Need support for this in keypad firmware first.
+        return;
+    }
+
+    switch ((KeypadCommands)command) {
         case KeypadCommands::ARM_AWAY:
-            armState = ArmState::ARMED_AWAY;
-            CoreIO.armLedOn();
-            // TODO what else to do?
+            setArmState(ArmState::ARMED_AWAY);
             break;
         case KeypadCommands::ARM_STAY:
-            armState = ArmState::ARMED_STAY;
-            CoreIO.armLedOn();
-            // TODO what else to do?
+            setArmState(ArmState::ARMED_STAY);
             break;
         case KeypadCommands::DISARM:
-            armState = ArmState::DISARMED;
-            CoreIO.armLedOff();
-            // TODO what else to do?
-            break;
-        case KeypadCommands::LOCK:
-
+            setArmState(ArmState::DISARMED);
             break;
         case KeypadCommands::UNLOCK:
-
+            if (doorId != DOOR_NONE) {
+                DoorManager.grantAccess(doorId);
+            }
             break;
         default:
+            // Everything else (ie. LOCK) is up to the rules.
             break;
     }
+
+    dispatchEvent(ReactionEvent::KEYPAD_COMMAND, result->request.sourceId, command);
 }
 
 void Application::onFobRead(Tag* tagData) {
-    for (uint8_t i = 0; i < tagData->records; i++) {
-        String key = "";
-        for (uint8_t j = 0; j < tagData->size; j++) {
-            key += String((char)tagData->tagBytes[i], HEX);
+    uint32_t pickedUpAt = micros();
+    LatencyStats.record(LatencyStage::READ_QUEUE, tagData->seenAt, pickedUpAt);
+
+    String key = "";
+    for (uint8_t i = 0; i < tagData->size; i++) {
+        if (tagData->tagBytes[i] < 0x10) {
+            key += "0";
         }
 
-        Serial.print(F("INFO: [PROX] Got new tag: "));
-        Serial.println(key);
-
-        if (AuthService.checkCardValid(key.c_str())) {
-            Serial.println(F("INFO: [PROX] Tag is valid."));
-            // TODO Check key validity then fire appropriate action.
-            // TODO How do we know what action to take?
-            // TODO Should we always verify keyfobs/keypad entries against the server?
-            // TODO Or should we attempt to download a list from the server and hold it
-            // in flash? If we can hold in flash, we woudn't need to hit the server all
-            // the time, but I feel like the user DB could grow to be fairly large and we
-            // have limited storage for the JSON response and RAM to hold it's contents.
-            // By comparison, commercial door controllers such as the Kantech KT-400 have
-            // 256MB Flash, and 128MB RAM. 
+        key += String(tagData->tagBytes[i], HEX);
+    }
+
+    Serial.print(F("INFO: [PROX] Got new tag: "));
+    Serial.println(key);
+
+    if (sysState == SystemState::SYS_DISABLED) {
+        Serial.println(F("WARN: [PROX] System disabled. Ignoring tag."));
+        return;
+    }
+
+    uint8_t doorId = DoorManager.getDoorForReader(tagData->id);
+    if (doorId != DOOR_NONE && !DoorManager.isEnabled(doorId)) {
+        Serial.print(F("WARN: [PROX] Ignoring tag for disabled door: "));
+        Serial.println(DoorManager.getDoor(doorId)->name);
+        return;
+    }
+
+    // The local credential database answers without touching the network.
+    // Only tags it has never heard of go to the auth worker.
+    CredentialStatus status = CredentialStore.lookup(tagData->tagBytes, tagData->size);
+    LatencyStats.record(LatencyStage::LOOKUP, pickedUpAt, micros());
+    switch (status) {
+        case CredentialStatus::GRANTED:
+            Serial.println(F("INFO: [PROX] Tag granted by local credential database."));
+            handleTagDecision(tagData->id, true, tagData->tagBytes, tagData->size, tagData->seenAt);
+            break;
+        case CredentialStatus::DENIED:
+            Serial.println(F("INFO: [PROX] Tag denied by local credential database."));
+            handleTagDecision(tagData->id, false, tagData->tagBytes, tagData->size, tagData->seenAt);
+            break;
+        case CredentialStatus::UNKNOWN:
+        default:
+            if (!submitAuthRequest(AuthRequestType::CARD, tagData->id, key.c_str(), nullptr, appOnFobAuthComplete, tagData->seenAt)) {
+                handleTagDecision(tagData->id, false, tagData->tagBytes, tagData->size, tagData->seenAt);
+            }
+            break;
+    }
+}
+
+void Application::onFobAuthComplete(const AuthResult* result) {
+    LatencyStats.record(LatencyStage::AUTH_QUEUE, result->request.submittedAt, result->startedAt);
+    LatencyStats.record(LatencyStage::AUTH_CHECK, result->startedAt, result->finishedAt);
+    LatencyStats.record(LatencyStage::AUTH_RETURN, result->finishedAt, micros());
+    if (result->code == AuthResultCode::EXPIRED) {
+        Serial.println(F("WARN: [PROX] Tag validation timed out."));
+    }
+
+    // The request only carries the UID as a hex string.
+    uint8_t uid[ACCESS_EVENT_CREDENTIAL_SIZE];
+    uint8_t uidLen = 0;
+    const char* hex = result->request.credential;
+    while (hex[0] != '\0' && hex[1] != '\0' && uidLen < sizeof(uid)) {
+        char byteStr[3] = { hex[0], hex[1], '\0' };
+        uid[uidLen++] = (uint8_t)strtoul(byteStr, NULL, 16);
+        hex += 2;
+    }
+
+    handleTagDecision(result->request.sourceId, result->code == AuthResultCode::ACCEPTED, uid, uidLen, result->request.seenAt);
+}
+
+void Application::handleTagDecision(uint8_t readerId, bool valid, const uint8_t* uid, uint8_t uidLen, uint32_t seenAt) {
+    uint32_t decidedAt = micros();
+    uint8_t doorId = DoorManager.getDoorForReader(readerId);
+    recordAccessEvent(valid ? AccessEventType::FOB_GRANTED : AccessEventType::FOB_DENIED, doorId, readerId, uid, uidLen);
+    journalEvent(JournalEventType::FOB, doorId, readerId, 0, valid, uid, uidLen);
+    if (valid) {
+        Serial.println(F("INFO: [PROX] Tag is valid."));
+        if (doorId != DOOR_NONE) {
+            // The lock relay is set from onDoorStateChange() before this returns.
+            DoorManager.grantAccess(doorId);
+            if (DoorManager.getLockState(doorId) == LockState::UNLOCKED) {
+                uint32_t unlockedAt = micros();
+                LatencyStats.record(LatencyStage::ACTUATE, decidedAt, unlockedAt);
+                LatencyStats.record(LatencyStage::TOTAL, seenAt, unlockedAt);
+                LatencyStats.recordDoor(doorId, seenAt, unlockedAt);
+            }
         }
-        else {
-            Serial.println(F("WARN: [PROX] Invalid tag."));
-            if (this->fobReaders.at(tagData->id).badCard()) {
-                Serial.println(F("WARN: [PROX] No or invalid ACK from reader."));
+
+        dispatchEvent(ReactionEvent::FOB_GRANTED, readerId, 0);
+    }
+    else {
+        Serial.println(F("WARN: [PROX] Invalid tag."));
+        if (readerId < this->fobReaders.size() && this->fobReaders.at(readerId).badCard()) {
+            Serial.println(F("WARN: [PROX] No or invalid ACK from reader."));
+        }
+
+        dispatchEvent(ReactionEvent::FOB_DENIED, readerId, 0);
+    }
+}
+
+void Application::onDoorStateChange(uint8_t doorId, DoorField field) {
+    doorDirty[doorId] |= STATUS_DIRTY_DOOR(field);
+    if (field == DoorField::LOCK_STATE) {
+        // Lock relays are energized to unlock.
+        const Door* door = DoorManager.getDoor(doorId);
+        bool unlock = DoorManager.getLockState(doorId) == LockState::UNLOCKED;
+        setRelay(door->lockRelay.moduleId, door->lockRelay.relayId, unlock);
+        Serial.print(F("INFO: Door "));
+        Serial.print(door->name);
+        Serial.println(unlock ? F(" unlocked.") : F(" locked."));
+    }
+    else if (field == DoorField::STATE) {
+        DoorState state = DoorManager.getDoorState(doorId);
+        if (state == DoorState::HELD_OPEN || state == DoorState::FORCED_OPEN) {
+            Serial.print(F("WARN: Door "));
+            Serial.print(DoorManager.getDoor(doorId)->name);
+            Serial.println(state == DoorState::HELD_OPEN ? F(" held open.") : F(" forced open."));
+            recordAccessEvent(state == DoorState::HELD_OPEN ? AccessEventType::DOOR_HELD_OPEN : AccessEventType::DOOR_FORCED_OPEN, doorId, 0, nullptr, 0);
+        }
+    }
+}
+
+uint32_t Application::getClockTime() {
+    // NTPClient keeps time off millis() between syncs, so this never
+    // touches the network or the I2C bus.
+    return timeClient != nullptr ? timeClient->getEpochTime() : 0;
+}
+
+void Application::recordAccessEvent(AccessEventType type, uint8_t doorId, uint8_t sourceId, const uint8_t* credential, uint8_t credentialLen) {
+    AccessEvent event;
+    memset(&event, 0, sizeof(AccessEvent));
+    event.sequence = nextEventSequence++;
+    event.timestamp = getClockTime();
+    event.type = type;
+    event.doorId = doorId;
+    event.sourceId = sourceId;
+    event.credentialLen = min(credentialLen, (uint8_t)ACCESS_EVENT_CREDENTIAL_SIZE);
+    if (credential != nullptr) {
+        memcpy(event.credential, credential, event.credentialLen);
+    }
+
+    // Every event goes through the spool, connected or not. It is only
+    // consumed once the broker has taken it, and the spool holds the last
+    // sequence number across a reboot.
+    if (EventSpool.append(&event)) {
+        return;
+    }
+
+    // No spool. Best effort: a failed publish loses the event.
+    char payload[EVENT_PAYLOAD_SIZE];
+    size_t len = encodeAccessEvent(&event, payload, sizeof(payload));
+    if (len == 0 || !MqttOutbox.push(MqttTopic::EVENTS, (const uint8_t*)payload, len)) {
+        Serial.print(F("ERROR: [SPOOL] Access event lost: "));
+        Serial.println(event.sequence);
+    }
+}
+
+size_t Application::encodeAccessEvent(const AccessEvent* event, char* buffer, size_t size) {
+    char credential[(ACCESS_EVENT_CREDENTIAL_SIZE * 2) + 1];
+    for (uint8_t i = 0; i < event->credentialLen; i++) {
+        sprintf(&credential[i * 2], "%02x", event->credential[i]);
+    }
+
+    credential[event->credentialLen * 2] = '\0';
+
+    StaticJsonDocument<JSON_OBJECT_SIZE(7)> doc;
+    doc["clientId"] = config.hostname.c_str();
+    doc["seq"] = event->sequence;
+    doc["time"] = event->timestamp;
+    doc["type"] = (uint8_t)event->type;
+    if (event->doorId != DOOR_NONE) {
+        doc["door"] = event->doorId;
+    }
+
+    doc["source"] = event->sourceId;
+    if (event->credentialLen > 0) {
+        doc["credential"] = (const char*)credential;
+    }
+
+    size_t len = TelemetryHelper::serializePayload(doc, buffer, size, config.mqttPayloadFormat);
+    return (len == 0 || len >= size - 1) ? 0 : len;
+}
+
+void Application::journalEvent(JournalEventType type, uint8_t doorId, uint8_t source, uint8_t target, bool value, const uint8_t* data, uint8_t dataLen) {
+    JournalRecord record;
+    record.timestamp = getClockTime();
+    record.type = type;
+    record.doorId = doorId;
+    record.source = source;
+    record.target = target;
+    record.value = value ? 1 : 0;
+    record.dataLen = min(dataLen, (uint8_t)JOURNAL_MAX_DATA);
+    if (data != nullptr) {
+        memcpy(record.data, data, record.dataLen);
+    }
+
+    Journal.append(&record);
+}
+
+void Application::queryJournal(const ControlRequest* request) {
+    // Unset fields are 0, which is also the "unbounded" value.
+    JournalQuery query;
+    query.doorId = (request->fields & CONTROL_FIELD_DOOR) ? request->doorId : JOURNAL_ANY_DOOR;
+    query.from = request->from;
+    query.to = request->to;
+    query.cursor = request->cursor;
+
+    JournalRecord records[JOURNAL_QUERY_LIMIT];
+    uint8_t count = Journal.query(&query, records, JOURNAL_QUERY_LIMIT);
+
+    StaticJsonDocument<JOURNAL_DOC_SIZE> reply;
+    reply["clientId"] = config.hostname.c_str();
+    reply["cursor"] = query.cursor;
+    JsonArray list = reply.createNestedArray("records");
+    char data[(JOURNAL_MAX_DATA * 2) + 1];
+    for (uint8_t i = 0; i < count; i++) {
+        const JournalRecord* record = &records[i];
+        JsonObject item = list.createNestedObject();
+        item["time"] = record->timestamp;
+        item["type"] = (uint8_t)record->type;
+        if (record->doorId != DOOR_NONE) {
+            item["door"] = record->doorId;
+        }
+
+        item["source"] = record->source;
+        item["target"] = record->target;
+        item["value"] = record->value;
+        if (record->dataLen > 0) {
+            for (uint8_t j = 0; j < record->dataLen; j++) {
+                sprintf(&data[j * 2], "%02x", record->data[j]);
             }
+
+            // Copied into the document.
+            item["data"] = (char*)data;
+        }
+    }
+
+    size_t len = TelemetryHelper::serializePayload(reply, journalPayload, sizeof(journalPayload), config.mqttPayloadFormat);
+    if (len == 0 || len >= sizeof(journalPayload) - 1) {
+        Serial.println(F("ERROR: [JOURNAL] Query reply too large."));
+        return;
+    }
+
+    if (!MqttOutbox.push(MqttTopic::JOURNAL, (const uint8_t*)journalPayload, len)) {
+        Serial.println(F("WARN: [JOURNAL] Outbox full. Query reply dropped."));
+    }
+}
+
+void Application::addLatencyHistogram(JsonObject item, const LatencyHistogram* histogram) {
+    item["count"] = histogram->count;
+    item["mean"] = histogram->count > 0 ? (uint32_t)(histogram->sum / histogram->count) : 0;
+    item["p50"] = LatencyStats.getPercentile(histogram, 50);
+    item["p95"] = LatencyStats.getPercentile(histogram, 95);
+    item["max"] = histogram->max;
+    JsonArray buckets = item.createNestedArray("buckets");
+    for (uint8_t i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+        buckets.add(histogram->buckets[i]);
+    }
+}
+
+void Application::publishLatencyStats() {
+    // All values are microseconds. buckets[i] counts samples up to
+    // bounds[i]; the last bucket counts everything above the last bound.
+    // Per-door histograms follow in their own report; both together
+    // don't fit one diagnostics payload.
+    StaticJsonDocument<LATENCY_DOC_SIZE> reply;
+    reply["clientId"] = config.hostname.c_str();
+    reply["report"] = "latency";
+    JsonArray bounds = reply.createNestedArray("bounds");
+    for (uint8_t i = 0; i < LATENCY_BOUND_COUNT; i++) {
+        bounds.add(LatencyStats.getBound(i));
+    }
+
+    JsonObject stages = reply.createNestedObject("stages");
+    for (uint8_t i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        LatencyStage stage = (LatencyStage)i;
+        addLatencyHistogram(stages.createNestedObject(LatencyStats.getStageName(stage)), LatencyStats.getStage(stage));
+    }
+
+    size_t len = TelemetryHelper::serializePayload(reply, diagPayload, sizeof(diagPayload), config.mqttPayloadFormat);
+    if (len == 0 || len >= sizeof(diagPayload) - 1) {
+        Serial.println(F("ERROR: [LATENCY] Latency report too large."));
+    }
+    else if (!MqttOutbox.push(MqttTopic::DIAG, (const uint8_t*)diagPayload, len)) {
+        Serial.println(F("WARN: [LATENCY] Outbox full. Latency report dropped."));
+    }
+
+    publishDoorLatencyStats();
+}
+
+void Application::publishDoorLatencyStats() {
+    // End to end, for doors that have been unlocked by a fob. Same
+    // bounds as the stage report.
+    StaticJsonDocument<DOOR_LATENCY_DOC_SIZE> reply;
+    reply["clientId"] = config.hostname.c_str();
+    reply["report"] = "doorLatency";
+    JsonArray bounds = reply.createNestedArray("bounds");
+    for (uint8_t i = 0; i < LATENCY_BOUND_COUNT; i++) {
+        bounds.add(LatencyStats.getBound(i));
+    }
+
+    JsonArray doors = reply.createNestedArray("doors");
+    for (uint8_t i = 0; i < DOOR_MAX_DOORS; i++) {
+        const LatencyHistogram* histogram = LatencyStats.getDoor(i);
+        if (histogram->count > 0) {
+            JsonObject item = doors.createNestedObject();
+            item["door"] = i;
+            addLatencyHistogram(item, histogram);
+        }
+    }
+
+    size_t len = TelemetryHelper::serializePayload(reply, diagPayload, sizeof(diagPayload), config.mqttPayloadFormat);
+    if (len == 0 || len >= sizeof(diagPayload) - 1) {
+        Serial.println(F("ERROR: [LATENCY] Door latency report too large."));
+        return;
+    }
+
+    if (!MqttOutbox.push(MqttTopic::DIAG, (const uint8_t*)diagPayload, len)) {
+        Serial.println(F("WARN: [LATENCY] Outbox full. Door latency report dropped."));
+    }
+}
+
+void Application::publishTaskStats() {
+    lastTaskStatsPublish = millis();
+    TaskStats.collect(lastTaskStatsPublish);
+
+    StaticJsonDocument<TASK_STATS_DOC_SIZE> reply;
+    reply["clientId"] = config.hostname.c_str();
+    reply["report"] = "tasks";
+    reply["loopRate"] = TaskStats.getLoopRate();
+    JsonArray tasks = reply.createNestedArray("tasks");
+    for (uint8_t i = 0; i < TaskStats.getTaskCount(); i++) {
+        const TaskStatsTask* task = TaskStats.getTask(i);
+        JsonObject item = tasks.createNestedObject();
+        item["name"] = (const char*)pcTaskGetTaskName(task->handle);
+        item["stack"] = task->stackSize;
+        item["stackFree"] = task->stackFree;
+        if (task->cpu != TASK_STATS_CPU_UNKNOWN) {
+            item["cpu"] = task->cpu;
         }
     }
+
+    JsonArray queues = reply.createNestedArray("queues");
+    for (uint8_t i = 0; i < TaskStats.getQueueCount(); i++) {
+        const TaskStatsQueue* queue = TaskStats.getQueue(i);
+        JsonObject item = queues.createNestedObject();
+        item["name"] = queue->name;
+        item["capacity"] = queue->capacity;
+        item["depth"] = queue->depth;
+        item["peak"] = queue->peak;
+        item["sent"] = queue->sent;
+        item["overflows"] = queue->overflows;
+    }
+
+    size_t len = TelemetryHelper::serializePayload(reply, diagPayload, sizeof(diagPayload), config.mqttPayloadFormat);
+    if (len == 0 || len >= sizeof(diagPayload) - 1) {
+        Serial.println(F("ERROR: [TASKS] Task stats report too large."));
+        return;
+    }
+
+    // Only the latest report is worth sending.
+    if (!MqttOutbox.push(MqttTopic::DIAG, (const uint8_t*)diagPayload, len, MQTT_COALESCE_TASK_STATS)) {
+        Serial.println(F("WARN: [TASKS] Outbox full. Task stats report dropped."));
+    }
 }
 
-void Application::handleControlRequest(ControlCommand command) {
-    switch (command) {
-        // TODO handle incoming commands.
+void Application::publishHeapStats() {
+    lastHeapStatsPublish = millis();
+    HeapStats.sample();
+    const HeapSnapshot* snapshot = HeapStats.getSnapshot();
+
+    StaticJsonDocument<HEAP_STATS_DOC_SIZE> reply;
+    reply["clientId"] = config.hostname.c_str();
+    reply["report"] = "heap";
+    reply["size"] = snapshot->size;
+    reply["free"] = snapshot->free;
+    reply["minFree"] = snapshot->minFree;
+    reply["largest"] = snapshot->largest;
+    reply["minLargest"] = snapshot->minLargest;
+    reply["fragmentation"] = snapshot->fragmentation;
+    JsonObject subsystems = reply.createNestedObject("subsystems");
+    for (uint8_t i = 0; i < HEAP_SUBSYSTEM_COUNT; i++) {
+        HeapSubsystem subsystem = (HeapSubsystem)i;
+        const HeapUsage* usage = HeapStats.getUsage(subsystem);
+        JsonObject item = subsystems.createNestedObject(HeapStats.getSubsystemName(subsystem));
+        item["current"] = usage->current;
+        item["peak"] = usage->peak;
+        item["allocations"] = usage->allocations;
+        item["failures"] = usage->failures;
+    }
+
+    size_t len = TelemetryHelper::serializePayload(reply, diagPayload, sizeof(diagPayload), config.mqttPayloadFormat);
+    if (len == 0 || len >= sizeof(diagPayload) - 1) {
+        Serial.println(F("ERROR: [HEAP] Heap stats report too large."));
+        return;
+    }
+
+    if (!MqttOutbox.push(MqttTopic::DIAG, (const uint8_t*)diagPayload, len, MQTT_COALESCE_HEAP_STATS)) {
+        Serial.println(F("WARN: [HEAP] Outbox full. Heap stats report dropped."));
+    }
+}
+
+void Application::dispatchEvent(ReactionEvent event, uint8_t moduleId, uint8_t sourceId) {
+    const ReactionAction* actions = nullptr;
+    uint16_t count = ReactionManager.getActions(event, moduleId, sourceId, &actions);
+    for (uint16_t i = 0; i < count; i++) {
+        executeAction(&actions[i]);
+    }
+}
+
+void Application::executeAction(const ReactionAction* action) {
+    switch (action->type) {
+        case ReactionActionType::RELAY_ON:
+            setRelay(action->moduleId, action->targetId, true);
+            break;
+        case ReactionActionType::RELAY_OFF:
+            setRelay(action->moduleId, action->targetId, false);
+            break;
+        case ReactionActionType::LOCK_DOOR:
+        case ReactionActionType::UNLOCK_DOOR:
+            // The lock relay follows the door's lock state (see onDoorStateChange).
+            if (action->type == ReactionActionType::UNLOCK_DOOR) {
+                DoorManager.unlockDoor(action->targetId);
+            }
+            else {
+                DoorManager.lockDoor(action->targetId);
+            }
+            break;
+        case ReactionActionType::ARM_STAY:
+            setArmState(ArmState::ARMED_STAY);
+            break;
+        case ReactionActionType::ARM_AWAY:
+            setArmState(ArmState::ARMED_AWAY);
+            break;
+        case ReactionActionType::DISARM:
+            setArmState(ArmState::DISARMED);
+            break;
         default:
-            Serial.println(F("WARN: [MQTT] Invalid control command received."));
+            Serial.print(F("WARN: Unknown rule action type: "));
+            Serial.println((uint8_t)action->type);
+            break;
+    }
+}
+
+void Application::setRelay(uint8_t moduleId, uint8_t relayId, bool energize) {
+    // Module 0 is the onboard relays (0 - 3). Modules 1 and up are relay
+    // modules (relays 0 - 4) in the order they were detected.
+    if (moduleId == 0) {
+        if (relayId < 4) {
+            journalEvent(JournalEventType::RELAY, DoorManager.getDoorForRelay(moduleId, relayId), moduleId, relayId, energize, nullptr, 0);
+            if (energize) {
+                CoreIO.relayOn((OnboardRelaySelect)relayId);
+            }
+            else {
+                CoreIO.relayOff((OnboardRelaySelect)relayId);
+            }
+        }
+        return;
+    }
+
+    if (moduleId <= this->relayModules.size() && relayId < 5) {
+        journalEvent(JournalEventType::RELAY, DoorManager.getDoorForRelay(moduleId, relayId), moduleId, relayId, energize, nullptr, 0);
+        RelayModule* module = &this->relayModules.at(moduleId - 1);
+        if (energize) {
+            module->close((RelaySelect)(relayId + 1));
+        }
+        else {
+            module->open((RelaySelect)(relayId + 1));
+        }
+    }
+}
+
+void Application::setArmState(ArmState state) {
+    if (armState != state) {
+        statusDirty |= STATUS_DIRTY_ARM_STATE;
+    }
+
+    armState = state;
+    if (state == ArmState::DISARMED) {
+        CoreIO.armLedOff();
+    }
+    else {
+        CoreIO.armLedOn();
+    }
+}
+
+void Application::onZoneChange(ZoneSnapshot* snapshot) {
+    zoneState = snapshot->state;
+    if ((snapshot->rising | snapshot->falling) == 0) {
+        // Baseline snapshot published when the input task starts.
+        for (uint8_t zone = 0; zone < ZONE_COUNT; zone++) {
+            DoorManager.syncInput(0, zone, bitRead(snapshot->state, zone));
+        }
+
+        return;
+    }
+
+    #ifdef DEBUG
+    Serial.print(F("DEBUG: [ZONE] State: 0x"));
+    Serial.print(snapshot->state, HEX);
+    Serial.print(F(" rising: 0x"));
+    Serial.print(snapshot->rising, HEX);
+    Serial.print(F(" falling: 0x"));
+    Serial.println(snapshot->falling, HEX);
+    #endif
+
+    // Only the bits that changed are visited.
+    uint16_t edges = snapshot->rising;
+    while (edges != 0) {
+        uint8_t zone = __builtin_ctz(edges);
+        edges &= edges - 1;
+        journalEvent(JournalEventType::ZONE, DoorManager.getDoorForInput(0, zone), 0, zone, true, nullptr, 0);
+        DoorManager.onInputChange(0, zone, true);
+        dispatchEvent(ReactionEvent::ZONE_ACTIVE, 0, zone);
+    }
+
+    edges = snapshot->falling;
+    while (edges != 0) {
+        uint8_t zone = __builtin_ctz(edges);
+        edges &= edges - 1;
+        journalEvent(JournalEventType::ZONE, DoorManager.getDoorForInput(0, zone), 0, zone, false, nullptr, 0);
+        DoorManager.onInputChange(0, zone, false);
+        dispatchEvent(ReactionEvent::ZONE_INACTIVE, 0, zone);
+    }
+}
+
+// Indexed by ControlCommand.
+const ControlHandlerEntry Application::controlHandlers[CONTROL_COMMAND_COUNT] = {
+    { &Application::onControlDisable, 0 },
+    { &Application::onControlEnable, 0 },
+    { &Application::onControlReboot, 0 },
+    { &Application::onControlRequestStatus, 0 },
+    { &Application::onControlSetArmState, CONTROL_FIELD_ARM_STATE },
+    { &Application::onControlLockDoor, CONTROL_FIELD_DOOR },
+    { &Application::onControlUnlockDoor, CONTROL_FIELD_DOOR },
+    { &Application::onControlQueryJournal, 0 },
+    { &Application::onControlQueryLatency, 0 }
+};
+
+void Application::handleControlRequest(const ControlRequest* request) {
+    uint8_t index = (uint8_t)request->command;
+    if (index >= CONTROL_COMMAND_COUNT) {
+        Serial.print(F("WARN: [MQTT] Invalid control command received: "));
+        Serial.println(index);
+        return;
+    }
+
+    const ControlHandlerEntry* entry = &controlHandlers[index];
+    if ((request->fields & entry->requiredFields) != entry->requiredFields) {
+        Serial.print(F("WARN: [MQTT] Control command missing parameters: "));
+        Serial.println(index);
+        return;
+    }
+
+    if ((request->fields & CONTROL_FIELD_DOOR) && request->doorId >= DoorManager.getDoorCount()) {
+        Serial.print(F("WARN: [MQTT] Control command for unknown door: "));
+        Serial.println(request->doorId);
+        return;
+    }
+
+    (this->*entry->handler)(request);
+}
+
+void Application::onControlDisable(const ControlRequest* request) {
+    if (request->fields & CONTROL_FIELD_DOOR) {
+        DoorManager.disableDoor(request->doorId);
+        return;
+    }
+
+    // Fobs and keypads are ignored until re-enabled.
+    Serial.println(F("WARN: [MQTT] System disabled by remote request."));
+    setSystemState(SystemState::SYS_DISABLED);
+}
+
+void Application::onControlEnable(const ControlRequest* request) {
+    if (request->fields & CONTROL_FIELD_DOOR) {
+        DoorManager.enableDoor(request->doorId);
+        return;
+    }
+
+    Serial.println(F("INFO: [MQTT] System enabled by remote request."));
+    setSystemState(SystemState::NORMAL);
+}
+
+void Application::onControlReboot(const ControlRequest* request) {
+    reboot();
+}
+
+void Application::onControlRequestStatus(const ControlRequest* request) {
+    requestFullStatus();
+}
+
+void Application::onControlSetArmState(const ControlRequest* request) {
+    setArmState(request->armState);
+}
+
+void Application::onControlLockDoor(const ControlRequest* request) {
+    // The lock relay follows the door's lock state (see onDoorStateChange).
+    DoorManager.lockDoor(request->doorId);
+}
+
+void Application::onControlUnlockDoor(const ControlRequest* request) {
+    DoorManager.unlockDoor(request->doorId);
+}
+
+void Application::onControlQueryJournal(const ControlRequest* request) {
+    queryJournal(request);
+}
+
+void Application::onControlQueryLatency(const ControlRequest* request) {
+    publishLatencyStats();
+    if (request->fields & CONTROL_FIELD_RESET) {
+        LatencyStats.reset();
     }
 }
 
 void Application::onMqttMessage(char* topic, byte* payload, unsigned int length) {
+    // Runs on the MQTT network task. Control messages are handed to the
+    // main loop rather than acted on here.
+    if (length > MQTT_CONTROL_MAX_SIZE) {
+        Serial.print(F("WARN: [MQTT] Control message too large. Ignoring "));
+        Serial.print(length);
+        Serial.println(F(" bytes."));
+        return;
+    }
+
+    MqttControlMessage message;
+    message.length = length;
+    memcpy(message.payload, payload, length);
+    if (!TaskStats.send(mqttControlQueue, &message)) {
+        mqttControlDropped++;
+        Serial.println(F("WARN: [MQTT] Control queue full. Message dropped."));
+    }
+}
+
+void Application::handleControlMessage(MqttControlMessage* message) {
     CoreIO.heartbeatLedOn();
-    Serial.print(F("INFO: [MQTT] Message arrived: ["));
-    Serial.print(topic);
-    Serial.print(F("] "));
+    Serial.print(F("INFO: [MQTT] Control message arrived: "));
+    if (config.mqttPayloadFormat == PayloadFormat::JSON) {
+        Serial.write(message->payload, message->length);
+        Serial.println();
+    }
+    else {
+        Serial.print(message->length);
+        Serial.println(F(" bytes (MessagePack)"));
+    }
+
+    #ifdef DEBUG
+    unsigned long started = micros();
+    #endif
 
-    // It's a lot easier to deal with if we just convert the payload
-    // to a string first.
-    String msg;
-    for (unsigned int i = 0; i < length; i++) {
-        msg += (char)payload[i];
+    ControlRequest request;
+    if (!parseControlRequest(message, &request)) {
+        return;
     }
 
-    Serial.println(msg);
+    handleControlRequest(&request);
+
+    #ifdef DEBUG
+    Serial.print(F("DEBUG: [MQTT] Control message handled in "));
+    Serial.print(micros() - started);
+    Serial.println(F(" us."));
+    #endif
+}
 
-    StaticJsonDocument<200> doc;
-    DeserializationError error = deserializeJson(doc, msg);
+bool Application::parseControlRequest(MqttControlMessage* message, ControlRequest* request) {
+    // Parsed in place: the document only holds pointers into the message
+    // buffer, so everything needed is copied into the request here.
+    StaticJsonDocument<CONTROL_DOC_SIZE> doc;
+    DeserializationError error = TelemetryHelper::deserializePayload(doc, message->payload, message->length, config.mqttPayloadFormat);
     if (error) {
-        Serial.print(F("ERROR: [MQTT] Failed to parse MQTT message to JSON: "));
+        Serial.print(F("ERROR: [MQTT] Failed to parse MQTT message: "));
         Serial.println(error.c_str());
-        doc.clear();
-        return;
+        return false;
     }
 
-    if (doc.containsKey("clientId")) {
-        String id = doc["clientId"].as<String>();
-        id.toUpperCase();
-        if (!id.equals(config.hostname)) {
-            Serial.println(F("INFO: Control message not intended for this host. Ignoring..."));
-            doc.clear();
-            return;
-        }
-    }
-    else {
+    const char* clientId = doc["clientId"];
+    if (clientId == nullptr) {
         Serial.println(F("WARN: MQTT message does not contain client ID. Ignoring..."));
-        doc.clear();
-        return;
+        return false;
+    }
+
+    if (strcasecmp(clientId, config.hostname.c_str()) != 0) {
+        Serial.println(F("INFO: Control message not intended for this host. Ignoring..."));
+        return false;
     }
 
     if (!doc.containsKey("command")) {
         Serial.println(F("WARN: MQTT message does not contain a control command. Ignoring..."));
-        doc.clear();
-        return;
+        return false;
+    }
+
+    memset(request, 0, sizeof(ControlRequest));
+    request->command = (ControlCommand)doc["command"].as<uint8_t>();
+    if (doc.containsKey("door")) {
+        request->fields |= CONTROL_FIELD_DOOR;
+        request->doorId = doc["door"].as<uint8_t>();
+    }
+
+    if (doc.containsKey("armState") && doc["armState"].as<uint8_t>() <= (uint8_t)ArmState::ARMED_AWAY) {
+        request->fields |= CONTROL_FIELD_ARM_STATE;
+        request->armState = (ArmState)doc["armState"].as<uint8_t>();
+    }
+
+    if (doc.containsKey("from")) {
+        request->fields |= CONTROL_FIELD_FROM;
+        request->from = doc["from"].as<uint32_t>();
+    }
+
+    if (doc.containsKey("to")) {
+        request->fields |= CONTROL_FIELD_TO;
+        request->to = doc["to"].as<uint32_t>();
     }
 
-    ControlCommand cmd = (ControlCommand)doc["command"].as<uint8_t>();
-    handleControlRequest(cmd);
+    if (doc.containsKey("cursor")) {
+        request->fields |= CONTROL_FIELD_CURSOR;
+        request->cursor = doc["cursor"].as<uint32_t>();
+    }
+
+    if (doc["reset"].as<bool>()) {
+        request->fields |= CONTROL_FIELD_RESET;
+    }
+
+    return true;
 }
 
 bool Application::reconnectMqttClient() {
@@ -824,17 +1808,123 @@ bool Application::reconnectMqttClient() {
     return true;
 }
 
-void Application::onCheckMqtt() {
-    Serial.println(F("INFO: Checking MQTT connection status..."));
-    if (reconnectMqttClient()) {
-        Serial.println(F("INFO: Successfully reconnected to MQTT broker."));
-        publishSystemState();
+void Application::onMqttService() {
+    // Runs on the MQTT network task, which is the only task that touches
+    // mqttClient once it has been started.
+    if (mqttReconfigureRequested) {
+        mqttReconfigureRequested = false;
+        if (mqttClient.connected()) {
+            mqttClient.unsubscribe(config.mqttTopicControl.c_str());
+            mqttClient.disconnect();
+        }
+
+        mqttClient.setServer(config.mqttBroker.c_str(), config.mqttPort);
+        lastMqttAttempt = 0;
     }
-    else {
-        Serial.println(F("ERROR: MQTT connection lost and reconnect failed."));
-        Serial.print(F("INFO: Retrying connection in "));
-        Serial.print(CHECK_MQTT_INTERVAL % 1000);
-        Serial.println(F(" seconds."));
+
+    if (!mqttClient.connected()) {
+        mqttConnected = false;
+        if (WiFi.status() != WL_CONNECTED) {
+            return;
+        }
+
+        if (lastMqttAttempt != 0 && millis() - lastMqttAttempt < CHECK_MQTT_INTERVAL) {
+            return;
+        }
+
+        lastMqttAttempt = millis();
+        if (!reconnectMqttClient()) {
+            Serial.println(F("ERROR: MQTT connection lost and reconnect failed."));
+            Serial.print(F("INFO: Retrying connection in "));
+            Serial.print(CHECK_MQTT_INTERVAL / 1000);
+            Serial.println(F(" seconds."));
+            return;
+        }
+
+        Serial.println(F("INFO: Successfully connected to MQTT broker."));
+        mqttConnected = true;
+
+        // Published from the main loop.
+        requestFullStatus();
+    }
+
+    mqttClient.loop();
+
+    // Live traffic first. Spooled events only go out once the outbox is empty.
+    if (MqttOutbox.drain(appPublishMqttMessage, MQTT_PUBLISH_BURST, appOnMqttPublishFailed) < MQTT_PUBLISH_BURST) {
+        drainEventSpool();
+    }
+}
+
+void Application::drainEventSpool() {
+    // Live events are sent on the next pass. A backlog (after a reconnect
+    // or a failed publish) goes out a batch per interval, so it doesn't
+    // crowd out the rest of the traffic.
+    uint32_t pending = EventSpool.getPendingCount();
+    if (pending == 0) {
+        return;
+    }
+
+    bool backlog = spoolDrainFailed || pending > SPOOL_DRAIN_BATCH;
+    if (backlog && millis() - lastSpoolDrain < SPOOL_DRAIN_INTERVAL) {
+        return;
+    }
+
+    lastSpoolDrain = millis();
+    spoolDrainFailed = false;
+    AccessEvent event;
+    for (uint8_t i = 0; i < SPOOL_DRAIN_BATCH && EventSpool.peek(&event); i++) {
+        size_t len = encodeAccessEvent(&event, spoolPayload, sizeof(spoolPayload));
+        if (len == 0) {
+            // Can never be delivered. Counted as lost so the gap in the
+            // sequence is accounted for.
+            Serial.print(F("ERROR: [SPOOL] Failed to encode access event. Discarded: "));
+            Serial.println(event.sequence);
+            EventSpool.discard(event.sequence);
+            continue;
+        }
+
+        if (!publishMqttMessage(MqttTopic::EVENTS, (const uint8_t*)spoolPayload, len)) {
+            // Still undelivered. Try again next batch.
+            spoolDrainFailed = true;
+            break;
+        }
+
+        EventSpool.consume(event.sequence);
+    }
+}
+
+bool Application::publishMqttMessage(MqttTopic topic, const uint8_t* payload, size_t length) {
+    const char* topicName;
+    switch (topic) {
+        case MqttTopic::EVENTS:
+            topicName = config.mqttTopicEvents.c_str();
+            break;
+        case MqttTopic::JOURNAL:
+            topicName = config.mqttTopicJournal.c_str();
+            break;
+        case MqttTopic::DIAG:
+            topicName = config.mqttTopicDiag.c_str();
+            break;
+        case MqttTopic::STATUS:
+        default:
+            topicName = config.mqttTopicStatus.c_str();
+            break;
+    }
+
+    if (!mqttClient.publish(topicName, payload, length)) {
+        Serial.println(F("ERROR: Failed to publish message."));
+        return false;
+    }
+
+    return true;
+}
+
+void Application::onMqttPublishFailed(MqttTopic topic, uint32_t context) {
+    // Runs on the MQTT network task. The main loop picks the masks up on
+    // its next status publish.
+    if (topic == MqttTopic::STATUS) {
+        statusRetry.fetch_or(context);
     }
 }
 
@@ -879,7 +1969,7 @@ void Application::initCommBus() {
     digitalWrite(PIN_BUS_RESET, HIGH);
     // ************************
 
-	Wire.begin();
+	I2CBus.begin();
 	scanBusDevices();
 	if (primaryExpanderFound) {
 		Serial.println(F("INFO: Found primary host bus controller."));
@@ -887,7 +1977,9 @@ void Application::initCommBus() {
         Serial.println(devicesFound.size());
 
 		uint8_t addr = 0;
+		primaryBus.begin();  // Before it is copied; relay detection uses the copy.
 		additionalBusses.push_back(primaryBus);  // The primary bus controller should always be at index 0.
+		additionalBusAddresses.push_back(PRIMARY_EXP_BUS_ADDRESS);
 		for (std::size_t i = 0; i < devicesFound.size(); i++) {
 			// MCP23017 addresses are 32 - 40, with 32 reserved by CoreIO.
 			addr = devicesFound.at(i);
@@ -895,6 +1987,7 @@ void Application::initCommBus() {
             	Adafruit_MCP23017 newBus;
             	newBus.begin(addr);
             	additionalBusses.push_back(newBus);
+				additionalBusAddresses.push_back(I2C_ADDRESS_OFFSET + addr);
 			}
         }
 	}
@@ -921,6 +2014,7 @@ void Application::initRTC() {
 	Serial.print(F("INIT: Initializing RTC at address 0x"));
 	Serial.print(RTC_ADDRESS, HEX);
 	Serial.println(F(" ..."));
+	I2CTransaction txn(RTC_ADDRESS);
 	if (!rtcFound || !rtc.begin()) {
 		Serial.println(F("FAIL"));
 		Serial.println(F("ERROR: Hardware RTC not found."));
@@ -985,7 +2079,7 @@ void Application::initRelayModules() {
 
 	uint8_t count = 0;
 	for (std::size_t i = 0; i < additionalBusses.size(); i++) {
-		RelayModule rm(&additionalBusses.at(i));
+		RelayModule rm(&additionalBusses.at(i), additionalBusAddresses.at(i));
 		if (rm.detect()) {
 			if (count == 0) {
 				Serial.println();
@@ -995,6 +2089,7 @@ void Application::initRelayModules() {
 			Serial.println(i);
 			rm.init();
 			relayModules.push_back(rm);
+			count++;
 		}
 	}
 
@@ -1076,6 +2171,8 @@ void Application::initFobReaders() {
                 Serial.println(reader.getFirmwareVersion());
                 Serial.print(F("INIT: Fob reader MF version: 0x"));
                 Serial.println(reader.getMiFareVersion(), HEX);
+                Serial.print(F("INIT: Fob reader combined poll: "));
+                Serial.println(reader.hasCombinedPoll() ? F("YES") : F("NO"));
                 Serial.print(F("INIT: Performing reader self-test... "));
                 if (reader.selfTest() == 0x01) {  // TODO is this right?
                     Serial.println("PASS");
@@ -1112,6 +2209,9 @@ void Application::initFilesystem() {
     Serial.println(F("DONE"));
     setConfigurationDefaults();
     loadConfiguration();
+    loadDoors();
+    loadRules();
+    buildStatusTopology();
 }
 
 void Application::initWiFi() {
@@ -1155,7 +2255,7 @@ void Application::initOTA() {
             ArduinoOTA.setHostname(config.hostname.c_str());
             ArduinoOTA.setPassword(config.otaPassword.c_str());
             ArduinoOTA.onStart([]() {
-                Application::singleton->sysState = SystemState::UPDATING;
+                Application::singleton->setSystemState(SystemState::UPDATING);
                 // Handles start of OTA update. Determines update type.
                 String type;
                 if (ArduinoOTA.getCommand() == U_FLASH) {
@@ -1215,15 +2315,11 @@ void Application::initOTA() {
 
 void Application::initMQTT() {
     Serial.print(F("INIT: Initializing MQTT client... "));
-    mqttClient.setBufferSize(256);
+    mqttClient.setBufferSize(MQTT_BUFFER_SIZE);
     mqttClient.setKeepAlive(45);
     mqttClient.setServer(config.mqttBroker.c_str(), config.mqttPort);
     mqttClient.setCallback(appOnMqttMessage);
     Serial.println(F("DONE"));
-    if (reconnectMqttClient()) {
-        delay(500);
-        publishSystemState();
-    }
 }
 
 void Application::initTimeclient() {
@@ -1233,15 +2329,23 @@ void Application::initTimeclient() {
     Serial.println(F("DONE"));
 }
 
+void Application::onRefreshAuthToken() {
+    // Renews the token a check interval ahead of the credential checks, so
+    // they never have to log in themselves.
+    if (WiFi.status() == WL_CONNECTED && !AuthService.refreshToken(false, AUTH_TOKEN_REFRESH_MARGIN + AUTH_TOKEN_CHECK_INTERVAL)) {
+        Serial.println(F("WARN: [NET] Background token refresh failed."));
+    }
+}
+
 void Application::onCheckWiFi() {
     Serial.println(F("INFO: Checking WiFi connectivity..."));
     if (WiFi.status() != WL_CONNECTED) {
         Serial.println(F("WARN: Lost connection. Attempting reconnect..."));
         connectWifi();
         if (WiFi.status() == WL_CONNECTED) {
+            // The MQTT network task reconnects on its own.
             initMDNS();
             initOTA();
-            initMQTT();
         }
     }
 }
@@ -1286,9 +2390,6 @@ void Application::handleSaveConfig() {
 }
 
 void Application::handleMqttConfigCommand(String newBroker, int newPort, String newUsername, String newPassw, String newConChan, String newStatChan) {
-    mqttClient.unsubscribe(config.mqttTopicControl.c_str());
-    mqttClient.disconnect();
-
     config.mqttBroker = newBroker;
     config.mqttPort = newPort;
     config.mqttUsername = newUsername;
@@ -1296,7 +2397,8 @@ void Application::handleMqttConfigCommand(String newBroker, int newPort, String
     config.mqttTopicControl = newConChan;
     config.mqttTopicStatus = newStatChan;
 
-    initMQTT();
+    // The MQTT network task reconnects with the new settings.
+    mqttReconfigureRequested = true;
     Serial.println();
 }
 
@@ -1329,10 +2431,14 @@ void Application::initConsole() {
     Console.onSaveConfigCommand(appHandleSaveConfig);
     Console.onMqttConfigCommand(appHandleMqttConfigCommand);
     Console.onBusReset(appHandleBusResetCommand);
+    Console.onLatencyStats(appHandleLatencyStatsCommand);
+    Console.onTaskStats(appHandleTaskStatsCommand);
+    Console.onHeapStats(appHandleHeapStatsCommand);
 }
 
 void Application::initApiClient() {
     Serial.print(F("INIT: Initializing API client... "));
+    AuthService.begin();
     AuthService.setApiCredentials(config.apiUsername, config.apiPassword);
     AuthService.setCardAuthEndpoint(config.cardValidateEndpoint.c_str());
     AuthService.setPinAuthEndpoint(config.pinValidateEndpoint.c_str());
@@ -1340,12 +2446,63 @@ void Application::initApiClient() {
     Serial.println(F("DONE"));
 }
 
+void Application::initEventSpool() {
+    Serial.print(F("INIT: Opening access event spool... "));
+    if (!EventSpool.begin()) {
+        Serial.println(F("FAIL"));
+        Serial.println(F("WARN: Access events will be lost while MQTT is offline, and numbering restarts on every boot."));
+        return;
+    }
+
+    nextEventSequence = EventSpool.getLastSequence() + 1;
+    Serial.println(F("DONE"));
+}
+
+void Application::initJournal() {
+    Serial.print(F("INIT: Opening access journal... "));
+    if (!Journal.begin()) {
+        Serial.println(F("FAIL"));
+        Serial.println(F("WARN: Events will not be journaled."));
+        return;
+    }
+
+    Serial.println(F("DONE"));
+}
+
+void Application::initCredentialStore() {
+    Serial.print(F("INIT: Loading local credential database... "));
+    if (!CredentialStore.begin()) {
+        Serial.println(F("FAIL"));
+        Serial.println(F("WARN: All tags will be validated against the API."));
+        return;
+    }
+
+    Serial.println(F("DONE"));
+    Serial.print(F("INIT: Credential database generation "));
+    Serial.print(CredentialStore.getGeneration());
+    Serial.print(F(" with "));
+    Serial.print(CredentialStore.getEntryCount());
+    Serial.println(F(" tags."));
+}
+
 void Application::init() {
+    HeapStats.begin();
     keypadQueue = xQueueCreate(5, sizeof(KeypadData));
     fobReaderQueue = xQueueCreate(5, sizeof(Tag));
-    dryContactQueue = xQueueCreate(1, sizeof(uint8_t));
-    optoContactQueue = xQueueCreate(1, sizeof(uint8_t));
+    zoneQueue = xQueueCreate(ZONE_QUEUE_DEPTH, sizeof(ZoneSnapshot));
+    authRequestQueue = xQueueCreate(AUTH_QUEUE_DEPTH, sizeof(AuthRequest));
+    authResultQueue = xQueueCreate(AUTH_QUEUE_DEPTH, sizeof(AuthResult));
+    mqttControlQueue = xQueueCreate(MQTT_CONTROL_QUEUE_DEPTH, sizeof(MqttControlMessage));
+    TaskStats.watchQueue(keypadQueue, "keypad");
+    TaskStats.watchQueue(fobReaderQueue, "fobReader");
+    TaskStats.watchQueue(zoneQueue, "zone");
+    TaskStats.watchQueue(authRequestQueue, "authRequest");
+    TaskStats.watchQueue(authResultQueue, "authResult");
+    TaskStats.watchQueue(mqttControlQueue, "mqttControl");
+    applicationTask = xTaskGetCurrentTaskHandle();
+    TaskStats.watchTask(applicationTask, APPLICATION_TASK_STACK_SIZE);
 	initSys();
+	TimerWheel.begin(millis());
 	initCommBus();
 	initCoreIO();
     heartbeatTask = initHeartbeat();
@@ -1353,27 +2510,38 @@ void Application::init() {
 	keypadCheckTask = initKeypadDevices();
     fobReaderCheckTask = initFobReaderDevices();
 	initFilesystem();
+    initCredentialStore();
+    initEventSpool();
+    initJournal();
     initApiClient();
+    authWorkerTask = initAuthWorker();
     wifiCheckTask = initCheckWiFi();
-    mqttCheckTask = initCheckMqtt();
+    mqttTask = initMqttTask();
+    authTokenTask = initAuthTokenRefresh();
     initMDNS();
     initOTA();
     clockSyncTask = initClockSync();
     inputTask = initInputTask();
     initConsole();
-    sysState = SystemState::NORMAL;
-    statusMsg = "Boot sequence complete";
+    setSystemState(SystemState::NORMAL);
+    setStatusMessage("Boot sequence complete");
     Serial.println(F("INIT: Boot sequence complete."));
     ESPCrashMonitor.enableWatchdog(ESPCrashMonitorClass::ETimeout::Timeout_2s);
 }
 
 void Application::update() {
+    TaskStats.countLoop();
+    HeapStats.update(millis());
     ESPCrashMonitor.iAmAlive();
     Console.checkInterrupt();
     #ifdef SUPPORT_OTA
         ArduinoOTA.handle();
     #endif
-    mqttClient.loop();
+
+    MqttControlMessage controlMsg;
+    while (xQueueReceive(mqttControlQueue, &controlMsg, 0)) {
+        handleControlMessage(&controlMsg);
+    }
 
     // TODO Keypad input could be a command to arm/disarm the system,
     // unlock a door, see certain statuses, etc. Unlike other
@@ -1395,19 +2563,36 @@ void Application::update() {
         onFobRead(&tag);
     }
 
-    // TODO We should probably implement some kind of "reaction manager" so-to-speak to
-    // handle how to react to these inputs.  This should involve some sort of mapping
-    // that defines what should happen if an input is triggered. For example:
-    // A REX attached to an input triggers a relay controlling a lock solenoid to unlock
-    // a door. Or a door contact attached to an input triggers an alarm condition and
-    // a siren goes off.
-    uint8_t dcValue = 0;
-    if (xQueueReceive(dryContactQueue, &dcValue, 0)) {
-        // TODO What to do with the DC value?
+    // Credential checks run on the auth worker task. Their completion
+    // handlers are run here so they can safely touch application state.
+    AuthResult authResult;
+    while (xQueueReceive(authResultQueue, &authResult, 0)) {
+        if (authResult.request.onComplete != nullptr) {
+            authResult.request.onComplete(&authResult);
+        }
+    }
+
+    // Zone edges are mapped to actions by the reaction manager (see rules.json).
+    // For example: a REX attached to an input unlocks a door, or a door contact
+    // triggers a relay driving a siren.
+    ZoneSnapshot zones;
+    while (xQueueReceive(zoneQueue, &zones, 0)) {
+        onZoneChange(&zones);
+    }
+
+    // Relock, REX shunt and held-open timeouts.
+    TimerWheel.advance(millis());
+
+    // Status changes from all of the above go out as one coalesced delta.
+    if (millis() - lastStatusPublish >= STATUS_PUBLISH_INTERVAL) {
+        publishSystemState();
+    }
+
+    if (millis() - lastTaskStatsPublish >= TASK_STATS_INTERVAL) {
+        publishTaskStats();
     }
 
-    uint8_t optoValue = 0;
-    if (xQueueReceive(optoContactQueue, &optoValue, 0)) {
-        // TODO What to do with the opto value?
+    if (millis() - lastHeapStatsPublish >= HEAP_STATS_INTERVAL) {
+        publishHeapStats();
     }
 }
\ No newline at end of file
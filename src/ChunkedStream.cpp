@@ -0,0 +1,139 @@
+#include "ChunkedStream.h"
+
+ChunkedStream::ChunkedStream(Stream& source) {
+	this->_source = &source;
+	this->_remaining = 0;
+	this->_peeked = -1;
+	this->_started = false;
+	this->_done = false;
+	this->_failed = false;
+
+	// The source already waits out its own timeout on every byte.
+	this->setTimeout(0);
+}
+
+int ChunkedStream::readSource() {
+	char c;
+	return this->_source->readBytes(&c, 1) == 1 ? (uint8_t)c : -1;
+}
+
+bool ChunkedStream::nextChunk() {
+	// Every chunk after the first is preceded by the CRLF that ends the
+	// previous one.
+	if (this->_started && (this->readSource() != '\r' || this->readSource() != '\n')) {
+		this->_failed = true;
+		return false;
+	}
+
+	this->_started = true;
+	uint32_t size = 0;
+	uint8_t digits = 0;
+	int c;
+	while ((c = this->readSource()) >= 0 && isHexadecimalDigit(c)) {
+		if (++digits > CHUNKED_STREAM_MAX_SIZE_DIGITS) {
+			this->_failed = true;
+			return false;
+		}
+
+		size = (size << 4) | (uint32_t)(isDigit(c) ? c - '0' : (tolower(c) - 'a') + 10);
+	}
+
+	// Skip any chunk extensions up to the end of the size line.
+	while (c >= 0 && c != '\n') {
+		c = this->readSource();
+	}
+
+	if (c < 0 || digits == 0) {
+		this->_failed = true;
+		return false;
+	}
+
+	if (size == 0) {
+		// Last chunk. Skip the trailer section, which ends with an empty
+		// line, so the connection is ready for the next response.
+		uint16_t lineLength = 0;
+		while ((c = this->readSource()) >= 0) {
+			if (c == '\n') {
+				if (lineLength == 0) {
+					break;
+				}
+
+				lineLength = 0;
+			}
+			else if (c != '\r') {
+				lineLength++;
+			}
+		}
+
+		this->_done = true;
+		return false;
+	}
+
+	this->_remaining = size;
+	return true;
+}
+
+int ChunkedStream::available() {
+	if (this->_peeked >= 0) {
+		return 1;
+	}
+
+	if (this->_remaining == 0) {
+		return 0;
+	}
+
+	int buffered = this->_source->available();
+	return buffered < (int)this->_remaining ? buffered : (int)this->_remaining;
+}
+
+int ChunkedStream::read() {
+	if (this->_peeked >= 0) {
+		int c = this->_peeked;
+		this->_peeked = -1;
+		return c;
+	}
+
+	if (this->_done || this->_failed) {
+		return -1;
+	}
+
+	if (this->_remaining == 0 && !this->nextChunk()) {
+		return -1;
+	}
+
+	int c = this->readSource();
+	if (c < 0) {
+		this->_failed = true;
+		return -1;
+	}
+
+	this->_remaining--;
+	return c;
+}
+
+int ChunkedStream::peek() {
+	if (this->_peeked < 0) {
+		this->_peeked = this->read();
+	}
+
+	return this->_peeked;
+}
+
+size_t ChunkedStream::write(uint8_t c) {
+	(void)c;
+	return 0;
+}
+
+void ChunkedStream::flush() {
+}
+
+void ChunkedStream::finish() {
+	// Reads whatever the parser left, up to the end of the body.
+	this->_peeked = -1;
+	while (this->read() >= 0) {
+	}
+}
+
+bool ChunkedStream::failed() {
+	return this->_failed;
+}
\ No newline at end of file
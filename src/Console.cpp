@@ -62,6 +62,18 @@ void ConsoleClass::onBusReset(void (*busResetHandler)()) {
     this->busResetHandler = busResetHandler;
 }
 
+void ConsoleClass::onLatencyStats(void (*latencyStatsHandler)()) {
+    this->latencyStatsHandler = latencyStatsHandler;
+}
+
+void ConsoleClass::onTaskStats(void (*taskStatsHandler)()) {
+    this->taskStatsHandler = taskStatsHandler;
+}
+
+void ConsoleClass::onHeapStats(void (*heapStatsHandler)()) {
+    this->heapStatsHandler = heapStatsHandler;
+}
+
 void ConsoleClass::setMqttConfig(String broker, int port, String username, String password, String conChan, String statChan) {
     this->_mqttBroker = broker;
     this->_mqttPort = port;
@@ -239,10 +251,13 @@ void ConsoleClass::displayMenu() {
     Serial.println(F("= g: Get network info        ="));
     Serial.println(F("= f: Save config changes     ="));
     Serial.println(F("= z: Restore default config  ="));
+    Serial.println(F("= l: Show fob latency stats  ="));
+    Serial.println(F("= p: Show task/queue stats   ="));
+    Serial.println(F("= h: Show heap stats         ="));
     Serial.println(F("=                            ="));
     Serial.println(F("=============================="));
     Serial.println();
-    Serial.println(F("Enter command choice (r/c/m/s/n/w/e/g/f/z): "));
+    Serial.println(F("Enter command choice (r/c/m/s/n/w/e/g/f/z/l/p/h): "));
     this->waitForUserInput();
 }
 
@@ -344,6 +359,27 @@ void ConsoleClass::checkCommand() {
                 this->factoryRestoreHandler();
             }
             break;
+        case 'l':
+            if (this->latencyStatsHandler != NULL) {
+                this->latencyStatsHandler();
+            }
+
+            this->enterCommandInterpreter();
+            break;
+        case 'p':
+            if (this->taskStatsHandler != NULL) {
+                this->taskStatsHandler();
+            }
+
+            this->enterCommandInterpreter();
+            break;
+        case 'h':
+            if (this->heapStatsHandler != NULL) {
+                this->heapStatsHandler();
+            }
+
+            this->enterCommandInterpreter();
+            break;
         default:
             // Specified command is invalid.
             Serial.println(F("WARN: Unrecognized command."));
@@ -1,93 +1,390 @@
 #include "Doors.h"
 
-DoorManagerClass::DoorManagerClass() {}
+DoorManagerClass::DoorManagerClass() {
+	this->_changeHandler = NULL;
+	this->_count = 0;
+	this->clearDoors();
+}
+
+bool DoorManagerClass::attachDoor(const Door& door) {
+	if (this->_count >= DOOR_MAX_DOORS) {
+		return false;
+	}
+
+	uint8_t id = this->_count;
+	this->_doors[id] = door;
+	this->_doors[id].name[DOOR_NAME_SIZE - 1] = '\0';
+	this->_enabled[id] = true;
+	this->_state[id] = DoorState::UNKNOWN;
+	this->_lockState[id] = LockState::LOCKED;  // Lock relays are de-energized at boot.
+	if (this->_doors[id].unlockMs == 0) {
+		this->_doors[id].unlockMs = DOOR_DEFAULT_UNLOCK_TIME;
+	}
+
+	this->_count++;
+	this->indexDoor(id);
+	return true;
+}
 
-void DoorManagerClass::attachDoor(Door door) {
-	if (_doors.size() < 4) {
-		_doors.push_back(door);
+bool DoorManagerClass::attachReader(uint8_t doorId, Reader reader) {
+	if (doorId < this->_count && this->_doors[doorId].readerCount < DOOR_MAX_READERS) {
+		Door* d = &this->_doors[doorId];
+		d->readers[d->readerCount++] = reader;
+		indexDevice(this->_readerDoor, DOOR_INDEX_DEVICES, reader.id, doorId);
+		return true;
 	}
+
+	return false;
 }
 
-void DoorManagerClass::attachReader(uint8_t doorId, Reader reader) {
-	if (doorId >= 0 && doorId < _doors.size()) {
-		_doors.at(doorId).readers.push_back(reader);
+bool DoorManagerClass::attachKeypad(uint8_t doorId, DoorKeypad keypad) {
+	if (doorId < this->_count && this->_doors[doorId].keypadCount < DOOR_MAX_KEYPADS) {
+		Door* d = &this->_doors[doorId];
+		d->keypads[d->keypadCount++] = keypad;
+		indexDevice(this->_keypadDoor, DOOR_INDEX_DEVICES, keypad.id, doorId);
+		return true;
 	}
+
+	return false;
 }
 
-void DoorManagerClass::attachKeypad(uint8_t doorId, DoorKeypad keypad) {
-	if (doorId >= 0 && doorId < _doors.size()) {
-		_doors.at(doorId).keypads.push_back(keypad);
+bool DoorManagerClass::attachInput(uint8_t doorId, DoorInput input) {
+	if (doorId < this->_count && this->_doors[doorId].inputCount < DOOR_MAX_INPUTS) {
+		Door* d = &this->_doors[doorId];
+		d->inputs[d->inputCount++] = input;
+		if (input.moduleId < DOOR_INDEX_MODULES) {
+			indexDevice(&this->_inputDoor[input.moduleId * DOOR_INDEX_INPUTS], DOOR_INDEX_INPUTS, input.inputId, doorId);
+		}
+
+		return true;
 	}
+
+	return false;
 }
 
 void DoorManagerClass::attachLockRelay(uint8_t doorId, LockRelay relay) {
-	if (doorId >= 0 && doorId < _doors.size()) {
-		_doors.at(doorId).lockRelay = relay;
+	if (doorId < this->_count) {
+		this->_doors[doorId].lockRelay = relay;
+	}
+}
+
+uint8_t DoorManagerClass::getDoorCount() const {
+	return this->_count;
+}
+
+const Door* DoorManagerClass::getDoor(uint8_t doorId) const {
+	if (doorId < this->_count) {
+		return &this->_doors[doorId];
+	}
+
+	return nullptr;
+}
+
+void DoorManagerClass::indexDevice(uint8_t* index, uint8_t size, uint8_t deviceId, uint8_t doorId) {
+	if (deviceId >= size) {
+		Serial.print(F("WARN: [DOOR] Device ID out of index range: "));
+		Serial.println(deviceId);
+		return;
+	}
+
+	if (index[deviceId] != DOOR_NONE && index[deviceId] != doorId) {
+		Serial.print(F("WARN: [DOOR] Device "));
+		Serial.print(deviceId);
+		Serial.print(F(" already belongs to door "));
+		Serial.println(index[deviceId]);
+		return;
+	}
+
+	index[deviceId] = doorId;
+}
+
+void DoorManagerClass::indexDoor(uint8_t doorId) {
+	const Door* d = &this->_doors[doorId];
+	for (uint8_t i = 0; i < d->readerCount; i++) {
+		indexDevice(this->_readerDoor, DOOR_INDEX_DEVICES, d->readers[i].id, doorId);
 	}
+
+	for (uint8_t i = 0; i < d->keypadCount; i++) {
+		indexDevice(this->_keypadDoor, DOOR_INDEX_DEVICES, d->keypads[i].id, doorId);
+	}
+
+	for (uint8_t i = 0; i < d->inputCount; i++) {
+		uint8_t moduleId = d->inputs[i].moduleId;
+		if (moduleId < DOOR_INDEX_MODULES) {
+			indexDevice(&this->_inputDoor[moduleId * DOOR_INDEX_INPUTS], DOOR_INDEX_INPUTS, d->inputs[i].inputId, doorId);
+		}
+	}
+}
+
+uint8_t DoorManagerClass::getDoorForReader(uint8_t readerId) const {
+	return readerId < DOOR_INDEX_DEVICES ? this->_readerDoor[readerId] : DOOR_NONE;
 }
 
-DoorState DoorManagerClass::getDoorState(uint8_t doorId) {
-	if (doorId >= 0 && doorId < _doors.size()) {
-		return _doors.at(doorId).state;
+uint8_t DoorManagerClass::getDoorForKeypad(uint8_t keypadId) const {
+	return keypadId < DOOR_INDEX_DEVICES ? this->_keypadDoor[keypadId] : DOOR_NONE;
+}
+
+uint8_t DoorManagerClass::getDoorForInput(uint8_t moduleId, uint8_t inputId) const {
+	if (moduleId < DOOR_INDEX_MODULES && inputId < DOOR_INDEX_INPUTS) {
+		return this->_inputDoor[(moduleId * DOOR_INDEX_INPUTS) + inputId];
+	}
+
+	return DOOR_NONE;
+}
+
+uint8_t DoorManagerClass::getDoorForRelay(uint8_t moduleId, uint8_t relayId) const {
+	// One lock relay per door, so a scan is as cheap as an index.
+	for (uint8_t i = 0; i < this->_count; i++) {
+		if (this->_doors[i].lockRelay.moduleId == moduleId && this->_doors[i].lockRelay.relayId == relayId) {
+			return i;
+		}
+	}
+
+	return DOOR_NONE;
+}
+
+bool DoorManagerClass::isEnabled(uint8_t doorId) const {
+	return doorId < this->_count && this->_enabled[doorId];
+}
+
+DoorState DoorManagerClass::getDoorState(uint8_t doorId) const {
+	if (doorId < this->_count) {
+		return this->_state[doorId];
 	}
 
 	return DoorState::UNKNOWN;
 }
 
-LockState DoorManagerClass::getLockState(uint8_t doorId) {
-	if (doorId >= 0 && doorId < _doors.size()) {
-		return _doors.at(doorId).lockState;
+LockState DoorManagerClass::getLockState(uint8_t doorId) const {
+	if (doorId < this->_count) {
+		return this->_lockState[doorId];
 	}
 
 	return LockState::UNKNOWN;
 }
 
+void DoorManagerClass::notify(uint8_t doorId, DoorField field) {
+	if (this->_changeHandler != NULL) {
+		this->_changeHandler(doorId, field);
+	}
+}
+
+void DoorManagerClass::setDoorState(uint8_t doorId, DoorState state) {
+	if (doorId < this->_count && this->_state[doorId] != state) {
+		this->_state[doorId] = state;
+		this->notify(doorId, DoorField::STATE);
+	}
+}
+
 void DoorManagerClass::enableDoor(uint8_t doorId) {
-	if (doorId >= 0 && doorId < _doors.size()) {
-		_doors.at(doorId).enabled = true;
-		// TODO Fire handler indicating status change?
+	if (doorId < this->_count && !this->_enabled[doorId]) {
+		this->_enabled[doorId] = true;
+		this->notify(doorId, DoorField::ENABLED);
 	}
 }
 
 void DoorManagerClass::disableDoor(uint8_t doorId) {
-	if (doorId >= 0 && doorId < _doors.size()) {
-		_doors.at(doorId).enabled = false;
-		// TODO Fire handler indicating status change?
+	if (doorId < this->_count && this->_enabled[doorId]) {
+		// Don't leave a momentary unlock behind on a door we stop managing.
+		if (this->_relockPending[doorId]) {
+			this->onAccessTimeout(doorId);
+		}
+
+		TimerWheel.cancel(this->_accessTimer[doorId]);
+		TimerWheel.cancel(this->_heldTimer[doorId]);
+		this->_accessTimer[doorId] = TIMER_WHEEL_INVALID;
+		this->_heldTimer[doorId] = TIMER_WHEEL_INVALID;
+		this->_authorized[doorId] = false;
+		this->_enabled[doorId] = false;
+		this->notify(doorId, DoorField::ENABLED);
 	}
 }
 
 void DoorManagerClass::lockDoor(uint8_t doorId) {
-	if (doorId >= 0 && doorId < _doors.size()) {
-		Door d = _doors.at(doorId);
-		if (d.enabled) {
-			d.lockState = LockState::LOCKED;
-			// TODO Fire handler for triggering relay?
-		}
+	if (doorId < this->_count && this->_enabled[doorId] && this->_lockState[doorId] != LockState::LOCKED) {
+		this->_lockState[doorId] = LockState::LOCKED;
+		this->notify(doorId, DoorField::LOCK_STATE);
 	}
 }
 
 void DoorManagerClass::unlockDoor(uint8_t doorId) {
-	if (doorId >= 0 && doorId < _doors.size()) {
-		Door d = _doors.at(doorId);
-		if (d.enabled) {
-			d.lockState = LockState::UNLOCKED;
-			// TODO Fire handler for triggering relay?
+	if (doorId < this->_count && this->_enabled[doorId] && this->_lockState[doorId] != LockState::UNLOCKED) {
+		this->_lockState[doorId] = LockState::UNLOCKED;
+		this->notify(doorId, DoorField::LOCK_STATE);
+	}
+}
+
+const DoorInput* DoorManagerClass::findInput(uint8_t doorId, uint8_t moduleId, uint8_t inputId) const {
+	const Door* d = &this->_doors[doorId];
+	for (uint8_t i = 0; i < d->inputCount; i++) {
+		if (d->inputs[i].moduleId == moduleId && d->inputs[i].inputId == inputId) {
+			return &d->inputs[i];
+		}
+	}
+
+	return nullptr;
+}
+
+void DoorManagerClass::accessTimerExpired(uint32_t arg) {
+	DoorManager.onAccessTimeout((uint8_t)arg);
+}
+
+void DoorManagerClass::heldOpenTimerExpired(uint32_t arg) {
+	DoorManager.onHeldOpenTimeout((uint8_t)arg);
+}
+
+void DoorManagerClass::openAccessWindow(uint8_t doorId, bool unlock) {
+	this->_authorized[doorId] = true;
+	if (unlock && this->_lockState[doorId] != LockState::UNLOCKED) {
+		this->_relockPending[doorId] = true;
+		this->unlockDoor(doorId);
+	}
+
+	// A second grant during the window restarts it.
+	TimerWheel.cancel(this->_accessTimer[doorId]);
+	this->_accessTimer[doorId] = TimerWheel.schedule(this->_doors[doorId].unlockMs, accessTimerExpired, doorId);
+	if (this->_accessTimer[doorId] == TIMER_WHEEL_INVALID) {
+		Serial.println(F("ERROR: [DOOR] No free timers. Relocking now."));
+		this->onAccessTimeout(doorId);
+	}
+}
+
+void DoorManagerClass::grantAccess(uint8_t doorId) {
+	if (doorId < this->_count && this->_enabled[doorId]) {
+		this->openAccessWindow(doorId, true);
+	}
+}
+
+void DoorManagerClass::onAccessTimeout(uint8_t doorId) {
+	this->_accessTimer[doorId] = TIMER_WHEEL_INVALID;
+	if (this->_relockPending[doorId]) {
+		this->_relockPending[doorId] = false;
+		this->lockDoor(doorId);
+	}
+
+	// An opening in progress stays authorized until the door closes.
+	if (!this->_contactOpen[doorId]) {
+		this->_authorized[doorId] = false;
+	}
+}
+
+void DoorManagerClass::onHeldOpenTimeout(uint8_t doorId) {
+	this->_heldTimer[doorId] = TIMER_WHEEL_INVALID;
+	if (this->_contactOpen[doorId] && this->_state[doorId] == DoorState::OPEN) {
+		this->setDoorState(doorId, DoorState::HELD_OPEN);
+	}
+}
+
+void DoorManagerClass::onContactChange(uint8_t doorId, bool open) {
+	this->_contactOpen[doorId] = open;
+	if (open) {
+		bool expected = this->_authorized[doorId] || this->_lockState[doorId] == LockState::UNLOCKED;
+		if (!expected) {
+			this->setDoorState(doorId, DoorState::FORCED_OPEN);
+			return;
 		}
+
+		this->setDoorState(doorId, DoorState::OPEN);
+		uint32_t heldOpenMs = this->_doors[doorId].heldOpenMs;
+		if (heldOpenMs > 0) {
+			TimerWheel.cancel(this->_heldTimer[doorId]);
+			this->_heldTimer[doorId] = TimerWheel.schedule(heldOpenMs, heldOpenTimerExpired, doorId);
+		}
+
+		return;
+	}
+
+	// Closing ends the access window; a momentary unlock relocks right away.
+	TimerWheel.cancel(this->_heldTimer[doorId]);
+	TimerWheel.cancel(this->_accessTimer[doorId]);
+	this->_heldTimer[doorId] = TIMER_WHEEL_INVALID;
+	this->_accessTimer[doorId] = TIMER_WHEEL_INVALID;
+	if (this->_relockPending[doorId]) {
+		this->_relockPending[doorId] = false;
+		this->lockDoor(doorId);
 	}
+
+	this->_authorized[doorId] = false;
+	this->setDoorState(doorId, DoorState::CLOSED);
+}
+
+void DoorManagerClass::onInputChange(uint8_t moduleId, uint8_t inputId, bool active) {
+	uint8_t doorId = this->getDoorForInput(moduleId, inputId);
+	if (doorId == DOOR_NONE || !this->_enabled[doorId]) {
+		return;
+	}
+
+	const DoorInput* input = this->findInput(doorId, moduleId, inputId);
+	if (input == nullptr) {
+		return;
+	}
+
+	if (input->invert) {
+		active = !active;
+	}
+
+	switch (input->type) {
+		case InputType::DOORCONTACT:
+			if (active != this->_contactOpen[doorId]) {
+				this->onContactChange(doorId, active);
+			}
+			break;
+		case InputType::REX:
+		case InputType::BUTTON:
+		case InputType::CRASHBAR:
+			if (active) {
+				this->openAccessWindow(doorId, this->_doors[doorId].rexUnlock);
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+void DoorManagerClass::syncInput(uint8_t moduleId, uint8_t inputId, bool active) {
+	// Takes on the current contact state without raising alarms (ie. at boot).
+	uint8_t doorId = this->getDoorForInput(moduleId, inputId);
+	if (doorId == DOOR_NONE) {
+		return;
+	}
+
+	const DoorInput* input = this->findInput(doorId, moduleId, inputId);
+	if (input == nullptr || input->type != InputType::DOORCONTACT) {
+		return;
+	}
+
+	bool open = input->invert ? !active : active;
+	this->_contactOpen[doorId] = open;
+	this->setDoorState(doorId, open ? DoorState::OPEN : DoorState::CLOSED);
 }
 
 void DoorManagerClass::clearDoors() {
-	for (auto door = _doors.begin(); door != _doors.end(); door++) {
-		door->inputs.clear();
-		door->keypads.clear();
-		door->readers.clear();
+	for (uint8_t i = 0; i < DOOR_MAX_DOORS; i++) {
+		if (i < this->_count) {
+			TimerWheel.cancel(this->_accessTimer[i]);
+			TimerWheel.cancel(this->_heldTimer[i]);
+		}
+
+		this->_enabled[i] = false;
+		this->_state[i] = DoorState::UNKNOWN;
+		this->_lockState[i] = LockState::UNKNOWN;
+		this->_contactOpen[i] = false;
+		this->_authorized[i] = false;
+		this->_relockPending[i] = false;
+		this->_accessTimer[i] = TIMER_WHEEL_INVALID;
+		this->_heldTimer[i] = TIMER_WHEEL_INVALID;
 	}
 
-	_doors.clear();
+	memset(this->_doors, 0, sizeof(this->_doors));
+
+	memset(this->_readerDoor, DOOR_NONE, sizeof(this->_readerDoor));
+	memset(this->_keypadDoor, DOOR_NONE, sizeof(this->_keypadDoor));
+	memset(this->_inputDoor, DOOR_NONE, sizeof(this->_inputDoor));
+	this->_count = 0;
 }
 
-vector<Door> DoorManagerClass::getDoors() {
-	return _doors;
+void DoorManagerClass::onStateChange(DoorChangeHandler handler) {
+	this->_changeHandler = handler;
 }
 
 DoorManagerClass DoorManager;
\ No newline at end of file
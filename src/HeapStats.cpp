@@ -0,0 +1,169 @@
+#include "HeapStats.h"
+#ifdef NATIVE
+#include <cstdlib>
+#endif
+
+static const char* const heapSubsystemNames[HEAP_SUBSYSTEM_COUNT] = {
+	"config",
+	"doors",
+	"rules",
+	"status"
+};
+
+#ifdef NATIVE
+static void printHeapStatsAtExit() {
+	// Native runs end with quick_exit() (see VirtualClock). Leave the
+	// numbers behind for leak and regression checks.
+	HeapStats.print();
+	Serial.flush();
+}
+#endif
+
+HeapStatsClass::HeapStatsClass() {
+	memset(this->_usage, 0, sizeof(this->_usage));
+	memset(&this->_snapshot, 0, sizeof(this->_snapshot));
+	this->_snapshot.minLargest = UINT32_MAX;
+	this->_lastSample = 0;
+	this->_mux = portMUX_INITIALIZER_UNLOCKED;
+}
+
+void HeapStatsClass::begin() {
+	this->_snapshot.size = ESP.getHeapSize();
+	this->sample();
+	#ifdef NATIVE
+	at_quick_exit(printHeapStatsAtExit);
+	#endif
+}
+
+void HeapStatsClass::charge(uint8_t subsystem, uint32_t size) {
+	portENTER_CRITICAL(&this->_mux);
+	HeapUsage* usage = &this->_usage[subsystem];
+	usage->current += size;
+	usage->allocations++;
+	if (usage->current > usage->peak) {
+		usage->peak = usage->current;
+	}
+	portEXIT_CRITICAL(&this->_mux);
+}
+
+void HeapStatsClass::release(uint8_t subsystem, uint32_t size) {
+	portENTER_CRITICAL(&this->_mux);
+	this->_usage[subsystem].current -= size;
+	portEXIT_CRITICAL(&this->_mux);
+}
+
+void* HeapStatsClass::allocate(HeapSubsystem subsystem, size_t size) {
+	uint8_t index = (uint8_t)subsystem < HEAP_SUBSYSTEM_COUNT ? (uint8_t)subsystem : 0;
+	Header* header = (Header*)malloc(sizeof(Header) + size);
+	if (header == nullptr) {
+		portENTER_CRITICAL(&this->_mux);
+		this->_usage[index].failures++;
+		portEXIT_CRITICAL(&this->_mux);
+		return nullptr;
+	}
+
+	header->size = size;
+	header->subsystem = index;
+	this->charge(index, size);
+	return header + 1;
+}
+
+void* HeapStatsClass::reallocate(void* ptr, size_t size) {
+	if (ptr == nullptr) {
+		return nullptr;
+	}
+
+	Header* header = (Header*)ptr - 1;
+	uint8_t index = header->subsystem;
+	uint32_t oldSize = header->size;
+	Header* resized = (Header*)realloc(header, sizeof(Header) + size);
+	if (resized == nullptr) {
+		// The original block is untouched and still charged.
+		portENTER_CRITICAL(&this->_mux);
+		this->_usage[index].failures++;
+		portEXIT_CRITICAL(&this->_mux);
+		return nullptr;
+	}
+
+	resized->size = size;
+	portENTER_CRITICAL(&this->_mux);
+	HeapUsage* usage = &this->_usage[index];
+	usage->current = usage->current - oldSize + size;
+	if (usage->current > usage->peak) {
+		usage->peak = usage->current;
+	}
+	portEXIT_CRITICAL(&this->_mux);
+	return resized + 1;
+}
+
+void HeapStatsClass::deallocate(void* ptr) {
+	if (ptr == nullptr) {
+		return;
+	}
+
+	Header* header = (Header*)ptr - 1;
+	this->release(header->subsystem, header->size);
+	free(header);
+}
+
+void HeapStatsClass::update(unsigned long now) {
+	if (now - this->_lastSample >= HEAP_STATS_SAMPLE_INTERVAL) {
+		this->_lastSample = now;
+		this->sample();
+	}
+}
+
+void HeapStatsClass::sample() {
+	HeapSnapshot* snapshot = &this->_snapshot;
+	snapshot->free = ESP.getFreeHeap();
+	snapshot->minFree = ESP.getMinFreeHeap();
+	snapshot->largest = ESP.getMaxAllocHeap();
+	if (snapshot->largest < snapshot->minLargest) {
+		snapshot->minLargest = snapshot->largest;
+	}
+
+	snapshot->fragmentation = snapshot->free > 0 && snapshot->largest < snapshot->free
+		? (uint8_t)(100 - ((uint64_t)snapshot->largest * 100) / snapshot->free)
+		: 0;
+}
+
+const HeapUsage* HeapStatsClass::getUsage(HeapSubsystem subsystem) {
+	return (uint8_t)subsystem < HEAP_SUBSYSTEM_COUNT ? &this->_usage[(uint8_t)subsystem] : nullptr;
+}
+
+const HeapSnapshot* HeapStatsClass::getSnapshot() {
+	return &this->_snapshot;
+}
+
+uint32_t HeapStatsClass::getOutstanding() {
+	uint32_t total = 0;
+	portENTER_CRITICAL(&this->_mux);
+	for (uint8_t i = 0; i < HEAP_SUBSYSTEM_COUNT; i++) {
+		total += this->_usage[i].current;
+	}
+	portEXIT_CRITICAL(&this->_mux);
+	return total;
+}
+
+const char* HeapStatsClass::getSubsystemName(HeapSubsystem subsystem) {
+	return (uint8_t)subsystem < HEAP_SUBSYSTEM_COUNT ? heapSubsystemNames[(uint8_t)subsystem] : "unknown";
+}
+
+void HeapStatsClass::print() {
+	const HeapSnapshot* snapshot = &this->_snapshot;
+	Serial.println();
+	Serial.println(F("INFO: [HEAP] Heap usage (bytes):"));
+	Serial.printf("size %lu, free %lu (low %lu), largest block %lu (low %lu), fragmentation %u%%\r\n",
+		(unsigned long)snapshot->size, (unsigned long)snapshot->free, (unsigned long)snapshot->minFree,
+		(unsigned long)snapshot->largest, (unsigned long)snapshot->minLargest, snapshot->fragmentation);
+	Serial.println(F("subsystem     current       peak     allocs   failures"));
+	for (uint8_t i = 0; i < HEAP_SUBSYSTEM_COUNT; i++) {
+		const HeapUsage* usage = &this->_usage[i];
+		Serial.printf("%-10s %10lu %10lu %10lu %10lu\r\n", heapSubsystemNames[i], (unsigned long)usage->current,
+			(unsigned long)usage->peak, (unsigned long)usage->allocations, (unsigned long)usage->failures);
+	}
+
+	Serial.println();
+}
+
+HeapStatsClass HeapStats;
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "InputFilter.h"
+
+InputFilterClass::InputFilterClass() {
+	this->_mux = portMUX_INITIALIZER_UNLOCKED;
+	for (uint8_t zone = 0; zone < INPUT_FILTER_ZONES; zone++) {
+		this->setDebounceTime(zone, INPUT_FILTER_DEFAULT_DEBOUNCE);
+	}
+
+	this->reset(0);
+}
+
+void InputFilterClass::reset(uint16_t state) {
+	portENTER_CRITICAL(&this->_mux);
+	this->_state = state;
+	this->_settling = 0;
+	for (uint8_t p = 0; p < INPUT_FILTER_PLANES; p++) {
+		this->_counter[p] = 0;
+	}
+
+	portEXIT_CRITICAL(&this->_mux);
+}
+
+void InputFilterClass::setDebounceTime(uint8_t zone, uint16_t debounceMs) {
+	if (zone >= INPUT_FILTER_ZONES) {
+		return;
+	}
+
+	// A threshold of 1 accepts a change on the first sample (no debounce).
+	uint16_t samples = (debounceMs + INPUT_FILTER_SAMPLE_INTERVAL - 1) / INPUT_FILTER_SAMPLE_INTERVAL;
+	samples = constrain(samples, 1, INPUT_FILTER_MAX_SAMPLES);
+
+	uint16_t bit = 1 << zone;
+	portENTER_CRITICAL(&this->_mux);
+	for (uint8_t p = 0; p < INPUT_FILTER_PLANES; p++) {
+		if (samples & (1 << p)) {
+			this->_threshold[p] |= bit;
+		}
+		else {
+			this->_threshold[p] &= ~bit;
+		}
+	}
+
+	portEXIT_CRITICAL(&this->_mux);
+}
+
+uint16_t InputFilterClass::getDebounceTime(uint8_t zone) {
+	if (zone >= INPUT_FILTER_ZONES) {
+		return 0;
+	}
+
+	uint16_t samples = 0;
+	for (uint8_t p = 0; p < INPUT_FILTER_PLANES; p++) {
+		if (this->_threshold[p] & (1 << zone)) {
+			samples |= (1 << p);
+		}
+	}
+
+	return samples * INPUT_FILTER_SAMPLE_INTERVAL;
+}
+
+uint16_t InputFilterClass::update(uint16_t raw) {
+	portENTER_CRITICAL(&this->_mux);
+
+	// Zones that read back their debounced value start over.
+	uint16_t diff = raw ^ this->_state;
+	for (uint8_t p = 0; p < INPUT_FILTER_PLANES; p++) {
+		this->_counter[p] &= diff;
+	}
+
+	// Ripple-carry increment of every differing zone's counter.
+	uint16_t carry = diff;
+	for (uint8_t p = 0; p < INPUT_FILTER_PLANES; p++) {
+		uint16_t next = this->_counter[p] & carry;
+		this->_counter[p] ^= carry;
+		carry = next;
+	}
+
+	// Zones whose counter reached their threshold take the new value.
+	uint16_t done = diff;
+	for (uint8_t p = 0; p < INPUT_FILTER_PLANES; p++) {
+		done &= ~(this->_counter[p] ^ this->_threshold[p]);
+	}
+
+	this->_state ^= done;
+	for (uint8_t p = 0; p < INPUT_FILTER_PLANES; p++) {
+		this->_counter[p] &= ~done;
+	}
+
+	this->_settling = diff & ~done;
+	uint16_t result = this->_state;
+	portEXIT_CRITICAL(&this->_mux);
+	return result;
+}
+
+uint16_t InputFilterClass::getState() {
+	return this->_state;
+}
+
+bool InputFilterClass::isSettling() {
+	return this->_settling != 0;
+}
+
+InputFilterClass InputFilter;
\ No newline at end of file
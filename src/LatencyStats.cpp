@@ -0,0 +1,118 @@
+#include "LatencyStats.h"
+
+// Upper bucket bounds (microseconds). Roughly 1-2.5-5 per decade, from
+// a local lookup up to an auth request that ran into its deadline.
+static const uint32_t latencyBounds[LATENCY_BOUND_COUNT] = {
+	100, 250, 500,
+	1000, 2500, 5000,
+	10000, 25000, 50000,
+	100000, 250000, 500000,
+	1000000, 2500000, 5000000
+};
+
+static const char* const latencyStageNames[LATENCY_STAGE_COUNT] = {
+	"readQueue",
+	"lookup",
+	"authQueue",
+	"authCheck",
+	"authReturn",
+	"actuate",
+	"total"
+};
+
+LatencyStatsClass::LatencyStatsClass() {
+	this->reset();
+}
+
+void LatencyStatsClass::add(LatencyHistogram* histogram, uint32_t elapsed) {
+	uint8_t bucket = 0;
+	while (bucket < LATENCY_BOUND_COUNT && elapsed > latencyBounds[bucket]) {
+		bucket++;
+	}
+
+	histogram->buckets[bucket]++;
+	histogram->count++;
+	histogram->sum += elapsed;
+	if (elapsed > histogram->max) {
+		histogram->max = elapsed;
+	}
+}
+
+void LatencyStatsClass::record(LatencyStage stage, uint32_t start, uint32_t end) {
+	if ((uint8_t)stage < LATENCY_STAGE_COUNT) {
+		add(&this->_stages[(uint8_t)stage], end - start);
+	}
+}
+
+void LatencyStatsClass::recordDoor(uint8_t doorId, uint32_t start, uint32_t end) {
+	if (doorId < DOOR_MAX_DOORS) {
+		add(&this->_doors[doorId], end - start);
+	}
+}
+
+const LatencyHistogram* LatencyStatsClass::getStage(LatencyStage stage) {
+	return (uint8_t)stage < LATENCY_STAGE_COUNT ? &this->_stages[(uint8_t)stage] : nullptr;
+}
+
+const LatencyHistogram* LatencyStatsClass::getDoor(uint8_t doorId) {
+	return doorId < DOOR_MAX_DOORS ? &this->_doors[doorId] : nullptr;
+}
+
+void LatencyStatsClass::reset() {
+	memset(this->_stages, 0, sizeof(this->_stages));
+	memset(this->_doors, 0, sizeof(this->_doors));
+}
+
+uint32_t LatencyStatsClass::getBound(uint8_t bucket) {
+	return bucket < LATENCY_BOUND_COUNT ? latencyBounds[bucket] : UINT32_MAX;
+}
+
+uint32_t LatencyStatsClass::getPercentile(const LatencyHistogram* histogram, uint8_t percent) {
+	// Only as precise as the buckets: this is the upper bound of the
+	// bucket the percentile falls in (or the max, if that is lower).
+	if (histogram->count == 0) {
+		return 0;
+	}
+
+	uint32_t rank = (uint32_t)(((uint64_t)histogram->count * percent + 99) / 100);
+	uint32_t seen = 0;
+	for (uint8_t i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+		seen += histogram->buckets[i];
+		if (seen >= rank) {
+			return min(getBound(i), histogram->max);
+		}
+	}
+
+	return histogram->max;
+}
+
+const char* LatencyStatsClass::getStageName(LatencyStage stage) {
+	return (uint8_t)stage < LATENCY_STAGE_COUNT ? latencyStageNames[(uint8_t)stage] : "unknown";
+}
+
+void LatencyStatsClass::printHistogram(const LatencyHistogram* histogram) {
+	uint32_t mean = histogram->count > 0 ? (uint32_t)(histogram->sum / histogram->count) : 0;
+	Serial.printf("%8lu %10lu %10lu %10lu %10lu\r\n", (unsigned long)histogram->count, (unsigned long)mean,
+		(unsigned long)getPercentile(histogram, 50), (unsigned long)getPercentile(histogram, 95), (unsigned long)histogram->max);
+}
+
+void LatencyStatsClass::print() {
+	Serial.println();
+	Serial.println(F("INFO: [LATENCY] Badge-to-unlock latency (microseconds):"));
+	Serial.println(F("stage         count       mean        p50        p95        max"));
+	for (uint8_t i = 0; i < LATENCY_STAGE_COUNT; i++) {
+		Serial.printf("%-12s", latencyStageNames[i]);
+		printHistogram(&this->_stages[i]);
+	}
+
+	for (uint8_t i = 0; i < DOOR_MAX_DOORS; i++) {
+		if (this->_doors[i].count > 0) {
+			Serial.printf("door %-7d", i);
+			printHistogram(&this->_doors[i]);
+		}
+	}
+
+	Serial.println();
+}
+
+LatencyStatsClass LatencyStats;
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "MqttOutbox.h"
+
+static_assert((MQTT_OUTBOX_DEPTH & (MQTT_OUTBOX_DEPTH - 1)) == 0, "MQTT_OUTBOX_DEPTH must be a power of 2");
+
+#define MQTT_OUTBOX_MASK (MQTT_OUTBOX_DEPTH - 1)
+
+MqttOutboxClass::MqttOutboxClass() {
+	for (uint32_t i = 0; i < MQTT_OUTBOX_DEPTH; i++) {
+		this->_slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	this->_enqueuePos.store(0, std::memory_order_relaxed);
+	this->_dequeuePos.store(0, std::memory_order_relaxed);
+	this->_queued.store(0, std::memory_order_relaxed);
+	this->_dropped.store(0, std::memory_order_relaxed);
+	this->_published = 0;
+	this->_coalesced = 0;
+	this->_failed = 0;
+}
+
+bool MqttOutboxClass::push(MqttTopic topic, const uint8_t* payload, size_t length, uint8_t coalesceKey, uint32_t context) {
+	if (length > MQTT_OUTBOX_SLOT_SIZE) {
+		this->_dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	Slot* slot;
+	uint32_t pos = this->_enqueuePos.load(std::memory_order_relaxed);
+	for (;;) {
+		slot = &this->_slots[pos & MQTT_OUTBOX_MASK];
+		uint32_t seq = slot->sequence.load(std::memory_order_acquire);
+		int32_t diff = (int32_t)(seq - pos);
+		if (diff == 0) {
+			if (this->_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		else if (diff < 0) {
+			// Full. The slot still holds a message from one lap ago.
+			this->_dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		else {
+			pos = this->_enqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	slot->topic = topic;
+	slot->coalesceKey = coalesceKey;
+	slot->length = length;
+	slot->context = context;
+	memcpy(slot->payload, payload, length);
+	slot->sequence.store(pos + 1, std::memory_order_release);
+	this->_queued.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+MqttOutboxClass::Slot* MqttOutboxClass::acquire() {
+	Slot* slot;
+	uint32_t pos = this->_dequeuePos.load(std::memory_order_relaxed);
+	for (;;) {
+		slot = &this->_slots[pos & MQTT_OUTBOX_MASK];
+		uint32_t seq = slot->sequence.load(std::memory_order_acquire);
+		int32_t diff = (int32_t)(seq - (pos + 1));
+		if (diff == 0) {
+			if (this->_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		else if (diff < 0) {
+			return nullptr;
+		}
+		else {
+			pos = this->_dequeuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	slot->position = pos;
+	return slot;
+}
+
+void MqttOutboxClass::release(Slot* slot) {
+	// Hand the slot back to producers for the next lap.
+	slot->sequence.store(slot->position + MQTT_OUTBOX_DEPTH, std::memory_order_release);
+}
+
+bool MqttOutboxClass::isSuperseded(const Slot* slot) {
+	if (slot->coalesceKey == MQTT_COALESCE_NONE) {
+		return false;
+	}
+
+	// Scan everything queued behind it. A slot that is claimed but not yet
+	// written is skipped; its producer hasn't published it yet.
+	uint32_t endPos = this->_enqueuePos.load(std::memory_order_acquire);
+	for (uint32_t pos = slot->position + 1; (int32_t)(endPos - pos) > 0; pos++) {
+		const Slot* later = &this->_slots[pos & MQTT_OUTBOX_MASK];
+		if (later->sequence.load(std::memory_order_acquire) != pos + 1) {
+			continue;
+		}
+
+		if (later->topic == slot->topic && later->coalesceKey == slot->coalesceKey) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+uint8_t MqttOutboxClass::drain(MqttPublishHandler handler, uint8_t maxMessages, MqttFailureHandler onFailure) {
+	uint8_t sent = 0;
+	Slot* slot;
+	while (sent < maxMessages && (slot = this->acquire()) != nullptr) {
+		if (this->isSuperseded(slot)) {
+			this->_coalesced++;
+		}
+		else if (handler(slot->topic, slot->payload, slot->length)) {
+			this->_published++;
+			sent++;
+		}
+		else {
+			this->_failed++;
+			sent++;
+			if (onFailure != nullptr) {
+				onFailure(slot->topic, slot->context);
+			}
+		}
+
+		this->release(slot);
+	}
+
+	return sent;
+}
+
+void MqttOutboxClass::getStats(MqttOutboxStats* stats) {
+	stats->queued = this->_queued.load(std::memory_order_relaxed);
+	stats->dropped = this->_dropped.load(std::memory_order_relaxed);
+	stats->published = this->_published;
+	stats->coalesced = this->_coalesced;
+	stats->failed = this->_failed;
+}
+
+MqttOutboxClass MqttOutbox;
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "ReactionManager.h"
+#include "HeapStats.h"
+
+ReactionManagerClass::ReactionManagerClass() {
+	this->_actions = nullptr;
+	this->_actionCount = 0;
+	memset(this->_offsets, 0, sizeof(this->_offsets));
+}
+
+int ReactionManagerClass::getKey(ReactionEvent event, uint8_t moduleId, uint8_t sourceId) {
+	if ((uint8_t)event >= REACTION_EVENT_TYPES || moduleId >= REACTION_MAX_MODULES || sourceId >= REACTION_MAX_SOURCES) {
+		return -1;
+	}
+
+	return (((uint8_t)event * REACTION_MAX_MODULES) + moduleId) * REACTION_MAX_SOURCES + sourceId;
+}
+
+void ReactionManagerClass::clear() {
+	vector<StagedRule>().swap(this->_staged);
+	if (this->_actions != nullptr) {
+		HeapStats.deallocate(this->_actions);
+		this->_actions = nullptr;
+	}
+
+	this->_actionCount = 0;
+	memset(this->_offsets, 0, sizeof(this->_offsets));
+}
+
+bool ReactionManagerClass::addRule(ReactionEvent event, uint8_t moduleId, uint8_t sourceId, ReactionAction action) {
+	int key = getKey(event, moduleId, sourceId);
+	if (key < 0 || this->_staged.size() >= REACTION_MAX_ACTIONS) {
+		return false;
+	}
+
+	StagedRule rule;
+	rule.key = (uint16_t)key;
+	rule.action = action;
+	this->_staged.push_back(rule);
+	return true;
+}
+
+bool ReactionManagerClass::compile() {
+	size_t count = this->_staged.size();
+	ReactionAction* actions = nullptr;
+	if (count > 0) {
+		actions = (ReactionAction*)HeapStats.allocate(HeapSubsystem::RULES, count * sizeof(ReactionAction));
+		if (actions == nullptr) {
+			return false;
+		}
+	}
+
+	// Counting sort by key. Rules keep their file order within a key.
+	uint16_t offsets[REACTION_TABLE_SIZE + 1];
+	memset(offsets, 0, sizeof(offsets));
+	for (auto r = this->_staged.begin(); r != this->_staged.end(); r++) {
+		offsets[r->key + 1]++;
+	}
+
+	for (uint16_t k = 0; k < REACTION_TABLE_SIZE; k++) {
+		offsets[k + 1] += offsets[k];
+	}
+
+	uint16_t fill[REACTION_TABLE_SIZE];
+	memcpy(fill, offsets, sizeof(fill));
+	for (auto r = this->_staged.begin(); r != this->_staged.end(); r++) {
+		actions[fill[r->key]++] = r->action;
+	}
+
+	if (this->_actions != nullptr) {
+		HeapStats.deallocate(this->_actions);
+	}
+
+	this->_actions = actions;
+	this->_actionCount = (uint16_t)count;
+	memcpy(this->_offsets, offsets, sizeof(this->_offsets));
+
+	// The staging area is only needed while building the table.
+	vector<StagedRule>().swap(this->_staged);
+	return true;
+}
+
+uint16_t ReactionManagerClass::getActions(ReactionEvent event, uint8_t moduleId, uint8_t sourceId, const ReactionAction** actions) {
+	int key = getKey(event, moduleId, sourceId);
+	if (key < 0 || this->_actions == nullptr) {
+		*actions = nullptr;
+		return 0;
+	}
+
+	*actions = &this->_actions[this->_offsets[key]];
+	return this->_offsets[key + 1] - this->_offsets[key];
+}
+
+uint16_t ReactionManagerClass::getActionCount() {
+	return this->_actionCount;
+}
+
+ReactionManagerClass ReactionManager;
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "TaskStats.h"
+
+TaskStatsClass::TaskStatsClass() {
+	memset(this->_tasks, 0, sizeof(this->_tasks));
+	memset(this->_queues, 0, sizeof(this->_queues));
+	this->_taskCount = 0;
+	this->_queueCount = 0;
+	this->_loops = 0;
+	this->_loopRate = 0;
+	this->_lastCollect = 0;
+	#ifdef TASK_STATS_RUN_TIME
+	this->_lastTotalRunTime = 0;
+	#endif
+}
+
+void TaskStatsClass::watchTask(TaskHandle_t task, uint32_t stackSize) {
+	if (task == NULL || this->_taskCount >= TASK_STATS_MAX_TASKS) {
+		return;
+	}
+
+	TaskStatsTask* entry = &this->_tasks[this->_taskCount++];
+	entry->handle = task;
+	entry->stackSize = stackSize;
+	entry->stackFree = stackSize;
+	entry->cpu = TASK_STATS_CPU_UNKNOWN;
+	entry->lastRunTime = 0;
+}
+
+void TaskStatsClass::watchQueue(QueueHandle_t queue, const char* name) {
+	if (queue == NULL || this->_queueCount >= TASK_STATS_MAX_QUEUES) {
+		return;
+	}
+
+	TaskStatsQueue* entry = &this->_queues[this->_queueCount++];
+	entry->queue = queue;
+	entry->name = name;
+	entry->capacity = uxQueueMessagesWaiting(queue) + uxQueueSpacesAvailable(queue);
+}
+
+TaskStatsQueue* TaskStatsClass::findQueue(QueueHandle_t queue) {
+	for (uint8_t i = 0; i < this->_queueCount; i++) {
+		if (this->_queues[i].queue == queue) {
+			return &this->_queues[i];
+		}
+	}
+
+	return nullptr;
+}
+
+bool TaskStatsClass::send(QueueHandle_t queue, const void* item, TickType_t ticks) {
+	bool sent = xQueueSend(queue, item, ticks) == pdTRUE;
+	TaskStatsQueue* entry = this->findQueue(queue);
+	if (entry == nullptr) {
+		return sent;
+	}
+
+	if (sent) {
+		entry->sent++;
+		uint16_t depth = uxQueueMessagesWaiting(queue);
+		if (depth > entry->peak) {
+			entry->peak = depth;
+		}
+	}
+	else {
+		entry->overflows++;
+	}
+
+	return sent;
+}
+
+void TaskStatsClass::countLoop() {
+	this->_loops++;
+}
+
+void TaskStatsClass::collectRunTime() {
+	#ifdef TASK_STATS_RUN_TIME
+	uint32_t totalRunTime = 0;
+	UBaseType_t count = uxTaskGetSystemState(this->_system, TASK_STATS_SYSTEM_TASKS, &totalRunTime);
+	uint32_t elapsed = totalRunTime - this->_lastTotalRunTime;
+	this->_lastTotalRunTime = totalRunTime;
+	for (uint8_t i = 0; i < this->_taskCount; i++) {
+		TaskStatsTask* task = &this->_tasks[i];
+		task->cpu = TASK_STATS_CPU_UNKNOWN;
+		for (UBaseType_t j = 0; j < count; j++) {
+			if (this->_system[j].xHandle == task->handle) {
+				uint32_t ran = this->_system[j].ulRunTimeCounter - task->lastRunTime;
+				task->lastRunTime = this->_system[j].ulRunTimeCounter;
+				if (elapsed > 0) {
+					task->cpu = (uint16_t)(((uint64_t)ran * 1000) / elapsed);
+				}
+				break;
+			}
+		}
+	}
+	#endif
+}
+
+void TaskStatsClass::collect(unsigned long now) {
+	// Rates cover the time since the previous collection.
+	unsigned long elapsed = now - this->_lastCollect;
+	this->_loopRate = elapsed > 0 ? (uint32_t)(((uint64_t)this->_loops * 1000) / elapsed) : 0;
+	this->_loops = 0;
+	this->_lastCollect = now;
+
+	for (uint8_t i = 0; i < this->_taskCount; i++) {
+		TaskStatsTask* task = &this->_tasks[i];
+		task->stackFree = uxTaskGetStackHighWaterMark(task->handle);
+	}
+
+	for (uint8_t i = 0; i < this->_queueCount; i++) {
+		TaskStatsQueue* queue = &this->_queues[i];
+		queue->depth = uxQueueMessagesWaiting(queue->queue);
+	}
+
+	this->collectRunTime();
+}
+
+uint8_t TaskStatsClass::getTaskCount() {
+	return this->_taskCount;
+}
+
+const TaskStatsTask* TaskStatsClass::getTask(uint8_t index) {
+	return index < this->_taskCount ? &this->_tasks[index] : nullptr;
+}
+
+uint8_t TaskStatsClass::getQueueCount() {
+	return this->_queueCount;
+}
+
+const TaskStatsQueue* TaskStatsClass::getQueue(uint8_t index) {
+	return index < this->_queueCount ? &this->_queues[index] : nullptr;
+}
+
+uint32_t TaskStatsClass::getLoopRate() {
+	return this->_loopRate;
+}
+
+void TaskStatsClass::print() {
+	Serial.println();
+	Serial.print(F("INFO: [TASKS] Main loop rate: "));
+	Serial.print(this->_loopRate);
+	Serial.println(F(" /s"));
+	Serial.println(F("task                   stack       free    cpu (0.1%)"));
+	for (uint8_t i = 0; i < this->_taskCount; i++) {
+		const TaskStatsTask* task = &this->_tasks[i];
+		Serial.printf("%-20s %7lu %10lu ", pcTaskGetTaskName(task->handle),
+			(unsigned long)task->stackSize, (unsigned long)task->stackFree);
+		if (task->cpu == TASK_STATS_CPU_UNKNOWN) {
+			Serial.println(F("       n/a"));
+		}
+		else {
+			Serial.printf("%10u\r\n", task->cpu);
+		}
+	}
+
+	Serial.println();
+	Serial.println(F("queue           capacity  depth   peak       sent  overflows"));
+	for (uint8_t i = 0; i < this->_queueCount; i++) {
+		const TaskStatsQueue* queue = &this->_queues[i];
+		Serial.printf("%-15s %8u %6u %6u %10lu %10lu\r\n", queue->name, queue->capacity, queue->depth,
+			queue->peak, (unsigned long)queue->sent, (unsigned long)queue->overflows);
+	}
+
+	Serial.println();
+}
+
+TaskStatsClass TaskStats;
\ No newline at end of file
@@ -39,4 +39,22 @@ String TelemetryHelper::getMqttStateDesc(int state) {
             break;
     }
     return desc;
+}
+
+size_t TelemetryHelper::serializePayload(const JsonDocument& doc, char* buffer, size_t size, PayloadFormat format) {
+    if (format == PayloadFormat::MSGPACK) {
+        return serializeMsgPack(doc, buffer, size);
+    }
+
+    return serializeJson(doc, buffer, size);
+}
+
+DeserializationError TelemetryHelper::deserializePayload(JsonDocument& doc, byte* payload, size_t length, PayloadFormat format) {
+    // A mutable buffer puts ArduinoJson in zero-copy mode: strings in the
+    // document point into the payload, which is modified in place.
+    if (format == PayloadFormat::MSGPACK) {
+        return deserializeMsgPack(doc, (char*)payload, length);
+    }
+
+    return deserializeJson(doc, (char*)payload, length);
 }
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "TimerWheel.h"
+
+TimerWheelClass::TimerWheelClass() {
+	for (uint8_t i = 0; i < TIMER_WHEEL_MAX_TIMERS; i++) {
+		this->_nodes[i].generation = 1;
+	}
+
+	this->begin(0);
+}
+
+void TimerWheelClass::begin(unsigned long now) {
+	memset(this->_slots, TIMER_WHEEL_NIL, sizeof(this->_slots));
+	for (uint8_t i = 0; i < TIMER_WHEEL_MAX_TIMERS; i++) {
+		Node* node = &this->_nodes[i];
+		node->active = false;
+		node->callback = nullptr;
+		node->next = (i + 1 < TIMER_WHEEL_MAX_TIMERS) ? i + 1 : TIMER_WHEEL_NIL;
+		node->prev = TIMER_WHEEL_NIL;
+	}
+
+	this->_freeList = 0;
+	this->_activeCount = 0;
+	this->_tick = 0;
+	this->_lastAdvance = now;
+}
+
+void TimerWheelClass::link(uint8_t index) {
+	Node* node = &this->_nodes[index];
+	uint32_t delta = node->expires - this->_tick;
+
+	// Pick the finest level whose span covers the remaining time.
+	uint8_t level = 0;
+	while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1UL << (TIMER_WHEEL_SLOT_BITS * (level + 1)))) {
+		level++;
+	}
+
+	node->level = level;
+	node->slot = (node->expires >> (TIMER_WHEEL_SLOT_BITS * level)) & (TIMER_WHEEL_SLOTS - 1);
+	node->prev = TIMER_WHEEL_NIL;
+	node->next = this->_slots[level][node->slot];
+	if (node->next != TIMER_WHEEL_NIL) {
+		this->_nodes[node->next].prev = index;
+	}
+
+	this->_slots[level][node->slot] = index;
+}
+
+void TimerWheelClass::unlink(uint8_t index) {
+	Node* node = &this->_nodes[index];
+	if (node->prev != TIMER_WHEEL_NIL) {
+		this->_nodes[node->prev].next = node->next;
+	}
+	else {
+		this->_slots[node->level][node->slot] = node->next;
+	}
+
+	if (node->next != TIMER_WHEEL_NIL) {
+		this->_nodes[node->next].prev = node->prev;
+	}
+
+	node->next = TIMER_WHEEL_NIL;
+	node->prev = TIMER_WHEEL_NIL;
+}
+
+uint8_t TimerWheelClass::nodeFor(wheel_timer_t timer) {
+	uint8_t index = timer & 0xFF;
+	if (timer == TIMER_WHEEL_INVALID || index >= TIMER_WHEEL_MAX_TIMERS) {
+		return TIMER_WHEEL_NIL;
+	}
+
+	Node* node = &this->_nodes[index];
+	if (!node->active || node->generation != (timer >> 8)) {
+		return TIMER_WHEEL_NIL;
+	}
+
+	return index;
+}
+
+wheel_timer_t TimerWheelClass::schedule(unsigned long delayMs, TimerWheelCallback callback, uint32_t arg) {
+	if (callback == nullptr || this->_freeList == TIMER_WHEEL_NIL) {
+		return TIMER_WHEEL_INVALID;
+	}
+
+	// Round up so a timer never fires early. A zero delay fires on the next tick.
+	uint32_t ticks = (delayMs + TIMER_WHEEL_TICK - 1) / TIMER_WHEEL_TICK;
+	ticks = constrain(ticks, 1, TIMER_WHEEL_MAX_TICKS);
+
+	uint8_t index = this->_freeList;
+	Node* node = &this->_nodes[index];
+	this->_freeList = node->next;
+
+	node->expires = this->_tick + ticks;
+	node->callback = callback;
+	node->arg = arg;
+	node->active = true;
+	this->link(index);
+	this->_activeCount++;
+	return ((wheel_timer_t)node->generation << 8) | index;
+}
+
+void TimerWheelClass::release(uint8_t index) {
+	Node* node = &this->_nodes[index];
+	node->active = false;
+	node->generation = (node->generation == 0xFF) ? 1 : node->generation + 1;
+	node->next = this->_freeList;
+	this->_freeList = index;
+	this->_activeCount--;
+}
+
+bool TimerWheelClass::cancel(wheel_timer_t timer) {
+	uint8_t index = this->nodeFor(timer);
+	if (index == TIMER_WHEEL_NIL) {
+		return false;
+	}
+
+	this->unlink(index);
+	this->release(index);
+	return true;
+}
+
+bool TimerWheelClass::isPending(wheel_timer_t timer) {
+	return this->nodeFor(timer) != TIMER_WHEEL_NIL;
+}
+
+void TimerWheelClass::cascade(uint8_t level) {
+	uint8_t slot = (this->_tick >> (TIMER_WHEEL_SLOT_BITS * level)) & (TIMER_WHEEL_SLOTS - 1);
+	uint8_t index = this->_slots[level][slot];
+	this->_slots[level][slot] = TIMER_WHEEL_NIL;
+	while (index != TIMER_WHEEL_NIL) {
+		uint8_t next = this->_nodes[index].next;
+		this->link(index);
+		index = next;
+	}
+}
+
+void TimerWheelClass::advance(unsigned long now) {
+	unsigned long elapsed = now - this->_lastAdvance;
+	while (elapsed >= TIMER_WHEEL_TICK) {
+		elapsed -= TIMER_WHEEL_TICK;
+		this->_lastAdvance += TIMER_WHEEL_TICK;
+		this->_tick++;
+
+		// When a finer level wraps, the next slot of the level above is
+		// redistributed. Coarsest level first so its timers can fall all
+		// the way through.
+		for (uint8_t level = TIMER_WHEEL_LEVELS - 1; level > 0; level--) {
+			uint32_t mask = (1UL << (TIMER_WHEEL_SLOT_BITS * level)) - 1;
+			if ((this->_tick & mask) == 0) {
+				this->cascade(level);
+			}
+		}
+
+		if (this->_activeCount == 0) {
+			continue;
+		}
+
+		// Pop one timer at a time so callbacks may freely schedule or
+		// cancel other timers, including ones due on this same tick.
+		uint8_t slot = this->_tick & (TIMER_WHEEL_SLOTS - 1);
+		uint8_t index;
+		while ((index = this->_slots[0][slot]) != TIMER_WHEEL_NIL) {
+			Node* node = &this->_nodes[index];
+			TimerWheelCallback callback = node->callback;
+			uint32_t arg = node->arg;
+			this->unlink(index);
+			this->release(index);
+			callback(arg);
+		}
+	}
+}
+
+uint8_t TimerWheelClass::getActiveCount() {
+	return this->_activeCount;
+}
+
+TimerWheelClass TimerWheel;
\ No newline at end of file
@@ -1,8 +1,29 @@
 #include "drivers/CoreIO.h"
 
-CoreIOClass::CoreIOClass() {}
+static volatile TaskHandle_t zoneInputNotifyTask = NULL;
+
+static void IRAM_ATTR onZoneInputInterrupt() {
+	if (zoneInputNotifyTask == NULL) {
+		return;
+	}
+
+	BaseType_t higherPriorityTaskWoken = pdFALSE;
+	vTaskNotifyGiveFromISR(zoneInputNotifyTask, &higherPriorityTaskWoken);
+	if (higherPriorityTaskWoken) {
+		portYIELD_FROM_ISR();
+	}
+}
+
+CoreIOClass::CoreIOClass() {
+	this->_lastZones = 0;
+	this->_expanderInterrupt = false;
+}
 
 void CoreIOClass::init(Adafruit_MCP23017* controller) {
+	// Every expander access below (and in the other methods) is a bus
+	// transaction; the expander is shared by the input, heartbeat and main
+	// tasks.
+	I2CTransaction txn(PRIMARY_EXP_BUS_ADDRESS);
 	this->_controller = controller;
 	this->_controller->begin();
 
@@ -49,11 +70,17 @@ void CoreIOClass::init(Adafruit_MCP23017* controller) {
 }
 
 void CoreIOClass::armLedOn() {
-	this->_controller->digitalWrite(PIN_ARM_LED, HIGH);
+	I2CTransaction txn(PRIMARY_EXP_BUS_ADDRESS);
+	if (txn.isLocked()) {
+		this->_controller->digitalWrite(PIN_ARM_LED, HIGH);
+	}
 }
 
 void CoreIOClass::armLedOff() {
-	this->_controller->digitalWrite(PIN_ARM_LED, LOW);
+	I2CTransaction txn(PRIMARY_EXP_BUS_ADDRESS);
+	if (txn.isLocked()) {
+		this->_controller->digitalWrite(PIN_ARM_LED, LOW);
+	}
 }
 
 void CoreIOClass::heartbeatLedOn() {
@@ -69,6 +96,11 @@ void CoreIOClass::heartbeatLedFlash(unsigned long delayMs) {
 }
 
 uint8_t CoreIOClass::readDryContactZoneInput(OnboardDryContactInput input) {
+	I2CTransaction txn(PRIMARY_EXP_BUS_ADDRESS, I2CPriority::ELEVATED);
+	if (!txn.isLocked()) {
+		return bitRead(this->_lastZones, ZONE_DRY_CONTACT_SHIFT + (uint8_t)input);
+	}
+
 	return this->_controller->digitalRead(this->_dcInputs[(uint8_t)input]);
 }
 
@@ -84,9 +116,16 @@ uint8_t CoreIOClass::readOptoZoneInput(OnboardOptoZoneInput input) {
 			result = digitalRead(this->_localOptoInputs[(uint8_t)input]);
 			break;
 		case OnboardOptoZoneInput::ZONE_7:
-		case OnboardOptoZoneInput::ZONE_8:
+		case OnboardOptoZoneInput::ZONE_8: {
+			I2CTransaction txn(PRIMARY_EXP_BUS_ADDRESS, I2CPriority::ELEVATED);
+			if (!txn.isLocked()) {
+				result = bitRead(this->_lastZones, ZONE_OPTO_SHIFT + (uint8_t)input);
+				break;
+			}
+
 			result = this->_controller->digitalRead(this->_expOptoInputs[(uint8_t)input - 6]);
 			break;
+		}
 		default:
 			break;
 	}
@@ -94,7 +133,92 @@ uint8_t CoreIOClass::readOptoZoneInput(OnboardOptoZoneInput input) {
 	return result;
 }
 
+uint16_t CoreIOClass::readZoneInputs() {
+	// One I2C transaction fetches every expander input. Reading the port
+	// also clears a pending expander interrupt. If the bus can't be had,
+	// report the last state rather than a spurious edge.
+	uint16_t port;
+	{
+		I2CTransaction txn(PRIMARY_EXP_BUS_ADDRESS, I2CPriority::ELEVATED);
+		if (!txn.isLocked()) {
+			return this->_lastZones;
+		}
+
+		port = this->_controller->readGPIOAB();
+	}
+
+	uint16_t zones = (port & 0xFF) << ZONE_DRY_CONTACT_SHIFT;
+
+	// Opto zones 1 - 6 are native GPIOs, 7 and 8 are on port B.
+	for (uint8_t i = 0; i < sizeof(this->_localOptoInputs); i++) {
+		if (digitalRead(this->_localOptoInputs[i]) == HIGH) {
+			zones |= (1 << (ZONE_OPTO_SHIFT + i));
+		}
+	}
+
+	for (uint8_t j = 0; j < sizeof(this->_expOptoInputs); j++) {
+		if (port & (1 << this->_expOptoInputs[j])) {
+			zones |= (1 << (ZONE_OPTO_SHIFT + 6 + j));
+		}
+	}
+
+	this->_lastZones = zones;
+	return zones;
+}
+
+void CoreIOClass::enableInputInterrupts(TaskHandle_t notifyTask) {
+	zoneInputNotifyTask = notifyTask;
+
+	// Native opto inputs interrupt on any edge.
+	for (size_t i = 0; i < sizeof(this->_localOptoInputs); i++) {
+		attachInterrupt(digitalPinToInterrupt(this->_localOptoInputs[i]), onZoneInputInterrupt, CHANGE);
+	}
+
+	// Expander inputs interrupt-on-change. INTA/INTB are mirrored, push-pull
+	// and active-low, so any change on either port pulls PIN_EXP_INT low.
+	I2CTransaction txn(PRIMARY_EXP_BUS_ADDRESS);
+	this->_controller->setupInterrupts(true, false, LOW);
+	for (size_t j = 0; j < sizeof(this->_expOptoInputs); j++) {
+		this->_controller->setupInterruptPin(this->_expOptoInputs[j], CHANGE);
+	}
+
+	for (size_t k = 0; k < sizeof(this->_dcInputs); k++) {
+		this->_controller->setupInterruptPin(this->_dcInputs[k], CHANGE);
+	}
+
+	// Clear anything latched so far. While idle, the expander then drives
+	// INT high. Not every board routes INTA to PIN_EXP_INT, and with
+	// nothing connected the pull-down holds the pin low instead. In that
+	// case expander zones are polled (see inputTask()).
+	this->_controller->readGPIOAB();
+	pinMode(PIN_EXP_INT, INPUT_PULLDOWN);
+	delayMicroseconds(10);
+	this->_expanderInterrupt = digitalRead(PIN_EXP_INT) == HIGH;
+	if (!this->_expanderInterrupt) {
+		Serial.print(F("WARN: [COREIO] Expander interrupt line not detected. Polling expander zones every "));
+		Serial.print(ZONE_POLL_INTERVAL);
+		Serial.println(F("ms."));
+		return;
+	}
+
+	pinMode(PIN_EXP_INT, INPUT_PULLUP);
+	attachInterrupt(digitalPinToInterrupt(PIN_EXP_INT), onZoneInputInterrupt, FALLING);
+
+	// Clear anything latched before the handler was attached.
+	this->_controller->readGPIOAB();
+}
+
+bool CoreIOClass::hasExpanderInterrupt() {
+	return this->_expanderInterrupt;
+}
+
 void CoreIOClass::relayOn(OnboardRelaySelect relay) {
+	// Read-modify-write of the port, so it must be one transaction.
+	I2CTransaction txn(PRIMARY_EXP_BUS_ADDRESS, I2CPriority::ELEVATED);
+	if (!txn.isLocked()) {
+		return;
+	}
+
 	uint8_t pin = this->_relayOutputs[(uint8_t)relay];
 	if (this->_controller->digitalRead(pin) != HIGH) {
 		this->_controller->digitalWrite(pin, HIGH);
@@ -102,6 +226,11 @@ void CoreIOClass::relayOn(OnboardRelaySelect relay) {
 }
 
 void CoreIOClass::relayOff(OnboardRelaySelect relay) {
+	I2CTransaction txn(PRIMARY_EXP_BUS_ADDRESS, I2CPriority::ELEVATED);
+	if (!txn.isLocked()) {
+		return;
+	}
+
 	uint8_t pin = this->_relayOutputs[(uint8_t)relay];
 	if (this->_controller->digitalRead(pin) != LOW) {
 		this->_controller->digitalWrite(pin, LOW);
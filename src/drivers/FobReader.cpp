@@ -1,144 +1,219 @@
 #include "drivers/FobReader.h"
 
-void FobReader::begin(uint8_t address, TwoWire *theWire) {
+void FobReader::begin(uint8_t address) {
 	this->_i2cAddr = address;
-	this->_wire = theWire;
+	this->_exchange.begin(address);
+	this->_pollCommand = FOBREADER_GET_AVAILABLE;
+	this->_combinedPoll = false;
+	this->_nextPoll = 0;
+	this->_lastActivity = 0;
+	this->_pollInterval = FOBREADER_POLL_IDLE;
 	memset(&this->tag, 0, sizeof(Tag));
-
-	this->_wire->begin();
 }
 
 uint8_t FobReader::getAddress() {
 	return this->_i2cAddr;
 }
 
-void FobReader::writeByte(uint8_t byte) {
-	this->_wire->beginTransmission(this->_i2cAddr);
-	this->_wire->write(byte);
-	this->_wire->endTransmission();
+bool FobReader::command(uint8_t cmd, uint8_t* response, size_t len) {
+	return I2CBus.transfer(this->_i2cAddr, &cmd, 1, response, len);
 }
 
-uint8_t FobReader::readByte() {
-	this->_wire->requestFrom(this->_i2cAddr, (uint8_t)1);
-	return this->_wire->read();
+bool FobReader::detect() {
+	uint8_t ack = 0;
+	return this->command(FOBREADER_DETECT, &ack, 1) && ack == FOBREADER_DETECT_ACK;
 }
 
-uint8_t *FobReader::readBytes(size_t len) {
-	uint8_t* buffer = new uint8_t;
-	this->_wire->requestFrom(this->_i2cAddr, (uint8_t)len);
-	for (size_t i = 0; i < len; i++) {
-		buffer[i] = this->_wire->read();
-	}
+uint8_t FobReader::init() {
+	uint8_t status = 0xFF;
+	this->command(FOBREADER_INIT, &status, 1);
 
-	return buffer;
+	// Older firmware doesn't know FOBREADER_POLL and won't echo it back.
+	uint8_t response[FOBREADER_POLL_SIZE];
+	this->_combinedPoll = this->command(FOBREADER_POLL, response, sizeof(response)) && response[0] == FOBREADER_POLL;
+	return status;
 }
 
-bool FobReader::detect() {
-	this->writeByte(FOBREADER_DETECT);
-	return this->readByte() == FOBREADER_DETECT_ACK;
-}
-
-uint8_t FobReader::init() {
-	this->writeByte(FOBREADER_INIT);
-	return this->readByte();
+bool FobReader::hasCombinedPoll() {
+	return this->_combinedPoll;
 }
 
 bool FobReader::selfTest() {
-	bool result = false;
-	this->writeByte(FOBREADER_SELF_TEST);
-	
 	// Byte 0: 0xDC (command ack)
 	// Byte 1: Result (1 = pass, 0 = fail)
-	uint8_t *response = this->readBytes(FOBREADER_SELF_TEST_SIZE);
-	if (response[0] == FOBREADER_SELF_TEST) {
-		result = (bool)response[1];
+	uint8_t response[FOBREADER_SELF_TEST_SIZE];
+	if (!this->command(FOBREADER_SELF_TEST, response, sizeof(response)) || response[0] != FOBREADER_SELF_TEST) {
+		return false;
 	}
 
-	delete[] response;
-	return result;
+	return (bool)response[1];
 }
 
 String FobReader::getFirmwareVersion() {
 	String result = "";
-	this->writeByte(FOBREADER_GET_FIRMWARE);
 
 	// Byte 0: 0xFC (command ack)
 	// Byte 1: Length of version string in bytes
 	// Bytes 2 - n: Version string
-	uint8_t *response = this->readBytes(FOBREADER_FW_PREAMBLE_SIZE);
-	if (response[0] == FOBREADER_GET_FIRMWARE) {
-		size_t len = response[1];
-
-		// The second response is the actual version string in bytes.
-		unsigned int payloadSize = len + FOBREADER_FW_PREAMBLE_SIZE;
-		uint8_t *val = this->readBytes(payloadSize);
-		for (unsigned int i = FOBREADER_FW_PREAMBLE_SIZE, i < payloadSize; i++) {
-			// Skip string null terminator
-			if (val[i] != 0x0) {
-				result += (char)val[i];
-			}
+	uint8_t response[FOBREADER_FW_PREAMBLE_SIZE + FOBREADER_MAX_FW_SIZE];
+	if (!this->command(FOBREADER_GET_FIRMWARE, response, FOBREADER_FW_PREAMBLE_SIZE) || response[0] != FOBREADER_GET_FIRMWARE) {
+		return result;
+	}
+
+	// The second response is the preamble again followed by the version
+	// string.
+	size_t payloadSize = min((size_t)response[1], (size_t)FOBREADER_MAX_FW_SIZE) + FOBREADER_FW_PREAMBLE_SIZE;
+	if (!I2CBus.read(this->_i2cAddr, response, payloadSize)) {
+		return result;
+	}
+
+	for (size_t i = FOBREADER_FW_PREAMBLE_SIZE; i < payloadSize; i++) {
+		// Skip string null terminator
+		if (response[i] != 0x0) {
+			result += (char)response[i];
 		}
-		
-		delete[] val;
 	}
 
-	delete[] response;
 	return result;
 }
 
 bool FobReader::isNewTagPresent() {
-	bool result = false;
-	this->writeByte(FOBREADER_GET_AVAILABLE);
-
 	// Byte 0: 0xFE (command ack)
 	// Byte 1: 1 or 0 (true or false)
-	uint8_t *response = this->readBytes(FOBREADER_TAG_PRESENCE_SIZE);
-	if (response[0] == FOBREADER_GET_AVAILABLE) {
-		result = (bool)response[1];
+	uint8_t response[FOBREADER_TAG_PRESENCE_SIZE];
+	if (!this->command(FOBREADER_GET_AVAILABLE, response, sizeof(response)) || response[0] != FOBREADER_GET_AVAILABLE) {
+		return false;
 	}
 
-	delete[] response;
-	return result;
+	return (bool)response[1];
 }
 
 bool FobReader::getTagData() {
-	this->writeByte(FOBREADER_GET_TAGS);
-
 	// Byte 0: 0xFD (command ack)
 	// Byte 1: Record count
 	// Byte 2: Tag size
 	// Byte 3 - 13: Tag UID bytes
-	uint8_t *response = this->readBytes(FOBREADER_TAG_DATA_SIZE);
-	if (response[0] == FOBREADER_GET_TAGS) {
-		memset(&this->tag, 0, sizeof(Tag));
-		this->tag.id = this->getId();
-		this->tag.records = response[1];
-		this->tag.size = response[2];
-		for (size_t i = 0; i < this->tag.size; i++) {
-			this->tag.tagBytes[i] = response[i + 3];
+	uint8_t response[FOBREADER_TAG_DATA_SIZE];
+	if (!this->command(FOBREADER_GET_TAGS, response, sizeof(response)) || response[0] != FOBREADER_GET_TAGS) {
+		return false;
+	}
+
+	this->readTag(response);
+	return true;
+}
+
+void FobReader::readTag(const uint8_t* response) {
+	memset(&this->tag, 0, sizeof(Tag));
+	this->tag.seenAt = micros();
+	this->tag.id = this->getId();
+	this->tag.records = response[1];
+	this->tag.size = min(response[2], (uint8_t)FOBREADER_MAX_TAG_SIZE);
+	memcpy(this->tag.tagBytes, &response[3], this->tag.size);
+}
+
+void FobReader::schedule(unsigned long now, bool activity) {
+	// Poll fast while someone is badging, then ease back to the idle rate.
+	if (activity) {
+		this->_lastActivity = now;
+		this->_pollInterval = FOBREADER_POLL_FAST;
+	}
+	else if (now - this->_lastActivity >= FOBREADER_ACTIVE_WINDOW) {
+		this->_pollInterval = min(this->_pollInterval + this->_pollInterval / 4 + 1, (uint32_t)FOBREADER_POLL_IDLE);
+	}
+
+	this->_nextPoll = now + this->_pollInterval;
+}
+
+bool FobReader::poll() {
+	// Returns true once tag holds a new read. Nothing goes out on the bus
+	// until the next poll is due, except to finish an exchange in flight.
+	if (!this->_exchange.isAwaitingResponse() && this->_pollCommand != FOBREADER_GET_TAGS
+		&& (long)(millis() - this->_nextPoll) < 0) {
+		return false;
+	}
+
+	bool read = this->_combinedPoll ? this->pollCombined() : this->pollLegacy();
+
+	// A reader that missed a deadline is backing off in the exchange.
+	// Keep it on the regular cadence so the task doesn't spin meanwhile.
+	if (!this->_exchange.isAwaitingResponse() && this->_pollCommand != FOBREADER_GET_TAGS
+		&& (long)(millis() - this->_nextPoll) >= 0) {
+		this->schedule(millis(), false);
+	}
+
+	return read;
+}
+
+bool FobReader::pollCombined() {
+	// Byte 0: 0xF9 (command ack)
+	// Byte 1: 1 if a new tag was read, otherwise 0
+	// Byte 2: Record count
+	// Byte 3: Tag size
+	// Bytes 4 - 14: Tag UID bytes
+	I2CExchangeResult result = this->_exchange.step(FOBREADER_POLL, this->_response, FOBREADER_POLL_SIZE);
+	if (result != I2CExchangeResult::COMPLETE) {
+		return false;
+	}
+
+	bool present = (bool)this->_response[1];
+	if (present) {
+		this->readTag(&this->_response[1]);
+	}
+
+	this->schedule(millis(), present);
+	return present;
+}
+
+bool FobReader::pollLegacy() {
+	// Same two commands as isNewTagPresent() and getTagData(), one bus
+	// operation per call.
+	size_t len = this->_pollCommand == FOBREADER_GET_TAGS ? FOBREADER_TAG_DATA_SIZE : FOBREADER_TAG_PRESENCE_SIZE;
+	I2CExchangeResult result = this->_exchange.step(this->_pollCommand, this->_response, len);
+	if (result == I2CExchangeResult::FAILED) {
+		this->_pollCommand = FOBREADER_GET_AVAILABLE;
+		return false;
+	}
+
+	if (result != I2CExchangeResult::COMPLETE) {
+		return false;
+	}
+
+	if (this->_pollCommand == FOBREADER_GET_AVAILABLE) {
+		if ((bool)this->_response[1]) {
+			this->_pollCommand = FOBREADER_GET_TAGS;
+		}
+		else {
+			this->schedule(millis(), false);
 		}
 
-		delete[] response;
-		return true;
+		return false;
 	}
 
-	delete[] response;
-	return false;
+	this->_pollCommand = FOBREADER_GET_AVAILABLE;
+	this->readTag(this->_response);
+	this->schedule(millis(), true);
+	return true;
 }
 
-uint8_t FobReader::getMiFareVersion() {
-	uint8_t result = 0xFF;
-	this->writeByte(FOBREADER_MIFARE_VERSION);
+uint32_t FobReader::getPollDelay() {
+	// Time until poll() has something to do.
+	if (this->_exchange.isAwaitingResponse() || this->_pollCommand == FOBREADER_GET_TAGS) {
+		return I2C_EXCHANGE_RESPONSE_DELAY;
+	}
+
+	long remaining = (long)(this->_nextPoll - millis());
+	return remaining > 0 ? (uint32_t)remaining : 0;
+}
 
+uint8_t FobReader::getMiFareVersion() {
 	// Byte 0: 0xDB (command ack)
 	// Byte 1: The MiFare firmware version code (ie. 0x92)
-	uint8_t *response = this->readBytes(FOBREADER_MIFARE_VER_SIZE);
-	if (response[0] == FOBREADER_MIFARE_VERSION) {
-		result = response[1];
+	uint8_t response[FOBREADER_MIFARE_VER_SIZE];
+	if (!this->command(FOBREADER_MIFARE_VERSION, response, sizeof(response)) || response[0] != FOBREADER_MIFARE_VERSION) {
+		return 0xFF;
 	}
 
-	delete[] response;
-	return result;
+	return response[1];
 }
 
 void FobReader::setId(uint8_t id) {
@@ -150,6 +225,6 @@ uint8_t FobReader::getId() {
 }
 
 bool FobReader::badCard() {
-	this->writeByte(FOBREADER_BAD_CARD);
-	return this->readByte() == FOBREADER_BAD_CARD;
+	uint8_t ack = 0;
+	return this->command(FOBREADER_BAD_CARD, &ack, 1) && ack == FOBREADER_BAD_CARD;
 }
\ No newline at end of file
@@ -0,0 +1,299 @@
+#include "drivers/I2CBus.h"
+
+I2CBusClass::I2CBusClass() {
+	this->_wire = NULL;
+	this->_lock = NULL;
+	this->_deviceCount = 0;
+	this->_lockTimeouts = 0;
+	memset(this->_stats, 0, sizeof(this->_stats));
+}
+
+void I2CBusClass::begin(TwoWire* wire) {
+	if (this->_lock == NULL) {
+		this->_lock = xSemaphoreCreateRecursiveMutex();
+	}
+
+	this->_wire = wire;
+	this->_wire->begin();
+	this->_wire->setTimeOut(I2C_BUS_WIRE_TIMEOUT);
+}
+
+bool I2CBusClass::lock(uint32_t timeoutMs) {
+	return xSemaphoreTakeRecursive(this->_lock, timeoutMs / portTICK_PERIOD_MS) == pdTRUE;
+}
+
+void I2CBusClass::unlock() {
+	xSemaphoreGiveRecursive(this->_lock);
+}
+
+void I2CBusClass::record(uint8_t address, uint32_t latencyUs, uint32_t waitUs, bool ok) {
+	// Only called with the bus held.
+	I2CDeviceStats* stats = NULL;
+	for (uint8_t i = 0; i < this->_deviceCount; i++) {
+		if (this->_stats[i].address == address) {
+			stats = &this->_stats[i];
+			break;
+		}
+	}
+
+	if (stats == NULL) {
+		if (this->_deviceCount >= I2C_BUS_MAX_DEVICES) {
+			return;
+		}
+
+		stats = &this->_stats[this->_deviceCount++];
+		stats->address = address;
+	}
+
+	stats->transactions++;
+	if (!ok) {
+		stats->errors++;
+	}
+
+	stats->lastLatencyUs = latencyUs;
+	stats->totalLatencyUs += latencyUs;
+	stats->maxLatencyUs = max(stats->maxLatencyUs, latencyUs);
+	stats->maxWaitUs = max(stats->maxWaitUs, waitUs);
+}
+
+bool I2CBusClass::writeLocked(uint8_t address, const uint8_t* data, size_t len) {
+	this->_wire->beginTransmission(address);
+	if (len > 0 && this->_wire->write(data, len) != len) {
+		this->_wire->endTransmission();
+		return false;
+	}
+
+	return this->_wire->endTransmission() == 0;
+}
+
+bool I2CBusClass::readLocked(uint8_t address, uint8_t* buffer, size_t len) {
+	// requestFrom() blocks until the read completes or times out, so
+	// whatever is available afterwards is all there will be.
+	if (len == 0 || len > I2C_BUS_MAX_TRANSFER) {
+		return false;
+	}
+
+	size_t received = this->_wire->requestFrom(address, (uint8_t)len);
+	for (size_t i = 0; i < received && i < len; i++) {
+		buffer[i] = this->_wire->read();
+	}
+
+	return received == len;
+}
+
+bool I2CBusClass::probe(uint8_t address) {
+	// Scans hit every address, so probes are not tracked.
+	if (!this->lock(I2C_BUS_LOCK_TIMEOUT)) {
+		this->_lockTimeouts++;
+		return false;
+	}
+
+	bool result = this->writeLocked(address, NULL, 0);
+	this->unlock();
+	return result;
+}
+
+bool I2CBusClass::write(uint8_t address, const uint8_t* data, size_t len, I2CPriority priority) {
+	I2CTransaction txn(address, priority);
+	if (!txn.isLocked()) {
+		return false;
+	}
+
+	if (!this->writeLocked(address, data, len)) {
+		txn.fail();
+		return false;
+	}
+
+	return true;
+}
+
+bool I2CBusClass::read(uint8_t address, uint8_t* buffer, size_t len, I2CPriority priority) {
+	I2CTransaction txn(address, priority);
+	if (!txn.isLocked()) {
+		return false;
+	}
+
+	if (!this->readLocked(address, buffer, len)) {
+		txn.fail();
+		return false;
+	}
+
+	return true;
+}
+
+bool I2CBusClass::transfer(uint8_t address, const uint8_t* tx, size_t txLen, uint8_t* rx, size_t rxLen, I2CPriority priority) {
+	// Command and response in one hold of the bus so another task's
+	// command can't land in between.
+	I2CTransaction txn(address, priority);
+	if (!txn.isLocked()) {
+		return false;
+	}
+
+	if (!this->writeLocked(address, tx, txLen) || !this->readLocked(address, rx, rxLen)) {
+		txn.fail();
+		return false;
+	}
+
+	return true;
+}
+
+uint8_t I2CBusClass::getDeviceCount() {
+	return this->_deviceCount;
+}
+
+bool I2CBusClass::getDeviceStats(uint8_t index, I2CDeviceStats* stats) {
+	if (index >= this->_deviceCount || !this->lock(I2C_BUS_LOCK_TIMEOUT)) {
+		return false;
+	}
+
+	memcpy(stats, &this->_stats[index], sizeof(I2CDeviceStats));
+	this->unlock();
+	return true;
+}
+
+uint32_t I2CBusClass::getLockTimeouts() {
+	return this->_lockTimeouts;
+}
+
+I2CTransaction::I2CTransaction(uint8_t address, I2CPriority priority, uint32_t timeoutMs) {
+	this->_address = address;
+	this->_failed = false;
+	this->_boosted = false;
+	this->_savedPriority = 0;
+
+	// Boost before waiting so the mutex wait list (ordered by priority)
+	// puts us ahead of normal traffic.
+	if (priority == I2CPriority::ELEVATED) {
+		this->_savedPriority = uxTaskPriorityGet(NULL);
+		if (this->_savedPriority < I2C_BUS_BOOST_PRIORITY) {
+			vTaskPrioritySet(NULL, I2C_BUS_BOOST_PRIORITY);
+			this->_boosted = true;
+		}
+	}
+
+	unsigned long waitStart = micros();
+	this->_locked = I2CBus.lock(timeoutMs);
+	this->_started = micros();
+	this->_waitUs = this->_started - waitStart;
+	if (!this->_locked) {
+		I2CBus._lockTimeouts++;
+		Serial.print(F("ERROR: [I2C] Timed out waiting for bus. Device: 0x"));
+		Serial.println(address, HEX);
+	}
+}
+
+I2CTransaction::~I2CTransaction() {
+	if (this->_locked) {
+		I2CBus.record(this->_address, micros() - this->_started, this->_waitUs, !this->_failed);
+		I2CBus.unlock();
+	}
+
+	if (this->_boosted) {
+		vTaskPrioritySet(NULL, this->_savedPriority);
+	}
+}
+
+bool I2CTransaction::isLocked() {
+	return this->_locked;
+}
+
+void I2CTransaction::fail() {
+	this->_failed = true;
+}
+
+I2CExchange::I2CExchange() {
+	this->_address = 0;
+	this->_command = 0;
+	this->_state = State::IDLE;
+	this->_deadline = 0;
+	this->_nextStep = 0;
+	this->_failures = 0;
+	this->_missedDeadlines = 0;
+}
+
+void I2CExchange::begin(uint8_t address) {
+	this->_address = address;
+	this->_state = State::IDLE;
+	this->_failures = 0;
+}
+
+I2CExchangeResult I2CExchange::fail(unsigned long now) {
+	this->_missedDeadlines++;
+	if (this->_failures < 0xFF) {
+		this->_failures++;
+	}
+
+	uint8_t shift = min(this->_failures - 1, 6);
+	unsigned long backoff = min((unsigned long)I2C_EXCHANGE_BACKOFF_MIN << shift, (unsigned long)I2C_EXCHANGE_BACKOFF_MAX);
+	this->_nextStep = now + backoff;
+	this->_state = State::BACKOFF;
+	if (this->_failures == I2C_EXCHANGE_OFFLINE_AFTER) {
+		Serial.print(F("WARN: [I2C] Device not responding. Backing off. Device: 0x"));
+		Serial.println(this->_address, HEX);
+	}
+
+	return I2CExchangeResult::FAILED;
+}
+
+I2CExchangeResult I2CExchange::step(uint8_t command, uint8_t* response, size_t len) {
+	unsigned long now = millis();
+	switch (this->_state) {
+		case State::BACKOFF:
+			if ((long)(now - this->_nextStep) < 0) {
+				return I2CExchangeResult::PENDING;
+			}
+
+			// Resend.
+			this->_state = State::IDLE;
+			// fall through
+		case State::IDLE:
+			if (!I2CBus.write(this->_address, &command, 1)) {
+				return this->fail(now);
+			}
+
+			this->_command = command;
+			this->_deadline = now + I2C_EXCHANGE_DEADLINE;
+			this->_nextStep = now + I2C_EXCHANGE_RESPONSE_DELAY;
+			this->_state = State::AWAITING_RESPONSE;
+			return I2CExchangeResult::PENDING;
+		case State::AWAITING_RESPONSE:
+			if ((long)(now - this->_nextStep) < 0) {
+				return I2CExchangeResult::PENDING;
+			}
+
+			if (I2CBus.read(this->_address, response, len) && response[0] == this->_command) {
+				if (this->_failures >= I2C_EXCHANGE_OFFLINE_AFTER) {
+					Serial.print(F("INFO: [I2C] Device responding again. Device: 0x"));
+					Serial.println(this->_address, HEX);
+				}
+
+				this->_failures = 0;
+				this->_state = State::IDLE;
+				return I2CExchangeResult::COMPLETE;
+			}
+
+			if ((long)(now - this->_deadline) >= 0) {
+				return this->fail(now);
+			}
+
+			// Not ready yet. Give the bus back and look again shortly.
+			this->_nextStep = now + I2C_EXCHANGE_RESPONSE_DELAY;
+			return I2CExchangeResult::PENDING;
+	}
+
+	return I2CExchangeResult::PENDING;
+}
+
+bool I2CExchange::isAwaitingResponse() {
+	return this->_state == State::AWAITING_RESPONSE;
+}
+
+bool I2CExchange::isOnline() {
+	return this->_failures < I2C_EXCHANGE_OFFLINE_AFTER;
+}
+
+uint32_t I2CExchange::getMissedDeadlines() {
+	return this->_missedDeadlines;
+}
+
+I2CBusClass I2CBus;
\ No newline at end of file
@@ -1,91 +1,54 @@
 #include "drivers/Keypad.h"
 
-void Keypad::begin(uint8_t address, TwoWire *theWire) {
+void Keypad::begin(uint8_t address) {
 	this->_i2cAddress = address;
-	this->_wire = theWire;
-	this->_commandData = new KeypadData;
-
-	this->_wire->begin();
+	this->_exchange.begin(address);
+	memset(&this->_commandData, 0, sizeof(KeypadData));
 }
 
 uint8_t Keypad::getAddress() {
 	return this->_i2cAddress;
 }
 
-void Keypad::writeByte(uint8_t byte) {
-	this->_wire->beginTransmission(this->_i2cAddress);
-	this->_wire->write(byte);
-	this->_wire->endTransmission();
-}
-
-void Keypad::writeBytes(uint8_t *bytes, size_t len) {
-	this->_wire->beginTransmission(this->_i2cAddress);
-	for (size_t i = 0; i < len; i++) {
-		this->_wire->write(bytes[i]);
-	}
-
-	this->_wire->endTransmission();
-}
-
-uint8_t Keypad::readByte() {
-	this->_wire->requestFrom(this->_i2cAddress, (uint8_t)1);
-	while (this->_wire->available() < 1) { ; }
-	return this->_wire->read();
-}
-
-uint8_t* Keypad::readBytes(size_t len) {
-	uint8_t* buffer = new uint8_t; 
-	this->_wire->requestFrom(this->_i2cAddress, (uint8_t)len);
-	while (this->_wire->available() < len) {
-		// Wait until all the bytes have arrived.
-		;
-	}
-
-	for (size_t i = 0; i < len; i++) {
-		buffer[i] = this->_wire->read();
-	}
-
-	return buffer;
+bool Keypad::command(uint8_t cmd, uint8_t* response, size_t len) {
+	return I2CBus.transfer(this->_i2cAddress, &cmd, 1, response, len);
 }
 
 bool Keypad::detect() {
-	this->writeByte(KEYPAD_DETECT);
-	return this->readByte() == KEYPAD_DETECT_ACK;
+	uint8_t ack = 0;
+	return this->command(KEYPAD_DETECT, &ack, 1) && ack == KEYPAD_DETECT_ACK;
 }
 
 uint8_t Keypad::init() {
-	this->writeByte(KEYPAD_INIT);
-	return this->readByte();
-}
-
-KeypadData* Keypad::readEntries() {
-	// Reset everything
-	this->_commandData->size = 0;
-	this->_commandData->command = 0;
-	for (uint8_t i = 0; i < KEYPAD_DATA_BUFFER_SIZE; i++) {
-		this->_commandData->data[i] = 0;
+	uint8_t status = 0xFF;
+	this->command(KEYPAD_INIT, &status, 1);
+	return status;
+}
+
+KeypadData* Keypad::poll() {
+	// Byte 0: 0xDE (command ack)
+	// Byte 1: Command
+	// Byte 2: Data length
+	// Bytes 3 - n: Command data
+	if (this->_exchange.step(KEYPAD_GET_CMD_DATA, this->_payload, sizeof(this->_payload)) != I2CExchangeResult::COMPLETE) {
+		return nullptr;
 	}
 
-	// Request any awaiting command data.
-	this->writeByte(KEYPAD_GET_CMD_DATA);
-
-	// If we get back an ack, then get the command, data len, and
-	// command data from the payload.
-	uint8_t *payload = this->readBytes(KEYPAD_DATA_BUFFER_SIZE + 3);
-	if (payload[0] == KEYPAD_GET_CMD_DATA) {
-		this->_commandData->id = this->getId();
-		this->_commandData->command = payload[1];
-		this->_commandData->size = payload[2];
-		for (uint8_t i = 0; i < this->_commandData->size; i++) {
-			this->_commandData->data[i] = payload[i + 3];
-		}
-
-		delete[] payload;
-		return this->_commandData;
+	// Nothing entered since the last poll.
+	if (this->_payload[2] == 0) {
+		return nullptr;
 	}
 
-	delete[] payload;
-	return nullptr;
+	memset(&this->_commandData, 0, sizeof(KeypadData));
+	this->_commandData.id = this->getId();
+	this->_commandData.command = this->_payload[1];
+	this->_commandData.size = min(this->_payload[2], (uint8_t)KEYPAD_DATA_BUFFER_SIZE);
+	memcpy(this->_commandData.data, &this->_payload[KEYPAD_CMD_PREAMBLE_SIZE], this->_commandData.size);
+	return &this->_commandData;
+}
+
+bool Keypad::isAwaitingResponse() {
+	return this->_exchange.isAwaitingResponse();
 }
 
 void Keypad::setId(uint8_t id) {
@@ -1,7 +1,8 @@
 #include "drivers/RelayModule.h"
 
-RelayModule::RelayModule(Adafruit_MCP23017 *busController) {
+RelayModule::RelayModule(Adafruit_MCP23017 *busController, uint8_t busAddress) {
 	this->_busController = busController;
+	this->_busAddress = busAddress;
 }
 
 uint8_t RelayModule::getRelayAddress(RelaySelect relay) {
@@ -55,6 +56,11 @@ uint8_t RelayModule::getLedAddressForRelay(RelaySelect relay) {
 }
 
 bool RelayModule::detect() {
+	I2CTransaction txn(this->_busAddress);
+	if (!txn.isLocked()) {
+		return false;
+	}
+
 	this->_busController->pinMode(PIN_RM_DET_IN, INPUT);
 	this->_busController->pinMode(PIN_RM_DET_OUT, OUTPUT);
 	this->_busController->digitalWrite(PIN_RM_DET_OUT, HIGH);
@@ -64,6 +70,7 @@ bool RelayModule::detect() {
 }
 
 void RelayModule::init() {
+	I2CTransaction txn(this->_busAddress);
 	uint8_t relayAddress = 0;
 	uint8_t ledAddress = 0;
 	for (uint8_t i = 1; i <= 5; i++) {
@@ -78,11 +85,19 @@ void RelayModule::init() {
 }
 
 ModuleRelayState RelayModule::getState(RelaySelect relay) {
+	I2CTransaction txn(this->_busAddress, I2CPriority::ELEVATED);
 	uint8_t address = this->getRelayAddress(relay);
 	return (ModuleRelayState)this->_busController->digitalRead(address);
 }
 
 void RelayModule::setState(RelaySelect relay, ModuleRelayState state) {
+	// Read-modify-write of the port, so it must be one transaction. The
+	// nested one in getState() is fine; the bus lock is recursive.
+	I2CTransaction txn(this->_busAddress, I2CPriority::ELEVATED);
+	if (!txn.isLocked()) {
+		return;
+	}
+
 	if (this->getState(relay) != state) {
 		uint8_t relayAddress = this->getRelayAddress(relay);
 		uint8_t ledAddress = this->getLedAddressForRelay(relay);
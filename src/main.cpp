@@ -2,13 +2,16 @@
  * 
  */
 
-#ifndef ESP32
+#if !defined(ESP32) && !defined(NATIVE)
 	#error This firmware is only compatible with ESP32 controllers.
 #endif
 
 #include <Arduino.h>
 #include "App.h"
 
+// Unit test builds (pio test) provide their own setup() and loop().
+#ifndef PIO_UNIT_TESTING
+
 Application app;
 
 void initSerial() {
@@ -34,4 +37,6 @@ void setup() {
 
 void loop() {
     // Nothing to do here. Everything is handled in tasks.
-}
\ No newline at end of file
+}
+
+#endif
\ No newline at end of file
@@ -1,9 +1,29 @@
 #include "services/AuthService.h"
-#include <HTTPClient.h>
-#include "ArduinoJson.h"
+#include <WiFi.h>
+#include "ChunkedStream.h"
+
+static const char* responseHeaders[] = { "Transfer-Encoding" };
 
 AuthServiceClass::AuthServiceClass() {
-	// TODO probably need to get the WiFiClient instance from main app.
+	this->_loginEndpoint = "";
+	this->_cardAuthEndpoint = "";
+	this->_pinAuthEndpoint = "";
+	this->_token = "";
+	this->_tokenIssuedAt = 0;
+	this->_tokenLifetime = 0;
+	this->_lock = NULL;
+}
+
+void AuthServiceClass::begin() {
+	if (this->_lock == NULL) {
+		this->_lock = xSemaphoreCreateRecursiveMutex();
+	}
+
+	// Keep the TCP connection to the API open between requests so each
+	// credential check costs one round trip instead of a new handshake.
+	this->_http.setReuse(true);
+	this->_http.setTimeout(AUTH_HTTP_TIMEOUT);
+	this->_http.collectHeaders(responseHeaders, 1);
 }
 
 void AuthServiceClass::setLoginEndpoint(const char* endpoint) {
@@ -21,105 +41,113 @@ void AuthServiceClass::setPinAuthEndpoint(const char* endpoint) {
 void AuthServiceClass::setApiCredentials(String username, String password) {
 	this->_username = username;
 	this->_password = password;
+	this->invalidateToken();
 }
 
-String AuthServiceClass::login() {
-	String result = "";
-	Serial.println(F("INFO: [NET] Attempting to authenticate with API..."));
-	if (WiFi.status() == WL_CONNECTED) {
-		WiFiClient client;
-		HTTPClient http;
-
-		http.begin(client, this->_loginEndpoint);
-		http.addHeader("Content-Type", "application/json");
-
-		uint16_t freeMem = ESP.getFreeHeap() - 512;
-        DynamicJsonDocument doc(freeMem);
-		doc["username"] = this->_username;
-		doc["password"] = this->_password;
-		doc.shrinkToFit();
+bool AuthServiceClass::tokenNeedsRefresh(unsigned long margin) {
+	if (this->_token.length() == 0) {
+		return true;
+	}
 
-		String payload;
-		serializeJson(doc, payload);
-		doc.clear();
+	// Never more than half the lifetime, so a token the API only issues
+	// for a short time is still reused.
+	margin = min(margin, this->_tokenLifetime / 2);
+	unsigned long age = millis() - this->_tokenIssuedAt;
+	return age + margin >= this->_tokenLifetime;
+}
 
-		int response = http.POST(payload.c_str());
-		if (response == HTTP_CODE_OK) {
-			freeMem = ESP.getFreeHeap() - 512;
-			DynamicJsonDocument responsePayload(freeMem);
-			DeserializationError err = deserializeJson(responsePayload, http.getString());
-			if (err) {
-				Serial.println(F("ERROR: [NET] Failed to parse JSON login response."));
-			}
-			else {
-				responsePayload.shrinkToFit();
-				result = responsePayload["token"].as<String>();
-				Serial.print(F("INFO: [NET] Retrieved bearer token: "));
-				Serial.println(result);
-			}
+void AuthServiceClass::invalidateToken() {
+	if (this->_lock != NULL) {
+		xSemaphoreTakeRecursive(this->_lock, portMAX_DELAY);
+	}
 
-			responsePayload.clear();
-		}
-		else {
-			Serial.print(F("ERROR: [NET] Auth failed. Response code: "));
-			Serial.println(response);
-		}
+	this->_token = "";
+	this->_tokenIssuedAt = 0;
+	this->_tokenLifetime = 0;
 
-		http.end();
+	if (this->_lock != NULL) {
+		xSemaphoreGiveRecursive(this->_lock);
 	}
-	else {
-		Serial.println(F("ERROR: [NET] WiFi disconnected."));
+}
+
+bool AuthServiceClass::refreshToken(bool force, unsigned long margin) {
+	xSemaphoreTakeRecursive(this->_lock, portMAX_DELAY);
+	bool result = true;
+	if (force || this->tokenNeedsRefresh(margin)) {
+		result = this->login();
 	}
 
+	xSemaphoreGiveRecursive(this->_lock);
 	return result;
 }
 
-bool AuthServiceClass::checkCardValid(const char* serial) {
-	bool result = false;
-	// TODO We need to NOT be retrieving a new auth token every time.
-	// TODO the logic for login() should probably store the token if it is an
-	// empty string, but if it isn't, then check the expiration and see if we
-	// need to refresh the token first.
-	String token = this->login();
-	Serial.println(F("INFO: [NET] Checking card validity..."));
-	if (token.length() == 0) {
-		Serial.println(F("ERROR: [NET] API authorization failed."));
-		return result;
+DeserializationError AuthServiceClass::parseResponse(JsonDocument& doc, JsonDocument& filter) {
+	// Parsed straight off the socket. The filter discards everything but
+	// the fields we need, so memory use is bounded by the document no matter
+	// how large the response is.
+	if (this->_http.getSize() >= 0 || !this->_http.header("Transfer-Encoding").equalsIgnoreCase("chunked")) {
+		return deserializeJson(doc, this->_http.getStream(), DeserializationOption::Filter(filter));
+	}
+
+	// Chunked: strip the framing as the parser reads, then read the rest of
+	// the body so the connection is ready for the next request.
+	ChunkedStream body(this->_http.getStream());
+	DeserializationError err = deserializeJson(doc, body, DeserializationOption::Filter(filter));
+	body.finish();
+	if (!err && body.failed()) {
+		return DeserializationError::InvalidInput;
 	}
 
+	return err;
+}
+
+bool AuthServiceClass::login() {
+	bool result = false;
+	Serial.println(F("INFO: [NET] Attempting to authenticate with API..."));
 	if (WiFi.status() == WL_CONNECTED) {
-		WiFiClient client;
-		HTTPClient http;
+		StaticJsonDocument<JSON_OBJECT_SIZE(2)> doc;
+		doc["username"] = this->_username.c_str();
+		doc["password"] = this->_password.c_str();
+
+		char payload[AUTH_LOGIN_BODY_SIZE];
+		size_t len = serializeJson(doc, payload, sizeof(payload));
+		if (len == 0 || len >= sizeof(payload) - 1) {
+			Serial.println(F("ERROR: [NET] API credentials too long for login request."));
+			return result;
+		}
 
-		String url = this->_cardAuthEndpoint + String("?serial=") + String(serial);
-		http.begin(client, url);
-		http.addHeader("Content-Type", "application/json");
-		http.setAuthorization("");
-		http.addHeader("Authorization", "Bearer " + token);
+		this->_http.begin(this->_client, this->_loginEndpoint);
+		this->_http.addHeader("Content-Type", "application/json");
 
-		int response = http.GET();
+		int response = this->_http.POST((uint8_t*)payload, len);
 		if (response == HTTP_CODE_OK) {
-			uint16_t freeMem = ESP.getFreeHeap() - 512;
-			DynamicJsonDocument responsePayload(freeMem);
-			DeserializationError err = deserializeJson(responsePayload, http.getString());
+			StaticJsonDocument<JSON_OBJECT_SIZE(2)> filter;
+			filter["token"] = true;
+			filter["expiresIn"] = true;
+
+			StaticJsonDocument<AUTH_LOGIN_DOC_SIZE> responsePayload;
+			DeserializationError err = this->parseResponse(responsePayload, filter);
 			if (err) {
-				Serial.println(F("ERROR: [NET] Failed to parse JSON login response."));
+				Serial.print(F("ERROR: [NET] Failed to parse JSON login response: "));
+				Serial.println(err.c_str());
 			}
 			else {
-				responsePayload.shrinkToFit();
-				result = responsePayload["accepted"].as<bool>();
-				Serial.print(F("INFO: [NET] Card validation success: "));
-				Serial.println(result);
+				this->_token = responsePayload["token"].as<const char*>();
+				unsigned long ttl = responsePayload["expiresIn"] | (unsigned long)AUTH_TOKEN_DEFAULT_TTL;
+				this->_tokenIssuedAt = millis();
+				this->_tokenLifetime = ttl * 1000;
+				result = this->_token.length() > 0;
+				Serial.print(F("INFO: [NET] Retrieved bearer token. Expires in "));
+				Serial.print(ttl);
+				Serial.println(F(" seconds."));
 			}
-
-			responsePayload.clear();
 		}
 		else {
-			Serial.print(F("ERROR: [NET] Card validation failed. Response code: "));
+			Serial.print(F("ERROR: [NET] Auth failed. Response code: "));
 			Serial.println(response);
 		}
 
-		http.end();
+		this->_http.end();
 	}
 	else {
 		Serial.println(F("ERROR: [NET] WiFi disconnected."));
@@ -128,54 +156,77 @@ bool AuthServiceClass::checkCardValid(const char* serial) {
 	return result;
 }
 
-bool AuthServiceClass::checkPinValid(const char* pin) {
+bool AuthServiceClass::checkCredential(const char* endpoint, const char* param, const char* value) {
 	bool result = false;
-	String token = this->login();
-	Serial.println(F("INFO: [NET] Checking pin validity..."));
-	if (token.length() == 0) {
+	xSemaphoreTakeRecursive(this->_lock, portMAX_DELAY);
+	if (!this->refreshToken()) {
 		Serial.println(F("ERROR: [NET] API authorization failed."));
+		xSemaphoreGiveRecursive(this->_lock);
 		return result;
 	}
 
 	if (WiFi.status() == WL_CONNECTED) {
-		WiFiClient client;
-		HTTPClient http;
+		String url = endpoint + String("?") + param + String("=") + String(value);
+		int response = 0;
+		for (uint8_t attempt = 0; attempt < 2; attempt++) {
+			this->_http.begin(this->_client, url);
+			this->_http.addHeader("Content-Type", "application/json");
+			this->_http.setAuthorization("");
+			this->_http.addHeader("Authorization", "Bearer " + this->_token);
+
+			response = this->_http.GET();
+			if (response != HTTP_CODE_UNAUTHORIZED || attempt > 0) {
+				break;
+			}
 
-		String url = this->_pinAuthEndpoint + String("?pin=") + String(pin);
-		http.begin(client, url);
-		http.addHeader("Content-Type", "application/json");
-		http.setAuthorization("");
-		http.addHeader("Authorization", "Bearer " + token);
+			// The API revoked our token before it expired. Get a new one
+			// and try once more.
+			this->_http.end();
+			Serial.println(F("WARN: [NET] Bearer token rejected. Refreshing..."));
+			if (!this->refreshToken(true)) {
+				break;
+			}
+		}
 
-		int response = http.GET();
 		if (response == HTTP_CODE_OK) {
-			uint16_t freeMem = ESP.getFreeHeap() - 512;
-			DynamicJsonDocument responsePayload(freeMem);
-			DeserializationError err = deserializeJson(responsePayload, http.getString());
+			StaticJsonDocument<JSON_OBJECT_SIZE(1)> filter;
+			filter["accepted"] = true;
+
+			StaticJsonDocument<AUTH_VALIDATE_DOC_SIZE> responsePayload;
+			DeserializationError err = this->parseResponse(responsePayload, filter);
 			if (err) {
-				Serial.println(F("ERROR: [NET] Failed to parse JSON login response."));
+				Serial.print(F("ERROR: [NET] Failed to parse JSON validation response: "));
+				Serial.println(err.c_str());
 			}
 			else {
-				responsePayload.shrinkToFit();
 				result = responsePayload["accepted"].as<bool>();
-				Serial.print(F("INFO: [NET] Pin validation success: "));
+				Serial.print(F("INFO: [NET] Validation success: "));
 				Serial.println(result);
 			}
-
-			responsePayload.clear();
 		}
 		else {
-			Serial.print(F("ERROR: [NET] Pin validation failed. Response code: "));
+			Serial.print(F("ERROR: [NET] Validation failed. Response code: "));
 			Serial.println(response);
 		}
 
-		http.end();
+		this->_http.end();
 	}
 	else {
 		Serial.println(F("ERROR: [NET] WiFi disconnected."));
 	}
 
+	xSemaphoreGiveRecursive(this->_lock);
 	return result;
 }
 
-AuthServiceClass AuthService;
\ No newline at end of file
+bool AuthServiceClass::checkCardValid(const char* serial) {
+	Serial.println(F("INFO: [NET] Checking card validity..."));
+	return this->checkCredential(this->_cardAuthEndpoint, "serial", serial);
+}
+
+bool AuthServiceClass::checkPinValid(const char* pin) {
+	Serial.println(F("INFO: [NET] Checking pin validity..."));
+	return this->checkCredential(this->_pinAuthEndpoint, "pin", pin);
+}
+
+AuthServiceClass AuthService;
@@ -0,0 +1,226 @@
+#include "services/ConfigCache.h"
+#include <FS.h>
+#include <SPIFFS.h>
+#include <rom/crc.h>
+
+// String fields in the order they are stored.
+static String config_t::* const configCacheStrings[] = {
+	&config_t::hostname,
+	&config_t::ssid,
+	&config_t::password,
+	&config_t::mqttTopicStatus,
+	&config_t::mqttTopicControl,
+	&config_t::mqttTopicEvents,
+	&config_t::mqttTopicJournal,
+	&config_t::mqttTopicDiag,
+	&config_t::mqttBroker,
+	&config_t::mqttUsername,
+	&config_t::mqttPassword,
+	&config_t::otaPassword,
+	&config_t::loginEndpoint,
+	&config_t::cardValidateEndpoint,
+	&config_t::pinValidateEndpoint,
+	&config_t::apiUsername,
+	&config_t::apiPassword
+};
+
+#define CONFIG_CACHE_STRING_COUNT (sizeof(configCacheStrings) / sizeof(configCacheStrings[0]))
+
+bool ConfigCacheClass::hashFile(const char* path, uint32_t* crc, uint32_t* size) {
+	File file = SPIFFS.open(path, "r");
+	if (!file) {
+		return false;
+	}
+
+	uint8_t chunk[CONFIG_CACHE_HASH_CHUNK];
+	size_t len;
+	*crc = 0;
+	*size = 0;
+	while ((len = file.read(chunk, sizeof(chunk))) > 0) {
+		*crc = crc32_le(*crc, chunk, len);
+		*size += len;
+	}
+
+	file.close();
+	return true;
+}
+
+size_t ConfigCacheClass::encode(const config_t* config, uint8_t* body, size_t capacity) {
+	configcache_fixed_t fixed;
+	memset(&fixed, 0, sizeof(fixed));
+	fixed.ip = (uint32_t)config->ip;
+	fixed.gw = (uint32_t)config->gw;
+	fixed.sm = (uint32_t)config->sm;
+	fixed.dns = (uint32_t)config->dns;
+	fixed.mqttPort = config->mqttPort;
+	fixed.otaPort = config->otaPort;
+	fixed.clockTimezone = config->clockTimezone;
+	fixed.mqttPayloadFormat = (uint8_t)config->mqttPayloadFormat;
+	fixed.flags = (config->useDhcp ? CONFIG_CACHE_FLAG_DHCP : 0)
+		| (config->mdnsEnable ? CONFIG_CACHE_FLAG_MDNS : 0)
+		| (config->otaEnable ? CONFIG_CACHE_FLAG_OTA : 0);
+
+	if (capacity < sizeof(fixed)) {
+		return 0;
+	}
+
+	memcpy(body, &fixed, sizeof(fixed));
+	size_t pos = sizeof(fixed);
+	for (uint8_t i = 0; i < CONFIG_CACHE_STRING_COUNT; i++) {
+		const String* value = &(config->*configCacheStrings[i]);
+		uint16_t len = value->length();
+		if (pos + sizeof(len) + len + 1 > capacity) {
+			return 0;
+		}
+
+		memcpy(body + pos, &len, sizeof(len));
+		pos += sizeof(len);
+		memcpy(body + pos, value->c_str(), len);
+		pos += len;
+		body[pos++] = 0;
+	}
+
+	return pos;
+}
+
+bool ConfigCacheClass::decode(const uint8_t* body, size_t size, config_t* config) {
+	configcache_fixed_t fixed;
+	if (size < sizeof(fixed)) {
+		return false;
+	}
+
+	memcpy(&fixed, body, sizeof(fixed));
+	if (fixed.mqttPayloadFormat > (uint8_t)PayloadFormat::MSGPACK) {
+		return false;
+	}
+
+	// Strings are checked before anything is assigned, so a bad body
+	// leaves the config untouched.
+	size_t pos = sizeof(fixed);
+	for (uint8_t i = 0; i < CONFIG_CACHE_STRING_COUNT; i++) {
+		uint16_t len;
+		if (pos + sizeof(len) > size) {
+			return false;
+		}
+
+		memcpy(&len, body + pos, sizeof(len));
+		pos += sizeof(len);
+		if (pos + len + 1 > size || body[pos + len] != 0) {
+			return false;
+		}
+
+		pos += len + 1;
+	}
+
+	if (pos != size) {
+		return false;
+	}
+
+	config->ip = IPAddress(fixed.ip);
+	config->gw = IPAddress(fixed.gw);
+	config->sm = IPAddress(fixed.sm);
+	config->dns = IPAddress(fixed.dns);
+	config->mqttPort = fixed.mqttPort;
+	config->otaPort = fixed.otaPort;
+	config->clockTimezone = fixed.clockTimezone;
+	config->mqttPayloadFormat = (PayloadFormat)fixed.mqttPayloadFormat;
+	config->useDhcp = (fixed.flags & CONFIG_CACHE_FLAG_DHCP) != 0;
+	config->mdnsEnable = (fixed.flags & CONFIG_CACHE_FLAG_MDNS) != 0;
+	config->otaEnable = (fixed.flags & CONFIG_CACHE_FLAG_OTA) != 0;
+
+	pos = sizeof(fixed);
+	for (uint8_t i = 0; i < CONFIG_CACHE_STRING_COUNT; i++) {
+		uint16_t len;
+		memcpy(&len, body + pos, sizeof(len));
+		pos += sizeof(len);
+		config->*configCacheStrings[i] = (const char*)(body + pos);
+		pos += len + 1;
+	}
+
+	return true;
+}
+
+ConfigCacheStatus ConfigCacheClass::load(config_t* config, uint32_t sourceCrc, uint32_t sourceSize) {
+	if (!SPIFFS.exists(CONFIG_CACHE_FILE_PATH)) {
+		return ConfigCacheStatus::MISSING;
+	}
+
+	File file = SPIFFS.open(CONFIG_CACHE_FILE_PATH, "r");
+	if (!file) {
+		return ConfigCacheStatus::MISSING;
+	}
+
+	uint8_t buffer[CONFIG_CACHE_MAX_SIZE];
+	size_t len = file.read(buffer, sizeof(buffer));
+	file.close();
+
+	configcache_header_t header;
+	if (len < sizeof(header)) {
+		return ConfigCacheStatus::INVALID;
+	}
+
+	memcpy(&header, buffer, sizeof(header));
+	if (header.magic != CONFIG_CACHE_MAGIC) {
+		return ConfigCacheStatus::INVALID;
+	}
+
+	if (header.version != CONFIG_CACHE_VERSION
+		|| header.sourceCrc != sourceCrc
+		|| header.sourceSize != sourceSize) {
+		return ConfigCacheStatus::STALE;
+	}
+
+	const uint8_t* body = buffer + sizeof(header);
+	if (sizeof(header) + header.bodySize != len
+		|| crc32_le(0, body, header.bodySize) != header.crc
+		|| !decode(body, header.bodySize, config)) {
+		return ConfigCacheStatus::INVALID;
+	}
+
+	return ConfigCacheStatus::LOADED;
+}
+
+bool ConfigCacheClass::save(const config_t* config, uint32_t sourceCrc, uint32_t sourceSize) {
+	uint8_t buffer[CONFIG_CACHE_MAX_SIZE];
+	configcache_header_t header;
+	size_t bodySize = encode(config, buffer + sizeof(header), sizeof(buffer) - sizeof(header));
+	if (bodySize == 0) {
+		Serial.println(F("WARN: [CFGCACHE] Config too large for snapshot."));
+		this->clear();
+		return false;
+	}
+
+	header.magic = CONFIG_CACHE_MAGIC;
+	header.version = CONFIG_CACHE_VERSION;
+	header.bodySize = bodySize;
+	header.sourceCrc = sourceCrc;
+	header.sourceSize = sourceSize;
+	header.crc = crc32_le(0, buffer + sizeof(header), bodySize);
+	memcpy(buffer, &header, sizeof(header));
+
+	File file = SPIFFS.open(CONFIG_CACHE_FILE_PATH, "w");
+	if (!file) {
+		Serial.println(F("WARN: [CFGCACHE] Unable to open snapshot for writing."));
+		return false;
+	}
+
+	size_t len = sizeof(header) + bodySize;
+	bool written = file.write(buffer, len) == len;
+	file.close();
+	if (!written) {
+		// A short write fails its CRC on the next boot, but don't leave
+		// it lying around.
+		Serial.println(F("WARN: [CFGCACHE] Failed to write snapshot."));
+		this->clear();
+	}
+
+	return written;
+}
+
+void ConfigCacheClass::clear() {
+	if (SPIFFS.exists(CONFIG_CACHE_FILE_PATH)) {
+		SPIFFS.remove(CONFIG_CACHE_FILE_PATH);
+	}
+}
+
+ConfigCacheClass ConfigCache;
\ No newline at end of file
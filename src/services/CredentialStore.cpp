@@ -0,0 +1,131 @@
+#include "services/CredentialStore.h"
+#include <rom/crc.h>
+
+CredentialStoreClass::CredentialStoreClass() {
+	this->_mapHandle = 0;
+	this->_image = nullptr;
+	this->_header = nullptr;
+	this->_displacements = nullptr;
+	this->_entries = nullptr;
+	this->_loaded = false;
+}
+
+uint32_t CredentialStoreClass::hash(const uint8_t* key, uint8_t len, uint32_t seed) {
+	// FNV-1a with a seeded basis, followed by the murmur3 finalizer.
+	uint32_t h = 0x811C9DC5 ^ seed;
+	for (uint8_t i = 0; i < len; i++) {
+		h ^= key[i];
+		h *= 0x01000193;
+	}
+
+	h ^= h >> 16;
+	h *= 0x85EBCA6B;
+	h ^= h >> 13;
+	h *= 0xC2B2AE35;
+	h ^= h >> 16;
+	return h;
+}
+
+bool CredentialStoreClass::begin() {
+	this->end();
+
+	const esp_partition_t* part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, CREDDB_PARTITION_SUBTYPE, CREDDB_PARTITION_LABEL);
+	if (part == NULL) {
+		Serial.println(F("ERROR: [CREDDB] Credential partition not found."));
+		return false;
+	}
+
+	const void* ptr = nullptr;
+	esp_err_t err = esp_partition_mmap(part, 0, part->size, SPI_FLASH_MMAP_DATA, &ptr, &this->_mapHandle);
+	if (err != ESP_OK) {
+		Serial.print(F("ERROR: [CREDDB] Failed to map credential partition: "));
+		Serial.println(err);
+		return false;
+	}
+
+	this->_image = (const uint8_t*)ptr;
+	this->_header = (const creddb_header_t*)this->_image;
+	if (this->_header->magic != CREDDB_MAGIC) {
+		Serial.println(F("WARN: [CREDDB] No credential image present."));
+		this->end();
+		return false;
+	}
+
+	if (this->_header->version != CREDDB_VERSION || this->_header->entrySize != CREDDB_ENTRY_SIZE) {
+		Serial.print(F("ERROR: [CREDDB] Unsupported image version: "));
+		Serial.println(this->_header->version);
+		this->end();
+		return false;
+	}
+
+	uint32_t bucketCount = this->_header->bucketCount;
+	uint32_t slotCount = this->_header->slotCount;
+	size_t bodySize = (bucketCount * sizeof(uint32_t)) + (slotCount * CREDDB_ENTRY_SIZE);
+	if (CREDDB_HEADER_SIZE + bodySize > part->size
+		|| (this->_header->entryCount > 0 && (bucketCount == 0 || slotCount < 2))) {
+		Serial.println(F("ERROR: [CREDDB] Credential image is truncated or malformed."));
+		this->end();
+		return false;
+	}
+
+	const uint8_t* body = this->_image + CREDDB_HEADER_SIZE;
+	if (crc32_le(0, body, bodySize) != this->_header->crc) {
+		Serial.println(F("ERROR: [CREDDB] Credential image CRC mismatch."));
+		this->end();
+		return false;
+	}
+
+	this->_displacements = (const uint32_t*)body;
+	this->_entries = (const creddb_entry_t*)(body + (bucketCount * sizeof(uint32_t)));
+	this->_loaded = true;
+	return true;
+}
+
+void CredentialStoreClass::end() {
+	if (this->_mapHandle != 0) {
+		spi_flash_munmap(this->_mapHandle);
+		this->_mapHandle = 0;
+	}
+
+	this->_image = nullptr;
+	this->_header = nullptr;
+	this->_displacements = nullptr;
+	this->_entries = nullptr;
+	this->_loaded = false;
+}
+
+bool CredentialStoreClass::isLoaded() {
+	return this->_loaded;
+}
+
+uint32_t CredentialStoreClass::getEntryCount() {
+	return this->_loaded ? this->_header->entryCount : 0;
+}
+
+uint32_t CredentialStoreClass::getGeneration() {
+	return this->_loaded ? this->_header->generation : 0;
+}
+
+CredentialStatus CredentialStoreClass::lookup(const uint8_t* uid, uint8_t len) {
+	if (!this->_loaded || this->_header->entryCount == 0 || len == 0 || len > CREDDB_MAX_UID_SIZE) {
+		return CredentialStatus::UNKNOWN;
+	}
+
+	uint32_t seed = this->_header->seed;
+	uint32_t slotCount = this->_header->slotCount;
+	uint32_t bucket = hash(uid, len, seed) % this->_header->bucketCount;
+	uint32_t h1 = hash(uid, len, seed + 1) % slotCount;
+	uint32_t h2 = (hash(uid, len, seed + 2) % (slotCount - 1)) + 1;
+	uint32_t slot = (uint32_t)((h1 + ((uint64_t)this->_displacements[bucket] * h2)) % slotCount);
+
+	// A perfect hash maps every key in the set to a unique slot, but keys
+	// outside the set land somewhere too, so the stored UID must match.
+	const creddb_entry_t* entry = &this->_entries[slot];
+	if (entry->uidLen != len || memcmp(entry->uid, uid, len) != 0) {
+		return CredentialStatus::UNKNOWN;
+	}
+
+	return (entry->flags & CREDDB_FLAG_GRANTED) ? CredentialStatus::GRANTED : CredentialStatus::DENIED;
+}
+
+CredentialStoreClass CredentialStore;
\ No newline at end of file
@@ -0,0 +1,322 @@
+#include "services/EventSpool.h"
+#include <rom/crc.h>
+
+static_assert(sizeof(spool_record_t) == SPOOL_RECORD_SIZE, "Spool record size mismatch");
+static_assert(sizeof(spool_sector_header_t) == SPOOL_HEADER_SIZE, "Spool header size mismatch");
+
+EventSpoolClass::EventSpoolClass() {
+	this->_partition = NULL;
+	this->_lock = NULL;
+	this->_sectorCount = 0;
+	this->_headSector = 0;
+	this->_headSlot = 0;
+	this->_headSequence = 0;
+	this->_tailSector = 0;
+	this->_tailSlot = 0;
+	this->_pending = 0;
+	this->_lost = 0;
+	this->_lastEventSequence = 0;
+	this->_ready = false;
+}
+
+bool EventSpoolClass::begin() {
+	this->_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, SPOOL_PARTITION_SUBTYPE, SPOOL_PARTITION_LABEL);
+	if (this->_partition == NULL) {
+		Serial.println(F("ERROR: [SPOOL] Spool partition not found."));
+		return false;
+	}
+
+	this->_sectorCount = this->_partition->size / SPOOL_SECTOR_SIZE;
+	if (this->_sectorCount < 2) {
+		Serial.println(F("ERROR: [SPOOL] Spool partition must be at least 2 sectors."));
+		return false;
+	}
+
+	if (this->_lock == NULL) {
+		this->_lock = xSemaphoreCreateMutex();
+	}
+
+	this->recover();
+	this->_ready = true;
+	return true;
+}
+
+bool EventSpoolClass::isReady() {
+	return this->_ready;
+}
+
+size_t EventSpoolClass::recordOffset(uint16_t sector, uint16_t slot) {
+	return ((size_t)sector * SPOOL_SECTOR_SIZE) + SPOOL_HEADER_SIZE + ((size_t)slot * SPOOL_RECORD_SIZE);
+}
+
+bool EventSpoolClass::readRecord(uint16_t sector, uint16_t slot, spool_record_t* record) {
+	return esp_partition_read(this->_partition, this->recordOffset(sector, slot), record, sizeof(spool_record_t)) == ESP_OK;
+}
+
+bool EventSpoolClass::isErased(const spool_record_t* record) {
+	const uint8_t* bytes = (const uint8_t*)record;
+	for (size_t i = 0; i < sizeof(spool_record_t); i++) {
+		if (bytes[i] != 0xFF) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool EventSpoolClass::isPending(const spool_record_t* record) {
+	if (record->consumed != SPOOL_ERASED || record->crc == SPOOL_ERASED) {
+		return false;
+	}
+
+	return crc32_le(0, (const uint8_t*)&record->event, sizeof(AccessEvent)) == record->crc;
+}
+
+void EventSpoolClass::advance(uint16_t* sector, uint16_t* slot) {
+	(*slot)++;
+	if (*slot >= SPOOL_RECORDS_PER_SECTOR) {
+		*slot = 0;
+		*sector = (*sector + 1) % this->_sectorCount;
+	}
+}
+
+uint32_t EventSpoolClass::readSectorSequence(uint16_t sector) {
+	spool_sector_header_t header;
+	if (esp_partition_read(this->_partition, (size_t)sector * SPOOL_SECTOR_SIZE, &header, sizeof(header)) != ESP_OK
+		|| header.magic != SPOOL_SECTOR_MAGIC || header.sequence == SPOOL_ERASED) {
+		return 0;
+	}
+
+	return header.sequence;
+}
+
+bool EventSpoolClass::openSector(uint16_t sector, uint32_t sequence) {
+	size_t offset = (size_t)sector * SPOOL_SECTOR_SIZE;
+	if (esp_partition_erase_range(this->_partition, offset, SPOOL_SECTOR_SIZE) != ESP_OK) {
+		Serial.print(F("ERROR: [SPOOL] Failed to erase sector "));
+		Serial.println(sector);
+		return false;
+	}
+
+	spool_sector_header_t header;
+	memset(&header, 0xFF, sizeof(header));
+	header.magic = SPOOL_SECTOR_MAGIC;
+	header.sequence = sequence;
+	return esp_partition_write(this->_partition, offset, &header, sizeof(header)) == ESP_OK;
+}
+
+void EventSpoolClass::recover() {
+	// The head is the sector opened most recently.
+	this->_headSequence = 0;
+	this->_headSector = 0;
+	for (uint16_t s = 0; s < this->_sectorCount; s++) {
+		uint32_t sequence = this->readSectorSequence(s);
+		if (sequence > this->_headSequence) {
+			this->_headSequence = sequence;
+			this->_headSector = s;
+		}
+	}
+
+	this->_pending = 0;
+	this->_lastEventSequence = 0;
+	if (this->_headSequence == 0) {
+		this->_headSlot = 0;
+		this->_tailSector = 0;
+		this->_tailSlot = 0;
+		return;
+	}
+
+	// Walk the ring oldest first. The first undelivered record is the tail;
+	// the slot after the last written record of the head sector is where
+	// the next append goes.
+	spool_record_t record;
+	bool tailFound = false;
+	for (uint16_t i = 1; i <= this->_sectorCount; i++) {
+		uint16_t s = (this->_headSector + i) % this->_sectorCount;
+		if (this->readSectorSequence(s) == 0) {
+			continue;
+		}
+
+		uint16_t lastWritten = 0;
+		for (uint16_t slot = 0; slot < SPOOL_RECORDS_PER_SECTOR; slot++) {
+			if (!this->readRecord(s, slot, &record)) {
+				continue;
+			}
+
+			if (!this->isErased(&record)) {
+				lastWritten = slot + 1;
+			}
+
+			if (record.crc == crc32_le(0, (const uint8_t*)&record.event, sizeof(AccessEvent))
+				&& record.event.sequence > this->_lastEventSequence) {
+				this->_lastEventSequence = record.event.sequence;
+			}
+
+			if (this->isPending(&record)) {
+				this->_pending++;
+				if (!tailFound) {
+					tailFound = true;
+					this->_tailSector = s;
+					this->_tailSlot = slot;
+				}
+			}
+		}
+
+		if (s == this->_headSector) {
+			this->_headSlot = lastWritten;
+		}
+	}
+
+	if (!tailFound) {
+		this->_tailSector = this->_headSector;
+		this->_tailSlot = this->_headSlot;
+	}
+
+	Serial.print(F("INFO: [SPOOL] Recovered "));
+	Serial.print(this->_pending);
+	Serial.println(F(" undelivered events."));
+}
+
+bool EventSpoolClass::append(const AccessEvent* event) {
+	if (!this->_ready) {
+		return false;
+	}
+
+	xSemaphoreTake(this->_lock, portMAX_DELAY);
+	if (this->_headSequence == 0 || this->_headSlot >= SPOOL_RECORDS_PER_SECTOR) {
+		uint16_t next = (this->_headSequence == 0) ? this->_headSector : (this->_headSector + 1) % this->_sectorCount;
+		if (this->_pending > 0 && this->_tailSector == next) {
+			// Full. Give up the oldest sector.
+			uint32_t dropped = 0;
+			spool_record_t record;
+			for (uint16_t slot = this->_tailSlot; slot < SPOOL_RECORDS_PER_SECTOR; slot++) {
+				if (this->readRecord(next, slot, &record) && this->isPending(&record)) {
+					dropped++;
+				}
+			}
+
+			this->_pending -= min(dropped, this->_pending);
+			this->_lost += dropped;
+			this->_tailSector = (next + 1) % this->_sectorCount;
+			this->_tailSlot = 0;
+			Serial.print(F("WARN: [SPOOL] Spool full. Dropped "));
+			Serial.print(dropped);
+			Serial.println(F(" oldest events."));
+		}
+
+		if (!this->openSector(next, this->_headSequence + 1)) {
+			xSemaphoreGive(this->_lock);
+			return false;
+		}
+
+		this->_headSector = next;
+		this->_headSlot = 0;
+		this->_headSequence++;
+		if (this->_pending == 0) {
+			this->_tailSector = this->_headSector;
+			this->_tailSlot = 0;
+		}
+	}
+
+	spool_record_t record;
+	memcpy(&record.event, event, sizeof(AccessEvent));
+	record.crc = crc32_le(0, (const uint8_t*)event, sizeof(AccessEvent));
+	record.consumed = SPOOL_ERASED;
+
+	size_t offset = this->recordOffset(this->_headSector, this->_headSlot);
+	this->_headSlot++;
+	bool result = esp_partition_write(this->_partition, offset, &record, sizeof(record)) == ESP_OK;
+	if (result) {
+		this->_pending++;
+		this->_lastEventSequence = event->sequence;
+	}
+	else {
+		Serial.println(F("ERROR: [SPOOL] Failed to write event."));
+	}
+
+	xSemaphoreGive(this->_lock);
+	return result;
+}
+
+bool EventSpoolClass::peek(AccessEvent* event) {
+	if (!this->_ready) {
+		return false;
+	}
+
+	bool result = false;
+	xSemaphoreTake(this->_lock, portMAX_DELAY);
+	spool_record_t record;
+	while (this->_pending > 0) {
+		if (this->_tailSector == this->_headSector && this->_tailSlot >= this->_headSlot) {
+			// Caught up with the writer; the count was off (ie. a torn write).
+			this->_pending = 0;
+			break;
+		}
+
+		if (this->readRecord(this->_tailSector, this->_tailSlot, &record) && this->isPending(&record)) {
+			memcpy(event, &record.event, sizeof(AccessEvent));
+			result = true;
+			break;
+		}
+
+		this->advance(&this->_tailSector, &this->_tailSlot);
+	}
+
+	xSemaphoreGive(this->_lock);
+	return result;
+}
+
+bool EventSpoolClass::markConsumed(uint32_t sequence) {
+	// The record is checked again in case the writer reclaimed its sector
+	// since peek().
+	spool_record_t record;
+	if (this->_pending == 0 || !this->readRecord(this->_tailSector, this->_tailSlot, &record)
+		|| !this->isPending(&record) || record.event.sequence != sequence) {
+		return false;
+	}
+
+	// Programming bits 1 -> 0 needs no erase.
+	uint32_t consumed = 0;
+	size_t offset = this->recordOffset(this->_tailSector, this->_tailSlot) + offsetof(spool_record_t, consumed);
+	esp_partition_write(this->_partition, offset, &consumed, sizeof(consumed));
+	this->advance(&this->_tailSector, &this->_tailSlot);
+	this->_pending--;
+	return true;
+}
+
+void EventSpoolClass::consume(uint32_t sequence) {
+	if (!this->_ready) {
+		return;
+	}
+
+	xSemaphoreTake(this->_lock, portMAX_DELAY);
+	this->markConsumed(sequence);
+	xSemaphoreGive(this->_lock);
+}
+
+void EventSpoolClass::discard(uint32_t sequence) {
+	if (!this->_ready) {
+		return;
+	}
+
+	xSemaphoreTake(this->_lock, portMAX_DELAY);
+	if (this->markConsumed(sequence)) {
+		this->_lost++;
+	}
+
+	xSemaphoreGive(this->_lock);
+}
+
+uint32_t EventSpoolClass::getPendingCount() {
+	return this->_pending;
+}
+
+uint32_t EventSpoolClass::getLostCount() {
+	return this->_lost;
+}
+
+uint32_t EventSpoolClass::getLastSequence() {
+	return this->_lastEventSequence;
+}
+
+EventSpoolClass EventSpool;
\ No newline at end of file
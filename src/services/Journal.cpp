@@ -0,0 +1,361 @@
+#include "services/Journal.h"
+#include <rom/crc.h>
+
+static_assert(sizeof(journal_block_header_t) == JOURNAL_HEADER_SIZE, "Journal header size mismatch");
+
+// Length byte, body, CRC-8.
+#define JOURNAL_FRAME_OVERHEAD 2
+#define JOURNAL_MIN_BODY 6
+
+JournalClass::JournalClass() {
+	this->_partition = NULL;
+	this->_mapHandle = 0;
+	this->_image = nullptr;
+	this->_blockCount = 0;
+	this->_headBlock = 0;
+	this->_headOffset = 0;
+	this->_headSequence = 0;
+	this->_lastTime = 0;
+	this->_ready = false;
+}
+
+bool JournalClass::begin() {
+	this->_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, JOURNAL_PARTITION_SUBTYPE, JOURNAL_PARTITION_LABEL);
+	if (this->_partition == NULL) {
+		Serial.println(F("ERROR: [JOURNAL] Journal partition not found."));
+		return false;
+	}
+
+	this->_blockCount = min((uint32_t)(this->_partition->size / JOURNAL_BLOCK_SIZE), (uint32_t)JOURNAL_MAX_BLOCKS);
+	if (this->_blockCount < 2) {
+		Serial.println(F("ERROR: [JOURNAL] Journal partition must be at least 2 sectors."));
+		return false;
+	}
+
+	const void* ptr = nullptr;
+	size_t size = (size_t)this->_blockCount * JOURNAL_BLOCK_SIZE;
+	esp_err_t err = esp_partition_mmap(this->_partition, 0, size, SPI_FLASH_MMAP_DATA, &ptr, &this->_mapHandle);
+	if (err != ESP_OK) {
+		Serial.print(F("ERROR: [JOURNAL] Failed to map journal partition: "));
+		Serial.println(err);
+		return false;
+	}
+
+	this->_image = (const uint8_t*)ptr;
+	this->recover();
+	this->_ready = true;
+	return true;
+}
+
+bool JournalClass::isReady() {
+	return this->_ready;
+}
+
+uint32_t JournalClass::doorBit(uint8_t doorId) {
+	return doorId < 31 ? (1UL << doorId) : JOURNAL_DOOR_NONE_BIT;
+}
+
+const journal_block_header_t* JournalClass::header(uint16_t block) {
+	return (const journal_block_header_t*)(this->_image + ((size_t)block * JOURNAL_BLOCK_SIZE));
+}
+
+size_t JournalClass::encode(const JournalRecord* record, int32_t delta, uint8_t* buffer) {
+	uint8_t* body = buffer + 1;
+	uint8_t len = 0;
+	body[len++] = (uint8_t)record->type;
+
+	// Zigzag keeps small negative deltas (clock corrections) small too.
+	uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+	while (zigzag >= 0x80) {
+		body[len++] = (uint8_t)(zigzag | 0x80);
+		zigzag >>= 7;
+	}
+
+	body[len++] = (uint8_t)zigzag;
+	body[len++] = record->doorId;
+	body[len++] = record->source;
+	body[len++] = record->target;
+	body[len++] = record->value;
+
+	uint8_t dataLen = min(record->dataLen, (uint8_t)JOURNAL_MAX_DATA);
+	memcpy(&body[len], record->data, dataLen);
+	len += dataLen;
+
+	buffer[0] = len;
+	buffer[1 + len] = crc8_le(0, buffer, len + 1);
+	return len + JOURNAL_FRAME_OVERHEAD;
+}
+
+bool JournalClass::decode(const uint8_t* body, uint8_t len, uint32_t prevTime, JournalRecord* record) {
+	uint8_t i = 0;
+	record->type = (JournalEventType)body[i++];
+	if (record->type > JournalEventType::ZONE) {
+		return false;
+	}
+
+	uint32_t zigzag = 0;
+	for (uint8_t shift = 0; shift < 35; shift += 7) {
+		if (i >= len) {
+			return false;
+		}
+
+		uint8_t b = body[i++];
+		zigzag |= (uint32_t)(b & 0x7F) << shift;
+		if ((b & 0x80) == 0) {
+			break;
+		}
+	}
+
+	if (i + 4 > len || len - (i + 4) > JOURNAL_MAX_DATA) {
+		return false;
+	}
+
+	int32_t delta = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+	record->timestamp = prevTime + delta;
+	record->doorId = body[i++];
+	record->source = body[i++];
+	record->target = body[i++];
+	record->value = body[i++];
+	record->dataLen = len - i;
+	memcpy(record->data, &body[i], record->dataLen);
+	return true;
+}
+
+size_t JournalClass::next(uint16_t block, size_t offset, uint32_t* prevTime, JournalRecord* record, bool* valid) {
+	// Returns the offset of the following record, or 0 at the end of the
+	// block. A record that fails its CRC (a torn write) is skipped; the
+	// writer chains its deltas from the last valid record as well.
+	const uint8_t* frame = this->_image + ((size_t)block * JOURNAL_BLOCK_SIZE) + offset;
+	if (offset + JOURNAL_FRAME_OVERHEAD > JOURNAL_BLOCK_SIZE) {
+		return 0;
+	}
+
+	uint8_t len = frame[0];
+	if (len < JOURNAL_MIN_BODY || len > JOURNAL_MAX_BODY || offset + len + JOURNAL_FRAME_OVERHEAD > JOURNAL_BLOCK_SIZE) {
+		return 0;
+	}
+
+	*valid = crc8_le(0, frame, len + 1) == frame[len + 1] && decode(&frame[1], len, *prevTime, record);
+	if (*valid) {
+		*prevTime = record->timestamp;
+	}
+
+	return offset + len + JOURNAL_FRAME_OVERHEAD;
+}
+
+void JournalClass::scanBlock(uint16_t block, size_t* end, uint32_t* lastTime) {
+	journal_index_t* index = &this->_index[block];
+	uint32_t prevTime = this->header(block)->baseTime;
+	JournalRecord record;
+	bool valid;
+	size_t offset = JOURNAL_HEADER_SIZE;
+	size_t following;
+	while ((following = this->next(block, offset, &prevTime, &record, &valid)) != 0) {
+		if (valid) {
+			index->minTime = min(index->minTime, record.timestamp);
+			index->maxTime = max(index->maxTime, record.timestamp);
+			index->doorMask |= doorBit(record.doorId);
+		}
+
+		offset = following;
+	}
+
+	// Anything other than erased flash here is a corrupt length byte. Don't
+	// append after it.
+	if (offset < JOURNAL_BLOCK_SIZE && this->_image[((size_t)block * JOURNAL_BLOCK_SIZE) + offset] != 0xFF) {
+		offset = JOURNAL_BLOCK_SIZE;
+	}
+
+	*end = offset;
+	*lastTime = prevTime;
+}
+
+void JournalClass::recover() {
+	this->_headSequence = 0;
+	this->_headBlock = 0;
+	for (uint16_t b = 0; b < this->_blockCount; b++) {
+		const journal_block_header_t* hdr = this->header(b);
+		journal_index_t* index = &this->_index[b];
+		index->sequence = 0;
+		index->minTime = JOURNAL_ERASED;
+		index->maxTime = 0;
+		index->doorMask = 0;
+		if (hdr->magic != JOURNAL_BLOCK_MAGIC || hdr->sequence == JOURNAL_ERASED || hdr->sequence == 0) {
+			continue;
+		}
+
+		index->sequence = hdr->sequence;
+		if (hdr->sequence > this->_headSequence) {
+			this->_headSequence = hdr->sequence;
+			this->_headBlock = b;
+		}
+
+		if (hdr->sealed == JOURNAL_SEALED) {
+			index->minTime = hdr->minTime;
+			index->maxTime = hdr->maxTime;
+			index->doorMask = hdr->doorMask;
+		}
+		else {
+			size_t end;
+			uint32_t lastTime;
+			this->scanBlock(b, &end, &lastTime);
+		}
+	}
+
+	this->_headOffset = JOURNAL_BLOCK_SIZE;
+	this->_lastTime = 0;
+	if (this->_headSequence != 0 && this->header(this->_headBlock)->sealed != JOURNAL_SEALED) {
+		// Scanned above, but the end of the head block is needed too.
+		journal_index_t* index = &this->_index[this->_headBlock];
+		index->minTime = JOURNAL_ERASED;
+		index->maxTime = 0;
+		index->doorMask = 0;
+		this->scanBlock(this->_headBlock, &this->_headOffset, &this->_lastTime);
+	}
+
+	Serial.print(F("INFO: [JOURNAL] Head block sequence: "));
+	Serial.println(this->_headSequence);
+}
+
+bool JournalClass::sealBlock(uint16_t block) {
+	if (this->header(block)->sealed == JOURNAL_SEALED) {
+		return true;
+	}
+
+	const journal_index_t* index = &this->_index[block];
+	uint32_t summary[4] = { index->minTime, index->maxTime, index->doorMask, JOURNAL_SEALED };
+	size_t offset = ((size_t)block * JOURNAL_BLOCK_SIZE) + offsetof(journal_block_header_t, minTime);
+	return esp_partition_write(this->_partition, offset, summary, sizeof(summary)) == ESP_OK;
+}
+
+bool JournalClass::openBlock(uint16_t block, uint32_t sequence, uint32_t baseTime) {
+	size_t offset = (size_t)block * JOURNAL_BLOCK_SIZE;
+	journal_index_t* index = &this->_index[block];
+	index->sequence = 0;
+	if (esp_partition_erase_range(this->_partition, offset, JOURNAL_BLOCK_SIZE) != ESP_OK) {
+		Serial.print(F("ERROR: [JOURNAL] Failed to erase block "));
+		Serial.println(block);
+		return false;
+	}
+
+	// The summary half stays erased until the block is sealed.
+	uint32_t head[3] = { JOURNAL_BLOCK_MAGIC, sequence, baseTime };
+	if (esp_partition_write(this->_partition, offset, head, sizeof(head)) != ESP_OK) {
+		return false;
+	}
+
+	index->sequence = sequence;
+	index->minTime = JOURNAL_ERASED;
+	index->maxTime = 0;
+	index->doorMask = 0;
+	return true;
+}
+
+bool JournalClass::append(const JournalRecord* record) {
+	if (!this->_ready) {
+		return false;
+	}
+
+	uint8_t frame[JOURNAL_MAX_BODY + JOURNAL_FRAME_OVERHEAD];
+	size_t size = encode(record, (int32_t)(record->timestamp - this->_lastTime), frame);
+	if (this->_headSequence == 0 || this->_headOffset + size > JOURNAL_BLOCK_SIZE) {
+		uint16_t block = this->_headBlock;
+		if (this->_headSequence != 0) {
+			if (!this->sealBlock(block)) {
+				Serial.println(F("WARN: [JOURNAL] Failed to seal block. It will be scanned on query."));
+			}
+
+			block = (block + 1) % this->_blockCount;
+		}
+
+		if (!this->openBlock(block, this->_headSequence + 1, record->timestamp)) {
+			return false;
+		}
+
+		this->_headBlock = block;
+		this->_headOffset = JOURNAL_HEADER_SIZE;
+		this->_headSequence++;
+		this->_lastTime = record->timestamp;
+		size = encode(record, 0, frame);
+	}
+
+	size_t offset = ((size_t)this->_headBlock * JOURNAL_BLOCK_SIZE) + this->_headOffset;
+	this->_headOffset += size;
+	if (esp_partition_write(this->_partition, offset, frame, size) != ESP_OK) {
+		Serial.println(F("ERROR: [JOURNAL] Failed to write record."));
+		return false;
+	}
+
+	journal_index_t* index = &this->_index[this->_headBlock];
+	index->minTime = min(index->minTime, record->timestamp);
+	index->maxTime = max(index->maxTime, record->timestamp);
+	index->doorMask |= doorBit(record->doorId);
+	this->_lastTime = record->timestamp;
+	return true;
+}
+
+bool JournalClass::blockMayMatch(const JournalQuery* query, const journal_index_t* index) {
+	if (index->maxTime < query->from || (query->to != 0 && index->minTime > query->to)) {
+		return false;
+	}
+
+	return query->doorId == JOURNAL_ANY_DOOR || (index->doorMask & doorBit(query->doorId)) != 0;
+}
+
+uint8_t JournalClass::query(JournalQuery* query, JournalRecord* results, uint8_t maxResults) {
+	uint32_t cursor = query->cursor;
+	query->cursor = 0;
+	if (!this->_ready || this->_headSequence == 0 || maxResults == 0) {
+		return 0;
+	}
+
+	// Cursors carry the low 20 bits of the block sequence and a 12 bit
+	// offset. A cursor into a block that has since been reused restarts
+	// at the oldest block.
+	uint32_t oldest = this->_headSequence >= this->_blockCount ? this->_headSequence - this->_blockCount + 1 : 1;
+	uint32_t sequence = oldest;
+	size_t resumeAt = 0;
+	if (cursor != 0) {
+		uint32_t age = (this->_headSequence - (cursor >> 12)) & 0xFFFFF;
+		if (age < this->_blockCount && this->_headSequence - age >= oldest) {
+			sequence = this->_headSequence - age;
+			resumeAt = cursor & 0xFFF;
+		}
+	}
+
+	uint8_t count = 0;
+	JournalRecord record;
+	for (; sequence <= this->_headSequence; sequence++, resumeAt = 0) {
+		uint16_t block = (this->_headBlock + this->_blockCount - (this->_headSequence - sequence)) % this->_blockCount;
+		const journal_index_t* index = &this->_index[block];
+		if (index->sequence != sequence || !this->blockMayMatch(query, index)) {
+			continue;
+		}
+
+		// Deltas chain from the start of the block, so decoding always
+		// starts there even when resuming.
+		uint32_t prevTime = this->header(block)->baseTime;
+		size_t offset = JOURNAL_HEADER_SIZE;
+		size_t following;
+		bool valid;
+		while ((following = this->next(block, offset, &prevTime, &record, &valid)) != 0) {
+			if (valid && offset >= resumeAt
+				&& record.timestamp >= query->from
+				&& (query->to == 0 || record.timestamp <= query->to)
+				&& (query->doorId == JOURNAL_ANY_DOOR || record.doorId == query->doorId)) {
+				if (count == maxResults) {
+					query->cursor = ((sequence & 0xFFFFF) << 12) | (uint32_t)offset;
+					return count;
+				}
+
+				memcpy(&results[count++], &record, sizeof(JournalRecord));
+			}
+
+			offset = following;
+		}
+	}
+
+	return count;
+}
+
+JournalClass Journal;
\ No newline at end of file
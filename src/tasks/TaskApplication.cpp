@@ -2,7 +2,7 @@
 
 void initApplication() {
 	TaskHandle_t taskHandle = Application::singleton->applicationTask;
-	xTaskCreate(ApplicationTask, "main program", 8192, NULL, 2, &taskHandle);
+	xTaskCreate(ApplicationTask, "main program", APPLICATION_TASK_STACK_SIZE, NULL, 2, &taskHandle);
 }
 
 void ApplicationTask(void *pvParameter) {
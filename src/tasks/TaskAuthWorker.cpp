@@ -0,0 +1,46 @@
+#include "tasks/TaskAuthWorker.h"
+#include "services/AuthService.h"
+
+TaskHandle_t initAuthWorker() {
+	TaskHandle_t handle = Application::singleton->authWorkerTask;
+	xTaskCreate(authWorkerTask, "auth worker", AUTH_WORKER_TASK_STACK_SIZE, NULL, 2, &handle);
+	TaskStats.watchTask(handle, AUTH_WORKER_TASK_STACK_SIZE);
+	return handle;
+}
+
+void authWorkerTask(void *pvParameter) {
+	QueueHandle_t requests = Application::singleton->authRequestQueue;
+	QueueHandle_t results = Application::singleton->authResultQueue;
+
+	AuthRequest request;
+	AuthResult result;
+	for (;;) {
+		if (!xQueueReceive(requests, &request, portMAX_DELAY)) {
+			continue;
+		}
+
+		result.request = request;
+		result.code = AuthResultCode::EXPIRED;
+		result.startedAt = micros();
+		if ((long)(millis() - request.deadline) < 0) {
+			bool valid = request.type == AuthRequestType::CARD
+				? AuthService.checkCardValid(request.credential)
+				: AuthService.checkPinValid(request.credential);
+
+			// A decision that arrives after the deadline is stale (the user
+			// has likely walked away), so it is reported as expired.
+			if ((long)(millis() - request.deadline) < 0) {
+				result.code = valid ? AuthResultCode::ACCEPTED : AuthResultCode::REJECTED;
+			}
+		}
+
+		result.finishedAt = micros();
+
+		// Every decision has to reach the main loop, which journals it and
+		// answers the user, so wait for room rather than drop it. Bounded in
+		// case the loop is wedged.
+		if (!TaskStats.send(results, &result, AUTH_RESULT_TIMEOUT / portTICK_PERIOD_MS)) {
+			Serial.println(F("ERROR: [AUTH] Result queue full. Dropping auth result."));
+		}
+	}
+}
\ No newline at end of file
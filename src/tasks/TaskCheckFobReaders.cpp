@@ -3,20 +3,26 @@
 TaskHandle_t initFobReaderDevices() {
 	TaskHandle_t handle = Application::singleton->fobReaderCheckTask;
 	Application::singleton->initFobReaders();
-	xTaskCreate(fobReaderTask, "fob reader subsystem", 2048, NULL, 2, &handle);
+	xTaskCreate(fobReaderTask, "fob reader subsystem", FOB_READER_TASK_STACK_SIZE, NULL, 2, &handle);
+	TaskStats.watchTask(handle, FOB_READER_TASK_STACK_SIZE);
 	return handle;
 }
 
 void fobReaderTask(void *pvParameter) {
 	QueueHandle_t queue = Application::singleton->fobReaderQueue;
 	for (;;) {
+		// Each reader sets its own pace (see FobReader::schedule()). Sleep
+		// until the next one is due.
+		uint32_t delayMs = FOBREADER_POLL_IDLE;
 		for (size_t i = 0; i < Application::singleton->fobReaders.size(); i++) {
-			auto fr = Application::singleton->fobReaders.at(i);
-			if (fr.isNewTagPresent() && fr.getTagData()) {
-				xQueueSend(queue, &fr.tag, 0);
+			FobReader* fr = &Application::singleton->fobReaders.at(i);
+			if (fr->poll()) {
+				TaskStats.send(queue, &fr->tag);
 			}
+
+			delayMs = min(delayMs, fr->getPollDelay());
 		}
 
-		vTaskDelay(20 / portTICK_PERIOD_MS);
+		vTaskDelay(max(delayMs / portTICK_PERIOD_MS, (uint32_t)1));
 	}
 }
\ No newline at end of file
@@ -3,21 +3,28 @@
 TaskHandle_t initKeypadDevices() {
 	TaskHandle_t handle = Application::singleton->keypadCheckTask;
 	Application::singleton->initKeypads();
-	xTaskCreate(keypadTask, "keypad subsystem", 2048, NULL, 2, &handle);
+	xTaskCreate(keypadTask, "keypad subsystem", KEYPAD_TASK_STACK_SIZE, NULL, 2, &handle);
+	TaskStats.watchTask(handle, KEYPAD_TASK_STACK_SIZE);
 	return handle;
 }
 
 void keypadTask(void *pvParameter) {
 	QueueHandle_t queue = Application::singleton->keypadQueue;
 	for (;;) {
-		for (size_t i = 0; Application::singleton->keypads.size(); i++) {
-			auto kp = Application::singleton->keypads.at(i);
-			auto data = kp.readEntries();
+		// Each poll is one short bus operation. Come back sooner while a
+		// keypad is preparing its reply.
+		bool awaiting = false;
+		for (size_t i = 0; i < Application::singleton->keypads.size(); i++) {
+			Keypad* kp = &Application::singleton->keypads.at(i);
+			KeypadData* data = kp->poll();
 			if (data != nullptr) {
-				xQueueSend(queue, &data, 0);
+				TaskStats.send(queue, data);
 			}
+
+			awaiting |= kp->isAwaitingResponse();
 		}
 
-		vTaskDelay(20 / portTICK_PERIOD_MS);
+		uint32_t delayMs = awaiting ? I2C_EXCHANGE_RESPONSE_DELAY : KEYPAD_POLL_INTERVAL;
+		vTaskDelay(max(delayMs / portTICK_PERIOD_MS, (uint32_t)1));
 	}
 }
\ No newline at end of file
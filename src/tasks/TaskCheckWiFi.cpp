@@ -3,7 +3,8 @@
 TaskHandle_t initCheckWiFi() {
 	TaskHandle_t handle = Application::singleton->wifiCheckTask;
 	Application::singleton->initWiFi();
-	xTaskCreate(checkWiFiTask, "wifi status check", 2048, NULL, 1, &handle);
+	xTaskCreate(checkWiFiTask, "wifi status check", WIFI_TASK_STACK_SIZE, NULL, 1, &handle);
+	TaskStats.watchTask(handle, WIFI_TASK_STACK_SIZE);
 	return handle;
 }
 
@@ -4,7 +4,8 @@ TaskHandle_t initClockSync() {
 	TaskHandle_t handle = Application::singleton->clockSyncTask;
 	Application::singleton->initRTC();
 	Application::singleton->initTimeclient();
-	xTaskCreate(clockSyncTask, "RTC sync", 2048, NULL, 1, &handle);
+	xTaskCreate(clockSyncTask, "RTC sync", CLOCK_SYNC_TASK_STACK_SIZE, NULL, 1, &handle);
+	TaskStats.watchTask(handle, CLOCK_SYNC_TASK_STACK_SIZE);
 	return handle;
 }
 
@@ -24,7 +25,13 @@ void printTimestamp(DateTime timestamp) {
 
 void clockSyncTask(void *pvParameter) {
 	for (;;) {
-		DateTime rtcTime = Application::singleton->rtc.now();
+		DateTime rtcTime;
+		{
+			// RTClib drives Wire directly.
+			I2CTransaction txn(RTC_ADDRESS);
+			rtcTime = Application::singleton->rtc.now();
+		}
+
 		Serial.print(F("INFO: Current RTC time: "));
 		printTimestamp(rtcTime);
 
@@ -43,6 +50,7 @@ void clockSyncTask(void *pvParameter) {
 			Serial.print(diff, DEC);
 			Serial.print(F(" seconds"));
 			Serial.println(F("INFO: Adjusting RTC time..."));
+			I2CTransaction txn(RTC_ADDRESS);
 			Application::singleton->rtc.adjust(timestamp);
 		}
 		else {
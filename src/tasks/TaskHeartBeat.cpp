@@ -2,7 +2,8 @@
 
 TaskHandle_t initHeartbeat() {
 	TaskHandle_t handle = Application::singleton->heartbeatTask;
-	xTaskCreatePinnedToCore(heartBeatTask, "heartbeat", 1024, NULL, 2, &handle, PIO_CORE_ID);
+	xTaskCreatePinnedToCore(heartBeatTask, "heartbeat", HEARTBEAT_TASK_STACK_SIZE, NULL, 2, &handle, PIO_CORE_ID);
+	TaskStats.watchTask(handle, HEARTBEAT_TASK_STACK_SIZE);
 	return handle;
 }
 
@@ -29,7 +30,9 @@ void heartBeatTask(void *pvParameter) {
 		}
 
 		if (flashes == 0 && delayMs == 0) {
+			// Solid while booting. Check back later rather than spin.
 			CoreIO.heartbeatLedOn();
+			vTaskDelay(HEARTBEAT_BOOT_POLL / portTICK_PERIOD_MS);
 			continue;
 		}
 
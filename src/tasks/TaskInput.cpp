@@ -1,25 +1,62 @@
 #include "tasks/TaskInput.h"
+#include "InputFilter.h"
 
 TaskHandle_t initInputTask() {
 	TaskHandle_t handle = Application::singleton->inputTask;
-	xTaskCreatePinnedToCore(inputTask, "zone inputs", 1024, NULL, 2, &handle, PIO_CORE_ID);
+	xTaskCreatePinnedToCore(inputTask, "zone inputs", INPUT_TASK_STACK_SIZE, NULL, 2, &handle, PIO_CORE_ID);
+	TaskStats.watchTask(handle, INPUT_TASK_STACK_SIZE);
+	CoreIO.enableInputInterrupts(handle);
 	return handle;
 }
 
 void inputTask(void *pvParameter) {
-	QueueHandle_t optoQueue = Application::singleton->optoContactQueue;
-	QueueHandle_t dcQueue = Application::singleton->dryContactQueue;
+	QueueHandle_t queue = Application::singleton->zoneQueue;
 
-	uint8_t value = 0;
+	// The first snapshot is a baseline with no edges so consumers learn the
+	// initial state of every zone.
+	ZoneSnapshot snapshot;
+	snapshot.timestamp = millis();
+	snapshot.state = CoreIO.readZoneInputs();
+	snapshot.rising = 0;
+	snapshot.falling = 0;
+	InputFilter.reset(snapshot.state);
+	TaskStats.send(queue, &snapshot);
+
+	uint16_t last = snapshot.state;
+	uint16_t current = 0;
 	for (;;) {
-		for (uint8_t i = 0; i < 8; i++) {
-			value = CoreIO.readOptoZoneInput((OnboardOptoZoneInput)i);
-			xQueueSend(optoQueue, &value, 0);
+		if (InputFilter.isSettling()) {
+			// Sample at a fixed rate until every changed zone has either
+			// settled or bounced back. Interrupts raised by the bounce itself
+			// are discarded so they don't skew the sample timing.
+			vTaskDelay(INPUT_FILTER_SAMPLE_INTERVAL / portTICK_PERIOD_MS);
+			ulTaskNotifyTake(pdTRUE, 0);
+		}
+		else {
+			// Sleep until a zone input interrupt fires. The timeout is only a
+			// safety net in case an edge is missed, or a short retry when edges
+			// are still waiting for room in the queue. Without the expander's
+			// interrupt line, its zones are only seen when polled.
+			bool pending = (snapshot.rising | snapshot.falling) != 0;
+			bool poll = pending || !CoreIO.hasExpanderInterrupt();
+			ulTaskNotifyTake(pdTRUE, (poll ? ZONE_POLL_INTERVAL : ZONE_RESCAN_INTERVAL) / portTICK_PERIOD_MS);
+		}
 
-			value = CoreIO.readDryContactZoneInput((OnboardDryContactInput)i);
-			xQueueSend(dcQueue, &value, 0);
+		current = InputFilter.update(CoreIO.readZoneInputs());
+		uint16_t changed = current ^ last;
+		if (changed != 0) {
+			snapshot.rising |= changed & current;
+			snapshot.falling |= changed & ~current;
+			snapshot.state = current;
+			snapshot.timestamp = millis();
+			last = current;
 		}
 
-		vTaskDelay(20 / portTICK_PERIOD_MS);
+		// If the queue was full, the edges stay accumulated in the snapshot
+		// and go out with the next one instead of being lost.
+		if ((snapshot.rising | snapshot.falling) != 0 && TaskStats.send(queue, &snapshot)) {
+			snapshot.rising = 0;
+			snapshot.falling = 0;
+		}
 	}
 }
\ No newline at end of file
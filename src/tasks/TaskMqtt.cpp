@@ -0,0 +1,16 @@
+#include "tasks/TaskMqtt.h"
+
+TaskHandle_t initMqttTask() {
+	TaskHandle_t handle = Application::singleton->mqttTask;
+	Application::singleton->initMQTT();
+	xTaskCreate(mqttNetworkTask, "MQTT network", MQTT_TASK_STACK_SIZE, NULL, 1, &handle);
+	TaskStats.watchTask(handle, MQTT_TASK_STACK_SIZE);
+	return handle;
+}
+
+void mqttNetworkTask(void *pvParameter) {
+	for (;;) {
+		Application::singleton->onMqttService();
+		vTaskDelay(MQTT_SERVICE_INTERVAL / portTICK_PERIOD_MS);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#include "tasks/TaskRefreshAuthToken.h"
+#include "services/AuthService.h"
+
+TaskHandle_t initAuthTokenRefresh() {
+	TaskHandle_t handle = Application::singleton->authTokenTask;
+	xTaskCreate(authTokenRefreshTask, "auth token refresh", AUTH_TOKEN_TASK_STACK_SIZE, NULL, 1, &handle);
+	TaskStats.watchTask(handle, AUTH_TOKEN_TASK_STACK_SIZE);
+	return handle;
+}
+
+void authTokenRefreshTask(void *pvParameter) {
+	for (;;) {
+		Application::singleton->onRefreshAuthToken();
+		vTaskDelay(AUTH_TOKEN_CHECK_INTERVAL / portTICK_PERIOD_MS);
+	}
+}
\ No newline at end of file
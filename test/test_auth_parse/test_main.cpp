@@ -0,0 +1,245 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <WiFi.h>
+#include "ChunkedStream.h"
+#include "NativeHarness.h"
+#include "services/AuthService.h"
+
+// AuthService response parsing against the stand-in API, with responses
+// sent both with a Content-Length and chunked. The benchmark compares the
+// filtered parse with what the service did before: copy the body into a
+// String and parse all of it into a DynamicJsonDocument sized from the
+// free heap.
+
+#define API_LOGIN "http://api.local/login"
+#define API_CARD "http://api.local/card"
+#define API_PIN "http://api.local/pin"
+#define API_TOKEN "eyJhbGciOiJIUzI1NiJ9.c2l0ZS1jb250cm9sbGVyLTAx.c2lnbmF0dXJlLXN0YW5kLWlu"
+#define BENCH_ROUNDS 5000UL
+
+static const char* responseHeaders[] = { "Transfer-Encoding" };
+
+struct ParseResult {
+	double nanos;
+	size_t heapBytes;
+	size_t arenaBytes;
+	size_t bodyBytes;
+};
+
+static bool chunked;
+static uint16_t padding;            // Extra profile fields added to every response.
+static uint32_t logins;
+
+// The responses carry what a typical access API sends alongside the one
+// field the controller needs.
+static void addProfile(String& body) {
+	body += "\"holder\":{\"name\":\"Jordan Example\",\"department\":\"Facilities\",\"groups\":[\"staff\",\"after-hours\",\"loading-dock\"]},";
+	body += "\"audit\":{\"requestId\":\"6f1c9a7e-52d4-4b0e-9f3a-1d2e3c4b5a69\",\"server\":\"api-02\",\"elapsedMs\":12},";
+	for (uint16_t i = 0; i < padding; i++) {
+		body += "\"note";
+		body += String(i);
+		body += "\":\"Lorem ipsum dolor sit amet, consectetur adipiscing elit\",";
+	}
+}
+
+static int respond(HTTPExchange& exchange) {
+	exchange.chunked = chunked;
+	exchange.body = "{";
+	addProfile(exchange.body);
+	if (exchange.url == API_LOGIN) {
+		logins++;
+		exchange.body += "\"token\":\"" API_TOKEN "\",\"expiresIn\":3600}";
+		return HTTP_CODE_OK;
+	}
+
+	if (exchange.authorization != "Bearer " API_TOKEN) {
+		return HTTP_CODE_UNAUTHORIZED;
+	}
+
+	exchange.body += exchange.url.indexOf("=0000") >= 0 ? "\"accepted\":false}" : "\"accepted\":true}";
+	return HTTP_CODE_OK;
+}
+
+// Fetches a validation response and times only the parse (host
+// nanoseconds) with the given parser.
+typedef bool (*ResponseParser)(HTTPClient& http, ParseResult* result);
+
+static bool timeParse(ResponseParser parser, ParseResult* result) {
+	WiFiClient client;
+	HTTPClient http;
+	http.collectHeaders(responseHeaders, 1);
+	http.begin(client, API_CARD "?serial=04A1B2C3");
+	http.addHeader("Authorization", "Bearer " API_TOKEN);
+	bool accepted = false;
+	if (http.GET() == HTTP_CODE_OK) {
+		uint64_t start = nativeHostNanos();
+		accepted = parser(http, result);
+		result->nanos += nativeHostNanos() - start;
+	}
+
+	http.end();
+	return accepted;
+}
+
+// The same steps as AuthServiceClass::parseResponse().
+static bool filteredParse(HTTPClient& http, ParseResult* result) {
+	StaticJsonDocument<JSON_OBJECT_SIZE(1)> filter;
+	filter["accepted"] = true;
+
+	StaticJsonDocument<AUTH_VALIDATE_DOC_SIZE> responsePayload;
+	DeserializationError err;
+	if (http.getSize() >= 0 || !http.header("Transfer-Encoding").equalsIgnoreCase("chunked")) {
+		err = deserializeJson(responsePayload, http.getStream(), DeserializationOption::Filter(filter));
+	}
+	else {
+		ChunkedStream body(http.getStream());
+		err = deserializeJson(responsePayload, body, DeserializationOption::Filter(filter));
+		body.finish();
+	}
+
+	result->heapBytes = 0;
+	result->arenaBytes = responsePayload.memoryUsage();
+	return !err && responsePayload["accepted"].as<bool>();
+}
+
+// The parse the service used before: the whole body as a String, parsed
+// unfiltered into a document that claims what the heap has left.
+static bool legacyParse(HTTPClient& http, ParseResult* result) {
+	uint16_t freeMem = ESP.getFreeHeap() - 512;
+	DynamicJsonDocument responsePayload(freeMem);
+	String body = http.getString();
+	DeserializationError err = deserializeJson(responsePayload, body);
+	result->heapBytes = freeMem + body.length();
+	result->arenaBytes = responsePayload.memoryUsage();
+	result->bodyBytes = body.length();
+	return !err && responsePayload["accepted"].as<bool>();
+}
+
+static ParseResult bench(ResponseParser parser) {
+	ParseResult result;
+	memset(&result, 0, sizeof(result));
+	for (uint32_t i = 0; i < BENCH_ROUNDS; i++) {
+		TEST_ASSERT_TRUE(timeParse(parser, &result));
+	}
+
+	result.nanos /= BENCH_ROUNDS;
+	return result;
+}
+
+static void report(const char* name, const ParseResult& filtered, const ParseResult& legacy) {
+	char line[192];
+	snprintf(line, sizeof(line), "%s, %u byte body: filtered %.0f ns, %u bytes heap, %u used of a %u byte arena; whole document %.0f ns, %u bytes heap, %u used",
+		name, (unsigned)legacy.bodyBytes, filtered.nanos, (unsigned)filtered.heapBytes, (unsigned)filtered.arenaBytes, (unsigned)AUTH_VALIDATE_DOC_SIZE,
+		legacy.nanos, (unsigned)legacy.heapBytes, (unsigned)legacy.arenaBytes);
+	TEST_MESSAGE(line);
+}
+
+void setUp() {
+	chunked = false;
+	padding = 0;
+	logins = 0;
+	AuthService.invalidateToken();
+}
+
+void tearDown() {
+}
+
+void test_login_with_known_length() {
+	TEST_ASSERT_TRUE(AuthService.refreshToken());
+	TEST_ASSERT_EQUAL_UINT32(1, logins);
+	TEST_ASSERT_TRUE(AuthService.checkCardValid("04A1B2C3"));
+	TEST_ASSERT_FALSE(AuthService.checkPinValid("0000"));
+	TEST_ASSERT_EQUAL_UINT32(1, logins);
+}
+
+void test_login_chunked() {
+	chunked = true;
+	TEST_ASSERT_TRUE(AuthService.refreshToken());
+	TEST_ASSERT_TRUE(AuthService.checkPinValid("1234"));
+	TEST_ASSERT_FALSE(AuthService.checkCardValid("00000000"));
+}
+
+void test_large_response_with_known_length() {
+	// Parsed straight off the stream; the filter keeps the arena small no
+	// matter how much else the response carries.
+	padding = 200;
+	TEST_ASSERT_TRUE(AuthService.checkCardValid("04A1B2C3"));
+}
+
+void test_large_chunked_response() {
+	// Decoded as the parser reads, so the size of the body doesn't matter
+	// either.
+	chunked = true;
+	padding = 200;
+	TEST_ASSERT_TRUE(AuthService.refreshToken(true));
+	TEST_ASSERT_TRUE(AuthService.checkCardValid("04A1B2C3"));
+	TEST_ASSERT_FALSE(AuthService.checkPinValid("0000"));
+}
+
+static String readChunked(const char* wire, bool* failed) {
+	WiFiClient source;
+	source.setTimeout(0);
+	source.loadResponse(wire);
+	ChunkedStream body(source);
+	String decoded;
+	int c;
+	while ((c = body.read()) >= 0) {
+		decoded += (char)c;
+	}
+
+	*failed = body.failed();
+	return decoded;
+}
+
+void test_chunk_framing() {
+	bool failed;
+	String decoded = readChunked("3;ext=1\r\n{\"a\r\nA\r\n\":true}   \r\n0\r\nX-Trailer: 1\r\n\r\n", &failed);
+	TEST_ASSERT_FALSE(failed);
+	TEST_ASSERT_EQUAL_STRING("{\"a\":true}   ", decoded.c_str());
+
+	// A bad size line or a body cut short is an error, not the end.
+	readChunked("zz\r\n{}\r\n0\r\n\r\n", &failed);
+	TEST_ASSERT_TRUE(failed);
+	readChunked("10\r\n{}", &failed);
+	TEST_ASSERT_TRUE(failed);
+}
+
+void test_benchmark_known_length() {
+	padding = 4;
+	ParseResult filtered = bench(filteredParse);
+	ParseResult legacy = bench(legacyParse);
+	report("known length", filtered, legacy);
+	TEST_ASSERT_TRUE(filtered.arenaBytes <= AUTH_VALIDATE_DOC_SIZE);
+}
+
+void test_benchmark_chunked() {
+	chunked = true;
+	padding = 4;
+	ParseResult filtered = bench(filteredParse);
+	ParseResult legacy = bench(legacyParse);
+	report("chunked", filtered, legacy);
+	TEST_ASSERT_TRUE(filtered.arenaBytes <= AUTH_VALIDATE_DOC_SIZE);
+}
+
+void setup() {
+	UNITY_BEGIN();
+	WiFi.begin("bench", "bench");
+	HTTPClient::setResponder(respond);
+	AuthService.begin();
+	AuthService.setLoginEndpoint(API_LOGIN);
+	AuthService.setCardAuthEndpoint(API_CARD);
+	AuthService.setPinAuthEndpoint(API_PIN);
+	AuthService.setApiCredentials("controller", "secret");
+
+	RUN_TEST(test_login_with_known_length);
+	RUN_TEST(test_login_chunked);
+	RUN_TEST(test_large_response_with_known_length);
+	RUN_TEST(test_large_chunked_response);
+	RUN_TEST(test_chunk_framing);
+	RUN_TEST(test_benchmark_known_length);
+	RUN_TEST(test_benchmark_chunked);
+	nativeExit(UNITY_END());
+}
+
+void loop() {
+}
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <WiFi.h>
+#include "App.h"
+#include "NativeHarness.h"
+#include "services/AuthService.h"
+#include "tasks/TaskAuthWorker.h"
+#include "tasks/TaskRefreshAuthToken.h"
+
+// Token caching and connection reuse in AuthService against a stand-in
+// API. Token lifetimes run on the virtual clock, so waiting them out takes
+// no real time.
+
+#define API_LOGIN "http://api.local/login"
+#define API_CARD "http://api.local/card"
+#define API_PIN "http://api.local/pin"
+#define BENCH_TTL 120                   // Token lifetime the stand-in hands out (seconds).
+#define BENCH_SHORT_TTL 30              // A lifetime shorter than the refresh margin (seconds).
+#define BENCH_LONG_TTL 300              // Leaves the refresh task room ahead of the checks (seconds).
+
+static Application app;
+static uint32_t logins;
+static uint32_t validations;
+static uint32_t tokenSerial;        // Bumped to revoke every token issued so far.
+static int32_t expiresIn;           // Left out of the login response when negative.
+static bool keepAlive;
+
+static String currentToken() {
+	return String("token-") + String(tokenSerial);
+}
+
+static int respond(HTTPExchange& exchange) {
+	exchange.keepAlive = keepAlive;
+	if (exchange.url == API_LOGIN) {
+		logins++;
+		exchange.body = "{\"token\":\"" + currentToken() + "\"";
+		if (expiresIn >= 0) {
+			exchange.body += ",\"expiresIn\":" + String(expiresIn);
+		}
+
+		exchange.body += "}";
+		return HTTP_CODE_OK;
+	}
+
+	if (exchange.authorization != "Bearer " + currentToken()) {
+		return HTTP_CODE_UNAUTHORIZED;
+	}
+
+	validations++;
+	exchange.body = "{\"accepted\":true}";
+	return HTTP_CODE_OK;
+}
+
+static void waitSeconds(uint32_t seconds) {
+	vTaskDelay((seconds * 1000UL) / portTICK_PERIOD_MS);
+}
+
+void setUp() {
+	logins = 0;
+	validations = 0;
+	tokenSerial++;
+	expiresIn = BENCH_TTL;
+	keepAlive = true;
+	AuthService.invalidateToken();
+}
+
+void tearDown() {
+}
+
+void test_token_is_cached_between_checks() {
+	for (uint8_t i = 0; i < 5; i++) {
+		TEST_ASSERT_TRUE(AuthService.checkCardValid("04A1B2C3"));
+		TEST_ASSERT_TRUE(AuthService.checkPinValid("1234"));
+	}
+
+	TEST_ASSERT_EQUAL_UINT32(1, logins);
+	TEST_ASSERT_EQUAL_UINT32(10, validations);
+}
+
+void test_token_is_refreshed_before_it_expires() {
+	TEST_ASSERT_TRUE(AuthService.checkCardValid("04A1B2C3"));
+
+	// Still outside the refresh margin.
+	waitSeconds(BENCH_TTL - (AUTH_TOKEN_REFRESH_MARGIN / 1000) - 1);
+	TEST_ASSERT_TRUE(AuthService.checkCardValid("04A1B2C3"));
+	TEST_ASSERT_EQUAL_UINT32(1, logins);
+
+	// Inside it: renewed ahead of the expiry, not after a rejection.
+	waitSeconds(2);
+	TEST_ASSERT_TRUE(AuthService.checkCardValid("04A1B2C3"));
+	TEST_ASSERT_EQUAL_UINT32(2, logins);
+	TEST_ASSERT_EQUAL_UINT32(3, validations);
+}
+
+void test_default_lifetime_without_expires_in() {
+	expiresIn = -1;
+	TEST_ASSERT_TRUE(AuthService.checkCardValid("04A1B2C3"));
+	waitSeconds(AUTH_TOKEN_DEFAULT_TTL - (AUTH_TOKEN_REFRESH_MARGIN / 1000) - 1);
+	TEST_ASSERT_TRUE(AuthService.checkCardValid("04A1B2C3"));
+	TEST_ASSERT_EQUAL_UINT32(1, logins);
+
+	waitSeconds(2);
+	TEST_ASSERT_TRUE(AuthService.checkCardValid("04A1B2C3"));
+	TEST_ASSERT_EQUAL_UINT32(2, logins);
+}
+
+void test_short_lifetime_is_still_cached() {
+	// Refreshed at half its lifetime, not on every check.
+	expiresIn = BENCH_SHORT_TTL;
+	for (uint8_t i = 0; i < 5; i++) {
+		TEST_ASSERT_TRUE(AuthService.checkCardValid("04A1B2C3"));
+		waitSeconds(2);
+	}
+
+	TEST_ASSERT_EQUAL_UINT32(1, logins);
+	waitSeconds((BENCH_SHORT_TTL / 2) - 10);
+	TEST_ASSERT_TRUE(AuthService.checkCardValid("04A1B2C3"));
+	TEST_ASSERT_EQUAL_UINT32(2, logins);
+}
+
+void test_revoked_token_is_replaced_once() {
+	TEST_ASSERT_TRUE(AuthService.checkCardValid("04A1B2C3"));
+
+	// The API revokes the token early. The check is retried with a new
+	// one.
+	tokenSerial++;
+	TEST_ASSERT_TRUE(AuthService.checkCardValid("04A1B2C3"));
+	TEST_ASSERT_EQUAL_UINT32(2, logins);
+	TEST_ASSERT_EQUAL_UINT32(2, validations);
+}
+
+void test_connection_is_kept_alive() {
+	// The login leaves the connection open; the checks all go over it.
+	TEST_ASSERT_TRUE(AuthService.refreshToken(true));
+	uint32_t connections = HTTPClient::getConnectionCount();
+	for (uint8_t i = 0; i < 10; i++) {
+		TEST_ASSERT_TRUE(AuthService.checkCardValid("04A1B2C3"));
+	}
+
+	TEST_ASSERT_EQUAL_UINT32(connections, HTTPClient::getConnectionCount());
+}
+
+void test_server_closing_the_connection() {
+	// Each response closes the connection, so every check opens a new one.
+	keepAlive = false;
+	TEST_ASSERT_TRUE(AuthService.refreshToken(true));
+	uint32_t connections = HTTPClient::getConnectionCount();
+	for (uint8_t i = 0; i < 10; i++) {
+		TEST_ASSERT_TRUE(AuthService.checkCardValid("04A1B2C3"));
+	}
+
+	TEST_ASSERT_EQUAL_UINT32(connections + 10, HTTPClient::getConnectionCount());
+}
+
+void test_background_refresh_keeps_checks_off_the_login_path() {
+	expiresIn = BENCH_LONG_TTL;
+	TEST_ASSERT_TRUE(AuthService.checkCardValid("04A1B2C3"));
+	xTaskCreate(authTokenRefreshTask, "auth token refresh", AUTH_TOKEN_TASK_STACK_SIZE, NULL, 1, NULL);
+
+	// Over several lifetimes the task renews the token before the checks
+	// would, so the checks in between never log in themselves. The waits
+	// don't line up with the task's interval.
+	for (uint8_t i = 0; i < 20; i++) {
+		waitSeconds((BENCH_LONG_TTL / 4) + 7);
+		uint32_t before = logins;
+		TEST_ASSERT_TRUE(AuthService.checkCardValid("04A1B2C3"));
+		TEST_ASSERT_EQUAL_UINT32(before, logins);
+	}
+
+	TEST_ASSERT_TRUE(logins > 1);
+}
+
+void test_worker_waits_for_a_busy_main_loop() {
+	// More checks than the result queue holds while the main loop is busy
+	// elsewhere. None of the decisions may be dropped.
+	app.authRequestQueue = xQueueCreate(AUTH_QUEUE_DEPTH, sizeof(AuthRequest));
+	app.authResultQueue = xQueueCreate(AUTH_QUEUE_DEPTH, sizeof(AuthResult));
+	xTaskCreate(authWorkerTask, "auth worker", AUTH_WORKER_TASK_STACK_SIZE, NULL, 2, NULL);
+
+	AuthRequest request;
+	memset(&request, 0, sizeof(request));
+	request.type = AuthRequestType::CARD;
+	strcpy(request.credential, "04A1B2C3");
+	const uint8_t total = AUTH_QUEUE_DEPTH * 2;
+	uint8_t received = 0;
+	AuthResult result;
+	for (uint8_t i = 0; i < total; i++) {
+		request.sourceId = i;
+		request.deadline = millis() + AUTH_REQUEST_DEADLINE;
+		while (xQueueSend(app.authRequestQueue, &request, 0) != pdTRUE) {
+			// Stalled for a while, then catches up on one result.
+			waitSeconds(1);
+			TEST_ASSERT_TRUE(xQueueReceive(app.authResultQueue, &result, 0));
+			TEST_ASSERT_EQUAL_UINT8(received++, result.request.sourceId);
+		}
+	}
+
+	while (received < total && xQueueReceive(app.authResultQueue, &result, AUTH_RESULT_TIMEOUT / portTICK_PERIOD_MS)) {
+		TEST_ASSERT_EQUAL_UINT8(received++, result.request.sourceId);
+	}
+
+	TEST_ASSERT_EQUAL_UINT8(total, received);
+}
+
+void setup() {
+	UNITY_BEGIN();
+	WiFi.begin("bench", "bench");
+	HTTPClient::setResponder(respond);
+	AuthService.begin();
+	AuthService.setLoginEndpoint(API_LOGIN);
+	AuthService.setCardAuthEndpoint(API_CARD);
+	AuthService.setPinAuthEndpoint(API_PIN);
+	AuthService.setApiCredentials("controller", "secret");
+
+	RUN_TEST(test_token_is_cached_between_checks);
+	RUN_TEST(test_token_is_refreshed_before_it_expires);
+	RUN_TEST(test_default_lifetime_without_expires_in);
+	RUN_TEST(test_short_lifetime_is_still_cached);
+	RUN_TEST(test_revoked_token_is_replaced_once);
+	RUN_TEST(test_connection_is_kept_alive);
+	RUN_TEST(test_server_closing_the_connection);
+	RUN_TEST(test_worker_waits_for_a_busy_main_loop);
+	RUN_TEST(test_background_refresh_keeps_checks_off_the_login_path);
+	nativeExit(UNITY_END());
+}
+
+void loop() {
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "App.h"
+#include "MCP23017Device.h"
+#include "NativeHarness.h"
+#include "tasks/TaskApplication.h"
+
+// Command-to-relay latency: from a control message arriving at the broker
+// to the lock relay changing on the expander, through the MQTT network
+// task, the control queue and the main loop. Runs the whole firmware
+// against the files in data/ (door 0 locks with onboard relay 1) and
+// measures on the virtual clock.
+
+#define BENCH_PRIMARY_EXPANDER 0x20
+#define BENCH_EXPANDER_INT_PIN 17       // PIN_EXP_INT
+#define BENCH_RTC_ADDRESS 0x68
+#define BENCH_COMMANDS 20
+#define BENCH_TIMEOUT 1000              // Longest wait for the relay (milliseconds).
+
+// Timestamps every change of the lock relay output.
+class WatchedExpander : public MCP23017Device {
+public:
+	volatile unsigned long changedAt = 0;
+	volatile uint32_t changes = 0;
+
+	void onReceive(const uint8_t* data, size_t len) override {
+		uint8_t before = this->getOutput(PIN_RELAY_1);
+		MCP23017Device::onReceive(data, len);
+		if (this->getOutput(PIN_RELAY_1) != before) {
+			this->changedAt = micros();
+			this->changes++;
+		}
+	}
+};
+
+static WatchedExpander expander;
+static NullI2CDevice rtc;
+static Application app;
+
+void nativeSetup() {
+	expander.setInterruptPin(BENCH_EXPANDER_INT_PIN);
+	Wire.attach(BENCH_PRIMARY_EXPANDER, &expander);
+	Wire.attach(BENCH_RTC_ADDRESS, &rtc);
+}
+
+// Injects a lock or unlock command for door 0 and returns the time
+// (microseconds) until the relay followed.
+static uint32_t commandToRelay(ControlCommand command) {
+	char payload[64];
+	snprintf(payload, sizeof(payload), "{\"clientId\":\"cygate4\",\"command\":%u,\"door\":0}", (unsigned)command);
+	uint32_t changes = expander.changes;
+	unsigned long start = micros();
+	MqttBroker.inject(MQTT_TOPIC_CONTROL, payload);
+	for (uint32_t waited = 0; expander.changes == changes && waited < BENCH_TIMEOUT; waited++) {
+		vTaskDelay(1);
+	}
+
+	TEST_ASSERT_EQUAL_UINT32(changes + 1, expander.changes);
+	uint8_t expected = command == ControlCommand::UNLOCK_DOOR ? HIGH : LOW;
+	TEST_ASSERT_EQUAL(expected, expander.getOutput(PIN_RELAY_1));
+	return expander.changedAt - start;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_boot_connects_to_the_broker() {
+	// Connected once the first status snapshot has gone out.
+	for (uint32_t waited = 0; MqttBroker.getPublishCount() == 0 && waited < 30000; waited += 100) {
+		vTaskDelay(100 / portTICK_PERIOD_MS);
+	}
+
+	TEST_ASSERT_TRUE(MqttBroker.getPublishCount() > 0);
+}
+
+void test_command_to_relay_latency() {
+	uint32_t worst = 0;
+	uint64_t total = 0;
+	for (uint8_t i = 0; i < BENCH_COMMANDS; i++) {
+		// Arrive at a different point of the network task's cycle each time.
+		vTaskDelay((50 + (i * 3)) / portTICK_PERIOD_MS);
+		ControlCommand command = (i % 2) == 0 ? ControlCommand::UNLOCK_DOOR : ControlCommand::LOCK_DOOR;
+		uint32_t elapsed = commandToRelay(command);
+		total += elapsed;
+		worst = max(worst, elapsed);
+	}
+
+	char line[96];
+	snprintf(line, sizeof(line), "%d commands: mean %lu us, worst %lu us", BENCH_COMMANDS,
+		(unsigned long)(total / BENCH_COMMANDS), (unsigned long)worst);
+	TEST_MESSAGE(line);
+
+	// Up to one network task period until the message is picked up, then
+	// the main loop's idle sleep and a tick of rounding.
+	TEST_ASSERT_LESS_OR_EQUAL((MQTT_SERVICE_INTERVAL + 2) * 1000UL, worst);
+}
+
+void setup() {
+	UNITY_BEGIN();
+	initApplication();
+	RUN_TEST(test_boot_connects_to_the_broker);
+	RUN_TEST(test_command_to_relay_latency);
+	nativeExit(UNITY_END());
+}
+
+void loop() {
+}
\ No newline at end of file
@@ -0,0 +1,220 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <rom/crc.h>
+#include "NativeHarness.h"
+#include "services/EventSpool.h"
+
+// Each test starts from an erased partition. A reboot is modelled by a
+// fresh EventSpoolClass recovering from what the last one left in flash.
+
+static const esp_partition_t* partition;
+static EventSpoolClass* spool;
+static uint32_t capacity;
+
+static AccessEvent makeEvent(uint32_t sequence) {
+	AccessEvent event;
+	memset(&event, 0, sizeof(event));
+	event.sequence = sequence;
+	event.timestamp = 1700000000 + sequence;
+	event.type = AccessEventType::FOB_GRANTED;
+	event.sourceId = sequence & 0x0F;
+	event.credentialLen = 4;
+	memcpy(event.credential, &sequence, sizeof(sequence));
+	return event;
+}
+
+static void append(uint32_t first, uint32_t last) {
+	for (uint32_t seq = first; seq <= last; seq++) {
+		AccessEvent event = makeEvent(seq);
+		TEST_ASSERT_TRUE(spool->append(&event));
+	}
+}
+
+// Peeks and consumes count events, which must come out in order starting
+// at first.
+static void deliver(uint32_t first, uint32_t count) {
+	AccessEvent event;
+	for (uint32_t i = 0; i < count; i++) {
+		TEST_ASSERT_TRUE(spool->peek(&event));
+		TEST_ASSERT_EQUAL_UINT32(first + i, event.sequence);
+		AccessEvent expected = makeEvent(first + i);
+		TEST_ASSERT_EQUAL_MEMORY(&expected, &event, sizeof(AccessEvent));
+		spool->consume(event.sequence);
+	}
+}
+
+static void reboot() {
+	delete spool;
+	spool = new EventSpoolClass();
+	TEST_ASSERT_TRUE(spool->begin());
+}
+
+static size_t recordOffset(uint16_t sector, uint16_t slot) {
+	return ((size_t)sector * SPOOL_SECTOR_SIZE) + SPOOL_HEADER_SIZE + ((size_t)slot * SPOOL_RECORD_SIZE);
+}
+
+void setUp() {
+	partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, SPOOL_PARTITION_SUBTYPE, SPOOL_PARTITION_LABEL);
+	TEST_ASSERT_NOT_NULL(partition);
+	TEST_ASSERT_EQUAL(ESP_OK, esp_partition_erase_range(partition, 0, partition->size));
+	capacity = (partition->size / SPOOL_SECTOR_SIZE) * SPOOL_RECORDS_PER_SECTOR;
+	spool = new EventSpoolClass();
+	TEST_ASSERT_TRUE(spool->begin());
+}
+
+void tearDown() {
+	delete spool;
+	spool = nullptr;
+}
+
+void test_events_are_delivered_in_order() {
+	append(1, 10);
+	TEST_ASSERT_EQUAL_UINT32(10, spool->getPendingCount());
+	deliver(1, 10);
+
+	AccessEvent event;
+	TEST_ASSERT_FALSE(spool->peek(&event));
+	TEST_ASSERT_EQUAL_UINT32(0, spool->getPendingCount());
+}
+
+void test_consume_ignores_a_stale_sequence() {
+	append(1, 2);
+	spool->consume(2);
+	TEST_ASSERT_EQUAL_UINT32(2, spool->getPendingCount());
+	deliver(1, 2);
+}
+
+void test_discarded_event_is_counted_as_lost() {
+	append(1, 3);
+	spool->discard(3);
+	TEST_ASSERT_EQUAL_UINT32(0, spool->getLostCount());
+
+	spool->discard(1);
+	TEST_ASSERT_EQUAL_UINT32(1, spool->getLostCount());
+	TEST_ASSERT_EQUAL_UINT32(2, spool->getPendingCount());
+	deliver(2, 2);
+}
+
+void test_wraparound_keeps_every_event() {
+	// Three laps of the ring with a small backlog, so sectors are erased
+	// and reopened many times without ever dropping anything.
+	uint32_t seq = 1;
+	while (seq <= capacity * 3) {
+		append(seq, seq + 9);
+		deliver(seq, 7);
+		deliver(seq + 7, 3);
+		seq += 10;
+	}
+
+	TEST_ASSERT_EQUAL_UINT32(0, spool->getLostCount());
+	append(seq, seq + 4);
+	reboot();
+	TEST_ASSERT_EQUAL_UINT32(5, spool->getPendingCount());
+	TEST_ASSERT_EQUAL_UINT32(seq + 4, spool->getLastSequence());
+	deliver(seq, 5);
+}
+
+void test_full_ring_drops_the_oldest_sector() {
+	append(1, capacity);
+	TEST_ASSERT_EQUAL_UINT32(capacity, spool->getPendingCount());
+	TEST_ASSERT_EQUAL_UINT32(0, spool->getLostCount());
+
+	// One more event reclaims the oldest sector.
+	append(capacity + 1, capacity + 1);
+	TEST_ASSERT_EQUAL_UINT32(SPOOL_RECORDS_PER_SECTOR, spool->getLostCount());
+	TEST_ASSERT_EQUAL_UINT32(capacity + 1 - SPOOL_RECORDS_PER_SECTOR, spool->getPendingCount());
+	deliver(SPOOL_RECORDS_PER_SECTOR + 1, capacity + 1 - SPOOL_RECORDS_PER_SECTOR);
+}
+
+void test_full_ring_with_partial_delivery() {
+	// The tail sector is half delivered when it is reclaimed; only the
+	// undelivered half counts as lost.
+	append(1, capacity);
+	deliver(1, 50);
+	append(capacity + 1, capacity + 1);
+	TEST_ASSERT_EQUAL_UINT32(SPOOL_RECORDS_PER_SECTOR - 50, spool->getLostCount());
+	deliver(SPOOL_RECORDS_PER_SECTOR + 1, 5);
+}
+
+void test_torn_write_is_skipped() {
+	append(1, 3);
+
+	// Power lost half way through writing the fourth record: the event is
+	// partly programmed and its CRC and consumed words are still erased.
+	AccessEvent torn = makeEvent(4);
+	TEST_ASSERT_EQUAL(ESP_OK, esp_partition_write(partition, recordOffset(0, 3), &torn, sizeof(AccessEvent) / 2));
+
+	reboot();
+	TEST_ASSERT_EQUAL_UINT32(3, spool->getPendingCount());
+	TEST_ASSERT_EQUAL_UINT32(3, spool->getLastSequence());
+
+	// The next record goes after the torn one, never on top of it.
+	append(4, 5);
+	spool_record_t record;
+	TEST_ASSERT_EQUAL(ESP_OK, esp_partition_read(partition, recordOffset(0, 4), &record, sizeof(record)));
+	TEST_ASSERT_EQUAL_UINT32(4, record.event.sequence);
+	deliver(1, 5);
+}
+
+void test_corrupt_record_is_skipped() {
+	append(1, 3);
+
+	// A bit flipped in a complete record: the CRC no longer matches.
+	uint8_t damaged = 0x00;
+	TEST_ASSERT_EQUAL(ESP_OK, esp_partition_write(partition, recordOffset(0, 1) + offsetof(AccessEvent, timestamp), &damaged, 1));
+
+	reboot();
+	TEST_ASSERT_EQUAL_UINT32(2, spool->getPendingCount());
+	deliver(1, 1);
+	deliver(3, 1);
+}
+
+void test_reboot_recovers_pending_events() {
+	append(1, 200);
+	deliver(1, 150);
+	reboot();
+
+	TEST_ASSERT_EQUAL_UINT32(50, spool->getPendingCount());
+	TEST_ASSERT_EQUAL_UINT32(200, spool->getLastSequence());
+	deliver(151, 50);
+}
+
+void test_reboot_keeps_the_sequence_once_everything_is_delivered() {
+	append(1, 20);
+	deliver(1, 20);
+	reboot();
+
+	TEST_ASSERT_EQUAL_UINT32(0, spool->getPendingCount());
+	TEST_ASSERT_EQUAL_UINT32(20, spool->getLastSequence());
+
+	// Appends continue where the last boot left off.
+	append(21, 22);
+	reboot();
+	TEST_ASSERT_EQUAL_UINT32(2, spool->getPendingCount());
+	deliver(21, 2);
+}
+
+void test_empty_partition_starts_at_zero() {
+	reboot();
+	TEST_ASSERT_EQUAL_UINT32(0, spool->getPendingCount());
+	TEST_ASSERT_EQUAL_UINT32(0, spool->getLastSequence());
+}
+
+void setup() {
+	UNITY_BEGIN();
+	RUN_TEST(test_events_are_delivered_in_order);
+	RUN_TEST(test_consume_ignores_a_stale_sequence);
+	RUN_TEST(test_discarded_event_is_counted_as_lost);
+	RUN_TEST(test_wraparound_keeps_every_event);
+	RUN_TEST(test_full_ring_drops_the_oldest_sector);
+	RUN_TEST(test_full_ring_with_partial_delivery);
+	RUN_TEST(test_torn_write_is_skipped);
+	RUN_TEST(test_corrupt_record_is_skipped);
+	RUN_TEST(test_reboot_recovers_pending_events);
+	RUN_TEST(test_reboot_keeps_the_sequence_once_everything_is_delivered);
+	RUN_TEST(test_empty_partition_starts_at_zero);
+	nativeExit(UNITY_END());
+}
+
+void loop() {
+}
\ No newline at end of file
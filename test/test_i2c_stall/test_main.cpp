@@ -0,0 +1,164 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "App.h"
+#include "NativeHarness.h"
+#include "tasks/TaskCheckFobReaders.h"
+#include "tasks/TaskCheckKeypads.h"
+
+// Polls a healthy keypad alongside a keypad and a fob reader that stop
+// answering, and measures the worst gap (virtual time) between two polls
+// of the healthy keypad. A stalled device may cost the others one bus
+// operation at a time, never a whole exchange.
+
+#define BENCH_HEALTHY_KEYPAD 0x30
+#define BENCH_STALLED_KEYPAD 0x31
+#define BENCH_STALLED_READER 0x40
+#define BENCH_RUN_TIME 5000             // Virtual time per scenario (milliseconds).
+
+enum class DeviceMode : uint8_t {
+	RESPONSIVE,     // Echoes the command followed by zeros (nothing to report).
+	BUSY,           // Acknowledges its address but never echoes a command.
+	STRETCHING      // Holds the clock for the whole Wire timeout on every read.
+};
+
+// Answers keypad and fob reader commands alike. Records the gap between
+// commands it receives.
+class BenchDevice : public I2CDevice {
+public:
+	volatile DeviceMode mode = DeviceMode::RESPONSIVE;
+	uint32_t commands = 0;
+	uint32_t worstGapUs = 0;
+
+	void reset() {
+		this->commands = 0;
+		this->worstGapUs = 0;
+	}
+
+	void onReceive(const uint8_t* data, size_t len) override {
+		if (len == 0) {
+			return;
+		}
+
+		unsigned long now = micros();
+		if (this->commands > 0 && now - this->_lastCommand > this->worstGapUs) {
+			this->worstGapUs = now - this->_lastCommand;
+		}
+
+		this->commands++;
+		this->_lastCommand = now;
+		this->_command = data[0];
+	}
+
+	size_t onRequest(uint8_t* buffer, size_t len) override {
+		switch (this->mode) {
+			case DeviceMode::RESPONSIVE:
+				memset(buffer, 0, len);
+				buffer[0] = this->_command;
+				return len;
+			case DeviceMode::BUSY:
+				memset(buffer, 0xFF, len);
+				return len;
+			case DeviceMode::STRETCHING:
+				delay(Wire.getTimeOut());
+				return 0;
+		}
+
+		return 0;
+	}
+
+private:
+	unsigned long _lastCommand = 0;
+	uint8_t _command = 0;
+};
+
+static BenchDevice healthyKeypad;
+static BenchDevice stalledKeypad;
+static BenchDevice stalledReader;
+static Application app;
+
+void nativeSetup() {
+	Wire.attach(BENCH_HEALTHY_KEYPAD, &healthyKeypad);
+	Wire.attach(BENCH_STALLED_KEYPAD, &stalledKeypad);
+	Wire.attach(BENCH_STALLED_READER, &stalledReader);
+}
+
+// Runs the tasks for BENCH_RUN_TIME with the two other devices in the
+// given mode and returns the healthy keypad's worst poll gap
+// (microseconds).
+static uint32_t measureWorstGap(DeviceMode mode, const char* label) {
+	stalledKeypad.mode = mode;
+	stalledReader.mode = mode;
+	vTaskDelay(100 / portTICK_PERIOD_MS);
+	healthyKeypad.reset();
+	vTaskDelay(BENCH_RUN_TIME / portTICK_PERIOD_MS);
+
+	char line[96];
+	snprintf(line, sizeof(line), "%s: %lu polls, worst gap %lu us", label,
+		(unsigned long)healthyKeypad.commands, (unsigned long)healthyKeypad.worstGapUs);
+	TEST_MESSAGE(line);
+	TEST_ASSERT_GREATER_THAN(0, healthyKeypad.commands);
+	return healthyKeypad.worstGapUs;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_worst_gap_with_every_device_answering() {
+	uint32_t worst = measureWorstGap(DeviceMode::RESPONSIVE, "all responsive");
+
+	// One poll interval plus the wait for the reply.
+	TEST_ASSERT_LESS_OR_EQUAL((KEYPAD_POLL_INTERVAL + 2 * I2C_EXCHANGE_RESPONSE_DELAY) * 1000UL, worst);
+}
+
+void test_busy_devices_do_not_delay_the_healthy_keypad() {
+	uint32_t worst = measureWorstGap(DeviceMode::BUSY, "busy keypad and reader");
+	TEST_ASSERT_LESS_OR_EQUAL((KEYPAD_POLL_INTERVAL + 2 * I2C_EXCHANGE_RESPONSE_DELAY) * 1000UL, worst);
+	TEST_ASSERT_GREATER_THAN(0, stalledKeypad.commands);
+}
+
+void test_stretching_devices_cost_at_most_one_wire_timeout_each() {
+	// Each stalled device can hold the bus for one Wire timeout per
+	// operation, and both may get in ahead of a single healthy poll.
+	uint32_t worst = measureWorstGap(DeviceMode::STRETCHING, "clock-stretching keypad and reader");
+	TEST_ASSERT_LESS_OR_EQUAL((KEYPAD_POLL_INTERVAL + 2 * I2C_EXCHANGE_RESPONSE_DELAY + 2 * I2C_BUS_WIRE_TIMEOUT) * 1000UL, worst);
+}
+
+void test_healthy_keypad_recovers_its_pace() {
+	uint32_t worst = measureWorstGap(DeviceMode::RESPONSIVE, "stalled devices answering again");
+	TEST_ASSERT_LESS_OR_EQUAL((KEYPAD_POLL_INTERVAL + 2 * I2C_EXCHANGE_RESPONSE_DELAY) * 1000UL, worst);
+}
+
+void setup() {
+	UNITY_BEGIN();
+	I2CBus.begin();
+
+	uint8_t keypadAddresses[] = { BENCH_HEALTHY_KEYPAD, BENCH_STALLED_KEYPAD };
+	for (uint8_t i = 0; i < sizeof(keypadAddresses); i++) {
+		Keypad kp;
+		kp.begin(keypadAddresses[i]);
+		kp.setId(i + 1);
+		app.keypads.push_back(kp);
+	}
+
+	FobReader reader;
+	reader.begin(BENCH_STALLED_READER);
+	reader.setId(1);
+	app.fobReaders.push_back(reader);
+
+	app.keypadQueue = xQueueCreate(4, sizeof(KeypadData));
+	app.fobReaderQueue = xQueueCreate(4, sizeof(Tag));
+	xTaskCreate(keypadTask, "keypad subsystem", KEYPAD_TASK_STACK_SIZE, NULL, 2, NULL);
+	xTaskCreate(fobReaderTask, "fob reader subsystem", FOB_READER_TASK_STACK_SIZE, NULL, 2, NULL);
+
+	RUN_TEST(test_worst_gap_with_every_device_answering);
+	RUN_TEST(test_busy_devices_do_not_delay_the_healthy_keypad);
+	RUN_TEST(test_stretching_devices_cost_at_most_one_wire_timeout_each);
+	RUN_TEST(test_healthy_keypad_recovers_its_pace);
+	nativeExit(UNITY_END());
+}
+
+void loop() {
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "InputFilter.h"
+#include "NativeHarness.h"
+
+#define DEBOUNCE_SAMPLES (INPUT_FILTER_DEFAULT_DEBOUNCE / INPUT_FILTER_SAMPLE_INTERVAL)
+#define BENCH_SAMPLES 4000000UL
+#define REFERENCE_SAMPLES 200000UL
+
+// One counter per zone, a zone at a time. Same rule as the vertical
+// counters: a zone takes a new value after reading it for its number of
+// consecutive samples.
+struct ReferenceFilter {
+	uint16_t state;
+	uint8_t count[INPUT_FILTER_ZONES];
+	uint8_t samples[INPUT_FILTER_ZONES];
+
+	uint16_t update(uint16_t raw) {
+		for (uint8_t zone = 0; zone < INPUT_FILTER_ZONES; zone++) {
+			uint16_t bit = 1 << zone;
+			if ((raw & bit) == (this->state & bit)) {
+				this->count[zone] = 0;
+			}
+			else if (++this->count[zone] >= this->samples[zone]) {
+				this->state ^= bit;
+				this->count[zone] = 0;
+			}
+		}
+
+		return this->state;
+	}
+};
+
+static InputFilterClass* filter;
+
+// Feeds a waveform (one raw word per sample) and returns the sample on
+// which the debounced state first differed from the initial state, or -1.
+static int firstChange(const uint16_t* samples, size_t count) {
+	uint16_t initial = filter->getState();
+	for (size_t i = 0; i < count; i++) {
+		if (filter->update(samples[i]) != initial) {
+			return (int)i;
+		}
+	}
+
+	return -1;
+}
+
+void setUp() {
+	filter = new InputFilterClass();
+	filter->reset(0);
+}
+
+void tearDown() {
+	delete filter;
+}
+
+void test_steady_edge_is_accepted_after_the_debounce_time() {
+	uint16_t wave[] = { 1, 1, 1, 1, 1, 1 };
+	TEST_ASSERT_EQUAL(DEBOUNCE_SAMPLES - 1, firstChange(wave, sizeof(wave) / sizeof(wave[0])));
+	TEST_ASSERT_FALSE(filter->isSettling());
+}
+
+void test_single_bounce_restarts_the_count() {
+	// Closes, bounces open once, then stays closed.
+	uint16_t wave[] = { 1, 0, 1, 1, 1, 1, 1, 1 };
+	TEST_ASSERT_EQUAL(2 + DEBOUNCE_SAMPLES - 1, firstChange(wave, sizeof(wave) / sizeof(wave[0])));
+	TEST_ASSERT_EQUAL_HEX16(1, filter->getState());
+}
+
+void test_chatter_longer_than_the_window_is_rejected() {
+	// Chatters for ten debounce windows without ever holding still, and
+	// ends open.
+	uint16_t wave[DEBOUNCE_SAMPLES * 10];
+	for (size_t i = 0; i < sizeof(wave) / sizeof(wave[0]); i++) {
+		wave[i] = (i % 3) != 2;
+	}
+
+	wave[(sizeof(wave) / sizeof(wave[0])) - 1] = 0;
+	TEST_ASSERT_EQUAL(-1, firstChange(wave, sizeof(wave) / sizeof(wave[0])));
+
+	// Once it settles the edge goes through on schedule.
+	uint16_t settled[] = { 1, 1, 1, 1, 1 };
+	TEST_ASSERT_EQUAL(DEBOUNCE_SAMPLES - 1, firstChange(settled, sizeof(settled) / sizeof(settled[0])));
+}
+
+void test_glitch_shorter_than_the_window_is_rejected() {
+	// Two glitches, each one sample short of the window, don't add up.
+	uint16_t wave[DEBOUNCE_SAMPLES * 3];
+	memset(wave, 0, sizeof(wave));
+	for (uint8_t i = 0; i < DEBOUNCE_SAMPLES - 1; i++) {
+		wave[i] = 1;
+		wave[DEBOUNCE_SAMPLES + i] = 1;
+	}
+
+	TEST_ASSERT_EQUAL(-1, firstChange(wave, sizeof(wave) / sizeof(wave[0])));
+	TEST_ASSERT_FALSE(filter->isSettling());
+	TEST_ASSERT_EQUAL_HEX16(0, filter->getState());
+}
+
+void test_simultaneous_edges_across_all_zones() {
+	// Every zone changes on the same sample; zone N debounces for N + 1
+	// samples, so the zones must come through one at a time, in order.
+	for (uint8_t zone = 0; zone < INPUT_FILTER_ZONES; zone++) {
+		filter->setDebounceTime(zone, (zone + 1) * INPUT_FILTER_SAMPLE_INTERVAL);
+	}
+
+	for (uint8_t i = 0; i < INPUT_FILTER_ZONES; i++) {
+		uint16_t expected = (uint16_t)((1UL << (i + 1)) - 1);
+		TEST_ASSERT_EQUAL_HEX16(expected, filter->update(0xFFFF));
+		TEST_ASSERT_EQUAL(i + 1 < INPUT_FILTER_ZONES, filter->isSettling());
+	}
+
+	// And back, with the odd zones bouncing once on the way.
+	uint16_t wave[INPUT_FILTER_ZONES + 1];
+	for (uint8_t i = 0; i <= INPUT_FILTER_ZONES; i++) {
+		wave[i] = i == 1 ? 0xAAAA : 0;
+	}
+
+	filter->update(wave[0]);
+	TEST_ASSERT_EQUAL_HEX16(0xFFFE, filter->getState());
+	for (uint8_t i = 1; i <= INPUT_FILTER_ZONES; i++) {
+		filter->update(wave[i]);
+	}
+
+	// The odd zones started over a sample late, so zone 15 is still one
+	// short.
+	TEST_ASSERT_EQUAL_HEX16(0x8000, filter->getState());
+}
+
+void test_matches_per_zone_counters_on_random_input() {
+	ReferenceFilter reference;
+	memset(&reference, 0, sizeof(reference));
+	for (uint8_t zone = 0; zone < INPUT_FILTER_ZONES; zone++) {
+		uint16_t debounceMs = (zone * 7) % (INPUT_FILTER_MAX_SAMPLES * INPUT_FILTER_SAMPLE_INTERVAL);
+		filter->setDebounceTime(zone, debounceMs);
+		reference.samples[zone] = filter->getDebounceTime(zone) / INPUT_FILTER_SAMPLE_INTERVAL;
+	}
+
+	// Zones mostly hold their value, with bursts of noise.
+	uint32_t seed = 1;
+	uint16_t raw = 0;
+	for (uint32_t i = 0; i < REFERENCE_SAMPLES; i++) {
+		seed = seed * 1103515245 + 12345;
+		raw ^= (seed >> 16) & (seed >> 4) & (seed >> 9);
+		TEST_ASSERT_EQUAL_HEX16(reference.update(raw), filter->update(raw));
+	}
+}
+
+void test_benchmark_update() {
+	// Every zone bouncing at random, the worst case for both filters.
+	uint32_t seed = 1;
+	uint16_t checksum = 0;
+	uint16_t referenceChecksum = 0;
+	uint64_t start = nativeHostNanos();
+	for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+		seed = seed * 1103515245 + 12345;
+		checksum ^= filter->update(seed >> 16);
+	}
+
+	uint64_t verticalNanos = nativeHostNanos() - start;
+
+	ReferenceFilter reference;
+	memset(&reference, 0, sizeof(reference));
+	memset(reference.samples, DEBOUNCE_SAMPLES, sizeof(reference.samples));
+	seed = 1;
+	start = nativeHostNanos();
+	for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+		seed = seed * 1103515245 + 12345;
+		referenceChecksum ^= reference.update(seed >> 16);
+	}
+
+	uint64_t referenceNanos = nativeHostNanos() - start;
+
+	char line[128];
+	snprintf(line, sizeof(line), "16 zones: vertical counters %.1f ns/sample, per-zone counters %.1f ns/sample",
+		(double)verticalNanos / BENCH_SAMPLES, (double)referenceNanos / BENCH_SAMPLES);
+	TEST_MESSAGE(line);
+	TEST_ASSERT_EQUAL_HEX16(referenceChecksum, checksum);
+}
+
+void setup() {
+	UNITY_BEGIN();
+	RUN_TEST(test_steady_edge_is_accepted_after_the_debounce_time);
+	RUN_TEST(test_single_bounce_restarts_the_count);
+	RUN_TEST(test_chatter_longer_than_the_window_is_rejected);
+	RUN_TEST(test_glitch_shorter_than_the_window_is_rejected);
+	RUN_TEST(test_simultaneous_edges_across_all_zones);
+	RUN_TEST(test_matches_per_zone_counters_on_random_input);
+	RUN_TEST(test_benchmark_update);
+	nativeExit(UNITY_END());
+}
+
+void loop() {
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "MqttOutbox.h"
+#include "NativeHarness.h"
+
+#define MAX_SENT 8
+
+static MqttOutboxClass* outbox;
+static MqttTopic sentTopics[MAX_SENT];
+static char sentPayloads[MAX_SENT][8];
+static uint8_t sentCount;
+
+static bool recordPublish(MqttTopic topic, const uint8_t* payload, size_t length) {
+	if (sentCount < MAX_SENT) {
+		sentTopics[sentCount] = topic;
+		memcpy(sentPayloads[sentCount], payload, length);
+		sentPayloads[sentCount][length] = 0;
+		sentCount++;
+	}
+
+	return true;
+}
+
+static bool failPublish(MqttTopic topic, const uint8_t* payload, size_t length) {
+	return false;
+}
+
+static MqttTopic failedTopic;
+static uint32_t failedContexts;
+
+static void recordFailure(MqttTopic topic, uint32_t context) {
+	failedTopic = topic;
+	failedContexts |= context;
+}
+
+static void push(MqttTopic topic, const char* payload, uint8_t coalesceKey) {
+	TEST_ASSERT_TRUE(outbox->push(topic, (const uint8_t*)payload, strlen(payload), coalesceKey));
+}
+
+void setUp() {
+	outbox = new MqttOutboxClass();
+	sentCount = 0;
+	failedContexts = 0;
+}
+
+void tearDown() {
+	delete outbox;
+}
+
+void test_adjacent_duplicate_is_skipped() {
+	push(MqttTopic::STATUS, "s1", MQTT_COALESCE_FULL_STATUS);
+	push(MqttTopic::STATUS, "s2", MQTT_COALESCE_FULL_STATUS);
+	outbox->drain(recordPublish, MQTT_OUTBOX_DEPTH);
+
+	MqttOutboxStats stats;
+	outbox->getStats(&stats);
+	TEST_ASSERT_EQUAL(1, sentCount);
+	TEST_ASSERT_EQUAL_STRING("s2", sentPayloads[0]);
+	TEST_ASSERT_EQUAL(1, stats.coalesced);
+}
+
+void test_duplicate_behind_other_messages_is_skipped() {
+	push(MqttTopic::STATUS, "s1", MQTT_COALESCE_FULL_STATUS);
+	push(MqttTopic::EVENTS, "e1", MQTT_COALESCE_NONE);
+	push(MqttTopic::DIAG, "h1", MQTT_COALESCE_HEAP_STATS);
+	push(MqttTopic::STATUS, "s2", MQTT_COALESCE_FULL_STATUS);
+	outbox->drain(recordPublish, MQTT_OUTBOX_DEPTH);
+
+	TEST_ASSERT_EQUAL(3, sentCount);
+	TEST_ASSERT_EQUAL_STRING("e1", sentPayloads[0]);
+	TEST_ASSERT_EQUAL_STRING("h1", sentPayloads[1]);
+	TEST_ASSERT_EQUAL_STRING("s2", sentPayloads[2]);
+}
+
+void test_different_keys_are_kept() {
+	push(MqttTopic::DIAG, "t1", MQTT_COALESCE_TASK_STATS);
+	push(MqttTopic::DIAG, "h1", MQTT_COALESCE_HEAP_STATS);
+	push(MqttTopic::DIAG, "l1", MQTT_COALESCE_NONE);
+	push(MqttTopic::DIAG, "l2", MQTT_COALESCE_NONE);
+	outbox->drain(recordPublish, MQTT_OUTBOX_DEPTH);
+
+	TEST_ASSERT_EQUAL(4, sentCount);
+}
+
+void test_duplicate_already_drained_is_not_counted() {
+	push(MqttTopic::STATUS, "s1", MQTT_COALESCE_FULL_STATUS);
+	outbox->drain(recordPublish, MQTT_OUTBOX_DEPTH);
+	push(MqttTopic::STATUS, "s2", MQTT_COALESCE_FULL_STATUS);
+	outbox->drain(recordPublish, MQTT_OUTBOX_DEPTH);
+
+	TEST_ASSERT_EQUAL(2, sentCount);
+	TEST_ASSERT_EQUAL_STRING("s1", sentPayloads[0]);
+	TEST_ASSERT_EQUAL_STRING("s2", sentPayloads[1]);
+}
+
+void test_failed_publish_hands_back_context() {
+	TEST_ASSERT_TRUE(outbox->push(MqttTopic::STATUS, (const uint8_t*)"d1", 2, MQTT_COALESCE_NONE, 0x0105));
+	TEST_ASSERT_TRUE(outbox->push(MqttTopic::STATUS, (const uint8_t*)"d2", 2, MQTT_COALESCE_NONE, 0x0200));
+	TEST_ASSERT_EQUAL(2, outbox->drain(failPublish, MQTT_OUTBOX_DEPTH, recordFailure));
+
+	MqttOutboxStats stats;
+	outbox->getStats(&stats);
+	TEST_ASSERT_EQUAL(2, stats.failed);
+	TEST_ASSERT_EQUAL(MqttTopic::STATUS, failedTopic);
+	TEST_ASSERT_EQUAL_UINT32(0x0305, failedContexts);
+}
+
+void test_sent_and_coalesced_messages_are_not_handed_back() {
+	TEST_ASSERT_TRUE(outbox->push(MqttTopic::STATUS, (const uint8_t*)"s1", 2, MQTT_COALESCE_FULL_STATUS, 0x01));
+	TEST_ASSERT_TRUE(outbox->push(MqttTopic::STATUS, (const uint8_t*)"s2", 2, MQTT_COALESCE_FULL_STATUS, 0x02));
+	outbox->drain(recordPublish, MQTT_OUTBOX_DEPTH, recordFailure);
+
+	TEST_ASSERT_EQUAL(1, sentCount);
+	TEST_ASSERT_EQUAL_UINT32(0, failedContexts);
+}
+
+void setup() {
+	UNITY_BEGIN();
+	RUN_TEST(test_adjacent_duplicate_is_skipped);
+	RUN_TEST(test_duplicate_behind_other_messages_is_skipped);
+	RUN_TEST(test_different_keys_are_kept);
+	RUN_TEST(test_duplicate_already_drained_is_not_counted);
+	RUN_TEST(test_failed_publish_hands_back_context);
+	RUN_TEST(test_sent_and_coalesced_messages_are_not_handed_back);
+	nativeExit(UNITY_END());
+}
+
+void loop() {
+}
\ No newline at end of file
@@ -0,0 +1,207 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "App.h"
+#include "NativeHarness.h"
+#include "TelemetryHelper.h"
+
+// Encode/decode time and payload size of the status and control documents
+// in each wire format. The documents follow publishSystemState() and
+// parseControlRequest(), with every door, reader, keypad and input slot
+// in use.
+
+#define BENCH_ROUNDS 20000UL
+#define BENCH_SUBSCRIBER_DOC_SIZE 16384     // Decoded full status, topology included.
+
+struct FormatResult {
+	size_t length;
+	double encodeNanos;
+	double decodeNanos;
+};
+
+static char topology[STATUS_TOPOLOGY_SIZE];
+static size_t topologyLength;
+static char payload[STATUS_PAYLOAD_SIZE];
+static byte scratch[STATUS_PAYLOAD_SIZE];
+
+static void buildTopology(PayloadFormat format) {
+	DynamicJsonDocument doc(STATUS_TOPOLOGY_SIZE * 2);
+	JsonArray theDoors = doc.to<JsonArray>();
+	for (uint8_t id = 0; id < DOOR_MAX_DOORS; id++) {
+		JsonObject obj = theDoors.createNestedObject();
+		obj["id"] = id;
+		obj["name"] = "Front Entrance";
+
+		JsonObject rel = obj.createNestedObject("lockRelay");
+		rel["moduleId"] = 1;
+		rel["relayId"] = id + 1;
+
+		JsonArray readers = obj.createNestedArray("readers");
+		for (uint8_t r = 0; r < DOOR_MAX_READERS; r++) {
+			readers.createNestedObject()["id"] = (id * DOOR_MAX_READERS) + r + 1;
+		}
+
+		JsonArray keypads = obj.createNestedArray("keypads");
+		for (uint8_t k = 0; k < DOOR_MAX_KEYPADS; k++) {
+			keypads.createNestedObject()["id"] = (id * DOOR_MAX_KEYPADS) + k + 1;
+		}
+
+		JsonArray inputs = obj.createNestedArray("inputs");
+		for (uint8_t i = 0; i < DOOR_MAX_INPUTS; i++) {
+			JsonObject inp = inputs.createNestedObject();
+			inp["type"] = i % 4;
+			inp["moduleId"] = 0;
+			inp["inputId"] = (id * DOOR_MAX_INPUTS) + i;
+		}
+	}
+
+	TEST_ASSERT_FALSE(doc.overflowed());
+	topologyLength = TelemetryHelper::serializePayload(doc, topology, sizeof(topology), format);
+	TEST_ASSERT_TRUE(topologyLength > 0 && topologyLength < sizeof(topology) - 1);
+}
+
+static size_t encodeStatus(bool full, PayloadFormat format) {
+	StaticJsonDocument<STATUS_DOC_SIZE> doc;
+	doc["clientId"] = "CYGATE4";
+	doc["full"] = full;
+	if (full) {
+		doc["firmwareVersion"] = FIRMWARE_VERSION;
+		doc["topology"] = serialized((const char*)topology, topologyLength);
+		doc["systemState"] = (uint8_t)SystemState::NORMAL;
+		doc["armState"] = (uint8_t)ArmState::ARMED_STAY;
+		doc["statusMsg"] = "";
+	}
+
+	// A delta carries the one door that changed.
+	JsonArray theDoors = doc.createNestedArray("doors");
+	for (uint8_t id = 0; id < (full ? DOOR_MAX_DOORS : 1); id++) {
+		JsonObject obj = theDoors.createNestedObject();
+		obj["id"] = id;
+		obj["state"] = 1;
+		if (full) {
+			obj["enabled"] = 1;
+			obj["lockState"] = 2;
+		}
+	}
+
+	TEST_ASSERT_FALSE(doc.overflowed());
+	return TelemetryHelper::serializePayload(doc, payload, sizeof(payload), format);
+}
+
+static size_t encodeControl(PayloadFormat format) {
+	StaticJsonDocument<CONTROL_DOC_SIZE> doc;
+	doc["clientId"] = "CYGATE4";
+	doc["command"] = (uint8_t)ControlCommand::QUERY_JOURNAL;
+	doc["door"] = 3;
+	doc["from"] = 1700000000UL;
+	doc["to"] = 1700086400UL;
+	doc["cursor"] = 4096;
+	TEST_ASSERT_FALSE(doc.overflowed());
+	return TelemetryHelper::serializePayload(doc, payload, sizeof(payload), format);
+}
+
+// Decodes a copy of the payload, since zero-copy parsing modifies the
+// buffer it is given.
+template <size_t DOC_SIZE>
+static DeserializationError decode(StaticJsonDocument<DOC_SIZE>& doc, size_t length, PayloadFormat format) {
+	memcpy(scratch, payload, length);
+	return TelemetryHelper::deserializePayload(doc, scratch, length, format);
+}
+
+static FormatResult benchStatus(bool full, PayloadFormat format) {
+	FormatResult result;
+	buildTopology(format);
+	uint64_t start = nativeHostNanos();
+	for (uint32_t i = 0; i < BENCH_ROUNDS; i++) {
+		result.length = encodeStatus(full, format);
+	}
+
+	result.encodeNanos = (double)(nativeHostNanos() - start) / BENCH_ROUNDS;
+	TEST_ASSERT_TRUE(result.length > 0 && result.length < sizeof(payload) - 1);
+
+	// Received by a subscriber, so decoded into a document that also
+	// holds the topology.
+	StaticJsonDocument<BENCH_SUBSCRIBER_DOC_SIZE> doc;
+	start = nativeHostNanos();
+	for (uint32_t i = 0; i < BENCH_ROUNDS; i++) {
+		TEST_ASSERT_FALSE(decode(doc, result.length, format));
+	}
+
+	result.decodeNanos = (double)(nativeHostNanos() - start) / BENCH_ROUNDS;
+	TEST_ASSERT_EQUAL(full ? DOOR_MAX_DOORS : 1, doc["doors"].size());
+	TEST_ASSERT_EQUAL(1, doc["doors"][0]["state"].as<uint8_t>());
+	if (full) {
+		TEST_ASSERT_EQUAL(2, doc["doors"][DOOR_MAX_DOORS - 1]["lockState"].as<uint8_t>());
+		JsonVariant lastInput = doc["topology"][DOOR_MAX_DOORS - 1]["inputs"][DOOR_MAX_INPUTS - 1];
+		TEST_ASSERT_EQUAL((DOOR_MAX_DOORS * DOOR_MAX_INPUTS) - 1, lastInput["inputId"].as<uint8_t>());
+	}
+
+	return result;
+}
+
+static FormatResult benchControl(PayloadFormat format) {
+	FormatResult result;
+	uint64_t start = nativeHostNanos();
+	for (uint32_t i = 0; i < BENCH_ROUNDS; i++) {
+		result.length = encodeControl(format);
+	}
+
+	result.encodeNanos = (double)(nativeHostNanos() - start) / BENCH_ROUNDS;
+	TEST_ASSERT_TRUE(result.length > 0 && result.length <= MQTT_CONTROL_MAX_SIZE);
+
+	StaticJsonDocument<CONTROL_DOC_SIZE> doc;
+	start = nativeHostNanos();
+	for (uint32_t i = 0; i < BENCH_ROUNDS; i++) {
+		TEST_ASSERT_FALSE(decode(doc, result.length, format));
+	}
+
+	result.decodeNanos = (double)(nativeHostNanos() - start) / BENCH_ROUNDS;
+	TEST_ASSERT_EQUAL_STRING("CYGATE4", doc["clientId"].as<const char*>());
+	TEST_ASSERT_EQUAL(1700086400UL, doc["to"].as<uint32_t>());
+	return result;
+}
+
+static void report(const char* name, const FormatResult& json, const FormatResult& msgPack) {
+	char line[160];
+	snprintf(line, sizeof(line), "%s: JSON %u bytes, encode %.0f ns, decode %.0f ns; MessagePack %u bytes, encode %.0f ns, decode %.0f ns",
+		name, (unsigned)json.length, json.encodeNanos, json.decodeNanos,
+		(unsigned)msgPack.length, msgPack.encodeNanos, msgPack.decodeNanos);
+	TEST_MESSAGE(line);
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_full_status() {
+	FormatResult json = benchStatus(true, PayloadFormat::JSON);
+	FormatResult msgPack = benchStatus(true, PayloadFormat::MSGPACK);
+	report("full status", json, msgPack);
+	TEST_ASSERT_TRUE(msgPack.length < json.length);
+}
+
+void test_status_delta() {
+	FormatResult json = benchStatus(false, PayloadFormat::JSON);
+	FormatResult msgPack = benchStatus(false, PayloadFormat::MSGPACK);
+	report("status delta", json, msgPack);
+	TEST_ASSERT_TRUE(msgPack.length < json.length);
+}
+
+void test_control() {
+	FormatResult json = benchControl(PayloadFormat::JSON);
+	FormatResult msgPack = benchControl(PayloadFormat::MSGPACK);
+	report("control", json, msgPack);
+	TEST_ASSERT_TRUE(msgPack.length < json.length);
+}
+
+void setup() {
+	UNITY_BEGIN();
+	RUN_TEST(test_full_status);
+	RUN_TEST(test_status_delta);
+	RUN_TEST(test_control);
+	nativeExit(UNITY_END());
+}
+
+void loop() {
+}
\ No newline at end of file
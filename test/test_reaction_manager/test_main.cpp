@@ -0,0 +1,173 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "NativeHarness.h"
+#include "ReactionManager.h"
+
+#define BENCH_ACTIONS_PER_KEY 2
+#define BENCH_COMPILE_ROUNDS 200
+#define BENCH_LOOKUPS 2000000UL
+
+struct LinearRule {
+	uint8_t event;
+	uint8_t moduleId;
+	uint8_t sourceId;
+	ReactionAction action;
+};
+
+static vector<LinearRule> linearRules;
+
+static ReactionAction makeAction(uint16_t key, uint8_t n) {
+	ReactionAction action;
+	action.type = (ReactionActionType)(n % 2);
+	action.moduleId = key & 0xFF;
+	action.targetId = (key >> 8) + n;
+	return action;
+}
+
+// Stages BENCH_ACTIONS_PER_KEY actions for every (event, module, source),
+// interleaved the way a long rules file lists them.
+static void stageAllKeys() {
+	linearRules.clear();
+	ReactionManager.clear();
+	for (uint8_t n = 0; n < BENCH_ACTIONS_PER_KEY; n++) {
+		for (uint8_t e = 0; e < REACTION_EVENT_TYPES; e++) {
+			for (uint8_t m = 0; m < REACTION_MAX_MODULES; m++) {
+				for (uint8_t s = 0; s < REACTION_MAX_SOURCES; s++) {
+					uint16_t key = ((e * REACTION_MAX_MODULES) + m) * REACTION_MAX_SOURCES + s;
+					ReactionAction action = makeAction(key, n);
+					TEST_ASSERT_TRUE(ReactionManager.addRule((ReactionEvent)e, m, s, action));
+					LinearRule rule = { e, m, s, action };
+					linearRules.push_back(rule);
+				}
+			}
+		}
+	}
+}
+
+void setUp() {
+}
+
+void tearDown() {
+	ReactionManager.clear();
+}
+
+void test_every_key_dispatches_its_actions_in_file_order() {
+	stageAllKeys();
+	TEST_ASSERT_TRUE(ReactionManager.compile());
+	TEST_ASSERT_EQUAL(REACTION_TABLE_SIZE * BENCH_ACTIONS_PER_KEY, ReactionManager.getActionCount());
+
+	for (uint8_t e = 0; e < REACTION_EVENT_TYPES; e++) {
+		for (uint8_t m = 0; m < REACTION_MAX_MODULES; m++) {
+			for (uint8_t s = 0; s < REACTION_MAX_SOURCES; s++) {
+				uint16_t key = ((e * REACTION_MAX_MODULES) + m) * REACTION_MAX_SOURCES + s;
+				const ReactionAction* actions;
+				TEST_ASSERT_EQUAL(BENCH_ACTIONS_PER_KEY, ReactionManager.getActions((ReactionEvent)e, m, s, &actions));
+				for (uint8_t n = 0; n < BENCH_ACTIONS_PER_KEY; n++) {
+					ReactionAction expected = makeAction(key, n);
+					TEST_ASSERT_EQUAL(expected.type, actions[n].type);
+					TEST_ASSERT_EQUAL(expected.moduleId, actions[n].moduleId);
+					TEST_ASSERT_EQUAL(expected.targetId, actions[n].targetId);
+				}
+			}
+		}
+	}
+}
+
+void test_out_of_range_keys_dispatch_nothing() {
+	stageAllKeys();
+	TEST_ASSERT_TRUE(ReactionManager.compile());
+
+	const ReactionAction* actions;
+	TEST_ASSERT_EQUAL(0, ReactionManager.getActions((ReactionEvent)REACTION_EVENT_TYPES, 0, 0, &actions));
+	TEST_ASSERT_EQUAL(0, ReactionManager.getActions(ReactionEvent::ZONE_ACTIVE, REACTION_MAX_MODULES, 0, &actions));
+	TEST_ASSERT_EQUAL(0, ReactionManager.getActions(ReactionEvent::ZONE_ACTIVE, 0, REACTION_MAX_SOURCES, &actions));
+	TEST_ASSERT_FALSE(ReactionManager.addRule(ReactionEvent::ZONE_ACTIVE, REACTION_MAX_MODULES, 0, makeAction(0, 0)));
+}
+
+void test_full_action_table_compiles() {
+	// The offsets are 16 bit. The largest table addRule() accepts must
+	// still index correctly at the last key.
+	ReactionManager.clear();
+	uint32_t added = 0;
+	while (ReactionManager.addRule(ReactionEvent::ZONE_INACTIVE, REACTION_MAX_MODULES - 1, REACTION_MAX_SOURCES - 1, makeAction(0, 0))) {
+		added++;
+	}
+
+	TEST_ASSERT_EQUAL(REACTION_MAX_ACTIONS, added);
+	TEST_ASSERT_TRUE(ReactionManager.compile());
+
+	const ReactionAction* actions;
+	TEST_ASSERT_EQUAL(REACTION_MAX_ACTIONS, ReactionManager.getActions(ReactionEvent::ZONE_INACTIVE, REACTION_MAX_MODULES - 1, REACTION_MAX_SOURCES - 1, &actions));
+	TEST_ASSERT_EQUAL(0, ReactionManager.getActions(ReactionEvent::ZONE_INACTIVE, REACTION_MAX_MODULES - 1, REACTION_MAX_SOURCES - 2, &actions));
+}
+
+void test_benchmark_compile_and_dispatch() {
+	uint64_t stageTotal = 0;
+	uint64_t compileTotal = 0;
+	for (uint16_t round = 0; round < BENCH_COMPILE_ROUNDS; round++) {
+		uint64_t start = nativeHostNanos();
+		stageAllKeys();
+		uint64_t staged = nativeHostNanos();
+		TEST_ASSERT_TRUE(ReactionManager.compile());
+		compileTotal += nativeHostNanos() - staged;
+		stageTotal += staged - start;
+	}
+
+	// Same pseudo-random event sequence for both dispatchers.
+	uint32_t seed = 1;
+	uint32_t matched = 0;
+	uint64_t start = nativeHostNanos();
+	for (uint32_t i = 0; i < BENCH_LOOKUPS; i++) {
+		seed = seed * 1103515245 + 12345;
+		uint8_t e = (seed >> 8) % REACTION_EVENT_TYPES;
+		uint8_t m = (seed >> 16) % REACTION_MAX_MODULES;
+		uint8_t s = (seed >> 24) % REACTION_MAX_SOURCES;
+		const ReactionAction* actions;
+		uint16_t count = ReactionManager.getActions((ReactionEvent)e, m, s, &actions);
+		for (uint16_t n = 0; n < count; n++) {
+			matched += actions[n].targetId;
+		}
+	}
+	uint64_t tableNanos = nativeHostNanos() - start;
+
+	// What a scan over the parsed rules costs per event, for comparison.
+	seed = 1;
+	uint32_t scanned = 0;
+	uint32_t scanLookups = BENCH_LOOKUPS / 100;
+	start = nativeHostNanos();
+	for (uint32_t i = 0; i < scanLookups; i++) {
+		seed = seed * 1103515245 + 12345;
+		uint8_t e = (seed >> 8) % REACTION_EVENT_TYPES;
+		uint8_t m = (seed >> 16) % REACTION_MAX_MODULES;
+		uint8_t s = (seed >> 24) % REACTION_MAX_SOURCES;
+		for (auto r = linearRules.begin(); r != linearRules.end(); r++) {
+			if (r->event == e && r->moduleId == m && r->sourceId == s) {
+				scanned += r->action.targetId;
+			}
+		}
+	}
+	uint64_t scanNanos = nativeHostNanos() - start;
+
+	char line[160];
+	snprintf(line, sizeof(line), "%u actions: stage %.1f us, compile %.1f us",
+		(unsigned)ReactionManager.getActionCount(),
+		stageTotal / 1000.0 / BENCH_COMPILE_ROUNDS, compileTotal / 1000.0 / BENCH_COMPILE_ROUNDS);
+	TEST_MESSAGE(line);
+	snprintf(line, sizeof(line), "dispatch: table %.2f ns/event, linear scan %.1f ns/event (checksums %lu, %lu)",
+		(double)tableNanos / BENCH_LOOKUPS, (double)scanNanos / scanLookups,
+		(unsigned long)matched, (unsigned long)scanned);
+	TEST_MESSAGE(line);
+	TEST_ASSERT_TRUE(matched > 0 && scanned > 0);
+}
+
+void setup() {
+	UNITY_BEGIN();
+	RUN_TEST(test_every_key_dispatches_its_actions_in_file_order);
+	RUN_TEST(test_out_of_range_keys_dispatch_nothing);
+	RUN_TEST(test_full_action_table_compiles);
+	RUN_TEST(test_benchmark_compile_and_dispatch);
+	nativeExit(UNITY_END());
+}
+
+void loop() {
+}
\ No newline at end of file
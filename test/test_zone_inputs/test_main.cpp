@@ -0,0 +1,103 @@
+#include <Arduino.h>
+#include <unity.h>
+#include "App.h"
+#include "InputFilter.h"
+#include "MCP23017Device.h"
+#include "NativeHarness.h"
+#include "tasks/TaskInput.h"
+
+// Edge-to-snapshot latency for an expander zone, measured on the virtual
+// clock, with and without the expander's INT line wired to PIN_EXP_INT.
+// The tests share one input task and run in order: the line is only
+// connected half way through.
+
+#define BENCH_PRIMARY_EXPANDER 0x20
+#define BENCH_EDGES 12
+#define BENCH_ZONE_PIN 0                // GPA0, dry-contact zone 1.
+#define BENCH_SETTLE_BOUND (INPUT_FILTER_DEFAULT_DEBOUNCE + (2 * INPUT_FILTER_SAMPLE_INTERVAL))
+
+static MCP23017Device expander;
+static Application app;
+static Adafruit_MCP23017 primaryBus;
+static TaskHandle_t inputHandle;
+static uint8_t zoneLevel = HIGH;     // Pulled up while idle.
+
+void nativeSetup() {
+	// INTA is left unconnected until test_interrupt_line_is_detected_once_wired.
+	Wire.attach(BENCH_PRIMARY_EXPANDER, &expander);
+}
+
+// Toggles the zone at a different phase each time and returns the worst
+// time (microseconds) until the input task reported the edge.
+static uint32_t measureWorstLatency() {
+	uint32_t worst = 0;
+	for (uint8_t i = 0; i < BENCH_EDGES; i++) {
+		vTaskDelay((100 + (i * 7)) / portTICK_PERIOD_MS);
+		zoneLevel = !zoneLevel;
+		unsigned long start = micros();
+		expander.setInput(BENCH_ZONE_PIN, zoneLevel);
+
+		ZoneSnapshot snapshot;
+		TEST_ASSERT_TRUE(xQueueReceive(app.zoneQueue, &snapshot, 2000 / portTICK_PERIOD_MS) == pdTRUE);
+		uint16_t edges = zoneLevel ? snapshot.rising : snapshot.falling;
+		TEST_ASSERT_TRUE((edges & (1 << (ZONE_DRY_CONTACT_SHIFT + BENCH_ZONE_PIN))) != 0);
+		uint32_t elapsed = micros() - start;
+		if (elapsed > worst) {
+			worst = elapsed;
+		}
+	}
+
+	char line[96];
+	snprintf(line, sizeof(line), "worst edge-to-snapshot latency over %d edges: %lu us", BENCH_EDGES, (unsigned long)worst);
+	TEST_MESSAGE(line);
+	return worst;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_missing_interrupt_line_is_detected() {
+	TEST_ASSERT_FALSE(CoreIO.hasExpanderInterrupt());
+}
+
+void test_expander_zone_is_polled_without_interrupt() {
+	uint32_t worst = measureWorstLatency();
+	TEST_ASSERT_LESS_OR_EQUAL((ZONE_POLL_INTERVAL + BENCH_SETTLE_BOUND) * 1000UL, worst);
+}
+
+void test_interrupt_line_is_detected_once_wired() {
+	expander.setInterruptPin(PIN_EXP_INT);
+	CoreIO.enableInputInterrupts(inputHandle);
+	TEST_ASSERT_TRUE(CoreIO.hasExpanderInterrupt());
+}
+
+void test_expander_zone_interrupt_latency() {
+	uint32_t worst = measureWorstLatency();
+	TEST_ASSERT_LESS_OR_EQUAL(BENCH_SETTLE_BOUND * 1000UL, worst);
+}
+
+void setup() {
+	UNITY_BEGIN();
+	I2CBus.begin();
+	primaryBus.begin();
+	CoreIO.init(&primaryBus);
+	app.zoneQueue = xQueueCreate(ZONE_QUEUE_DEPTH, sizeof(ZoneSnapshot));
+	xTaskCreate(inputTask, "zone inputs", INPUT_TASK_STACK_SIZE, NULL, 2, &inputHandle);
+	CoreIO.enableInputInterrupts(inputHandle);
+
+	// The baseline snapshot.
+	ZoneSnapshot snapshot;
+	xQueueReceive(app.zoneQueue, &snapshot, 1000 / portTICK_PERIOD_MS);
+
+	RUN_TEST(test_missing_interrupt_line_is_detected);
+	RUN_TEST(test_expander_zone_is_polled_without_interrupt);
+	RUN_TEST(test_interrupt_line_is_detected_once_wired);
+	RUN_TEST(test_expander_zone_interrupt_latency);
+	nativeExit(UNITY_END());
+}
+
+void loop() {
+}
\ No newline at end of file
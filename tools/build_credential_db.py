@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+"""
+Builds a CyGate4 credential database image for the "creddb" flash partition.
+
+The input is a CSV file with one tag per line:
+
+    uid[,granted]
+
+where uid is the tag UID in hex (separators such as ':' or '-' are ignored)
+and granted is 1 (default) to allow access or 0 to explicitly deny it (ie. a
+lost or revoked fob). Lines starting with '#' are ignored.
+
+The resulting image can be flashed with:
+
+    esptool.py write_flash <creddb offset> creddb.bin
+
+The layout and hash functions must match src/services/CredentialStore.cpp.
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import time
+import zlib
+
+MAGIC = 0x42445943  # "CYDB"
+VERSION = 1
+HEADER_SIZE = 32
+MAX_UID_SIZE = 10
+ENTRY_SIZE = 12
+FLAG_GRANTED = 0x01
+DEFAULT_PARTITION_SIZE = 0x40000
+MASK32 = 0xFFFFFFFF
+
+
+def hash32(key, seed):
+    h = 0x811C9DC5 ^ seed
+    for b in key:
+        h ^= b
+        h = (h * 0x01000193) & MASK32
+
+    h ^= h >> 16
+    h = (h * 0x85EBCA6B) & MASK32
+    h ^= h >> 13
+    h = (h * 0xC2B2AE35) & MASK32
+    h ^= h >> 16
+    return h
+
+
+def is_prime(n):
+    if n < 2:
+        return False
+    if n % 2 == 0:
+        return n == 2
+    i = 3
+    while i * i <= n:
+        if n % i == 0:
+            return False
+        i += 2
+    return True
+
+
+def next_prime(n):
+    while not is_prime(n):
+        n += 1
+    return n
+
+
+def parse_uid(text):
+    digits = ''.join(c for c in text if c not in ':- ')
+    uid = bytes.fromhex(digits)
+    if len(uid) == 0 or len(uid) > MAX_UID_SIZE:
+        raise ValueError('UID must be 1 - %d bytes: %s' % (MAX_UID_SIZE, text))
+    return uid
+
+
+def load_tags(path):
+    tags = {}
+    with open(path, newline='') as f:
+        for lineno, row in enumerate(csv.reader(f), 1):
+            if not row or not row[0].strip() or row[0].strip().startswith('#'):
+                continue
+            uid = parse_uid(row[0].strip())
+            granted = True
+            if len(row) > 1 and row[1].strip():
+                granted = row[1].strip() not in ('0', 'false', 'no')
+            if uid in tags:
+                print('WARN: line %d: duplicate UID %s, last entry wins' % (lineno, uid.hex()), file=sys.stderr)
+            tags[uid] = granted
+    return tags
+
+
+def build(tags, seed, load, lam):
+    keys = list(tags.keys())
+    n = len(keys)
+    if n == 0:
+        return 0, 2, [], [None, None]
+
+    slot_count = next_prime(max(2, int(n / load)))
+    bucket_count = max(1, (n + lam - 1) // lam)
+
+    buckets = [[] for _ in range(bucket_count)]
+    for key in keys:
+        buckets[hash32(key, seed) % bucket_count].append(key)
+
+    displacements = [0] * bucket_count
+    slots = [None] * slot_count
+    order = sorted(range(bucket_count), key=lambda b: len(buckets[b]), reverse=True)
+    for b in order:
+        members = buckets[b]
+        if not members:
+            continue
+
+        pairs = [(hash32(k, seed + 1) % slot_count, (hash32(k, seed + 2) % (slot_count - 1)) + 1) for k in members]
+        for d in range(slot_count):
+            placed = [(h1 + d * h2) % slot_count for h1, h2 in pairs]
+            if len(set(placed)) == len(placed) and all(slots[s] is None for s in placed):
+                for key, s in zip(members, placed):
+                    slots[s] = key
+                displacements[b] = d
+                break
+        else:
+            return None
+
+    return bucket_count, slot_count, displacements, slots
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Build a CyGate4 credential database image.')
+    parser.add_argument('input', help='CSV file of tag UIDs (uid[,granted])')
+    parser.add_argument('-o', '--output', default='creddb.bin', help='output image path (default: creddb.bin)')
+    parser.add_argument('--partition-size', type=lambda x: int(x, 0), default=DEFAULT_PARTITION_SIZE,
+                        help='size of the creddb partition in bytes (default: 0x40000)')
+    parser.add_argument('--load', type=float, default=0.99, help='slot load factor, 1.0 = minimal (default: 0.99)')
+    parser.add_argument('--bucket-size', type=int, default=4, help='average keys per bucket (default: 4)')
+    args = parser.parse_args()
+
+    tags = load_tags(args.input)
+
+    result = None
+    seed = 0
+    for seed in range(0, 1000 * 3, 3):
+        result = build(tags, seed, args.load, args.bucket_size)
+        if result is not None:
+            break
+    if result is None:
+        print('ERROR: Unable to find a perfect hash for the input set.', file=sys.stderr)
+        return 1
+
+    bucket_count, slot_count, displacements, slots = result
+
+    body = bytearray()
+    for d in displacements:
+        body += struct.pack('<I', d)
+    for key in slots:
+        if key is None:
+            body += bytes(ENTRY_SIZE)
+        else:
+            flags = FLAG_GRANTED if tags[key] else 0
+            body += struct.pack('<BB', len(key), flags) + key.ljust(MAX_UID_SIZE, b'\x00')
+
+    header = struct.pack('<IHHIIIIII', MAGIC, VERSION, ENTRY_SIZE, len(tags), bucket_count,
+                         slot_count, seed, int(time.time()) & MASK32, zlib.crc32(body) & MASK32)
+    image = header + body
+    if len(image) > args.partition_size:
+        print('ERROR: Image size %d exceeds partition size %d.' % (len(image), args.partition_size), file=sys.stderr)
+        return 1
+
+    with open(args.output, 'wb') as f:
+        f.write(image)
+
+    print('INFO: Wrote %s: %d tags, %d buckets, %d slots, %d bytes.' % (
+        args.output, len(tags), bucket_count, slot_count, len(image)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())